@@ -42,7 +42,14 @@
 */
 #include <stdio.h>
 #include <string.h>
+#include "wizard/studio.h"
 #include "wizard/WizardsToolkit.h"
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+#include <sys/wait.h>
+#endif
+#include "wizard/chacha.h"
+#include "wizard/crc64.h"
+#include "wizard/poly1305.h"
 #include "validate.h"
 
 /*
@@ -106,10 +113,13 @@ static WizardBooleanType TestAES(void)
     i;
 
   StringInfo
+    *additional_data,
     *ciphertext,
     *key,
+    *nonce,
     *plaintext,
-    *results;
+    *results,
+    *tag;
 
   WizardBooleanType
     clone,
@@ -220,6 +230,104 @@ static WizardBooleanType TestAES(void)
   results=DestroyStringInfo(results);
   plaintext=DestroyStringInfo(plaintext);
   cipher_info=DestroyCipherInfo(cipher_info);
+  /*
+    Validate GCM mode.
+  */
+  (void) PrintValidateString(stdout,
+    "testing AES GCM-mode encipher/decipher:\n");
+  cipher_info=AcquireCipherInfo(AESCipher,GCMMode);
+  for (i=0; i < AESGCMTestVectors; i++)
+  {
+    (void) PrintValidateString(stdout,"  test %.17g (%.17g bit key) ",
+      (double) i+1,(double) (8*aes_gcm_test_vector[i].key_length));
+    key=AcquireStringInfo(aes_gcm_test_vector[i].key_length);
+    SetStringInfoDatum(key,aes_gcm_test_vector[i].key);
+    SetCipherKey(cipher_info,key);
+    nonce=AcquireStringInfo(GetCipherBlocksize(cipher_info));
+    SetStringInfoDatum(nonce,aes_gcm_test_vector[i].nonce);
+    SetCipherNonce(cipher_info,nonce);
+    additional_data=AcquireStringInfo(
+      aes_gcm_test_vector[i].additional_length);
+    SetStringInfoDatum(additional_data,aes_gcm_test_vector[i].additional_data);
+    SetCipherAdditionalData(cipher_info,additional_data);
+    plaintext=AcquireStringInfo(aes_gcm_test_vector[i].length);
+    SetStringInfoDatum(plaintext,aes_gcm_test_vector[i].plaintext);
+    ciphertext=EncipherCipher(cipher_info,plaintext);
+    results=AcquireStringInfo(aes_gcm_test_vector[i].length);
+    SetStringInfoDatum(results,aes_gcm_test_vector[i].ciphertext);
+    tag=AcquireStringInfo(sizeof(aes_gcm_test_vector[i].tag));
+    SetStringInfoDatum(tag,aes_gcm_test_vector[i].tag);
+    clone=(CompareStringInfo(ciphertext,results) == 0) &&
+      (CompareStringInfo(GetCipherTag(cipher_info),tag) == 0) ? WizardTrue :
+      WizardFalse;
+    SetCipherNonce(cipher_info,nonce);
+    plaintext=DecipherCipher(cipher_info,ciphertext);
+    SetStringInfoDatum(results,aes_gcm_test_vector[i].plaintext);
+    if ((CompareStringInfo(plaintext,results) != 0) ||
+        (CompareStringInfo(GetCipherTag(cipher_info),tag) != 0))
+      clone=WizardFalse;
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    tag=DestroyStringInfo(tag);
+    additional_data=DestroyStringInfo(additional_data);
+    results=DestroyStringInfo(results);
+    nonce=DestroyStringInfo(nonce);
+    key=DestroyStringInfo(key);
+    plaintext=DestroyStringInfo(plaintext);
+  }
+  cipher_info=DestroyCipherInfo(cipher_info);
+  /*
+    Validate XTS mode.
+  */
+  (void) PrintValidateString(stdout,
+    "testing AES XTS-mode encipher/decipher:\n");
+  cipher_info=AcquireCipherInfo(AESCipher,XTSMode);
+  key=AcquireStringInfo(sizeof(aes_xts_key));
+  SetStringInfoDatum(key,aes_xts_key);
+  SetCipherKey(cipher_info,key);
+  key=DestroyStringInfo(key);
+  nonce=AcquireStringInfo(sizeof(aes_xts_nonce));
+  SetStringInfoDatum(nonce,aes_xts_nonce);
+  SetCipherNonce(cipher_info,nonce);
+  (void) PrintValidateString(stdout,"  test 1 ");
+  plaintext=AcquireStringInfo(sizeof(aes_xts_ciphertext));
+  (void) memset(GetStringInfoDatum(plaintext),0x44,
+    GetStringInfoLength(plaintext));
+  ciphertext=EncipherCipher(cipher_info,plaintext);
+  results=AcquireStringInfo(sizeof(aes_xts_ciphertext));
+  SetStringInfoDatum(results,aes_xts_ciphertext);
+  clone=CompareStringInfo(ciphertext,results) == 0 ? WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
+  plaintext=DestroyStringInfo(plaintext);
+  /*
+    Decipher a slice from the middle of a longer ciphertext.
+  */
+  (void) PrintValidateString(stdout,"  test 2 ");
+  plaintext=AcquireStringInfo(96);
+  for (i=0; i < 96; i++)
+    GetStringInfoDatum(plaintext)[i]=(unsigned char) (31*i);
+  results=CloneStringInfo(plaintext);
+  ciphertext=EncipherCipher(cipher_info,plaintext);
+  plaintext=SplitStringInfo(ciphertext,32);
+  plaintext=DestroyStringInfo(plaintext);
+  SetStringInfoLength(ciphertext,32);
+  plaintext=DecipherCipherRange(cipher_info,ciphertext,32);
+  clone=memcmp(GetStringInfoDatum(plaintext),GetStringInfoDatum(results)+32,
+    32) == 0 ? WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
+  plaintext=DestroyStringInfo(plaintext);
+  nonce=DestroyStringInfo(nonce);
+  cipher_info=DestroyCipherInfo(cipher_info);
   return(pass);
 }
 
@@ -270,6 +378,99 @@ static WizardBooleanType TestAuthenticate(const char *passphrase)
   return(pass);
 }
 
+static WizardBooleanType TestBLAKE3(void)
+{
+  HashInfo
+    *hash_info;
+
+   ssize_t
+    i,
+    j;
+
+  StringInfo
+    *plaintext,
+    *results;
+
+  unsigned char
+    *p;
+
+  WizardBooleanType
+    clone,
+    pass,
+    status;
+
+  (void) PrintValidateString(stdout,"testing blake3:\n");
+  pass=WizardTrue;
+  hash_info=AcquireHashInfo(BLAKE3Hash);
+  for (i=0; i < BLAKE3TestVectors; i++)
+  {
+    (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+    status=InitializeHash(hash_info);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=AcquireStringInfo(blake3_test_vector[i].length);
+    p=GetStringInfoDatum(plaintext);
+    for (j=0; j < (ssize_t) blake3_test_vector[i].length; j++)
+      p[j]=(unsigned char) (j % 251);
+    status=UpdateHash(hash_info,plaintext);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=DestroyStringInfo(plaintext);
+    status=FinalizeHash(hash_info);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+    SetStringInfoDatum(results,blake3_test_vector[i].digest);
+    clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+      WizardTrue : WizardFalse;
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    results=DestroyStringInfo(results);
+  }
+  /*
+    Multiple update test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  for (j=0; j < (ssize_t) blake3_test_vector[i-1].length; )
+  {
+    ssize_t
+      k,
+      length;
+
+    length=1+3*j;
+    if (length > ((ssize_t) blake3_test_vector[i-1].length-j))
+      length=(ssize_t) blake3_test_vector[i-1].length-j;
+    plaintext=AcquireStringInfo((size_t) length);
+    p=GetStringInfoDatum(plaintext);
+    for (k=0; k < length; k++)
+      p[k]=(unsigned char) ((j+k) % 251);
+    status=UpdateHash(hash_info,plaintext);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=DestroyStringInfo(plaintext);
+    j+=length;
+  }
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,blake3_test_vector[i-1].digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
+  hash_info=DestroyHashInfo(hash_info);
+  return(pass);
+}
+
 static WizardBooleanType TestBZIPEntropy(void)
 {
   EntropyInfo
@@ -343,6 +544,9 @@ static WizardBooleanType TestBZIPEntropy(void)
 
 static WizardBooleanType TestChacha(void)
 {
+  ChachaInfo
+    *chacha_info;
+
   CipherInfo
     *cipher_info;
 
@@ -350,11 +554,17 @@ static WizardBooleanType TestChacha(void)
     i;
 
   StringInfo
+    *additional_data,
     *ciphertext,
     *key,
+    *nonce,
     *plaintext,
     *results;
 
+  unsigned char
+    block[64],
+    keystream[13*64];
+
   WizardBooleanType
     clone,
     pass;
@@ -464,10 +674,83 @@ static WizardBooleanType TestChacha(void)
   results=DestroyStringInfo(results);
   plaintext=DestroyStringInfo(plaintext);
   cipher_info=DestroyCipherInfo(cipher_info);
+  /*
+    Validate the keystream; 13 blocks exercise every block width.
+  */
+  (void) PrintValidateString(stdout,"testing Chacha keystream:\n");
+  (void) PrintValidateString(stdout,"  test 0 ");
+  chacha_info=AcquireChachaInfo();
+  key=AcquireStringInfo(sizeof(chacha_keystream_key));
+  SetStringInfoDatum(key,chacha_keystream_key);
+  SetChachaKey(chacha_info,key);
+  key=DestroyStringInfo(key);
+  SetChachaNonce(chacha_info,chacha_keystream_nonce,chacha_keystream_counter);
+  GetChachaKeystream(chacha_info,13,keystream);
+  clone=memcmp(keystream,chacha_keystream_result,64) == 0 ? WizardTrue :
+    WizardFalse;
+  SetChachaNonce(chacha_info,chacha_keystream_nonce,chacha_keystream_counter);
+  for (i=0; i < 13; i++)
+  {
+    GetChachaKeystream(chacha_info,1,block);
+    if (memcmp(keystream+64*i,block,64) != 0)
+      clone=WizardFalse;
+  }
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+     "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  chacha_info=DestroyChachaInfo(chacha_info);
+  /*
+    Validate Poly1305 mode.
+  */
+  (void) PrintValidateString(stdout,
+    "testing Chacha Poly1305-mode encipher/decipher:\n");
+  cipher_info=AcquireCipherInfo(ChachaCipher,Poly1305Mode);
+  key=AcquireStringInfo(sizeof(chacha_poly1305_key));
+  SetStringInfoDatum(key,chacha_poly1305_key);
+  SetCipherKey(cipher_info,key);
+  key=DestroyStringInfo(key);
+  nonce=AcquireStringInfo(GetCipherBlocksize(cipher_info));
+  ResetStringInfo(nonce);
+  (void) memcpy(GetStringInfoDatum(nonce),chacha_poly1305_nonce,
+    sizeof(chacha_poly1305_nonce));
+  additional_data=AcquireStringInfo(sizeof(chacha_poly1305_additional_data));
+  SetStringInfoDatum(additional_data,chacha_poly1305_additional_data);
+  for (i=0; i < 2; i++)
+  {
+    (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+    SetCipherAdditionalData(cipher_info,i == 0 ? (StringInfo *) NULL :
+      additional_data);
+    SetCipherNonce(cipher_info,nonce);
+    plaintext=StringToStringInfo(ChachaPoly1305Plaintext);
+    ciphertext=EncipherCipher(cipher_info,plaintext);
+    clone=memcmp(GetStringInfoDatum(ciphertext),chacha_poly1305_ciphertext,
+      sizeof(chacha_poly1305_ciphertext)) == 0 ? WizardTrue : WizardFalse;
+    if (memcmp(GetStringInfoDatum(GetCipherTag(cipher_info)),
+        chacha_poly1305_tag[i],sizeof(chacha_poly1305_tag[i])) != 0)
+      clone=WizardFalse;
+    SetCipherNonce(cipher_info,nonce);
+    plaintext=DecipherCipher(cipher_info,ciphertext);
+    results=StringToStringInfo(ChachaPoly1305Plaintext);
+    if (CompareStringInfo(plaintext,results) != 0)
+      clone=WizardFalse;
+    if (memcmp(GetStringInfoDatum(GetCipherTag(cipher_info)),
+        chacha_poly1305_tag[i],sizeof(chacha_poly1305_tag[i])) != 0)
+      clone=WizardFalse;
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+       "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    results=DestroyStringInfo(results);
+    plaintext=DestroyStringInfo(plaintext);
+  }
+  additional_data=DestroyStringInfo(additional_data);
+  nonce=DestroyStringInfo(nonce);
+  cipher_info=DestroyCipherInfo(cipher_info);
   return(pass);
 }
 
-static WizardBooleanType TestCRC64(void)
+static WizardBooleanType TestCRC32C(void)
 {
   HashInfo
     *hash_info;
@@ -484,6 +767,88 @@ static WizardBooleanType TestCRC64(void)
     pass,
     status;
 
+  (void) PrintValidateString(stdout,"testing crc32c:\n");
+  pass=WizardTrue;
+  hash_info=AcquireHashInfo(CRC32CHash);
+  for (i=0; i < CRC32CTestVectors; i++)
+  {
+    (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+    status=InitializeHash(hash_info);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=StringToStringInfo((char *) crc32c_test_vector[i].plaintext);
+    status=UpdateHash(hash_info,plaintext);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=DestroyStringInfo(plaintext);
+    status=FinalizeHash(hash_info);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+    SetStringInfoDatum(results,crc32c_test_vector[i].digest);
+    clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+      WizardTrue : WizardFalse;
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    results=DestroyStringInfo(results);
+  }
+  /*
+    Long message test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=AcquireStringInfo(1000000);
+  (void) memset(GetStringInfoDatum(plaintext),'a',
+    GetStringInfoLength(plaintext));
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,crc32c_million_digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
+  hash_info=DestroyHashInfo(hash_info);
+  return(pass);
+}
+
+static WizardBooleanType TestCRC64(void)
+{
+  CRC64Info
+    *crc_info;
+
+  HashInfo
+    *hash_info;
+
+   ssize_t
+    i,
+    j;
+
+  StringInfo
+    *plaintext,
+    *results;
+
+  WizardBooleanType
+    clone,
+    pass,
+    status;
+
+  WizardSizeType
+    crc,
+    next_crc;
+
   (void) PrintValidateString(stdout,"testing crc64:\n");
   pass=WizardTrue;
   hash_info=AcquireHashInfo(CRC64Hash);
@@ -540,7 +905,166 @@ static WizardBooleanType TestCRC64(void)
   if (clone == WizardFalse)
     pass=WizardFalse;
   results=DestroyStringInfo(results);
+  /*
+    Long message test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+1);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=AcquireStringInfo(1000000);
+  (void) memset(GetStringInfoDatum(plaintext),'a',
+    GetStringInfoLength(plaintext));
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,crc64_million_digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+     "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
   hash_info=DestroyHashInfo(hash_info);
+  /*
+    Combine test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+2);
+  crc_info=AcquireCRC64Info();
+  status=InitializeCRC64(crc_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=StringToStringInfo("ABCDEFGHIJKLMNOPQRSTUVWXYZabcde");
+  status=UpdateCRC64(crc_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  crc=GetCRC64CyclicRedundancyCheck(crc_info);
+  status=InitializeCRC64(crc_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=StringToStringInfo("fghijklmnopqrstuvwxyz0123456789");
+  status=UpdateCRC64(crc_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  next_crc=GetCRC64CyclicRedundancyCheck(crc_info);
+  crc=CombineCRC64(crc,next_crc,GetStringInfoLength(plaintext));
+  plaintext=DestroyStringInfo(plaintext);
+  clone=WizardTrue;
+  for (j=0; j < 8; j++)
+    if ((unsigned char) (crc >> (56-8*j)) != crc64_test_vector[5].digest[j])
+      clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+     "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  crc_info=DestroyCRC64Info(crc_info);
+  return(pass);
+}
+
+static WizardBooleanType TestHashState(void)
+{
+  static const HashType
+    hashes[] =
+    {
+      CRC32CHash, CRC64Hash, MD5Hash, SHA1Hash, SHA2224Hash, SHA2256Hash,
+      SHA2256TreeHash, SHA2384Hash, SHA2512Hash, SHA3224Hash, SHA3256Hash,
+      SHA3384Hash, SHA3512Hash, BLAKE3Hash
+    };
+
+  static const size_t
+    offsets[] = { 0, 1, 63, 64, 1000, 1048653, 2098151 };
+
+  HashInfo
+    *clone_info,
+    *hash_info,
+    *resume_info;
+
+  ssize_t
+    i,
+    j;
+
+  StringInfo
+    *digest,
+    *plaintext,
+    *state;
+
+  size_t
+    length;
+
+  unsigned char
+    *p;
+
+  WizardBooleanType
+    pass,
+    status;
+
+  /*
+    Resume each hash from an exported state and from a clone, at offsets that
+    straddle blocks, chunks, and tree leaves.
+  */
+  (void) PrintValidateString(stdout,"testing hash state:\n");
+  pass=WizardTrue;
+  length=2*1048576+1000;
+  plaintext=AcquireStringInfo(length);
+  p=GetStringInfoDatum(plaintext);
+  for (j=0; j < (ssize_t) length; j++)
+    p[j]=(unsigned char) (j % 251);
+  for (i=0; i < (ssize_t) (sizeof(hashes)/sizeof(*hashes)); i++)
+  {
+    (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+    status=WizardTrue;
+    hash_info=AcquireHashInfo(hashes[i]);
+    (void) InitializeHash(hash_info);
+    (void) UpdateHashBytes(hash_info,p,length);
+    (void) FinalizeHash(hash_info);
+    digest=CloneStringInfo(GetHashDigest(hash_info));
+    for (j=0; j < (ssize_t) (sizeof(offsets)/sizeof(*offsets)); j++)
+    {
+      (void) InitializeHash(hash_info);
+      (void) UpdateHashBytes(hash_info,p,offsets[j]);
+      state=ExportHashState(hash_info);
+      clone_info=CloneHashInfo(hash_info);
+      resume_info=AcquireHashInfo(hashes[i]);
+      if (ImportHashState(resume_info,state) == WizardFalse)
+        status=WizardFalse;
+      state=DestroyStringInfo(state);
+      (void) UpdateHashBytes(hash_info,p+offsets[j],length-offsets[j]);
+      (void) UpdateHashBytes(clone_info,p+offsets[j],length-offsets[j]);
+      (void) UpdateHashBytes(resume_info,p+offsets[j],length-offsets[j]);
+      (void) FinalizeHash(hash_info);
+      (void) FinalizeHash(clone_info);
+      (void) FinalizeHash(resume_info);
+      if ((CompareStringInfo(GetHashDigest(hash_info),digest) != 0) ||
+          (CompareStringInfo(GetHashDigest(clone_info),digest) != 0) ||
+          (CompareStringInfo(GetHashDigest(resume_info),digest) != 0))
+        status=WizardFalse;
+      resume_info=DestroyHashInfo(resume_info);
+      clone_info=DestroyHashInfo(clone_info);
+    }
+    /*
+      A state must not import into a different hash.
+    */
+    state=ExportHashState(hash_info);
+    resume_info=AcquireHashInfo(hashes[i] == MD5Hash ? SHA1Hash : MD5Hash);
+    if (ImportHashState(resume_info,state) != WizardFalse)
+      status=WizardFalse;
+    resume_info=DestroyHashInfo(resume_info);
+    state=DestroyStringInfo(state);
+    digest=DestroyStringInfo(digest);
+    hash_info=DestroyHashInfo(hash_info);
+    (void) PrintValidateString(stdout,"%s.\n",status != WizardFalse ? "pass" :
+      "fail");
+    if (status == WizardFalse)
+      pass=WizardFalse;
+  }
+  plaintext=DestroyStringInfo(plaintext);
   return(pass);
 }
 
@@ -635,6 +1159,7 @@ static WizardBooleanType TestHMACSHA2256(void)
     i;
 
   HMACInfo
+    *empty_info,
     *hmac_info;
 
   StringInfo
@@ -667,6 +1192,51 @@ static WizardBooleanType TestHMACSHA2256(void)
     key=DestroyStringInfo(key);
     message=DestroyStringInfo(message);
   }
+  /*
+    Keyed reuse test: each MAC with an unchanged key restores the saved pad
+    states rather than rehashing them.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+  clone=WizardTrue;
+  for (i=0; i < HMACSHA2256TestVectors; i++)
+  {
+    key=StringToStringInfo((char *) hmac_sha2256_test_vector[i].key);
+    message=StringToStringInfo((char *) hmac_sha2256_test_vector[i].plaintext);
+    results=AcquireStringInfo(HMACSHA2256Digestsize);
+    SetStringInfoDatum(results,hmac_sha2256_test_vector[i].digest);
+    ConstructHMAC(hmac_info,key,message);
+    ConstructHMAC(hmac_info,key,message);
+    if (CompareStringInfo(GetHMACDigest(hmac_info),results) != 0)
+      clone=WizardFalse;
+    ResetHMAC(hmac_info);
+    UpdateHMAC(hmac_info,message);
+    FinalizeHMAC(hmac_info);
+    if (CompareStringInfo(GetHMACDigest(hmac_info),results) != 0)
+      clone=WizardFalse;
+    results=DestroyStringInfo(results);
+    key=DestroyStringInfo(key);
+    message=DestroyStringInfo(message);
+  }
+  /*
+    Without InitializeHMAC() the key is empty.
+  */
+  key=AcquireStringInfo(0);
+  message=StringToStringInfo((char *) hmac_sha2256_test_vector[0].plaintext);
+  ConstructHMAC(hmac_info,key,message);
+  empty_info=AcquireHMACInfo(SHA2256Hash);
+  ResetHMAC(empty_info);
+  UpdateHMAC(empty_info,message);
+  FinalizeHMAC(empty_info);
+  if (CompareStringInfo(GetHMACDigest(empty_info),GetHMACDigest(hmac_info)) !=
+      0)
+    clone=WizardFalse;
+  empty_info=DestroyHMACInfo(empty_info);
+  key=DestroyStringInfo(key);
+  message=DestroyStringInfo(message);
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
   hmac_info=DestroyHMACInfo(hmac_info);
   return(pass);
 }
@@ -839,27 +1409,55 @@ static WizardBooleanType TestMD5(void)
     results=DestroyStringInfo(results);
   }
   /*
-    Multiple update test.
+    Multiple update test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=StringToStringInfo("ABCDEFGHIJKLMNOPQRSTUVWXYZabcde");
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  plaintext=StringToStringInfo("fghijklmnopqrstuvwxyz0123456789");
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  results=AcquireStringInfo(GetHashDigestsize(hash_info));
+  SetStringInfoDatum(results,md5_test_vector[5].digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
+  /*
+    Raw buffer test: the pieces straddle the 64-byte block boundary.
   */
-  (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+1);
   status=InitializeHash(hash_info);
   if (status == WizardFalse)
     pass=WizardFalse;
-  plaintext=StringToStringInfo("ABCDEFGHIJKLMNOPQRSTUVWXYZabcde");
-  status=UpdateHash(hash_info,plaintext);
+  status=UpdateHashBytes(hash_info,md5_test_vector[6].plaintext,13);
   if (status == WizardFalse)
     pass=WizardFalse;
-  plaintext=DestroyStringInfo(plaintext);
-  plaintext=StringToStringInfo("fghijklmnopqrstuvwxyz0123456789");
-  status=UpdateHash(hash_info,plaintext);
+  status=UpdateHashBytes(hash_info,md5_test_vector[6].plaintext+13,64);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  status=UpdateHashBytes(hash_info,md5_test_vector[6].plaintext+77,3);
   if (status == WizardFalse)
     pass=WizardFalse;
-  plaintext=DestroyStringInfo(plaintext);
   status=FinalizeHash(hash_info);
   if (status == WizardFalse)
     pass=WizardFalse;
   results=AcquireStringInfo(GetHashDigestsize(hash_info));
-  SetStringInfoDatum(results,md5_test_vector[5].digest);
+  SetStringInfoDatum(results,md5_test_vector[6].digest);
   clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
     WizardTrue : WizardFalse;
   (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
@@ -928,6 +1526,93 @@ static WizardBooleanType TestMime(void)
   return(pass);
 }
 
+static WizardBooleanType TestPoly1305(void)
+{
+  Poly1305Info
+    *poly1305_info;
+
+  size_t
+    i;
+
+  StringInfo
+    *digest,
+    *plaintext;
+
+  unsigned char
+    key[32];
+
+  WizardBooleanType
+    clone,
+    pass;
+
+  (void) PrintValidateString(stdout,"testing Poly1305:\n");
+  pass=WizardTrue;
+  poly1305_info=AcquirePoly1305Info();
+  (void) PrintValidateString(stdout,"  test 0 ");
+  (void) InitializePoly1305(poly1305_info,poly1305_key);
+  plaintext=StringToStringInfo(Poly1305Plaintext);
+  (void) UpdatePoly1305(poly1305_info,GetStringInfoDatum(plaintext),
+    GetStringInfoLength(plaintext));
+  plaintext=DestroyStringInfo(plaintext);
+  (void) FinalizePoly1305(poly1305_info);
+  clone=memcmp(GetStringInfoDatum(GetPoly1305Digest(poly1305_info)),
+    poly1305_tag,sizeof(poly1305_tag)) == 0 ? WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+     "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Multiple update test; a long message takes the vectorized path in one
+    update and the scalar path a byte at a time.
+  */
+  (void) PrintValidateString(stdout,"  test 1 ");
+  for (i=0; i < sizeof(key); i++)
+    key[i]=(unsigned char) (0xff-i);
+  plaintext=AcquireStringInfo(4099);
+  for (i=0; i < GetStringInfoLength(plaintext); i++)
+    GetStringInfoDatum(plaintext)[i]=(unsigned char) (i*31+(i >> 8));
+  (void) InitializePoly1305(poly1305_info,key);
+  (void) UpdatePoly1305(poly1305_info,GetStringInfoDatum(plaintext),
+    GetStringInfoLength(plaintext));
+  (void) FinalizePoly1305(poly1305_info);
+  digest=CloneStringInfo(GetPoly1305Digest(poly1305_info));
+  (void) InitializePoly1305(poly1305_info,key);
+  for (i=0; i < GetStringInfoLength(plaintext); i++)
+    (void) UpdatePoly1305(poly1305_info,GetStringInfoDatum(plaintext)+i,1);
+  (void) FinalizePoly1305(poly1305_info);
+  clone=CompareStringInfo(GetPoly1305Digest(poly1305_info),digest) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+     "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  digest=DestroyStringInfo(digest);
+  plaintext=DestroyStringInfo(plaintext);
+  poly1305_info=DestroyPoly1305Info(poly1305_info);
+  return(pass);
+}
+
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+static void *GetSiblingRandomInfo(void *context)
+{
+  RandomInfo
+    *random_info;
+
+  StringInfo
+    **sibling;
+
+  /*
+    Report the generator of a second thread and the key it draws.
+  */
+  sibling=(StringInfo **) context;
+  random_info=GetThreadRandomInfo();
+  if (random_info == (RandomInfo *) NULL)
+    return((void *) NULL);
+  *sibling=GetRandomKey(random_info,32);
+  return((void *) random_info);
+}
+#endif
+
 static WizardBooleanType TestRandomKey(void)
 {
   double
@@ -964,7 +1649,146 @@ static WizardBooleanType TestRandomKey(void)
     "fail");
   if (clone == WizardFalse)
     pass=WizardFalse;
+  for (i=0; i < 2; i++)
+  {
+    const unsigned char
+      *p;
+
+    size_t
+      j;
+
+    /*
+      Keystream generators, small requests and a bulk request that spans
+      several rekeys.
+    */
+    (void) PrintValidateString(stdout,"  test %.20g ",(double) i+2);
+    SetRandomGenerator(random_info,i == 0 ? ChachaRandomGenerator :
+      AESRandomGenerator);
+    value=0.0;
+    for (j=0; j < 1000000; j++)
+      value+=GetRandomValue(random_info);
+    value/=j;
+    clone=(WizardBooleanType) (AbsoluteValue(value-0.5) < 0.001);
+    key=GetRandomKey(random_info,3*1048576+100);
+    p=GetStringInfoDatum(key);
+    value=0.0;
+    for (j=0; j < GetStringInfoLength(key); j++)
+      value+=p[j];
+    value/=j;
+    if (AbsoluteValue(value-127.5) > 0.5)
+      clone=WizardFalse;
+    key=DestroyStringInfo(key);
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+  }
   random_info=DestroyRandomInfo(random_info);
+  {
+    StringInfo
+      *sibling;
+
+    /*
+      The thread generator persists across calls within a thread.
+    */
+    (void) PrintValidateString(stdout,"  test 4 ");
+    random_info=GetThreadRandomInfo();
+    clone=(random_info != (RandomInfo *) NULL) &&
+      (random_info == GetThreadRandomInfo()) ? WizardTrue : WizardFalse;
+    if (clone != WizardFalse)
+      {
+        key=GetRandomKey(random_info,32);
+        sibling=GetRandomKey(random_info,32);
+        if (CompareStringInfo(key,sibling) == 0)
+          clone=WizardFalse;
+        sibling=DestroyStringInfo(sibling);
+        key=DestroyStringInfo(key);
+      }
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+  }
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  {
+    int
+      status,
+      pipes[2];
+
+    pid_t
+      pid;
+
+    pthread_t
+      thread;
+
+    StringInfo
+      *sibling;
+
+    void
+      *sibling_info;
+
+    /*
+      Another thread gets a generator of its own.
+    */
+    (void) PrintValidateString(stdout,"  test 5 ");
+    random_info=GetThreadRandomInfo();
+    sibling=(StringInfo *) NULL;
+    sibling_info=(void *) NULL;
+    clone=WizardFalse;
+    if ((pthread_create(&thread,(pthread_attr_t *) NULL,GetSiblingRandomInfo,
+         &sibling) == 0) && (pthread_join(thread,&sibling_info) == 0) &&
+        (sibling_info != (void *) NULL) && (sibling_info != random_info))
+      {
+        key=GetRandomKey(random_info,32);
+        clone=CompareStringInfo(key,sibling) != 0 ? WizardTrue : WizardFalse;
+        key=DestroyStringInfo(key);
+      }
+    if (sibling != (StringInfo *) NULL)
+      sibling=DestroyStringInfo(sibling);
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    /*
+      A forked child reseeds rather than repeat the output of its parent.
+    */
+    (void) PrintValidateString(stdout,"  test 6 ");
+    (void) fflush(stdout);
+    clone=WizardFalse;
+    if (pipe(pipes) == 0)
+      {
+        pid=fork();
+        if (pid == 0)
+          {
+            ssize_t
+              count;
+
+            key=GetRandomKey(GetThreadRandomInfo(),32);
+            count=write(pipes[1],GetStringInfoDatum(key),
+              GetStringInfoLength(key));
+            _exit(count == (ssize_t) GetStringInfoLength(key) ? 0 : 1);
+          }
+        (void) close(pipes[1]);
+        if (pid > 0)
+          {
+            key=GetRandomKey(random_info,32);
+            sibling=AcquireStringInfo(32);
+            if ((read(pipes[0],GetStringInfoDatum(sibling),32) == 32) &&
+                (waitpid(pid,&status,0) == pid) && (WIFEXITED(status) != 0) &&
+                (WEXITSTATUS(status) == 0))
+              clone=CompareStringInfo(key,sibling) != 0 ? WizardTrue :
+                WizardFalse;
+            sibling=DestroyStringInfo(sibling);
+            key=DestroyStringInfo(key);
+          }
+        (void) close(pipes[0]);
+      }
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+  }
+#endif
   return(pass);
 }
 
@@ -1169,17 +1993,53 @@ static WizardBooleanType TestSHA1(void)
   if (clone == WizardFalse)
     pass=WizardFalse;
   results=DestroyStringInfo(results);
+  /*
+    Long message test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+1);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=AcquireStringInfo(1000000);
+  (void) memset(GetStringInfoDatum(plaintext),'a',
+    GetStringInfoLength(plaintext));
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,sha1_million_digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
   hash_info=DestroyHashInfo(hash_info);
   return(pass);
 }
 
 static WizardBooleanType TestSHA2256(void)
 {
+  const StringInfo
+    *digest;
+
+  HashBatchInfo
+    *batch_info;
+
   HashInfo
     *hash_info;
 
    ssize_t
-    i;
+    i,
+    j;
+
+  size_t
+    id;
 
   StringInfo
     *plaintext,
@@ -1246,6 +2106,173 @@ static WizardBooleanType TestSHA2256(void)
   if (clone == WizardFalse)
     pass=WizardFalse;
   results=DestroyStringInfo(results);
+  /*
+    Long message test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+1);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=AcquireStringInfo(1000000);
+  (void) memset(GetStringInfoDatum(plaintext),'a',
+    GetStringInfoLength(plaintext));
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,sha2256_million_digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
+  hash_info=DestroyHashInfo(hash_info);
+  /*
+    Batch test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+2);
+  batch_info=AcquireHashBatchInfo(SHA2256Hash);
+  for (i=0; i < SHA2256TestVectors; i++)
+  {
+    plaintext=StringToStringInfo((char *) sha2256_test_vector[i].plaintext);
+    status=SubmitHashBatch(batch_info,plaintext,(size_t) i);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=DestroyStringInfo(plaintext);
+  }
+  plaintext=AcquireStringInfo(1000000);
+  (void) memset(GetStringInfoDatum(plaintext),'a',
+    GetStringInfoLength(plaintext));
+  status=SubmitHashBatch(batch_info,plaintext,(size_t) i);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  status=FlushHashBatch(batch_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  clone=WizardTrue;
+  for (j=0; j <= SHA2256TestVectors; j++)
+  {
+    digest=GetHashBatchDigest(batch_info,&id);
+    if (digest == (const StringInfo *) NULL)
+      {
+        clone=WizardFalse;
+        break;
+      }
+    results=AcquireStringInfo(GetStringInfoLength(digest));
+    if (id < (size_t) SHA2256TestVectors)
+      SetStringInfoDatum(results,sha2256_test_vector[id].digest);
+    else
+      SetStringInfoDatum(results,sha2256_million_digest);
+    if (CompareStringInfo(digest,results) != 0)
+      clone=WizardFalse;
+    results=DestroyStringInfo(results);
+  }
+  if (GetHashBatchDigest(batch_info,&id) != (const StringInfo *) NULL)
+    clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  batch_info=DestroyHashBatchInfo(batch_info);
+  return(pass);
+}
+
+static WizardBooleanType TestSHA2256Tree(void)
+{
+  HashInfo
+    *hash_info;
+
+   ssize_t
+    i,
+    j;
+
+  StringInfo
+    *plaintext,
+    *results;
+
+  unsigned char
+    *p;
+
+  WizardBooleanType
+    clone,
+    pass,
+    status;
+
+  (void) PrintValidateString(stdout,"testing sha2256-tree:\n");
+  pass=WizardTrue;
+  hash_info=AcquireHashInfo(SHA2256TreeHash);
+  for (i=0; i < SHA2256TreeTestVectors; i++)
+  {
+    (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+    status=InitializeHash(hash_info);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=AcquireStringInfo(sha2256_tree_test_vector[i].length);
+    p=GetStringInfoDatum(plaintext);
+    for (j=0; j < (ssize_t) sha2256_tree_test_vector[i].length; j++)
+      p[j]=(unsigned char) (j % 251);
+    status=UpdateHash(hash_info,plaintext);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=DestroyStringInfo(plaintext);
+    status=FinalizeHash(hash_info);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+    SetStringInfoDatum(results,sha2256_tree_test_vector[i].digest);
+    clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+      WizardTrue : WizardFalse;
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    results=DestroyStringInfo(results);
+  }
+  /*
+    Multiple update test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  for (j=0; j < (ssize_t) sha2256_tree_test_vector[i-1].length; )
+  {
+    ssize_t
+      k,
+      length;
+
+    length=1+3*j;
+    if (length > ((ssize_t) sha2256_tree_test_vector[i-1].length-j))
+      length=(ssize_t) sha2256_tree_test_vector[i-1].length-j;
+    plaintext=AcquireStringInfo((size_t) length);
+    p=GetStringInfoDatum(plaintext);
+    for (k=0; k < length; k++)
+      p[k]=(unsigned char) ((j+k) % 251);
+    status=UpdateHash(hash_info,plaintext);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    plaintext=DestroyStringInfo(plaintext);
+    j+=length;
+  }
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,sha2256_tree_test_vector[i-1].digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
   hash_info=DestroyHashInfo(hash_info);
   return(pass);
 }
@@ -1400,6 +2427,32 @@ static WizardBooleanType TestSHA2512(void)
   if (clone == WizardFalse)
     pass=WizardFalse;
   results=DestroyStringInfo(results);
+  /*
+    Long message test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+1);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=AcquireStringInfo(1000000);
+  (void) memset(GetStringInfoDatum(plaintext),'a',
+    GetStringInfoLength(plaintext));
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,sha2512_million_digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
   hash_info=DestroyHashInfo(hash_info);
   return(pass);
 }
@@ -1477,6 +2530,32 @@ static WizardBooleanType TestSHA3(void)
   if (clone == WizardFalse)
     pass=WizardFalse;
   results=DestroyStringInfo(results);
+  /*
+    Long message test.
+  */
+  (void) PrintValidateString(stdout,"  test %.17g ",(double) i+1);
+  status=InitializeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=AcquireStringInfo(1000000);
+  (void) memset(GetStringInfoDatum(plaintext),'a',
+    GetStringInfoLength(plaintext));
+  status=UpdateHash(hash_info,plaintext);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  status=FinalizeHash(hash_info);
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  plaintext=DestroyStringInfo(plaintext);
+  results=AcquireStringInfo(GetStringInfoLength(GetHashDigest(hash_info)));
+  SetStringInfoDatum(results,sha3_million_digest);
+  clone=CompareStringInfo(GetHashDigest(hash_info),results) == 0 ?
+    WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  results=DestroyStringInfo(results);
   hash_info=DestroyHashInfo(hash_info);
   return(pass);
 }
@@ -1738,6 +2817,8 @@ int main(int argc,char **argv)
   if (TestMime() == WizardFalse)
     pass=WizardFalse;
 #endif
+  if (TestCRC32C() == WizardFalse)
+    pass=WizardFalse;
   if (TestCRC64() == WizardFalse)
     pass=WizardFalse;
   if (TestMD5() == WizardFalse)
@@ -1746,18 +2827,26 @@ int main(int argc,char **argv)
     pass=WizardFalse;
   if (TestSHA2256() == WizardFalse)
     pass=WizardFalse;
+  if (TestSHA2256Tree() == WizardFalse)
+    pass=WizardFalse;
   if (TestSHA2384() == WizardFalse)
     pass=WizardFalse;
   if (TestSHA2512() == WizardFalse)
     pass=WizardFalse;
   if (TestSHA3() == WizardFalse)
     pass=WizardFalse;
+  if (TestBLAKE3() == WizardFalse)
+    pass=WizardFalse;
+  if (TestHashState() == WizardFalse)
+    pass=WizardFalse;
   if (TestHMACMD5() == WizardFalse)
     pass=WizardFalse;
   if (TestHMACSHA1() == WizardFalse)
     pass=WizardFalse;
   if (TestHMACSHA2256() == WizardFalse)
     pass=WizardFalse;
+  if (TestPoly1305() == WizardFalse)
+    pass=WizardFalse;
   if (TestAES() == WizardFalse)
     pass=WizardFalse;
   if (TestChacha() == WizardFalse)
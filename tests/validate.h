@@ -23,6 +23,7 @@
 */
 #define AESEncipherTestVectors 3
 #define AESDecipherTestVectors 3
+#define AESGCMTestVectors 5
 
 struct AESTestVector
 {
@@ -110,6 +111,312 @@ struct AESTestVector
     },
   };
 
+struct AESGCMTestVector
+{
+  size_t
+    key_length,
+    length,
+    additional_length;
+
+  unsigned char
+    key[32],
+    nonce[16],
+    plaintext[64],
+    ciphertext[64],
+    tag[16],
+    additional_data[20];
+};
+
+struct AESGCMTestVector
+  aes_gcm_test_vector[] = /* From the GCM specification */
+  {
+    {
+      16, 16, 0,
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x01 },
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+      { 0x03, 0x88, 0xda, 0xce, 0x60, 0xb6, 0xa3, 0x92, 0xf3, 0x28,
+        0xc2, 0xb9, 0x71, 0xb2, 0xfe, 0x78 },
+      { 0xab, 0x6e, 0x47, 0xd4, 0x2c, 0xec, 0x13, 0xbd, 0xf5, 0x3a,
+        0x67, 0xb2, 0x12, 0x57, 0xbd, 0xdf }
+    },
+    {
+      16, 64, 0,
+      { 0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a,
+        0x8f, 0x94, 0x67, 0x30, 0x83, 0x08 },
+      { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca,
+        0xf8, 0x88, 0x00, 0x00, 0x00, 0x01 },
+      { 0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59,
+        0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a, 0x86, 0xa7, 0xa9, 0x53,
+        0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31,
+        0x8a, 0x72, 0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+        0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25, 0xb1, 0x6a,
+        0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39,
+        0x1a, 0xaf, 0xd2, 0x55 },
+      { 0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72,
+        0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c, 0xe3, 0xaa, 0x21, 0x2f,
+        0x2c, 0x02, 0xa4, 0xe0, 0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac,
+        0xa1, 0x2e, 0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+        0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05, 0x1b, 0xa3,
+        0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91,
+        0x47, 0x3f, 0x59, 0x85 },
+      { 0x4d, 0x5c, 0x2a, 0xf3, 0x27, 0xcd, 0x64, 0xa6, 0x2c, 0xf3,
+        0x5a, 0xbd, 0x2b, 0xa6, 0xfa, 0xb4 }
+    },
+    {
+      32, 64, 0,
+      { 0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a,
+        0x8f, 0x94, 0x67, 0x30, 0x83, 0x08, 0xfe, 0xff, 0xe9, 0x92,
+        0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30,
+        0x83, 0x08 },
+      { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca,
+        0xf8, 0x88, 0x00, 0x00, 0x00, 0x01 },
+      { 0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59,
+        0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a, 0x86, 0xa7, 0xa9, 0x53,
+        0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31,
+        0x8a, 0x72, 0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+        0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25, 0xb1, 0x6a,
+        0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39,
+        0x1a, 0xaf, 0xd2, 0x55 },
+      { 0x52, 0x2d, 0xc1, 0xf0, 0x99, 0x56, 0x7d, 0x07, 0xf4, 0x7f,
+        0x37, 0xa3, 0x2a, 0x84, 0x42, 0x7d, 0x64, 0x3a, 0x8c, 0xdc,
+        0xbf, 0xe5, 0xc0, 0xc9, 0x75, 0x98, 0xa2, 0xbd, 0x25, 0x55,
+        0xd1, 0xaa, 0x8c, 0xb0, 0x8e, 0x48, 0x59, 0x0d, 0xbb, 0x3d,
+        0xa7, 0xb0, 0x8b, 0x10, 0x56, 0x82, 0x88, 0x38, 0xc5, 0xf6,
+        0x1e, 0x63, 0x93, 0xba, 0x7a, 0x0a, 0xbc, 0xc9, 0xf6, 0x62,
+        0x89, 0x80, 0x15, 0xad },
+      { 0xb0, 0x94, 0xda, 0xc5, 0xd9, 0x34, 0x71, 0xbd, 0xec, 0x1a,
+        0x50, 0x22, 0x70, 0xe3, 0xcc, 0x6c }
+    },
+    {
+      16, 60, 20,
+      { 0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a,
+        0x8f, 0x94, 0x67, 0x30, 0x83, 0x08 },
+      { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca,
+        0xf8, 0x88, 0x00, 0x00, 0x00, 0x01 },
+      { 0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59,
+        0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a, 0x86, 0xa7, 0xa9, 0x53,
+        0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31,
+        0x8a, 0x72, 0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+        0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25, 0xb1, 0x6a,
+        0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39 },
+      { 0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72,
+        0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c, 0xe3, 0xaa, 0x21, 0x2f,
+        0x2c, 0x02, 0xa4, 0xe0, 0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac,
+        0xa1, 0x2e, 0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+        0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05, 0x1b, 0xa3,
+        0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91 },
+      { 0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb, 0x94, 0xfa,
+        0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47 },
+      { 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed,
+        0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xab, 0xad, 0xda, 0xd2 }
+    },
+    {
+      32, 60, 20,
+      { 0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a,
+        0x8f, 0x94, 0x67, 0x30, 0x83, 0x08, 0xfe, 0xff, 0xe9, 0x92,
+        0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30,
+        0x83, 0x08 },
+      { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca,
+        0xf8, 0x88, 0x00, 0x00, 0x00, 0x01 },
+      { 0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59,
+        0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a, 0x86, 0xa7, 0xa9, 0x53,
+        0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31,
+        0x8a, 0x72, 0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+        0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25, 0xb1, 0x6a,
+        0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39 },
+      { 0x52, 0x2d, 0xc1, 0xf0, 0x99, 0x56, 0x7d, 0x07, 0xf4, 0x7f,
+        0x37, 0xa3, 0x2a, 0x84, 0x42, 0x7d, 0x64, 0x3a, 0x8c, 0xdc,
+        0xbf, 0xe5, 0xc0, 0xc9, 0x75, 0x98, 0xa2, 0xbd, 0x25, 0x55,
+        0xd1, 0xaa, 0x8c, 0xb0, 0x8e, 0x48, 0x59, 0x0d, 0xbb, 0x3d,
+        0xa7, 0xb0, 0x8b, 0x10, 0x56, 0x82, 0x88, 0x38, 0xc5, 0xf6,
+        0x1e, 0x63, 0x93, 0xba, 0x7a, 0x0a, 0xbc, 0xc9, 0xf6, 0x62 },
+      { 0x76, 0xfc, 0x6e, 0xce, 0x0f, 0x4e, 0x17, 0x68, 0xcd, 0xdf,
+        0x88, 0x53, 0xbb, 0x2d, 0x55, 0x1b },
+      { 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed,
+        0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xab, 0xad, 0xda, 0xd2 }
+    },
+  };
+
+static const unsigned char
+  aes_xts_ciphertext[32] = /* IEEE 1619, vector 2 */
+  {
+    0xc4, 0x54, 0x18, 0x5e, 0x6a, 0x16, 0x93, 0x6e, 0x39, 0x33,
+    0x40, 0x38, 0xac, 0xef, 0x83, 0x8b, 0xfb, 0x18, 0x6f, 0xff,
+    0x74, 0x80, 0xad, 0xc4, 0x28, 0x93, 0x82, 0xec, 0xd6, 0xd3,
+    0x94, 0xf0
+  },
+  aes_xts_key[32] =
+  {
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x22, 0x22, 0x22, 0x22,
+    0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22,
+    0x22, 0x22
+  },
+  aes_xts_nonce[16] =
+  {
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+  };
+
+/*
+  BLAKE3 test vectors.
+*/
+#define BLAKE3Digestsize  32
+#define BLAKE3TestVectors  15
+
+struct BLAKE3TestVector
+{
+  size_t
+    length;
+
+  unsigned char
+    digest[BLAKE3Digestsize];
+};
+
+struct BLAKE3TestVector
+  blake3_test_vector[] = /* From the BLAKE3 reference test vectors */
+  {
+    {
+      0,
+      {
+        0xaf, 0x13, 0x49, 0xb9, 0xf5, 0xf9, 0xa1, 0xa6,
+        0xa0, 0x40, 0x4d, 0xea, 0x36, 0xdc, 0xc9, 0x49,
+        0x9b, 0xcb, 0x25, 0xc9, 0xad, 0xc1, 0x12, 0xb7,
+        0xcc, 0x9a, 0x93, 0xca, 0xe4, 0x1f, 0x32, 0x62
+      }
+    },
+    {
+      1,
+      {
+        0x2d, 0x3a, 0xde, 0xdf, 0xf1, 0x1b, 0x61, 0xf1,
+        0x4c, 0x88, 0x6e, 0x35, 0xaf, 0xa0, 0x36, 0x73,
+        0x6d, 0xcd, 0x87, 0xa7, 0x4d, 0x27, 0xb5, 0xc1,
+        0x51, 0x02, 0x25, 0xd0, 0xf5, 0x92, 0xe2, 0x13
+      }
+    },
+    {
+      1023,
+      {
+        0x10, 0x10, 0x89, 0x70, 0xee, 0xda, 0x3e, 0xb9,
+        0x32, 0xba, 0xac, 0x14, 0x28, 0xc7, 0xa2, 0x16,
+        0x3b, 0x0e, 0x92, 0x4c, 0x9a, 0x9e, 0x25, 0xb3,
+        0x5b, 0xba, 0x72, 0xb2, 0x8f, 0x70, 0xbd, 0x11
+      }
+    },
+    {
+      1024,
+      {
+        0x42, 0x21, 0x47, 0x39, 0xf0, 0x95, 0xa4, 0x06,
+        0xf3, 0xfc, 0x83, 0xde, 0xb8, 0x89, 0x74, 0x4a,
+        0xc0, 0x0d, 0xf8, 0x31, 0xc1, 0x0d, 0xaa, 0x55,
+        0x18, 0x9b, 0x5d, 0x12, 0x1c, 0x85, 0x5a, 0xf7
+      }
+    },
+    {
+      1025,
+      {
+        0xd0, 0x02, 0x78, 0xae, 0x47, 0xeb, 0x27, 0xb3,
+        0x4f, 0xae, 0xcf, 0x67, 0xb4, 0xfe, 0x26, 0x3f,
+        0x82, 0xd5, 0x41, 0x29, 0x16, 0xc1, 0xff, 0xd9,
+        0x7c, 0x8c, 0xb7, 0xfb, 0x81, 0x4b, 0x84, 0x44
+      }
+    },
+    {
+      2048,
+      {
+        0xe7, 0x76, 0xb6, 0x02, 0x8c, 0x7c, 0xd2, 0x2a,
+        0x4d, 0x0b, 0xa1, 0x82, 0xa8, 0xbf, 0x62, 0x20,
+        0x5d, 0x2e, 0xf5, 0x76, 0x46, 0x7e, 0x83, 0x8e,
+        0xd6, 0xf2, 0x52, 0x9b, 0x85, 0xfb, 0xa2, 0x4a
+      }
+    },
+    {
+      2049,
+      {
+        0x5f, 0x4d, 0x72, 0xf4, 0x0d, 0x7a, 0x5f, 0x82,
+        0xb1, 0x5c, 0xa2, 0xb2, 0xe4, 0x4b, 0x1d, 0xe3,
+        0xc2, 0xef, 0x86, 0xc4, 0x26, 0xc9, 0x5c, 0x1a,
+        0xf0, 0xb6, 0x87, 0x95, 0x22, 0x56, 0x30, 0x30
+      }
+    },
+    {
+      3072,
+      {
+        0xb9, 0x8c, 0xb0, 0xff, 0x36, 0x23, 0xbe, 0x03,
+        0x32, 0x6b, 0x37, 0x3d, 0xe6, 0xb9, 0x09, 0x52,
+        0x18, 0x51, 0x3e, 0x64, 0xf1, 0xee, 0x2e, 0xdd,
+        0x25, 0x25, 0xc7, 0xad, 0x1e, 0x5c, 0xff, 0xd2
+      }
+    },
+    {
+      3073,
+      {
+        0x71, 0x24, 0xb4, 0x95, 0x01, 0x01, 0x2f, 0x81,
+        0xcc, 0x7f, 0x11, 0xca, 0x06, 0x9e, 0xc9, 0x22,
+        0x6c, 0xec, 0xb8, 0xa2, 0xc8, 0x50, 0xcf, 0xe6,
+        0x44, 0xe3, 0x27, 0xd2, 0x2d, 0x3e, 0x1c, 0xd3
+      }
+    },
+    {
+      4096,
+      {
+        0x01, 0x50, 0x94, 0x01, 0x3f, 0x57, 0xa5, 0x27,
+        0x7b, 0x59, 0xd8, 0x47, 0x5c, 0x05, 0x01, 0x04,
+        0x2c, 0x0b, 0x64, 0x2e, 0x53, 0x1b, 0x0a, 0x1c,
+        0x8f, 0x58, 0xd2, 0x16, 0x32, 0x29, 0xe9, 0x69
+      }
+    },
+    {
+      4097,
+      {
+        0x9b, 0x40, 0x52, 0xb3, 0x8f, 0x1c, 0x5f, 0xc8,
+        0xb1, 0xf9, 0xff, 0x7a, 0xc7, 0xb2, 0x7c, 0xd2,
+        0x42, 0x48, 0x7b, 0x3d, 0x89, 0x0d, 0x15, 0xc9,
+        0x6a, 0x1c, 0x25, 0xb8, 0xaa, 0x0f, 0xb9, 0x95
+      }
+    },
+    {
+      8193,
+      {
+        0xba, 0xb6, 0xc0, 0x9c, 0xb8, 0xce, 0x8c, 0xf4,
+        0x59, 0x26, 0x13, 0x98, 0xd2, 0xe7, 0xae, 0xf3,
+        0x57, 0x00, 0xbf, 0x48, 0x81, 0x16, 0xce, 0xb9,
+        0x4a, 0x36, 0xd0, 0xf5, 0xf1, 0xb7, 0xbc, 0x3b
+      }
+    },
+    {
+      16384,
+      {
+        0xf8, 0x75, 0xd6, 0x64, 0x6d, 0xe2, 0x89, 0x85,
+        0x64, 0x6f, 0x34, 0xee, 0x13, 0xbe, 0x9a, 0x57,
+        0x6f, 0xd5, 0x15, 0xf7, 0x6b, 0x5b, 0x0a, 0x26,
+        0xbb, 0x32, 0x47, 0x35, 0x04, 0x1d, 0xdd, 0xe4
+      }
+    },
+    {
+      31744,
+      {
+        0x62, 0xb6, 0x96, 0x0e, 0x1a, 0x44, 0xbc, 0xc1,
+        0xeb, 0x1a, 0x61, 0x1a, 0x8d, 0x62, 0x35, 0xb6,
+        0xb4, 0xb7, 0x8f, 0x32, 0xe7, 0xab, 0xc4, 0xfb,
+        0x4c, 0x6c, 0xdc, 0xce, 0x94, 0x89, 0x5c, 0x47
+      }
+    },
+    {
+      102400,
+      {
+        0xbc, 0x3e, 0x3d, 0x41, 0xa1, 0x14, 0x6b, 0x06,
+        0x9a, 0xbf, 0xfa, 0xd3, 0xc0, 0xd4, 0x48, 0x60,
+        0xcf, 0x66, 0x43, 0x90, 0xaf, 0xce, 0x4d, 0x96,
+        0x61, 0xf7, 0x90, 0x2e, 0x79, 0x43, 0xe0, 0x85
+      }
+    }
+  };
+
 /*
   BZip test vectors.
 */
@@ -283,6 +590,126 @@ struct ChachaTestVector
     },
   };
 
+/*
+  Chacha keystream test vector (RFC 7539, section 2.3.2).
+*/
+static const unsigned char
+  chacha_keystream_counter[8] =
+  {
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09
+  },
+  chacha_keystream_key[32] =
+  {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13,
+    0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+    0x1e, 0x1f
+  },
+  chacha_keystream_nonce[8] =
+  {
+    0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00
+  },
+  chacha_keystream_result[64] =
+  {
+    0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15, 0x50, 0x0f,
+    0xdd, 0x1f, 0xa3, 0x20, 0x71, 0xc4, 0xc7, 0xd1, 0xf4, 0xc7,
+    0x33, 0xc0, 0x68, 0x03, 0x04, 0x22, 0xaa, 0x9a, 0xc3, 0xd4,
+    0x6c, 0x4e, 0xd2, 0x82, 0x64, 0x46, 0x07, 0x9f, 0xaa, 0x09,
+    0x14, 0xc2, 0xd7, 0x05, 0xd9, 0x8b, 0x02, 0xa2, 0xb5, 0x12,
+    0x9c, 0xd1, 0xde, 0x16, 0x4e, 0xb9, 0xcb, 0xd0, 0x83, 0xe8,
+    0xa2, 0x50, 0x3c, 0x4e
+  };
+
+/*
+  ChaCha20-Poly1305 test vector (RFC 8439, section 2.8.2), with and without
+  the additional data.
+*/
+#define ChachaPoly1305Plaintext  "Ladies and Gentlemen of the class of '99: " \
+  "If I could offer you only one tip for the future, sunscreen would be it."
+
+static const unsigned char
+  chacha_poly1305_ciphertext[114] =
+  {
+    0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86,
+    0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2, 0xa4, 0xad, 0xed, 0x51,
+    0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee,
+    0x62, 0xd6, 0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12,
+    0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b, 0x1a, 0x71,
+    0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6,
+    0x7e, 0xcd, 0x3b, 0x36, 0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77,
+    0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+    0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85,
+    0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc, 0x3f, 0xf4, 0xde, 0xf0,
+    0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce,
+    0xc6, 0x4b, 0x61, 0x16
+  },
+  chacha_poly1305_additional_data[12] =
+  {
+    0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7
+  },
+  chacha_poly1305_key[32] =
+  {
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91, 0x92, 0x93,
+    0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d,
+    0x9e, 0x9f
+  },
+  chacha_poly1305_nonce[12] =
+  {
+    0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45,
+    0x46, 0x47
+  },
+  chacha_poly1305_tag[2][16] =
+  {
+    {
+      0x6a, 0x23, 0xa4, 0x68, 0x1f, 0xd5, 0x94, 0x56, 0xae, 0xa1,
+      0xd2, 0x9f, 0x82, 0x47, 0x72, 0x16
+    },
+    {
+      0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90,
+      0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91
+    }
+  };
+
+/*
+  CRC32C test vectors.
+*/
+#define CRC32CDigestsize  4
+#define CRC32CTestVectors  7
+
+struct CRC32CTestVector
+{
+  unsigned char
+    plaintext[128],
+    digest[CRC32CDigestsize];
+};
+
+struct CRC32CTestVector
+  crc32c_test_vector[] =
+  {
+    { "",
+      { 0x00, 0x00, 0x00, 0x00 } },
+    { "a",
+      { 0xc1, 0xd0, 0x43, 0x30 } },
+    { "abc",
+      { 0x36, 0x4b, 0x3f, 0xb7 } },
+    { "123456789",
+      { 0xe3, 0x06, 0x92, 0x83 } },
+    { "message digest",
+      { 0x02, 0xbd, 0x79, 0xd0 } },
+    { "abcdefghijklmnopqrstuvwxyz",
+      { 0x9e, 0xe6, 0xef, 0x25 } },
+    { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+      { 0xa2, 0x45, 0xd5, 0x7d } }
+  };
+
+static const unsigned char
+  crc32c_million_digest[4] = /* One million a's */
+  {
+    0x43, 0x6f, 0xe2, 0x40
+  };
+
 /*
   CRC64 test vectors.
 */
@@ -316,6 +743,12 @@ struct CRC64TestVector
       { 0x83, 0xa2, 0xa4, 0xd2, 0x89, 0xfd, 0xf3, 0x89 } }
   };
 
+static const unsigned char
+  crc64_million_digest[8] = /* One million a's */
+  {
+    0x3c, 0xc9, 0xfd, 0x58, 0xa5, 0x36, 0x5d, 0x50
+  };
+
 /*
   EllipticCurve test vectors.
   Note, this is really AES vectors until we get elliptic curve implemented.
@@ -892,6 +1325,25 @@ struct MD5TestVector
         0xda, 0x2e, 0x21, 0x07, 0xb6, 0x7a } }
   };
 
+/*
+  Poly1305 test vector (RFC 8439, section 2.5.2).
+*/
+#define Poly1305Plaintext  "Cryptographic Forum Research Group"
+
+static const unsigned char
+  poly1305_key[32] =
+  {
+    0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33, 0x7f, 0x44,
+    0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8, 0x01, 0x03, 0x80, 0x8a,
+    0xfb, 0x0d, 0xb2, 0xfd, 0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49,
+    0xf5, 0x1b
+  },
+  poly1305_tag[16] =
+  {
+    0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6, 0xc2, 0x2b,
+    0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9
+  };
+
 /*
   Serpent test vectors.
 */
@@ -1021,6 +1473,13 @@ struct SHA1TestVector
     }
   };
 
+static const unsigned char
+  sha1_million_digest[20] = /* One million a's, from NIST */
+  {
+    0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e,
+    0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f
+  };
+
 /*
   SHA2256 test vectors from from NIST.
 */
@@ -1049,6 +1508,98 @@ struct SHA2256TestVector
     },
   };
 
+static const unsigned char
+  sha2256_million_digest[32] = /* One million a's, from NIST */
+  {
+    0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1,
+    0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48,
+    0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11,
+    0x2c, 0xd0
+  };
+
+/*
+  SHA2256 Merkle tree test vectors, 1048576-byte leaves per RFC 6962.
+*/
+#define SHA2256TreeDigestsize  32
+#define SHA2256TreeTestVectors  7
+
+struct SHA2256TreeTestVector
+{
+  size_t
+    length;
+
+  unsigned char
+    digest[SHA2256TreeDigestsize];
+};
+
+struct SHA2256TreeTestVector
+  sha2256_tree_test_vector[] =
+  {
+    {
+      0,
+      {
+        0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14,
+        0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+        0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,
+        0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
+      }
+    },
+    {
+      3,
+      {
+        0x6b, 0x02, 0x71, 0xf8, 0xcc, 0x97, 0x12, 0x1c,
+        0x9e, 0x25, 0xe8, 0xc7, 0x31, 0xf4, 0x7c, 0x94,
+        0x1b, 0x48, 0x7c, 0x58, 0x3f, 0x5f, 0xe1, 0x54,
+        0x98, 0xa4, 0xc6, 0xf1, 0x99, 0x4a, 0xf2, 0x99
+      }
+    },
+    {
+      1048575,
+      {
+        0x2d, 0xc4, 0x81, 0x92, 0x12, 0x83, 0x2e, 0xa6,
+        0x95, 0x32, 0xe0, 0x05, 0x28, 0x8d, 0x8f, 0xf4,
+        0x02, 0xd4, 0x6a, 0x01, 0x45, 0x09, 0x85, 0xe7,
+        0xbd, 0xdd, 0xe5, 0xd3, 0x22, 0x53, 0x50, 0x96
+      }
+    },
+    {
+      1048576,
+      {
+        0xf4, 0xe5, 0x37, 0x04, 0xc0, 0x7a, 0xef, 0x05,
+        0xb5, 0xb1, 0x2a, 0x89, 0xd6, 0xc1, 0xe5, 0x42,
+        0x92, 0xfa, 0x7d, 0x9d, 0x8c, 0x3e, 0xe4, 0x31,
+        0xc4, 0x0b, 0x6f, 0x6e, 0xf6, 0xd1, 0x92, 0x80
+      }
+    },
+    {
+      1048577,
+      {
+        0xc7, 0x82, 0xcd, 0x77, 0xb0, 0xf9, 0x13, 0x9f,
+        0x9d, 0x7f, 0xab, 0x30, 0x6f, 0x38, 0x4a, 0x6c,
+        0xab, 0x7f, 0x6c, 0x65, 0x42, 0x62, 0x52, 0xd0,
+        0xf6, 0x7e, 0xf5, 0xaa, 0xdf, 0xfc, 0xc3, 0xf3
+      }
+    },
+    {
+      3145733,
+      {
+        0x19, 0xcc, 0x3f, 0x2d, 0xb5, 0xba, 0xd6, 0xff,
+        0xe7, 0xc2, 0x53, 0x8c, 0xa8, 0x92, 0xfb, 0xee,
+        0x5a, 0xfa, 0x64, 0xcc, 0xe9, 0x58, 0xb8, 0x30,
+        0xb6, 0x0b, 0xea, 0x68, 0xa1, 0x55, 0xd4, 0xa4
+      }
+    },
+    {
+      9437191,
+      {
+        0xe8, 0x4c, 0x1f, 0x97, 0x72, 0x6f, 0x9e, 0x24,
+        0xdb, 0xca, 0x59, 0x2b, 0xd7, 0x08, 0x1f, 0x2b,
+        0x1e, 0x92, 0x70, 0xb3, 0x2e, 0x67, 0x55, 0x13,
+        0xb9, 0x92, 0x92, 0xfa, 0xce, 0x4d, 0x37, 0xb8
+      }
+    }
+  };
+
 /*
   SHA2384 test vectors from from NIST and kerneli.
 */
@@ -1149,6 +1700,18 @@ struct SHA2512TestVector
     },
   };
 
+static const unsigned char
+  sha2512_million_digest[64] = /* One million a's, from NIST */
+  {
+    0xe7, 0x18, 0x48, 0x3d, 0x0c, 0xe7, 0x69, 0x64, 0x4e, 0x2e,
+    0x42, 0xc7, 0xbc, 0x15, 0xb4, 0x63, 0x8e, 0x1f, 0x98, 0xb1,
+    0x3b, 0x20, 0x44, 0x28, 0x56, 0x32, 0xa8, 0x03, 0xaf, 0xa9,
+    0x73, 0xeb, 0xde, 0x0f, 0xf2, 0x44, 0x87, 0x7e, 0xa6, 0x0a,
+    0x4c, 0xb0, 0x43, 0x2c, 0xe5, 0x77, 0xc3, 0x1b, 0xeb, 0x00,
+    0x9c, 0x5c, 0x2c, 0x49, 0xaa, 0x2e, 0x4e, 0xad, 0xb2, 0x17,
+    0xad, 0x8c, 0xc0, 0x9b
+  };
+
 /*
   SHA3 test vectors.
 */
@@ -1177,6 +1740,15 @@ struct SHA3TestVector
     }
   };
 
+static const unsigned char
+  sha3_million_digest[SHA3Digestsize] = /* One million a's, Keccak-256 */
+  {
+    0xfa, 0xda, 0xe6, 0xb4, 0x9f, 0x12, 0x9b, 0xbb, 0x81, 0x2b,
+    0xe8, 0x40, 0x7b, 0x7b, 0x28, 0x94, 0xf3, 0x4a, 0xec, 0xf6,
+    0xdb, 0xd1, 0xf9, 0xb0, 0xf0, 0xc7, 0xe9, 0x85, 0x30, 0x98,
+    0xfc, 0x96
+  };
+
 /*
   Twofish test vectors.
 */
@@ -86,6 +86,7 @@ WizardExport ContentInfo *AcquireContentInfo(void)
   content_info->entropy=BZIPEntropy;
   content_info->level=6;
   content_info->hmac=SHA2256Hash;
+  content_info->hmac_interval=1;
   content_info->random_hash=SHA2256Hash;
   content_info->chunksize=262144;
   content_info->timestamp=time((time_t *) NULL);
@@ -146,6 +147,8 @@ WizardExport ContentInfo *DestroyContentInfo(ContentInfo *content_info)
     content_info->cipher_info=DestroyCipherInfo(content_info->cipher_info);
   if (content_info->properties != (char *) NULL)
     content_info->properties=DestroyString(content_info->properties);
+  if (content_info->cipher_rdf != (StringInfo *) NULL)
+    content_info->cipher_rdf=DestroyStringInfo(content_info->cipher_rdf);
   if (content_info->content != (char *) NULL)
     content_info->content=DestroyString(content_info->content);
   if (content_info->version != (char *) NULL)
@@ -367,10 +370,16 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
   target_digest=DestroyString(target_digest);
   digest=DestroyString(digest);
   /*
-    Parse content XML.
+    Parse content XML.  Content that predates the protocol property is
+    protocol 1.0.  The RDF is kept as read, protocol 2.0 authenticates it
+    with the content.
   */
+  content_info->protocol_major=1;
+  content_info->protocol_minor=0;
   rdf=NewXMLTree((const char *) GetStringInfoDatum(properties),exception);
-  properties=DestroyStringInfo(properties);
+  if (content_info->cipher_rdf != (StringInfo *) NULL)
+    content_info->cipher_rdf=DestroyStringInfo(content_info->cipher_rdf);
+  content_info->cipher_rdf=properties;
   if (rdf == (XMLTreeInfo *) NULL)
     return(WizardFalse);
   child=GetXMLTreeChild(rdf,"cipher:Content");
@@ -450,6 +459,13 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
             content_info->hmac=(HashType) type;
             break;
           }
+        if (strcmp(tag,"hmac-interval") == 0)
+          {
+            content_info->hmac_interval=(size_t) StringToUnsignedLong(content);
+            if (content_info->hmac_interval == 0)
+              content_info->hmac_interval=1;
+            break;
+          }
         break;
       }
       case 'i':
@@ -523,6 +539,22 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
           }
         break;
       }
+      case 'p':
+      {
+        if (strcmp(tag,"protocol") == 0)
+          {
+            char
+              *q;
+
+            content_info->protocol_major=(unsigned int) strtoul(content,&q,10);
+            content_info->protocol_minor=0;
+            if (*q == '.')
+              content_info->protocol_minor=(unsigned int) strtoul(q+1,
+                (char **) NULL,10);
+            break;
+          }
+        break;
+      }
       case 'r':
       {
         if (strcmp(tag,"random-hash") == 0)
@@ -596,6 +628,56 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
   return(WizardTrue);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n i t i a l i z e C o n t e n t H M A C                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  InitializeContentHMAC() starts the HMAC of an interval of records: a copy
+%  of the HMAC of the cipher properties followed by the 64-bit interval
+%  number.  Each interval tag then authenticates its records on their own, so
+%  decipher can verify any interval without reading those before it.
+%
+%  The format of the InitializeContentHMAC method is:
+%
+%      void InitializeContentHMAC(ContentInfo *content_info,
+%        const HMACInfo *properties_info,const WizardSizeType interval)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: The content info.
+%
+%    o properties_info: the HMAC of the cipher properties.
+%
+%    o interval: the interval number.
+%
+*/
+WizardExport void InitializeContentHMAC(ContentInfo *content_info,
+  const HMACInfo *properties_info,const WizardSizeType interval)
+{
+  size_t
+    i;
+
+  unsigned char
+    number[8];
+
+  WizardAssert(CipherDomain,content_info != (ContentInfo *) NULL);
+  WizardAssert(CipherDomain,content_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,properties_info != (const HMACInfo *) NULL);
+  if (content_info->hmac_info != (HMACInfo *) NULL)
+    content_info->hmac_info=DestroyHMACInfo(content_info->hmac_info);
+  content_info->hmac_info=CloneHMACInfo(properties_info);
+  for (i=0; i < 8; i++)
+    number[i]=(unsigned char) (interval >> (8*(7-i)));
+  UpdateHMACBytes(content_info->hmac_info,number,sizeof(number));
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -654,6 +736,9 @@ WizardExport WizardBooleanType PrintCipherProperties(
   (void) fprintf(file,"  Keyed-Hashed Message Authentication Code:\n");
   (void) fprintf(file,"    hash: %s\n",WizardOptionToMnemonic(WizardHashOptions,
     content_info->hmac));
+  if ((content_info->protocol_major >= 2) && (content_info->hmac != NoHash))
+    (void) fprintf(file,"    interval: %.17g chunks\n",(double)
+      content_info->hmac_interval);
   (void) fprintf(file,"  Random Generator:\n");
   (void) fprintf(file,"    hash: %s\n",WizardOptionToMnemonic(WizardHashOptions,
     content_info->random_hash));
@@ -672,3 +757,69 @@ WizardExport WizardBooleanType PrintCipherProperties(
     (void) fprintf(file,"  Version: %s\n",content_info->version);
   return(ferror(file) != 0 ? WizardFalse : WizardTrue);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t C o n t e n t R e c o r d D a t a                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetContentRecordData() sets the cipher properties, the chunk number, and
+%  the record header, the marker and the entropy byte, as the additional data
+%  that the GCM and Poly1305 modes authenticate with the chunk that follows
+%  it.  A record cannot be moved, dropped, or remarked as the last one.
+%
+%  The format of the SetContentRecordData method is:
+%
+%      void SetContentRecordData(ContentInfo *content_info,
+%        const WizardSizeType chunk,const unsigned char marker,
+%        const EntropyType entropy)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: The content info.
+%
+%    o chunk: the chunk number.
+%
+%    o marker: the record marker.
+%
+%    o entropy: the entropy type of the chunk.
+%
+*/
+WizardExport void SetContentRecordData(ContentInfo *content_info,
+  const WizardSizeType chunk,const unsigned char marker,
+  const EntropyType entropy)
+{
+  StringInfo
+    *additional_data;
+
+  size_t
+    i,
+    length;
+
+  unsigned char
+    *p;
+
+  WizardAssert(CipherDomain,content_info != (ContentInfo *) NULL);
+  WizardAssert(CipherDomain,content_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,content_info->cipher_rdf != (StringInfo *) NULL);
+  length=GetStringInfoLength(content_info->cipher_rdf);
+  additional_data=AcquireStringInfo(length+10);
+  p=GetStringInfoDatum(additional_data);
+  (void) memcpy(p,GetStringInfoDatum(content_info->cipher_rdf),length);
+  p+=length;
+  for (i=0; i < 8; i++)
+    *p++=(unsigned char) (chunk >> (8*(7-i)));
+  *p++=marker;
+  if (content_info->entropy != NoEntropy)
+    *p++=(unsigned char) entropy;
+  SetStringInfoLength(additional_data,(size_t) (p-GetStringInfoDatum(
+    additional_data)));
+  SetCipherAdditionalData(content_info->cipher_info,additional_data);
+  additional_data=DestroyStringInfo(additional_data);
+}
@@ -22,8 +22,11 @@
 extern "C" {
 #endif
 
-#define CipherProtocolMajor  1
-#define CipherProtocolMinor  0 
+#define CipherProtocolMajor  2
+#define CipherProtocolMinor  0
+#define CipherFinalRecord  0x01
+#define CipherRecord  0x00
+#define CipherTagExtent  4194304
 
 typedef struct _ContentInfo
 {
@@ -35,6 +38,9 @@ typedef struct _ContentInfo
     *content,
     *properties;
 
+  StringInfo
+    *cipher_rdf;
+
   CipherInfo
     *cipher_info;
 
@@ -79,6 +85,9 @@ typedef struct _ContentInfo
   HashType
     hmac;
 
+  size_t
+    hmac_interval;
+
   RandomInfo
     *random_info;
 
@@ -86,7 +95,12 @@ typedef struct _ContentInfo
     random_hash;
 
   size_t
-    chunksize;
+    chunksize,
+    threads;
+
+  WizardSizeType
+    offset,
+    extent;
 
   time_t
     access_date,
@@ -113,6 +127,11 @@ extern WizardExport WizardBooleanType
   GetContentInfo(ContentInfo *,BlobInfo *,ExceptionInfo *),
   PrintCipherProperties(const ContentInfo *,FILE *);
 
+extern WizardExport void
+  InitializeContentHMAC(ContentInfo *,const HMACInfo *,const WizardSizeType),
+  SetContentRecordData(ContentInfo *,const WizardSizeType,const unsigned char,
+    const EntropyType);
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }
 #endif
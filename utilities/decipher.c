@@ -65,9 +65,191 @@
   Forward declaraction.
 */
 static WizardBooleanType
+  DecipherChunks(ContentInfo *,const char *,ExceptionInfo *),
   DecipherContent(ContentInfo *,const char *,const char *,
-    const WizardBooleanType,ExceptionInfo *);
+    const WizardBooleanType,ExceptionInfo *),
+  DecipherRecords(ContentInfo *,const char *,ExceptionInfo *);
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D e c i p h e r C h u n k s                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherChunks() deciphers protocol 1 content: each chunk is preceded by
+%  the HMAC of its plaintext.
+%
+%  The format of the DecipherChunks method is:
+%
+%      WizardBooleanType DecipherChunks(ContentInfo *content_info,
+%        const char *cipher_filename,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+%    o cipher_filename: the ciphertext filename.
+%
+%    o exception: return any exceptions in this structure.
+%
+*/
+static WizardBooleanType DecipherChunks(ContentInfo *content_info,
+  const char *cipher_filename,ExceptionInfo *exception)
+{
+#define ThrowDecipherChunksException(asperity,tag,context) \
+{ \
+  (void) ThrowWizardException(exception,GetWizardModule(),asperity, \
+    tag,context,strerror(errno)); \
+  return(WizardFalse); \
+}
+
+  char
+    message[WizardPathExtent];
+
+  EntropyType
+    entropy;
+
+  size_t
+    blocksize,
+    length,
+    pad;
+
+  ssize_t
+    count;
+
+  StringInfo
+    *ciphertext,
+    *hmac,
+    *plaintext;
+
+  size_t
+    chunk;
+
+  WizardBooleanType
+    status;
+
+  hmac=(StringInfo *) NULL;
+  if (content_info->hmac != NoHash)
+    hmac=AcquireStringInfo(GetHMACDigestsize(content_info->hmac_info));
+  entropy=content_info->entropy;
+  blocksize=GetCipherBlocksize(content_info->cipher_info);
+  pad=blocksize-content_info->chunksize % blocksize;
+  if (pad == blocksize)
+    pad=0;
+  ciphertext=AcquireStringInfo(content_info->chunksize);
+  chunk=0;
+  if (content_info->extent != 0)
+    {
+      WizardSizeType
+        extent;
+
+      /*
+        Chunks are a fixed size, seek to the one that holds the offset.
+      */
+      extent=content_info->chunksize;
+      if (content_info->mode != CFBMode)
+        extent+=pad;
+      if (content_info->hmac != NoHash)
+        extent+=GetStringInfoLength(hmac);
+      if (content_info->entropy != NoEntropy)
+        extent++;
+      chunk=(size_t) (content_info->offset/content_info->chunksize);
+      if (SeekBlob(content_info->cipherblob,TellBlob(content_info->cipherblob)+
+          (WizardOffsetType) (chunk*extent),SEEK_SET) < 0)
+        ThrowDecipherChunksException(FileError,"unable to seek ciphertext "
+          "`%s': `%s'",cipher_filename);
+    }
+  for ( ; ; chunk++)
+  {
+    if (content_info->hmac != NoHash)
+      {
+        length=GetStringInfoLength(hmac);
+        count=ReadBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
+          hmac));
+        if (count <= 0)
+          break;
+      }
+    if (content_info->entropy != NoEntropy)
+      entropy=(EntropyType) ReadBlobByte(content_info->cipherblob);
+    length=content_info->chunksize;
+    if (content_info->mode != CFBMode)
+      length+=pad;
+    SetStringInfoLength(ciphertext,length);
+    count=ReadBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
+      ciphertext));
+    if (count <= 0)
+      break;
+    length=(size_t) count;
+    SetStringInfoLength(ciphertext,length);
+    if (content_info->mode == XTSMode)
+      plaintext=DecipherCipherRange(content_info->cipher_info,ciphertext,
+        (WizardSizeType) chunk*(content_info->chunksize+pad));
+    else
+      plaintext=DecipherCipher(content_info->cipher_info,ciphertext);
+    if ((content_info->mode != CFBMode) &&
+        ((pad != 0) || (EOFBlob(content_info->cipherblob) != WizardFalse)))
+      length-=GetStringInfoDatum(plaintext)[length-1]+1;
+    SetStringInfoLength(plaintext,length);
+    if (entropy != NoEntropy)
+      {
+        status=RestoreEntropy(content_info->entropy_info,length,plaintext,
+          exception);
+        if (status == WizardFalse)
+          ThrowDecipherChunksException(FileError,"unable to restore entropy "
+            "`%s': `%s'",cipher_filename);
+        SetStringInfo(plaintext,GetEntropyChaos(content_info->entropy_info));
+      }
+    if (content_info->hmac != NoHash)
+      {
+        ConstructHMAC(content_info->hmac_info,GetAuthenticateKey(
+          content_info->authenticate_info),plaintext);
+        if (CompareStringInfo(hmac,GetHMACDigest(content_info->hmac_info)) != 0)
+          {
+            (void) FormatLocaleString(message,WizardPathExtent,"corrupt cipher "
+              "chunk #%.17g `%s'",(double) chunk,cipher_filename);
+            ThrowDecipherChunksException(FileError,"%s: `%s'",message);
+          }
+      }
+    if (content_info->extent != 0)
+      {
+        WizardSizeType
+          first,
+          last;
+
+        /*
+          Keep the part of the chunk that overlaps the extract.
+        */
+        first=(WizardSizeType) chunk*content_info->chunksize;
+        last=Min(first+length,content_info->offset+content_info->extent);
+        first=Max(first,content_info->offset);
+        if (last <= first)
+          break;
+        (void) memmove(GetStringInfoDatum(plaintext),GetStringInfoDatum(
+          plaintext)+(first-(WizardSizeType) chunk*content_info->chunksize),
+          (size_t) (last-first));
+        length=(size_t) (last-first);
+      }
+    count=WriteBlobChunk(content_info->plainblob,length,GetStringInfoDatum(
+      plaintext));
+    if (count != (ssize_t) length)
+      ThrowDecipherChunksException(FileError,"unable to write plaintext "
+        "`%s': `%s'",cipher_filename);
+    if ((content_info->extent != 0) &&
+        (((WizardSizeType) (chunk+1)*content_info->chunksize) >=
+         (content_info->offset+content_info->extent)))
+      break;
+  }
+  ciphertext=DestroyStringInfo(ciphertext);
+  if (content_info->hmac != NoHash)
+    hmac=DestroyStringInfo(hmac);
+  return(WizardTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -107,6 +289,7 @@ static void DecipherUsage(void)
       "-(de)compress        automagically (de)compress BZIP and ZIP files",
       "-debug events        display copious debugging information",
       "-entropy type        increase content entropy",
+      "-extract offset,size decipher only this many bytes at this offset",
       "-help                print program options",
       "-hmac hash           ensure message integrity with this hash",
       "-key hash            strengthen the key with this hash",
@@ -119,6 +302,7 @@ static void DecipherUsage(void)
       "-passphrase filename get the passphrase from this file",
       "-properties filename get cipher properties from this file",
       "-random hash         strengthen random data with this hash",
+      "-threads value       maximum number of threads to decipher with",
       "-true-random         strengthen deciphering with true random numbers",
       "-verbose             print detailed information about the secure content",
       "-version             print version information",
@@ -345,6 +529,33 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
             content_info->entropy=(EntropyType) type;
             break;
           }
+        if (LocaleCompare("extract",option+1) == 0)
+          {
+            char
+              *p,
+              *q;
+
+            double
+              extent,
+              offset;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing offset and size: `%s'",
+                option);
+            offset=StringToDouble(argv[i],&p);
+            if ((p == argv[i]) || (*p != ',') || (offset < 0.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            q=p+1;
+            extent=StringToDouble(q,&p);
+            if ((p == q) || (extent < 1.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            content_info->offset=(WizardSizeType) offset;
+            content_info->extent=(WizardSizeType) extent;
+            break;
+          }
         ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
           option);
         break;
@@ -534,6 +745,26 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
       }
       case 't':
       {
+        if (LocaleCompare(option,"-threads") == 0)
+          {
+            char
+              *p;
+
+            double
+              value;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing threads: `%s'",
+                option);
+            value=StringToDouble(argv[i],&p);
+            if ((p == argv[i]) || (value < 1.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            content_info->threads=(size_t) value;
+            break;
+          }
         if (LocaleCompare(option+1,"true-random") == 0)
           {
             SetRandomTrueRandom(*option == '-' ? WizardTrue : WizardFalse);
@@ -630,28 +861,6 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
   return(WizardFalse); \
 }
 
-  char
-    message[WizardPathExtent];
-
-  EntropyType
-    entropy;
-
-  size_t
-    blocksize,
-    length,
-    pad;
-
-  ssize_t
-    count;
-
-  StringInfo
-    *ciphertext,
-    *hmac,
-    *plaintext;
-
-  size_t
-    chunk;
-
   WizardBooleanType
     status;
 
@@ -690,6 +899,9 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
     }
   if (status == WizardFalse)
     return(WizardFalse);
+  if (content_info->protocol_major > CipherProtocolMajor)
+    ThrowDecipherContentException(OptionError,"unsupported cipher protocol "
+      "`%s': `%s'",cipher_filename);
   content_info->authenticate_info=AcquireAuthenticateInfo(
     content_info->authenticate_method,content_info->keyring,
     content_info->key_hash);
@@ -714,8 +926,32 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
   if (status == WizardFalse)
     ThrowDecipherContentException(ResourceError,"authentication failed: `%s': "
       "`%s'",cipher_filename);
+  if ((content_info->mode == GCMMode) || (content_info->mode == Poly1305Mode))
+    {
+      /*
+        Authenticated modes tag each chunk themselves, the HMAC pass is
+        redundant.
+      */
+      if ((content_info->mode == GCMMode) &&
+          (content_info->cipher != AESCipher) &&
+          (content_info->cipher != TwofishCipher))
+        ThrowDecipherContentException(OptionError,"GCM mode requires a "
+          "128-bit block cipher `%s': `%s'",cipher_filename);
+      if ((content_info->mode == Poly1305Mode) &&
+          (content_info->cipher != ChachaCipher))
+        ThrowDecipherContentException(OptionError,"Poly1305 mode requires "
+          "the Chacha cipher `%s': `%s'",cipher_filename);
+      content_info->hmac=NoHash;
+    }
+  if ((content_info->mode == XTSMode) &&
+      (content_info->cipher != AESCipher) &&
+      (content_info->cipher != TwofishCipher))
+    ThrowDecipherContentException(OptionError,"XTS mode requires a 128-bit "
+      "block cipher `%s': `%s'",cipher_filename);
   content_info->cipher_info=AcquireCipherInfo(content_info->cipher,
     content_info->mode);
+  if (content_info->threads != 0)
+    SetCipherThreads(content_info->cipher_info,content_info->threads);
   SetCipherKey(content_info->cipher_info,GetAuthenticateKey(
     content_info->authenticate_info));
   if (content_info->nonce != (char *) NULL)
@@ -730,74 +966,21 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
       SetCipherNonce(content_info->cipher_info,nonce);
       nonce=DestroyStringInfo(nonce);
     }
-  hmac=(StringInfo *) NULL;
   if (content_info->hmac != NoHash)
-    {
-      content_info->hmac_info=AcquireHMACInfo(content_info->hmac);
-      hmac=AcquireStringInfo(GetHMACDigestsize(content_info->hmac_info));
-    }
-  entropy=content_info->entropy;
+    content_info->hmac_info=AcquireHMACInfo(content_info->hmac);
   if (content_info->entropy != NoEntropy)
     content_info->entropy_info=AcquireEntropyInfo(content_info->entropy,
       content_info->level);
-  blocksize=GetCipherBlocksize(content_info->cipher_info);
-  pad=blocksize-content_info->chunksize % blocksize;
-  if (pad == blocksize)
-    pad=0;
-  ciphertext=AcquireStringInfo(content_info->chunksize);
-  for (chunk=0; ; chunk++)
-  {
-    if (content_info->hmac != NoHash)
-      {
-        length=GetStringInfoLength(hmac);
-        count=ReadBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
-          hmac));
-        if (count <= 0)
-          break;
-      }
-    if (content_info->entropy != NoEntropy)
-      entropy=(EntropyType) ReadBlobByte(content_info->cipherblob);
-    length=content_info->chunksize;
-    if (content_info->mode != CFBMode)
-      length+=pad;
-    SetStringInfoLength(ciphertext,length);
-    count=ReadBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
-      ciphertext));
-    if (count <= 0)
-      break;
-    length=(size_t) count;
-    SetStringInfoLength(ciphertext,length);
-    plaintext=DecipherCipher(content_info->cipher_info,ciphertext);
-    if ((content_info->mode != CFBMode) &&
-        ((pad != 0) || (EOFBlob(content_info->cipherblob) != WizardFalse)))
-      length-=GetStringInfoDatum(plaintext)[length-1]+1;
-    SetStringInfoLength(plaintext,length);
-    if (entropy != NoEntropy)
-      {
-        status=RestoreEntropy(content_info->entropy_info,length,plaintext,
-          exception);
-        if (status == WizardFalse)
-          ThrowDecipherContentException(FileError,"unable to restore entropy "
-            "`%s': `%s'",cipher_filename);
-        SetStringInfo(plaintext,GetEntropyChaos(content_info->entropy_info));
-      }
-    if (content_info->hmac != NoHash)
-      {
-        ConstructHMAC(content_info->hmac_info,GetAuthenticateKey(
-          content_info->authenticate_info),plaintext);
-        if (CompareStringInfo(hmac,GetHMACDigest(content_info->hmac_info)) != 0)
-          {
-            (void) FormatLocaleString(message,WizardPathExtent,"corrupt cipher "
-              "chunk #%.17g `%s'",(double) chunk,cipher_filename);
-            ThrowDecipherContentException(FileError,"%s: `%s'",message);
-          }
-      }
-    count=WriteBlobChunk(content_info->plainblob,length,GetStringInfoDatum(
-      plaintext));
-    if (count != (ssize_t) length)
-      ThrowDecipherContentException(FileError,"unable to write plaintext "
-        "`%s': `%s'",cipher_filename);
-  }
+  if ((content_info->protocol_major < 2) &&
+      ((content_info->mode == GCMMode) || (content_info->mode == Poly1305Mode)))
+    ThrowDecipherContentException(OptionError,"authenticated modes require "
+      "protocol 2.0 `%s': `%s'",cipher_filename);
+  if (content_info->protocol_major < 2)
+    status=DecipherChunks(content_info,cipher_filename,exception);
+  else
+    status=DecipherRecords(content_info,cipher_filename,exception);
+  if (status == WizardFalse)
+    return(WizardFalse);
   if (CloseBlob(content_info->cipherblob) == WizardFalse)
     ThrowFileException(exception,FileError,content_info->content);
   if (CloseBlob(content_info->plainblob) == WizardFalse)
@@ -813,12 +996,361 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
       ThrowFileException(exception,FileError,plain_filename);
   }
 #endif
-  ciphertext=DestroyStringInfo(ciphertext);
-  if (content_info->hmac != NoHash)
-    hmac=DestroyStringInfo(hmac);
   return(WizardTrue);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D e c i p h e r R e c o r d s                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherRecords() deciphers protocol 2 content: a marker precedes each
+%  record and a tag follows each interval of hmac-interval records.  A tag
+%  covers the cipher properties, the interval number, and the records of its
+%  interval, so an extract seeks to the interval that holds the offset and
+%  verifies only the intervals it reads.  An interval is held in memory until
+%  its tag is verified; only then is it deciphered and written.
+%
+%  The format of the DecipherRecords method is:
+%
+%      WizardBooleanType DecipherRecords(ContentInfo *content_info,
+%        const char *cipher_filename,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+%    o cipher_filename: the ciphertext filename.
+%
+%    o exception: return any exceptions in this structure.
+%
+*/
+
+static WizardBooleanType ReadCipherRecord(ContentInfo *content_info,
+  const size_t length,void *data)
+{
+  /*
+    Read part of a record and add it to the running HMAC.
+  */
+  if (ReadBlobChunk(content_info->cipherblob,length,data) != (ssize_t) length)
+    return(WizardFalse);
+  if (content_info->hmac != NoHash)
+    UpdateHMACBytes(content_info->hmac_info,data,length);
+  return(WizardTrue);
+}
+
+static WizardBooleanType DecipherRecords(ContentInfo *content_info,
+  const char *cipher_filename,ExceptionInfo *exception)
+{
+#define ThrowDecipherRecordsException(asperity,tag,context) \
+{ \
+  (void) ThrowWizardException(exception,GetWizardModule(),asperity, \
+    tag,context,strerror(errno)); \
+  return(WizardFalse); \
+}
+#define ThrowCorruptRecordException() \
+{ \
+  (void) FormatLocaleString(message,WizardPathExtent,"corrupt cipher " \
+    "chunk #%.17g `%s'",(double) chunk,cipher_filename); \
+  ThrowDecipherRecordsException(FileError,"%s: `%s'",message); \
+}
+
+  char
+    message[WizardPathExtent];
+
+  EntropyType
+    entropy;
+
+  HMACInfo
+    *properties_info;
+
+  size_t
+    blocksize,
+    chunk,
+    digestsize,
+    extent,
+    first,
+    interval,
+    last,
+    length,
+    pad,
+    start;
+
+  ssize_t
+    count;
+
+  StringInfo
+    *ciphertext,
+    *digest,
+    *plaintext,
+    *records,
+    *tag;
+
+  unsigned char
+    *entropies,
+    marker;
+
+  WizardBooleanType
+    status;
+
+  blocksize=GetCipherBlocksize(content_info->cipher_info);
+  pad=blocksize-content_info->chunksize % blocksize;
+  if (pad == blocksize)
+    pad=0;
+  tag=(StringInfo *) NULL;
+  if (GetCipherTag(content_info->cipher_info) != (const StringInfo *) NULL)
+    tag=AcquireStringInfo(GetStringInfoLength(GetCipherTag(
+      content_info->cipher_info)));
+  digestsize=0;
+  interval=1;
+  properties_info=(HMACInfo *) NULL;
+  if (content_info->hmac != NoHash)
+    {
+      properties_info=AcquireHMACInfo(content_info->hmac);
+      InitializeHMAC(properties_info,GetAuthenticateKey(
+        content_info->authenticate_info));
+      UpdateHMAC(properties_info,content_info->cipher_rdf);
+      digestsize=GetHMACDigestsize(properties_info);
+      interval=content_info->hmac_interval;
+      if (interval > Max(CipherTagExtent/content_info->chunksize,1))
+        ThrowDecipherRecordsException(FileError,"corrupt cipher properties "
+          "`%s': `%s'",cipher_filename);
+    }
+  digest=AcquireStringInfo(digestsize);
+  extent=content_info->chunksize;
+  if ((content_info->mode != CFBMode) && (tag == (StringInfo *) NULL))
+    extent+=pad;
+  ciphertext=AcquireStringInfo(extent+blocksize);
+  chunk=0;
+  first=0;
+  last=(~0UL);
+  if (content_info->extent != 0)
+    {
+      size_t
+        record;
+
+      WizardSizeType
+        offset,
+        size;
+
+      /*
+        Records before the interval that holds the offset are skipped;
+        records of that interval before the offset are authenticated but not
+        deciphered.  An offset past the end reads the last interval, the
+        shortest final record included, so its tag vouches for the end.
+      */
+      if (tag != (StringInfo *) NULL)
+        ThrowDecipherRecordsException(OptionError,"unable to extract from "
+          "authenticated mode ciphertext `%s': `%s'",cipher_filename);
+      first=(size_t) (content_info->offset/content_info->chunksize);
+      last=(size_t) ((content_info->offset+content_info->extent-1)/
+        content_info->chunksize);
+      record=1+extent;
+      if (content_info->entropy != NoEntropy)
+        record++;
+      offset=(WizardSizeType) TellBlob(content_info->cipherblob);
+      size=GetBlobSize(content_info->cipherblob);
+      length=record-extent+digestsize;
+      if (content_info->mode != CFBMode)
+        length+=blocksize;
+      chunk=first/interval;
+      if ((size >= (offset+length)) && (((size-offset-length)/(interval*
+          record+digestsize)) < (WizardSizeType) chunk))
+        chunk=(size_t) ((size-offset-length)/(interval*record+digestsize));
+      chunk*=interval;
+      if (SeekBlob(content_info->cipherblob,(WizardOffsetType) offset+
+          (WizardOffsetType) (chunk*record+(chunk/interval)*digestsize),
+          SEEK_SET) < 0)
+        ThrowDecipherRecordsException(FileError,"unable to seek ciphertext "
+          "`%s': `%s'",cipher_filename);
+    }
+  /*
+    The last record may carry a whole block of padding and the final tag.
+  */
+  records=AcquireStringInfo(extent+blocksize+digestsize+1);
+  entropies=(unsigned char *) AcquireQuantumMemory(interval,
+    sizeof(*entropies));
+  if (entropies == (unsigned char *) NULL)
+    ThrowDecipherRecordsException(ResourceError,"memory allocation failed "
+      "`%s': `%s'",cipher_filename);
+  marker=CipherRecord;
+  while (marker == CipherRecord)
+  {
+    size_t
+      extents,
+      i,
+      records_read;
+
+    /*
+      Read and authenticate an interval of records before any of them is
+      deciphered, so no plaintext is released ahead of its tag.
+    */
+    if (content_info->hmac != NoHash)
+      InitializeContentHMAC(content_info,properties_info,(WizardSizeType)
+        (chunk/interval));
+    start=chunk;
+    extents=0;
+    for (records_read=0; records_read < interval; records_read++)
+    {
+      chunk=start+records_read;
+      if ((extents+extent+blocksize+digestsize+1) >
+          GetStringInfoLength(records))
+        SetStringInfoLength(records,2*GetStringInfoLength(records));
+      if (ReadCipherRecord(content_info,1,&marker) == WizardFalse)
+        ThrowCorruptRecordException();
+      if ((marker != CipherRecord) && (marker != CipherFinalRecord))
+        ThrowCorruptRecordException();
+      if (tag != (StringInfo *) NULL)
+        if (ReadCipherRecord(content_info,GetStringInfoLength(tag),
+              GetStringInfoDatum(tag)) == WizardFalse)
+          ThrowCorruptRecordException();
+      entropies[records_read]=(unsigned char) content_info->entropy;
+      if (content_info->entropy != NoEntropy)
+        if (ReadCipherRecord(content_info,1,entropies+records_read) ==
+            WizardFalse)
+          ThrowCorruptRecordException();
+      if (marker == CipherRecord)
+        {
+          if (ReadCipherRecord(content_info,extent,GetStringInfoDatum(
+                records)+extents) == WizardFalse)
+            ThrowCorruptRecordException();
+          extents+=extent;
+          continue;
+        }
+      /*
+        The last record runs to the final tag at the end of the content.
+      */
+      count=ReadBlobChunk(content_info->cipherblob,extent+blocksize+
+        digestsize+1,GetStringInfoDatum(records)+extents);
+      if ((count < (ssize_t) digestsize) ||
+          ((size_t) count > (extent+blocksize+digestsize)))
+        ThrowCorruptRecordException();
+      length=(size_t) count-digestsize;
+      if (content_info->hmac != NoHash)
+        {
+          UpdateHMACBytes(content_info->hmac_info,GetStringInfoDatum(
+            records)+extents,length);
+          FinalizeHMAC(content_info->hmac_info);
+          SetStringInfoDatum(digest,GetStringInfoDatum(records)+extents+
+            length);
+          if (CompareStringInfo(digest,GetHMACDigest(
+                content_info->hmac_info)) != 0)
+            ThrowCorruptRecordException();
+        }
+      extents+=length;
+      records_read++;
+      break;
+    }
+    if ((content_info->hmac != NoHash) && (marker == CipherRecord))
+      {
+        /*
+          Verify the tag that ends the interval.
+        */
+        chunk=start+records_read-1;
+        if (ReadBlobChunk(content_info->cipherblob,digestsize,
+              GetStringInfoDatum(digest)) != (ssize_t) digestsize)
+          ThrowCorruptRecordException();
+        FinalizeHMAC(content_info->hmac_info);
+        if (CompareStringInfo(digest,GetHMACDigest(
+              content_info->hmac_info)) != 0)
+          ThrowCorruptRecordException();
+      }
+    for (i=0, chunk=start; i < records_read; i++, chunk++)
+    {
+      unsigned char
+        record_marker;
+
+      if ((chunk < first) || (chunk > last))
+        continue;
+      record_marker=CipherRecord;
+      length=extent;
+      if ((i+1) == records_read)
+        {
+          record_marker=marker;
+          length=extents-i*extent;
+        }
+      entropy=(EntropyType) entropies[i];
+      SetStringInfoLength(ciphertext,length);
+      (void) memcpy(GetStringInfoDatum(ciphertext),GetStringInfoDatum(
+        records)+i*extent,length);
+      if (tag != (StringInfo *) NULL)
+        SetContentRecordData(content_info,(WizardSizeType) chunk,
+          record_marker,entropy);
+      if (content_info->mode == XTSMode)
+        plaintext=DecipherCipherRange(content_info->cipher_info,ciphertext,
+          (WizardSizeType) chunk*(content_info->chunksize+pad));
+      else
+        plaintext=DecipherCipher(content_info->cipher_info,ciphertext);
+      if ((tag != (StringInfo *) NULL) &&
+          (CompareStringInfo(tag,GetCipherTag(content_info->cipher_info)) !=
+           0))
+        ThrowCorruptRecordException();
+      if ((content_info->mode != CFBMode) && (tag == (StringInfo *) NULL) &&
+          ((pad != 0) || (record_marker == CipherFinalRecord)))
+        {
+          if ((length == 0) ||
+              ((size_t) GetStringInfoDatum(plaintext)[length-1] >= length))
+            ThrowCorruptRecordException();
+          length-=GetStringInfoDatum(plaintext)[length-1]+1;
+        }
+      SetStringInfoLength(plaintext,length);
+      if ((entropy != NoEntropy) && (length != 0))
+        {
+          status=RestoreEntropy(content_info->entropy_info,length,plaintext,
+            exception);
+          if (status == WizardFalse)
+            ThrowDecipherRecordsException(FileError,"unable to restore "
+              "entropy `%s': `%s'",cipher_filename);
+          SetStringInfo(plaintext,GetEntropyChaos(content_info->entropy_info));
+        }
+      if (content_info->extent != 0)
+        {
+          WizardSizeType
+            offset,
+            target;
+
+          /*
+            Keep the part of the chunk that overlaps the extract.
+          */
+          offset=(WizardSizeType) chunk*content_info->chunksize;
+          target=Min(offset+length,content_info->offset+
+            content_info->extent);
+          offset=Max(offset,content_info->offset);
+          length=0;
+          if (target > offset)
+            {
+              (void) memmove(GetStringInfoDatum(plaintext),
+                GetStringInfoDatum(plaintext)+(offset-(WizardSizeType)
+                chunk*content_info->chunksize),(size_t) (target-offset));
+              length=(size_t) (target-offset);
+            }
+        }
+      count=WriteBlobChunk(content_info->plainblob,length,
+        GetStringInfoDatum(plaintext));
+      if (count != (ssize_t) length)
+        ThrowDecipherRecordsException(FileError,"unable to write plaintext "
+          "`%s': `%s'",cipher_filename);
+    }
+    if ((chunk-1) >= last)
+      break;
+  }
+  entropies=(unsigned char *) RelinquishWizardMemory(entropies);
+  records=DestroyStringInfo(records);
+  ciphertext=DestroyStringInfo(ciphertext);
+  digest=DestroyStringInfo(digest);
+  if (properties_info != (HMACInfo *) NULL)
+    properties_info=DestroyHMACInfo(properties_info);
+  if (tag != (StringInfo *) NULL)
+    tag=DestroyStringInfo(tag);
+  return(WizardTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
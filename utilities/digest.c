@@ -54,6 +54,32 @@
 #endif
 #include "content.h"
 #include "utility_.h"
+
+/*
+  Define declarations.
+*/
+#define DigestBatchExtent  1048576
+#define DigestBatchWindow  64
+#define DigestStreamExtent  4194304
+
+/*
+  Typedef declarations.
+*/
+typedef struct _DigestContent
+{
+  char
+    *digest,
+    *path;
+
+  time_t
+    modify_date;
+
+  WizardSizeType
+    extent;
+
+  StringInfo
+    *content;
+} DigestContent;
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -165,7 +191,7 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
   ssize_t
     count;
 
-  StringInfo
+  unsigned char
     *content;
 
   WizardBooleanType
@@ -418,20 +444,23 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
                     /*
                       Compute content message digest and verify.
                     */
+                    content=(unsigned char *) AcquireQuantumMemory(
+                      DigestStreamExtent,sizeof(*content));
+                    if (content == (unsigned char *) NULL)
+                      ThrowDigestException(ResourceError,
+                        "memory allocation failed: `%s'",strerror(errno));
                     hash_info=AcquireHashInfo(hash);
                     InitializeHash(hash_info);
-                    for (content=AcquireStringInfo(WizardMaxBufferExtent); ; )
+                    for ( ; ; )
                     {
-                      count=ReadBlobChunk(content_blob,WizardMaxBufferExtent,
-                        GetStringInfoDatum(content));
+                      count=ReadBlobChunk(content_blob,DigestStreamExtent,
+                        content);
                       if (count <= 0)
                         break;
-                      length=(size_t) count;
-                      SetStringInfoLength(content,length);
-                      UpdateHash(hash_info,content);
+                      UpdateHashBytes(hash_info,content,(size_t) count);
                     }
                     FinalizeHash(hash_info);
-                    content=DestroyStringInfo(content);
+                    content=(unsigned char *) RelinquishWizardMemory(content);
                     if (strcmp(digest,GetHashHexDigest(hash_info)) != 0)
                       {
                         char
@@ -507,6 +536,105 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
   return(status);
 }
 
+static char *FormatDigestRDF(const DigestContent *content,const HashType hash)
+{
+  char
+    algorithm[WizardPathExtent],
+    *canonical_path,
+    content_extent[WizardPathExtent],
+    *digest_rdf,
+    timestamp[WizardPathExtent];
+
+  digest_rdf=AcquireString("  <digest:Content rdf:about=\"");
+  canonical_path=CanonicalXMLContent(content->path,WizardFalse);
+  (void) ConcatenateString(&digest_rdf,canonical_path);
+  canonical_path=DestroyString(canonical_path);
+  (void) ConcatenateString(&digest_rdf,"\">\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:timestamp>");
+  (void) FormatWizardTime(time((time_t *) NULL),WizardPathExtent,timestamp);
+  (void) ConcatenateString(&digest_rdf,timestamp);
+  (void) ConcatenateString(&digest_rdf,"</digest:timestamp>\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:modify-date>");
+  (void) FormatWizardTime(content->modify_date,WizardPathExtent,timestamp);
+  (void) ConcatenateString(&digest_rdf,timestamp);
+  (void) ConcatenateString(&digest_rdf,"</digest:modify-date>\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:create-date>");
+  (void) FormatWizardTime(content->modify_date,WizardPathExtent,timestamp);
+  (void) ConcatenateString(&digest_rdf,timestamp);
+  (void) ConcatenateString(&digest_rdf,"</digest:create-date>\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:extent>");
+  (void) FormatLocaleString(content_extent,WizardPathExtent,"%.17g",(double)
+    content->extent);
+  (void) ConcatenateString(&digest_rdf,content_extent);
+  (void) ConcatenateString(&digest_rdf,"</digest:extent>\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:");
+  (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
+    WizardOptionToMnemonic(WizardHashOptions,hash));
+  LocaleLower(algorithm);
+  (void) ConcatenateString(&digest_rdf,algorithm);
+  (void) ConcatenateString(&digest_rdf,">");
+  (void) ConcatenateString(&digest_rdf,content->digest);
+  (void) ConcatenateString(&digest_rdf,"</digest:");
+  (void) ConcatenateString(&digest_rdf,algorithm);
+  (void) ConcatenateString(&digest_rdf,">\n");
+  (void) ConcatenateString(&digest_rdf,"  </digest:Content>\n");
+  return(digest_rdf);
+}
+
+static WizardBooleanType WriteDigestContents(BlobInfo *digest_blob,
+  HashBatchInfo *batch_info,const HashType hash,DigestContent *contents,
+  size_t *number_contents)
+{
+  char
+    *digest_rdf;
+
+  const StringInfo
+    *digest;
+
+  size_t
+    id,
+    length;
+
+  ssize_t
+    count,
+    i;
+
+  WizardBooleanType
+    status;
+
+  /*
+    Complete the batched digests, then write the content in command-line
+    order.
+  */
+  if (batch_info != (HashBatchInfo *) NULL)
+    {
+      (void) FlushHashBatch(batch_info);
+      for ( ; ; )
+      {
+        digest=GetHashBatchDigest(batch_info,&id);
+        if (digest == (const StringInfo *) NULL)
+          break;
+        contents[id].digest=StringInfoToHexString(digest);
+      }
+    }
+  status=WizardTrue;
+  for (i=0; i < (ssize_t) *number_contents; i++)
+  {
+    digest_rdf=FormatDigestRDF(contents+i,hash);
+    length=strlen(digest_rdf);
+    count=WriteBlob(digest_blob,length,(unsigned char *) digest_rdf);
+    digest_rdf=DestroyString(digest_rdf);
+    if (count != (ssize_t) length)
+      status=WizardFalse;
+    contents[i].path=DestroyString(contents[i].path);
+    contents[i].digest=DestroyString(contents[i].digest);
+    if (contents[i].content != (StringInfo *) NULL)
+      contents[i].content=DestroyStringInfo(contents[i].content);
+  }
+  *number_contents=0;
+  return(status);
+}
+
 WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
   ExceptionInfo *exception)
 {
@@ -515,35 +643,35 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
     *digest_blob;
 
   char
-    algorithm[WizardPathExtent],
-    *canonical_path,
-    content_extent[WizardPathExtent],
-    *digest_rdf,
-    *digest,
-    *option,
-    timestamp[WizardPathExtent];
+    *option;
 
   const struct stat
     *properties;
 
+  DigestContent
+    *content,
+    contents[DigestBatchWindow];
+
+  HashBatchInfo
+    *batch_info;
+
   HashInfo
     *hash_info;
 
   HashType
+    batch_hash,
     hash;
 
    ssize_t
     i;
 
   size_t
-    length;
+    length,
+    number_contents;
 
   ssize_t
     count;
 
-  StringInfo
-    *content;
-
   WizardBooleanType
     status;
 
@@ -585,6 +713,9 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
   if (digest_blob == (BlobInfo *) NULL)
     return(WizardFalse);
   hash=SHA2256Hash;
+  batch_hash=hash;
+  batch_info=(HashBatchInfo *) NULL;
+  number_contents=0;
   (void) WriteBlobString(digest_blob,"<?xml version=\"1.0\"?>\n");
   (void) WriteBlobString(digest_blob,"<rdf:RDF xmlns:rdf=\""
     "http://www.w3.org/1999/02/22-rdf-syntax-ns#\"\n");
@@ -714,71 +845,87 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
     content_blob=OpenBlob(argv[i],ReadBinaryBlobMode,WizardFalse,exception);
     if (content_blob == (BlobInfo *) NULL)
       continue;
+    if ((batch_info != (HashBatchInfo *) NULL) && (batch_hash != hash))
+      {
+        status=WriteDigestContents(digest_blob,batch_info,batch_hash,contents,
+          &number_contents);
+        if (status == WizardFalse)
+          ThrowFileException(exception,FileError,argv[argc-1]);
+        batch_info=DestroyHashBatchInfo(batch_info);
+      }
+    if (batch_info == (HashBatchInfo *) NULL)
+      {
+        batch_info=AcquireHashBatchInfo(hash);
+        batch_hash=hash;
+      }
     properties=GetBlobProperties(content_blob);
-    hash_info=AcquireHashInfo(hash);
-    InitializeHash(hash_info);
-    extent=0;
-    for (content=AcquireStringInfo(WizardMaxBufferExtent); ; )
-    {
-      count=ReadBlobChunk(content_blob,WizardMaxBufferExtent,GetStringInfoDatum(
-        content));
-      if (count <= 0)
-        break;
-      length=(size_t) count;
-      SetStringInfoLength(content,length);
-      UpdateHash(hash_info,content);
-      extent+=length;
-    }
-    FinalizeHash(hash_info);
-    digest_rdf=AcquireString("  <digest:Content rdf:about=\"");
-    canonical_path=CanonicalXMLContent(argv[i],WizardFalse);
-    (void) ConcatenateString(&digest_rdf,canonical_path);
-    canonical_path=DestroyString(canonical_path);
-    (void) ConcatenateString(&digest_rdf,"\">\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:timestamp>");
-    (void) FormatWizardTime(time((time_t *) NULL),WizardPathExtent,timestamp);
-    (void) ConcatenateString(&digest_rdf,timestamp);
-    (void) ConcatenateString(&digest_rdf,"</digest:timestamp>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:modify-date>");
-    (void) FormatWizardTime(properties->st_mtime,WizardPathExtent,timestamp);
-    (void) ConcatenateString(&digest_rdf,timestamp);
-    (void) ConcatenateString(&digest_rdf,"</digest:modify-date>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:create-date>");
-    (void) FormatWizardTime(properties->st_mtime,WizardPathExtent,timestamp);
-    (void) ConcatenateString(&digest_rdf,timestamp);
-    (void) ConcatenateString(&digest_rdf,"</digest:create-date>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:extent>");
-    (void) FormatLocaleString(content_extent,WizardPathExtent,"%.17g",(double)
-      extent);
-    (void) ConcatenateString(&digest_rdf,content_extent);
-    (void) ConcatenateString(&digest_rdf,"</digest:extent>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:");
-    (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
-      WizardOptionToMnemonic(WizardHashOptions,hash));
-    LocaleLower(algorithm);
-    (void) ConcatenateString(&digest_rdf,algorithm);
-    (void) ConcatenateString(&digest_rdf,">");
-    digest=GetHashHexDigest(hash_info);
-    (void) ConcatenateString(&digest_rdf,digest);
-    digest=DestroyString(digest);
-    (void) ConcatenateString(&digest_rdf,"</digest:");
-    (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
-      WizardOptionToMnemonic(WizardHashOptions,hash));
-    LocaleLower(algorithm);
-    (void) ConcatenateString(&digest_rdf,algorithm);
-    (void) ConcatenateString(&digest_rdf,">\n");
-    (void) ConcatenateString(&digest_rdf,"  </digest:Content>\n");
-    content=DestroyStringInfo(content);
-    hash_info=DestroyHashInfo(hash_info);
+    content=contents+number_contents;
+    (void) memset(content,0,sizeof(*content));
+    content->path=ConstantString(argv[i]);
+    content->modify_date=properties->st_mtime;
+    if ((GetHashBatchLanes(batch_info) > 1) &&
+        ((WizardSizeType) properties->st_size <= DigestBatchExtent))
+      {
+        /*
+          Small content is read whole and hashed alongside its neighbors.
+        */
+        content->content=AcquireStringInfo((size_t) properties->st_size);
+        count=ReadBlob(content_blob,GetStringInfoLength(content->content),
+          GetStringInfoDatum(content->content));
+        if (count < 0)
+          count=0;
+        SetStringInfoLength(content->content,(size_t) count);
+        content->extent=(WizardSizeType) count;
+        (void) SubmitHashBatch(batch_info,content->content,number_contents);
+      }
+    else
+      {
+        unsigned char
+          *chunk;
+
+        chunk=(unsigned char *) AcquireQuantumMemory(DigestStreamExtent,
+          sizeof(*chunk));
+        if (chunk == (unsigned char *) NULL)
+          ThrowDigestException(ResourceError,"memory allocation failed: `%s'",
+            strerror(errno));
+        hash_info=AcquireHashInfo(hash);
+        InitializeHash(hash_info);
+        extent=0;
+        for ( ; ; )
+        {
+          count=ReadBlobChunk(content_blob,DigestStreamExtent,chunk);
+          if (count <= 0)
+            break;
+          length=(size_t) count;
+          UpdateHashBytes(hash_info,chunk,length);
+          extent+=length;
+        }
+        FinalizeHash(hash_info);
+        content->extent=extent;
+        content->digest=GetHashHexDigest(hash_info);
+        chunk=(unsigned char *) RelinquishWizardMemory(chunk);
+        hash_info=DestroyHashInfo(hash_info);
+      }
     if (CloseBlob(content_blob) == WizardFalse)
       ThrowFileException(exception,FileError,argv[i]);
     content_blob=DestroyBlob(content_blob);
-    length=strlen(digest_rdf);
-    count=WriteBlob(digest_blob,length,(unsigned char *) digest_rdf);
-    digest_rdf=DestroyString(digest_rdf);
-    if (count != (ssize_t) length)
-      ThrowFileException(exception,FileError,argv[argc-1]);
+    number_contents++;
+    if (number_contents == DigestBatchWindow)
+      {
+        status=WriteDigestContents(digest_blob,batch_info,batch_hash,contents,
+          &number_contents);
+        if (status == WizardFalse)
+          ThrowFileException(exception,FileError,argv[argc-1]);
+      }
   }
+  if (batch_info != (HashBatchInfo *) NULL)
+    {
+      status=WriteDigestContents(digest_blob,batch_info,batch_hash,contents,
+        &number_contents);
+      if (status == WizardFalse)
+        ThrowFileException(exception,FileError,argv[argc-1]);
+      batch_info=DestroyHashBatchInfo(batch_info);
+    }
   (void) WriteBlobString(digest_blob,"</rdf:RDF>\n");
   if (CloseBlob(digest_blob) == WizardFalse)
     status=WizardFalse;
@@ -120,6 +120,7 @@ static void EncipherUsage()
       "-passphrase filename get the passphrase from this file",
       "-properties filename put cipher properties to this file",
       "-random hash         strengthen random data with this hash",
+      "-threads value       maximum number of threads to encipher with",
       "-true-random         strengthen enciphering with true random numbers",
       "-verbose             print detailed information about the secure content",
       "-version             print version information",
@@ -534,6 +535,26 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
       }
       case 't':
       {
+        if (LocaleCompare(option,"-threads") == 0)
+          {
+            char
+              *p;
+
+            double
+              value;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing threads: `%s'",
+                option);
+            value=StringToDouble(argv[i],&p);
+            if ((p == argv[i]) || (value < 1.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            content_info->threads=(size_t) value;
+            break;
+          }
         if (LocaleCompare(option+1,"true-random") == 0)
           {
             SetRandomTrueRandom(*option == '-' ? WizardTrue : WizardFalse);
@@ -619,6 +640,19 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
 %    o exception: return any exceptions in this structure.
 %
 */
+static WizardBooleanType WriteCipherRecord(ContentInfo *content_info,
+  const void *data,const size_t length)
+{
+  /*
+    Write part of a record and add it to the running HMAC.
+  */
+  if (WriteBlobChunk(content_info->cipherblob,length,data) != (ssize_t) length)
+    return(WizardFalse);
+  if (content_info->hmac != NoHash)
+    UpdateHMACBytes(content_info->hmac_info,data,length);
+  return(WizardTrue);
+}
+
 static WizardBooleanType EncipherContent(ContentInfo *content_info,
   const char *plain_filename,const char *cipher_filename,
   const WizardBooleanType compress,ExceptionInfo *exception)
@@ -639,26 +673,39 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
 
   const StringInfo
     *chaos,
-    *hmac;
+    *hmac,
+    *tag;
 
   const struct stat
     *properties;
 
+  EntropyType
+    entropy;
+
   HashInfo
     *hash_info;
 
+  HMACInfo
+    *properties_info;
+
   size_t
     blocksize,
+    chunk,
     length,
-    pad;
+    pad,
+    stride;
 
   ssize_t
     count;
 
   StringInfo
     *ciphertext,
+    *lookahead,
     *plaintext;
 
+  unsigned char
+    marker;
+
   WizardBooleanType
     status;
 
@@ -673,8 +720,35 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
     compress,exception);
   if (content_info->cipherblob == (BlobInfo *) NULL)
     return(WizardFalse);
+  if ((content_info->mode == GCMMode) || (content_info->mode == Poly1305Mode))
+    {
+      /*
+        Authenticated modes tag each chunk themselves, the HMAC pass is
+        redundant.
+      */
+      if ((content_info->mode == GCMMode) &&
+          (content_info->cipher != AESCipher) &&
+          (content_info->cipher != TwofishCipher))
+        ThrowEncipherContentException(OptionError,"GCM mode requires a "
+          "128-bit block cipher `%s': `%s'",cipher_filename);
+      if ((content_info->mode == Poly1305Mode) &&
+          (content_info->cipher != ChachaCipher))
+        ThrowEncipherContentException(OptionError,"Poly1305 mode requires "
+          "the Chacha cipher `%s': `%s'",cipher_filename);
+      content_info->hmac=NoHash;
+    }
+  content_info->hmac_interval=CipherTagExtent/content_info->chunksize;
+  if (content_info->hmac_interval == 0)
+    content_info->hmac_interval=1;
+  if ((content_info->mode == XTSMode) &&
+      (content_info->cipher != AESCipher) &&
+      (content_info->cipher != TwofishCipher))
+    ThrowEncipherContentException(OptionError,"XTS mode requires a 128-bit "
+      "block cipher `%s': `%s'",cipher_filename);
   content_info->cipher_info=AcquireCipherInfo(content_info->cipher,
     content_info->mode);
+  if (content_info->threads != 0)
+    SetCipherThreads(content_info->cipher_info,content_info->threads);
   content_info->authenticate_info=AcquireAuthenticateInfo(
     content_info->authenticate_method,content_info->keyring,
     content_info->key_hash);
@@ -693,6 +767,7 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
   content_info->nonce=StringInfoToHexString(GetCipherNonce(
     content_info->cipher_info));
   content_info->random_info=AcquireRandomInfo(content_info->random_hash);
+  SetRandomGenerator(content_info->random_info,ChachaRandomGenerator);
   properties=GetBlobProperties(content_info->plainblob);
   content_info->access_date=properties->st_atime;
   content_info->modify_date=properties->st_mtime;
@@ -744,6 +819,10 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
     "    <cipher:hmac>%s</cipher:hmac>\n",WizardOptionToMnemonic(
     WizardHashOptions,content_info->hmac));
   (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:hmac-interval>%.17g</cipher:hmac-interval>\n",(double)
+    content_info->hmac_interval);
+  (void) ConcatenateString(&cipher_rdf,message);
   (void) FormatLocaleString(message,WizardPathExtent,
     "    <cipher:chunksize>%.17g</cipher:chunksize>\n",(double)
     content_info->chunksize);
@@ -773,11 +852,10 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
     Wrap cipher RDF in a cipher-packet.
   */
   length=strlen(cipher_rdf);
+  content_info->cipher_rdf=StringToStringInfo(cipher_rdf);
   hash_info=AcquireHashInfo(SHA2256Hash);
   InitializeHash(hash_info);
-  plaintext=StringToStringInfo(cipher_rdf);
-  UpdateHash(hash_info,plaintext);
-  plaintext=DestroyStringInfo(plaintext);
+  UpdateHashBytes(hash_info,cipher_rdf,length);
   FinalizeHash(hash_info);
   digest=GetHashHexDigest(hash_info);
   length=(size_t) FormatLocaleString(message,WizardPathExtent,
@@ -815,90 +893,134 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
     ThrowEncipherContentException(FileError,
       "unable to write cipher properties `%s': `%s'",cipher_filename);
   /*
-    Encipher plaintext.
+    Encipher plaintext.  The records are authenticated in intervals of
+    hmac-interval records: a tag follows each interval, including the last
+    one, and covers the cipher properties, the interval number, and the
+    interval's records as written.
   */
+  properties_info=(HMACInfo *) NULL;
   if (content_info->hmac != NoHash)
-    content_info->hmac_info=AcquireHMACInfo(content_info->hmac);
+    {
+      properties_info=AcquireHMACInfo(content_info->hmac);
+      InitializeHMAC(properties_info,GetAuthenticateKey(
+        content_info->authenticate_info));
+      UpdateHMAC(properties_info,content_info->cipher_rdf);
+    }
   content_info->entropy_info=(EntropyInfo *) NULL;
   if (content_info->entropy != NoEntropy)
     content_info->entropy_info=AcquireEntropyInfo(content_info->entropy,
       content_info->level);
-  pad=0;
   blocksize=GetCipherBlocksize(content_info->cipher_info);
-  ciphertext=(StringInfo *) NULL;
-  for (plaintext=AcquireStringInfo(content_info->chunksize); ; )
+  stride=content_info->chunksize;
+  if ((stride % blocksize) != 0)
+    stride+=blocksize-stride % blocksize;
+  plaintext=AcquireStringInfo(content_info->chunksize);
+  lookahead=AcquireStringInfo(content_info->chunksize);
+  count=ReadBlobChunk(content_info->plainblob,content_info->chunksize,
+    GetStringInfoDatum(lookahead));
+  for (chunk=0; ; chunk++)
   {
-    SetStringInfoLength(plaintext,content_info->chunksize);
-    count=ReadBlobChunk(content_info->plainblob,content_info->chunksize,
-      GetStringInfoDatum(plaintext));
-    if (count <= 0)
-      break;
-    length=(size_t) count;
+    StringInfo
+      *swap;
+
+    /*
+      Read one chunk ahead so the last record is known when it is written.
+    */
+    swap=plaintext;
+    plaintext=lookahead;
+    lookahead=swap;
+    if ((content_info->hmac != NoHash) &&
+        ((chunk % content_info->hmac_interval) == 0))
+      InitializeContentHMAC(content_info,properties_info,(WizardSizeType)
+        (chunk/content_info->hmac_interval));
+    length=count > 0 ? (size_t) count : 0;
     SetStringInfoLength(plaintext,length);
-    if (content_info->hmac != NoHash)
-      {
-        ConstructHMAC(content_info->hmac_info,GetAuthenticateKey(
-          content_info->authenticate_info),plaintext);
-        hmac=GetHMACDigest(content_info->hmac_info);
-        count=WriteBlobChunk(content_info->cipherblob,GetStringInfoLength(hmac),
-          GetStringInfoDatum(hmac));
-        if (count != (ssize_t) GetStringInfoLength(hmac))
-          ThrowEncipherContentException(FileError,"unable to write ciphertext "
-            "`%s': `%s'",cipher_filename);
-      }
-    if (content_info->entropy != NoEntropy)
+    SetStringInfoLength(lookahead,content_info->chunksize);
+    count=ReadBlobChunk(content_info->plainblob,content_info->chunksize,
+      GetStringInfoDatum(lookahead));
+    marker=count > 0 ? CipherRecord : CipherFinalRecord;
+    entropy=NoEntropy;
+    if ((content_info->entropy != NoEntropy) && (length != 0))
       {
         status=IncreaseEntropy(content_info->entropy_info,plaintext,exception);
         chaos=GetEntropyChaos(content_info->entropy_info);
         if (status == WizardFalse)
           ThrowEncipherContentException(FileError,"unable to increase entropy "
             "`%s': `%s'",cipher_filename);
-        if (GetStringInfoLength(chaos) > length)
-          count=WriteBlobByte(content_info->cipherblob,(unsigned char)
-            NoEntropy);
-        else
+        if (GetStringInfoLength(chaos) <= length)
           {
             SetStringInfo(plaintext,chaos);
             SetRandomKey(content_info->random_info,length-GetStringInfoLength(
               chaos),GetStringInfoDatum(plaintext)+GetStringInfoLength(chaos));
-            count=WriteBlobByte(content_info->cipherblob,(unsigned char)
-              content_info->entropy);
+            entropy=content_info->entropy;
           }
-        if (count != 1)
-          ThrowEncipherContentException(FileError,"unable to write ciphertext "
-            "`%s': `%s'",cipher_filename);
       }
-    ciphertext=EncipherCipher(content_info->cipher_info,plaintext);
-    if (content_info->mode != CFBMode)
+    if ((content_info->mode == GCMMode) ||
+        (content_info->mode == Poly1305Mode))
+      SetContentRecordData(content_info,(WizardSizeType) chunk,marker,
+        entropy);
+    if (content_info->mode == XTSMode)
+      ciphertext=EncipherCipherRange(content_info->cipher_info,plaintext,
+        (WizardSizeType) chunk*stride);
+    else
+      ciphertext=EncipherCipher(content_info->cipher_info,plaintext);
+    tag=GetCipherTag(content_info->cipher_info);
+    if ((content_info->mode != CFBMode) && (tag == (const StringInfo *) NULL))
       {
+        /*
+          The last record always carries its cryptographic padding.
+        */
         pad=blocksize-length % blocksize;
-        if (pad != blocksize)
+        if ((pad != blocksize) || (marker == CipherFinalRecord))
           length+=pad;
       }
-    count=WriteBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
-      ciphertext));
-    if (count != (ssize_t) length)
+    /*
+      The record marker, cipher tag, and entropy byte precede the chunk.
+    */
+    status=WriteCipherRecord(content_info,&marker,1);
+    if (tag != (const StringInfo *) NULL)
+      status&=WriteCipherRecord(content_info,GetStringInfoDatum(tag),
+        GetStringInfoLength(tag));
+    if (content_info->entropy != NoEntropy)
+      {
+        unsigned char
+          byte;
+
+        byte=(unsigned char) entropy;
+        status&=WriteCipherRecord(content_info,&byte,1);
+      }
+    status&=WriteCipherRecord(content_info,GetStringInfoDatum(ciphertext),
+      length);
+    if (status == WizardFalse)
       ThrowEncipherContentException(FileError,"unable to write ciphertext "
         "`%s': `%s'",cipher_filename);
+    if ((content_info->hmac != NoHash) &&
+        ((marker == CipherFinalRecord) ||
+         (((chunk+1) % content_info->hmac_interval) == 0)))
+      {
+        /*
+          The interval tag follows its last record.
+        */
+        FinalizeHMAC(content_info->hmac_info);
+        hmac=GetHMACDigest(content_info->hmac_info);
+        if (WriteBlobChunk(content_info->cipherblob,GetStringInfoLength(hmac),
+              GetStringInfoDatum(hmac)) != (ssize_t) GetStringInfoLength(hmac))
+          ThrowEncipherContentException(FileError,"unable to write ciphertext "
+            "`%s': `%s'",cipher_filename);
+      }
+    if (marker == CipherFinalRecord)
+      break;
     if (SyncBlob(content_info->cipherblob) != WizardFalse)
       ThrowEncipherContentException(FileError,"unable to sync ciphertext `%s': "
         "`%s'",cipher_filename);
   }
-  if ((content_info->mode != CFBMode) && (pad == blocksize))
-    {
-      /*
-        Cryptographic padding.
-      */
-      count=WriteBlobChunk(content_info->cipherblob,blocksize,
-        GetStringInfoDatum(ciphertext)+length);
-      if (count != (ssize_t) blocksize)
-        ThrowEncipherContentException(FileError,"unable to write ciphertext "
-          "`%s': `%s'",cipher_filename);
-    }
+  if (properties_info != (HMACInfo *) NULL)
+    properties_info=DestroyHMACInfo(properties_info);
   if (CloseBlob(content_info->cipherblob) == WizardFalse)
     ThrowFileException(exception,FileError,content_info->content);
   if (CloseBlob(content_info->plainblob) == WizardFalse)
     ThrowFileException(exception,FileError,content_info->content);
+  lookahead=DestroyStringInfo(lookahead);
   plaintext=DestroyStringInfo(plaintext);
   return(WizardTrue);
 }
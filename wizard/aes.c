@@ -41,6 +41,7 @@
 */
 #include "wizard/studio.h"
 #include "wizard/aes.h"
+#include "wizard/cpu-private.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
 #include "wizard/memory_.h"
@@ -61,6 +62,10 @@ struct _AESInfo
   ssize_t
     rounds;
 
+  WizardBooleanType
+    aesni,
+    vperm;
+
   time_t
     timestamp;
 
@@ -72,6 +77,7 @@ struct _AESInfo
   Define declarations.
 */
 #define AESBlocksize 16
+#define AESNILanes  8
 
 /*
   Global declarations.
@@ -143,6 +149,58 @@ static unsigned char
      40, 223, 140, 161, 137,  13, 191, 230,  66, 104,  65, 153,  45,  15,
     176,  84, 187, 22
   };
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+/*
+  Vector permute tables: the S-box input is mapped to a GF((2^4)^2) basis,
+  inverted with nibble lookups (1/0 is 0x80, which a shuffle maps to zero),
+  and mapped back by the output tables.
+*/
+static const unsigned char
+  VPermDecipherInput[2][16] =
+  {
+    { 0x47, 0x1F, 0xD8, 0x80, 0xDF, 0x87, 0x40, 0x18, 0x6F, 0x37, 0xF0,
+      0xA8, 0xF7, 0xAF, 0x68, 0x30 },
+    { 0x00, 0x76, 0x79, 0x0F, 0xF9, 0x8F, 0x80, 0xF6, 0x92, 0xE4, 0xEB,
+      0x9D, 0x6B, 0x1D, 0x12, 0x64 }
+  },
+  VPermDecipherOutput[2][16] =
+  {
+    { 0x00, 0xF2, 0x99, 0x30, 0x9D, 0xC6, 0xA9, 0x5B, 0xC2, 0x5F, 0x6F,
+      0xF6, 0x34, 0x04, 0xAD, 0x6B },
+    { 0x00, 0xF3, 0xC8, 0xDC, 0x2C, 0xCB, 0x14, 0xE7, 0x2F, 0x03, 0xDF,
+      0x17, 0x38, 0xE4, 0xF0, 0x3B }
+  },
+  VPermEncipherInput[2][16] =
+  {
+    { 0x00, 0x01, 0x20, 0x21, 0x46, 0x47, 0x66, 0x67, 0x4C, 0x4D, 0x6C,
+      0x6D, 0x0A, 0x0B, 0x2A, 0x2B },
+    { 0x00, 0x3C, 0xD5, 0xE9, 0x34, 0x08, 0xE1, 0xDD, 0xE5, 0xD9, 0x30,
+      0x0C, 0xD1, 0xED, 0x04, 0x38 }
+  },
+  VPermEncipherOutput[2][16] =
+  {
+    { 0x00, 0x64, 0x99, 0x12, 0xE5, 0x0A, 0x8B, 0xEF, 0x76, 0x93, 0x81,
+      0x18, 0x6E, 0x7C, 0xF7, 0xFD },
+    { 0x00, 0x7B, 0xB0, 0x3D, 0x67, 0x91, 0x8D, 0xF6, 0x46, 0x21, 0x1C,
+      0xAC, 0xEA, 0xD7, 0x5A, 0xCB }
+  },
+  VPermInverse[2][16] =
+  {
+    { 0x80, 0x01, 0x09, 0x0E, 0x0D, 0x0B, 0x07, 0x06, 0x0F, 0x02, 0x0C,
+      0x05, 0x0A, 0x04, 0x03, 0x08 },
+    { 0x80, 0x0F, 0x0E, 0x05, 0x07, 0x03, 0x0B, 0x04, 0x0A, 0x0D, 0x08,
+      0x06, 0x0C, 0x09, 0x02, 0x01 }
+  },
+  VPermShift[5][16] =
+  {
+    { 0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11 },
+    { 0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3 },
+    { 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12 },
+    { 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 },
+    { 3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14 }
+  };
+#endif
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -172,6 +230,8 @@ WizardExport AESInfo *AcquireAESInfo(void)
     ThrowWizardFatalError(CipherDomain,MemoryError);
   (void) memset(aes_info,0,sizeof(*aes_info));
   aes_info->blocksize=AESBlocksize;
+  aes_info->aesni=HasCPUFeature(AESNICPUFeature);
+  aes_info->vperm=HasCPUFeature(SSSE3CPUFeature);
   aes_info->key=AcquireStringInfo(32);
   aes_info->encipher_key=(unsigned int *) AcquireQuantumMemory(60UL,
     sizeof(*aes_info->encipher_key));
@@ -316,6 +376,142 @@ static inline unsigned int RotateLeft(const unsigned int x)
   return(((x << 8) | ((x >> 24) & 0xff)));
 }
 
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static WizardTarget("aes") void DecipherAESNIBlock(const AESInfo *aes_info,
+  const unsigned char *ciphertext,unsigned char *plaintext)
+{
+  const __m128i
+    *key;
+
+  __m128i
+    text;
+
+  ssize_t
+    i;
+
+  /*
+    The deciphering key is already in equivalent inverse cipher form.
+  */
+  key=(const __m128i *) aes_info->decipher_key;
+  text=_mm_xor_si128(_mm_loadu_si128((const __m128i *) ciphertext),
+    _mm_loadu_si128(key+aes_info->rounds));
+  for (i=aes_info->rounds-1; i > 0; i--)
+    text=_mm_aesdec_si128(text,_mm_loadu_si128(key+i));
+  text=_mm_aesdeclast_si128(text,_mm_loadu_si128(key));
+  _mm_storeu_si128((__m128i *) plaintext,text);
+  /*
+    Reset registers.
+  */
+  text=_mm_setzero_si128();
+  (void) text;
+}
+
+static inline WizardTarget("ssse3") __m128i XTimeAESVPerm(const __m128i text)
+{
+  return(_mm_xor_si128(_mm_add_epi8(text,text),_mm_and_si128(_mm_cmplt_epi8(
+    text,_mm_setzero_si128()),_mm_set1_epi8(0x1b))));
+}
+
+static inline WizardTarget("ssse3") __m128i MixAESVPermColumns(
+  const __m128i text)
+{
+  __m128i
+    alpha,
+    beta,
+    gamma;
+
+  /*
+    2*a[r] ^ 3*a[r+1] ^ a[r+2] ^ a[r+3] in each column.
+  */
+  alpha=_mm_shuffle_epi8(text,_mm_loadu_si128((const __m128i *)
+    VPermShift[2]));
+  beta=_mm_shuffle_epi8(text,_mm_loadu_si128((const __m128i *)
+    VPermShift[3]));
+  gamma=_mm_shuffle_epi8(text,_mm_loadu_si128((const __m128i *)
+    VPermShift[4]));
+  return(_mm_xor_si128(_mm_xor_si128(XTimeAESVPerm(_mm_xor_si128(text,alpha)),
+    alpha),_mm_xor_si128(beta,gamma)));
+}
+
+static inline WizardTarget("ssse3") __m128i SubAESVPermBytes(
+  const __m128i text,const unsigned char (*input)[16],
+  const unsigned char (*output)[16])
+{
+  __m128i
+    alpha,
+    beta,
+    delta,
+    gamma,
+    inverse,
+    mask;
+
+  /*
+    Change basis, then invert: alpha and beta are the low and high nibbles.
+  */
+  mask=_mm_set1_epi8(0x0f);
+  inverse=_mm_loadu_si128((const __m128i *) VPermInverse[0]);
+  alpha=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+    input[0]),_mm_and_si128(text,mask)),_mm_shuffle_epi8(_mm_loadu_si128(
+    (const __m128i *) input[1]),_mm_and_si128(_mm_srli_epi16(text,4),mask)));
+  beta=_mm_and_si128(_mm_srli_epi16(alpha,4),mask);
+  alpha=_mm_and_si128(alpha,mask);
+  gamma=_mm_xor_si128(alpha,beta);
+  beta=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) VPermInverse[1]),
+    beta);
+  delta=_mm_xor_si128(_mm_shuffle_epi8(inverse,gamma),beta);
+  beta=_mm_xor_si128(_mm_shuffle_epi8(inverse,alpha),beta);
+  beta=_mm_xor_si128(_mm_shuffle_epi8(inverse,beta),gamma);
+  delta=_mm_xor_si128(_mm_shuffle_epi8(inverse,delta),alpha);
+  return(_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+    output[0]),beta),_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+    output[1]),delta)));
+}
+
+static WizardTarget("ssse3") void DecipherAESVPermBlock(
+  const AESInfo *aes_info,const unsigned char *ciphertext,
+  unsigned char *plaintext)
+{
+  const __m128i
+    *key;
+
+  __m128i
+    alpha,
+    text;
+
+  ssize_t
+    i;
+
+  /*
+    The inverse cipher with the enciphering key in reverse order; no lookup
+    depends on the text.
+  */
+  key=(const __m128i *) aes_info->encipher_key;
+  text=_mm_xor_si128(_mm_loadu_si128((const __m128i *) ciphertext),
+    _mm_loadu_si128(key+aes_info->rounds));
+  for (i=aes_info->rounds-1; i >= 0; i--)
+  {
+    text=_mm_shuffle_epi8(text,_mm_loadu_si128((const __m128i *)
+      VPermShift[1]));
+    text=SubAESVPermBytes(text,VPermDecipherInput,VPermDecipherOutput);
+    text=_mm_xor_si128(text,_mm_loadu_si128(key+i));
+    if (i == 0)
+      break;
+    alpha=XTimeAESVPerm(XTimeAESVPerm(text));
+    alpha=_mm_xor_si128(alpha,_mm_shuffle_epi8(alpha,_mm_loadu_si128(
+      (const __m128i *) VPermShift[3])));
+    text=MixAESVPermColumns(_mm_xor_si128(text,alpha));
+  }
+  _mm_storeu_si128((__m128i *) plaintext,text);
+  /*
+    Reset registers.
+  */
+  alpha=_mm_setzero_si128();
+  text=_mm_setzero_si128();
+  (void) alpha;
+  (void) text;
+}
+#endif
+
 WizardExport void DecipherAESBlock(AESInfo *aes_info,
   const unsigned char *ciphertext,unsigned char *plaintext)
 {
@@ -418,6 +614,18 @@ WizardExport void DecipherAESBlock(AESInfo *aes_info,
     key[4],
     text[4];
 
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (aes_info->aesni != WizardFalse)
+    {
+      DecipherAESNIBlock(aes_info,ciphertext,plaintext);
+      return;
+    }
+  if (aes_info->vperm != WizardFalse)
+    {
+      DecipherAESVPermBlock(aes_info,ciphertext,plaintext);
+      return;
+    }
+#endif
   /*
     Decipher one block.
   */
@@ -449,6 +657,104 @@ WizardExport void DecipherAESBlock(AESInfo *aes_info,
   (void) ResetWizardMemory(key,0,sizeof(key));
   (void) ResetWizardMemory(text,0,sizeof(text));
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e c i p h e r A E S B l o c k s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherAESBlocks() deciphers consecutive blocks of ciphertext to produce
+%  blocks of plaintext.  Independent blocks are interleaved when the processor
+%  supports it.
+%
+%  The format of the DecipherAESBlocks method is:
+%
+%     void DecipherAESBlocks(AESInfo *aes_info,const unsigned char *ciphertext,
+%       unsigned char *plaintext,const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o aes_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+%    o plaintext: The plain text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static WizardTarget("aes") void DecipherAESNIBlocks(const AESInfo *aes_info,
+  const unsigned char *ciphertext,unsigned char *plaintext,const size_t blocks)
+{
+  const __m128i
+    *key;
+
+  __m128i
+    round_key,
+    text[AESNILanes];
+
+  size_t
+    i;
+
+  ssize_t
+    j,
+    k;
+
+  key=(const __m128i *) aes_info->decipher_key;
+  for (i=0; (i+AESNILanes) <= blocks; i+=AESNILanes)
+  {
+    round_key=_mm_loadu_si128(key+aes_info->rounds);
+    for (k=0; k < AESNILanes; k++)
+      text[k]=_mm_xor_si128(_mm_loadu_si128((const __m128i *) (ciphertext+
+        AESBlocksize*(i+k))),round_key);
+    for (j=aes_info->rounds-1; j > 0; j--)
+    {
+      round_key=_mm_loadu_si128(key+j);
+      for (k=0; k < AESNILanes; k++)
+        text[k]=_mm_aesdec_si128(text[k],round_key);
+    }
+    round_key=_mm_loadu_si128(key);
+    for (k=0; k < AESNILanes; k++)
+      _mm_storeu_si128((__m128i *) (plaintext+AESBlocksize*(i+k)),
+        _mm_aesdeclast_si128(text[k],round_key));
+  }
+  for ( ; i < blocks; i++)
+    DecipherAESNIBlock(aes_info,ciphertext+AESBlocksize*i,plaintext+
+      AESBlocksize*i);
+  /*
+    Reset registers.
+  */
+  for (k=0; k < AESNILanes; k++)
+    text[k]=_mm_setzero_si128();
+  (void) text;
+}
+#endif
+
+WizardExport void DecipherAESBlocks(AESInfo *aes_info,
+  const unsigned char *ciphertext,unsigned char *plaintext,const size_t blocks)
+{
+  size_t
+    i;
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (aes_info->aesni != WizardFalse)
+    {
+      DecipherAESNIBlocks(aes_info,ciphertext,plaintext,blocks);
+      return;
+    }
+#endif
+  for (i=0; i < blocks; i++)
+    DecipherAESBlock(aes_info,ciphertext+AESBlocksize*i,plaintext+
+      AESBlocksize*i);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -518,6 +824,72 @@ WizardExport AESInfo *DestroyAESInfo(AESInfo *aes_info)
 %    o ciphertext: The cipher text.
 %
 */
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static WizardTarget("aes") void EncipherAESNIBlock(const AESInfo *aes_info,
+  const unsigned char *plaintext,unsigned char *ciphertext)
+{
+  const __m128i
+    *key;
+
+  __m128i
+    text;
+
+  ssize_t
+    i;
+
+  key=(const __m128i *) aes_info->encipher_key;
+  text=_mm_xor_si128(_mm_loadu_si128((const __m128i *) plaintext),
+    _mm_loadu_si128(key));
+  for (i=1; i < aes_info->rounds; i++)
+    text=_mm_aesenc_si128(text,_mm_loadu_si128(key+i));
+  text=_mm_aesenclast_si128(text,_mm_loadu_si128(key+aes_info->rounds));
+  _mm_storeu_si128((__m128i *) ciphertext,text);
+  /*
+    Reset registers.
+  */
+  text=_mm_setzero_si128();
+  (void) text;
+}
+
+static WizardTarget("ssse3") void EncipherAESVPermBlock(
+  const AESInfo *aes_info,const unsigned char *plaintext,
+  unsigned char *ciphertext)
+{
+  const __m128i
+    *key;
+
+  __m128i
+    text;
+
+  ssize_t
+    i;
+
+  /*
+    SubBytes leaves out the 0x63 affine constant, it is added back after.
+  */
+  key=(const __m128i *) aes_info->encipher_key;
+  text=_mm_xor_si128(_mm_loadu_si128((const __m128i *) plaintext),
+    _mm_loadu_si128(key));
+  for (i=1; i <= aes_info->rounds; i++)
+  {
+    text=SubAESVPermBytes(text,VPermEncipherInput,VPermEncipherOutput);
+    text=_mm_xor_si128(text,_mm_set1_epi8(0x63));
+    text=_mm_shuffle_epi8(text,_mm_loadu_si128((const __m128i *)
+      VPermShift[0]));
+    if (i < aes_info->rounds)
+      text=MixAESVPermColumns(text);
+    text=_mm_xor_si128(text,_mm_loadu_si128(key+i));
+  }
+  _mm_storeu_si128((__m128i *) ciphertext,text);
+  /*
+    Reset registers.
+  */
+  text=_mm_setzero_si128();
+  (void) text;
+}
+#endif
+
 WizardExport void EncipherAESBlock(AESInfo *aes_info,
   const unsigned char *plaintext,unsigned char *ciphertext)
 {
@@ -596,6 +968,18 @@ WizardExport void EncipherAESBlock(AESInfo *aes_info,
     key[4],
     text[4];
 
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (aes_info->aesni != WizardFalse)
+    {
+      EncipherAESNIBlock(aes_info,plaintext,ciphertext);
+      return;
+    }
+  if (aes_info->vperm != WizardFalse)
+    {
+      EncipherAESVPermBlock(aes_info,plaintext,ciphertext);
+      return;
+    }
+#endif
   /*
     Encipher one block.
   */
@@ -627,6 +1011,104 @@ WizardExport void EncipherAESBlock(AESInfo *aes_info,
   (void) ResetWizardMemory(key,0,sizeof(key));
   (void) ResetWizardMemory(text,0,sizeof(text));
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r A E S B l o c k s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherAESBlocks() enciphers consecutive blocks of plaintext to produce
+%  blocks of ciphertext.  Independent blocks are interleaved when the processor
+%  supports it.
+%
+%  The format of the EncipherAESBlocks method is:
+%
+%     void EncipherAESBlocks(AESInfo *aes_info,const unsigned char *plaintext,
+%       unsigned char *ciphertext,const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o aes_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+%    o ciphertext: The cipher text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static WizardTarget("aes") void EncipherAESNIBlocks(const AESInfo *aes_info,
+  const unsigned char *plaintext,unsigned char *ciphertext,const size_t blocks)
+{
+  const __m128i
+    *key;
+
+  __m128i
+    round_key,
+    text[AESNILanes];
+
+  size_t
+    i;
+
+  ssize_t
+    j,
+    k;
+
+  key=(const __m128i *) aes_info->encipher_key;
+  for (i=0; (i+AESNILanes) <= blocks; i+=AESNILanes)
+  {
+    round_key=_mm_loadu_si128(key);
+    for (k=0; k < AESNILanes; k++)
+      text[k]=_mm_xor_si128(_mm_loadu_si128((const __m128i *) (plaintext+
+        AESBlocksize*(i+k))),round_key);
+    for (j=1; j < aes_info->rounds; j++)
+    {
+      round_key=_mm_loadu_si128(key+j);
+      for (k=0; k < AESNILanes; k++)
+        text[k]=_mm_aesenc_si128(text[k],round_key);
+    }
+    round_key=_mm_loadu_si128(key+aes_info->rounds);
+    for (k=0; k < AESNILanes; k++)
+      _mm_storeu_si128((__m128i *) (ciphertext+AESBlocksize*(i+k)),
+        _mm_aesenclast_si128(text[k],round_key));
+  }
+  for ( ; i < blocks; i++)
+    EncipherAESNIBlock(aes_info,plaintext+AESBlocksize*i,ciphertext+
+      AESBlocksize*i);
+  /*
+    Reset registers.
+  */
+  for (k=0; k < AESNILanes; k++)
+    text[k]=_mm_setzero_si128();
+  (void) text;
+}
+#endif
+
+WizardExport void EncipherAESBlocks(AESInfo *aes_info,
+  const unsigned char *plaintext,unsigned char *ciphertext,const size_t blocks)
+{
+  size_t
+    i;
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (aes_info->aesni != WizardFalse)
+    {
+      EncipherAESNIBlocks(aes_info,plaintext,ciphertext,blocks);
+      return;
+    }
+#endif
+  for (i=0; i < blocks; i++)
+    EncipherAESBlock(aes_info,plaintext+AESBlocksize*i,ciphertext+
+      AESBlocksize*i);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -719,6 +1201,102 @@ static inline unsigned int RotateRight(const unsigned int x)
   return((x >> 8) | ((x & 0xff) << 24));
 }
 
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static inline WizardTarget("aes") __m128i ExpandAESNIKey(__m128i key,
+  const __m128i assist)
+{
+  key=_mm_xor_si128(key,_mm_slli_si128(key,4));
+  key=_mm_xor_si128(key,_mm_slli_si128(key,4));
+  key=_mm_xor_si128(key,_mm_slli_si128(key,4));
+  return(_mm_xor_si128(key,assist));
+}
+
+#define ExpandAESNI128Key(key,i,rcon) \
+  key[i]=ExpandAESNIKey(key[i-1],_mm_shuffle_epi32( \
+    _mm_aeskeygenassist_si128(key[i-1],rcon),0xff))
+#define ExpandAESNI256Key(key,i,rcon) \
+{ \
+  key[i]=ExpandAESNIKey(key[i-2],_mm_shuffle_epi32( \
+    _mm_aeskeygenassist_si128(key[i-1],rcon),0xff)); \
+  if ((i) < 14) \
+    key[i+1]=ExpandAESNIKey(key[i-1],_mm_shuffle_epi32( \
+      _mm_aeskeygenassist_si128(key[i],0x00),0xaa)); \
+}
+
+static WizardTarget("aes") void SetAESNIKey(AESInfo *aes_info,
+  const unsigned char *datum)
+{
+  __m128i
+    *encipher_key,
+    key[15];
+
+  ssize_t
+    i;
+
+  /*
+    Expand the 128 and 256-bit key schedules in hardware; the 192-bit schedule
+    is expanded by the portable code.
+  */
+  encipher_key=(__m128i *) aes_info->encipher_key;
+  if (aes_info->rounds == 10)
+    {
+      key[0]=_mm_loadu_si128((const __m128i *) datum);
+      ExpandAESNI128Key(key,1,0x01);
+      ExpandAESNI128Key(key,2,0x02);
+      ExpandAESNI128Key(key,3,0x04);
+      ExpandAESNI128Key(key,4,0x08);
+      ExpandAESNI128Key(key,5,0x10);
+      ExpandAESNI128Key(key,6,0x20);
+      ExpandAESNI128Key(key,7,0x40);
+      ExpandAESNI128Key(key,8,0x80);
+      ExpandAESNI128Key(key,9,0x1b);
+      ExpandAESNI128Key(key,10,0x36);
+      for (i=0; i <= aes_info->rounds; i++)
+        _mm_storeu_si128(encipher_key+i,key[i]);
+    }
+  if (aes_info->rounds == 14)
+    {
+      key[0]=_mm_loadu_si128((const __m128i *) datum);
+      key[1]=_mm_loadu_si128((const __m128i *) (datum+16));
+      ExpandAESNI256Key(key,2,0x01);
+      ExpandAESNI256Key(key,4,0x02);
+      ExpandAESNI256Key(key,6,0x04);
+      ExpandAESNI256Key(key,8,0x08);
+      ExpandAESNI256Key(key,10,0x10);
+      ExpandAESNI256Key(key,12,0x20);
+      ExpandAESNI256Key(key,14,0x40);
+      for (i=0; i <= aes_info->rounds; i++)
+        _mm_storeu_si128(encipher_key+i,key[i]);
+    }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(key,0,sizeof(key));
+}
+
+static WizardTarget("aes") void InvertAESNIKey(AESInfo *aes_info)
+{
+  __m128i
+    *decipher_key,
+    *encipher_key;
+
+  ssize_t
+    i;
+
+  /*
+    Generate deciphering key with the inverse mix columns instruction.
+  */
+  encipher_key=(__m128i *) aes_info->encipher_key;
+  decipher_key=(__m128i *) aes_info->decipher_key;
+  _mm_storeu_si128(decipher_key,_mm_loadu_si128(encipher_key));
+  for (i=1; i < aes_info->rounds; i++)
+    _mm_storeu_si128(decipher_key+i,_mm_aesimc_si128(_mm_loadu_si128(
+      encipher_key+i)));
+  _mm_storeu_si128(decipher_key+aes_info->rounds,_mm_loadu_si128(
+    encipher_key+aes_info->rounds));
+}
+#endif
+
 WizardExport void SetAESKey(AESInfo *aes_info,const StringInfo *key)
 {
   ssize_t
@@ -762,6 +1340,15 @@ WizardExport void SetAESKey(AESInfo *aes_info,const StringInfo *key)
   (void) memset(datum,0,GetStringInfoLength(aes_info->key));
   (void) CopyWizardMemory(datum,GetStringInfoDatum(key),
     Min(GetStringInfoLength(key),GetStringInfoLength(aes_info->key)));
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if ((aes_info->aesni != WizardFalse) && (aes_info->rounds != 12))
+    {
+      SetAESNIKey(aes_info,datum);
+      InvertAESNIKey(aes_info);
+      (void) ResetWizardMemory(datum,0,GetStringInfoLength(aes_info->key));
+      return;
+    }
+#endif
   for (i=0; i < n; i++)
     aes_info->encipher_key[i]=(unsigned int) datum[4*i] |
       ((unsigned int) datum[4*i+1] << 8) |
@@ -785,13 +1372,20 @@ WizardExport void SetAESKey(AESInfo *aes_info,const StringInfo *key)
   /*
     Generate deciphering key (in reverse order).
   */
-  for (i=0; i < 4; i++)
-  {
-    aes_info->decipher_key[i]=aes_info->encipher_key[i];
-    aes_info->decipher_key[bytes-4+i]=aes_info->encipher_key[bytes-4+i];
-  }
-  for (i=4; i < (bytes-4); i+=4)
-    InverseAddRoundKey(aes_info->encipher_key+i,aes_info->decipher_key+i);
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (aes_info->aesni != WizardFalse)
+    InvertAESNIKey(aes_info);
+  else
+#endif
+    {
+      for (i=0; i < 4; i++)
+      {
+        aes_info->decipher_key[i]=aes_info->encipher_key[i];
+        aes_info->decipher_key[bytes-4+i]=aes_info->encipher_key[bytes-4+i];
+      }
+      for (i=4; i < (bytes-4); i+=4)
+        InverseAddRoundKey(aes_info->encipher_key+i,aes_info->decipher_key+i);
+    }
   /*
     Reset registers.
   */
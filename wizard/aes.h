@@ -34,7 +34,11 @@ extern WizardExport unsigned int
 
 extern WizardExport void
   DecipherAESBlock(AESInfo *,const unsigned char *,unsigned char *),
+  DecipherAESBlocks(AESInfo *,const unsigned char *,unsigned char *,
+    const size_t),
   EncipherAESBlock(AESInfo *,const unsigned char *,unsigned char *),
+  EncipherAESBlocks(AESInfo *,const unsigned char *,unsigned char *,
+    const size_t),
   SetAESKey(AESInfo *,const StringInfo *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
@@ -0,0 +1,1136 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                   BBBB   L        A    K   K  EEEEE  3333                   %
+%                   B   B  L       A A   K  K   E          3                  %
+%                   BBBB   L      AAAAA  KKK    EEE     333                   %
+%                   B   B  L      A   A  K  K   E          3                  %
+%                   BBBB   LLLLL  A   A  K   K  EEEEE  3333                   %
+%                                                                             %
+%                                                                             %
+%                     Wizard's Toolkit BLAKE3 Hash Methods                    %
+%                                                                             %
+%                             Software Design                                 %
+%                                 Cristy                                      %
+%                               March  2003                                   %
+%                                                                             %
+%                                                                             %
+%  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization         %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+% BLAKE3 splits the message into 1024-byte chunks that are hashed
+% independently and combined in a binary tree, so many chunks can be
+% compressed at once in SIMD lanes or across threads.  See
+% https://github.com/BLAKE3-team/BLAKE3-specs.
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "wizard/studio.h"
+#include "wizard/blake3.h"
+#include "wizard/exception.h"
+#include "wizard/exception-private.h"
+#include "wizard/hash-private.h"
+#include "wizard/memory_.h"
+
+/*
+  Define declarations.
+*/
+#define BLAKE3Batchsize  1024
+#define BLAKE3Blocksize  64
+#define BLAKE3ChunkEnd  0x02
+#define BLAKE3Chunksize  1024
+#define BLAKE3ChunkStart  0x01
+#define BLAKE3Digestsize  32
+#define BLAKE3G(a,b,c,d,x,y) \
+{ \
+  a+=b+(x); \
+  d=BLAKE3RotateRight(d ^ a,16); \
+  c+=d; \
+  b=BLAKE3RotateRight(b ^ c,12); \
+  a+=b+(y); \
+  d=BLAKE3RotateRight(d ^ a,8); \
+  c+=d; \
+  b=BLAKE3RotateRight(b ^ c,7); \
+}
+#define BLAKE3MaxDepth  54
+#define BLAKE3Parent  0x04
+#define BLAKE3Root  0x08
+#define BLAKE3RotateRight(x,n)  (((x) >> (n)) | ((x) << (32-(n))))
+#define BLAKE3Round(G,v,m,s) \
+{ \
+  G(v[0],v[4],v[8],v[12],m[s[0]],m[s[1]]); \
+  G(v[1],v[5],v[9],v[13],m[s[2]],m[s[3]]); \
+  G(v[2],v[6],v[10],v[14],m[s[4]],m[s[5]]); \
+  G(v[3],v[7],v[11],v[15],m[s[6]],m[s[7]]); \
+  G(v[0],v[5],v[10],v[15],m[s[8]],m[s[9]]); \
+  G(v[1],v[6],v[11],v[12],m[s[10]],m[s[11]]); \
+  G(v[2],v[7],v[8],v[13],m[s[12]],m[s[13]]); \
+  G(v[3],v[4],v[9],v[14],m[s[14]],m[s[15]]); \
+}
+#define BLAKE3Rounds  7
+#define BLAKE3Threshold  262144
+
+/*
+  Typedef declarations.
+*/
+struct _BLAKE3Info
+{
+  unsigned int
+    digestsize,
+    blocksize;
+
+  StringInfo
+    *digest;
+
+  unsigned int
+    key[8],
+    chaining[8],
+    stack[8*BLAKE3MaxDepth],
+    *chaining_values;
+
+  unsigned char
+    block[BLAKE3Blocksize];
+
+  size_t
+    block_length,
+    blocks,
+    depth;
+
+  WizardSizeType
+    chunks;
+
+  size_t
+    threads,
+    threshold;
+
+  time_t
+    timestamp;
+
+  size_t
+    signature;
+};
+
+/*
+  Static declarations.
+*/
+static const unsigned int
+  BLAKE3IV[8] =
+  {
+    0x6a09e667U, 0xbb67ae85U, 0x3c6ef372U, 0xa54ff53aU, 0x510e527fU,
+    0x9b05688cU, 0x1f83d9abU, 0x5be0cd19U
+  };
+
+static const unsigned char
+  BLAKE3Schedule[BLAKE3Rounds][16] =
+  {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    {  2,  6,  3, 10,  7,  0,  4, 13,  1, 11, 12,  5,  9, 14, 15,  8 },
+    {  3,  4, 10, 12, 13,  2,  7, 14,  6,  5,  9,  0, 11, 15,  8,  1 },
+    { 10,  7, 12,  9, 14,  3, 13, 15,  4,  0, 11,  2,  5,  8,  1,  6 },
+    { 12, 13,  9, 11, 15, 10, 14,  8,  7,  2,  5,  3,  0,  1,  6,  4 },
+    {  9, 14, 11,  5,  8, 12, 15,  1, 13,  3,  0, 10,  2,  6,  4,  7 },
+    { 11, 15,  5,  0,  1,  9,  8,  6, 14, 10,  2, 12,  3,  4,  7, 13 }
+  };
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   A c q u i r e B L A K E 3 I n f o                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireBLAKE3Info() allocate the BLAKE3Info structure.
+%
+%  The format of the AcquireBLAKE3Info method is:
+%
+%      BLAKE3Info *AcquireBLAKE3Info(void)
+%
+*/
+WizardExport BLAKE3Info *AcquireBLAKE3Info(void)
+{
+  BLAKE3Info
+    *blake_info;
+
+  blake_info=(BLAKE3Info *) AcquireWizardMemory(sizeof(*blake_info));
+  if (blake_info == (BLAKE3Info *) NULL)
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  (void) memset(blake_info,0,sizeof(*blake_info));
+  blake_info->digestsize=BLAKE3Digestsize;
+  blake_info->blocksize=BLAKE3Blocksize;
+  blake_info->digest=AcquireStringInfo(BLAKE3Digestsize);
+  (void) memcpy(blake_info->key,BLAKE3IV,sizeof(blake_info->key));
+  (void) memcpy(blake_info->chaining,BLAKE3IV,sizeof(blake_info->chaining));
+  blake_info->threads=1;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  blake_info->threads=(size_t) omp_get_max_threads();
+#endif
+  blake_info->threshold=BLAKE3Threshold;
+  blake_info->timestamp=time((time_t *) NULL);
+  blake_info->signature=WizardSignature;
+  return(blake_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y B L A K E 3 I n f o                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyBLAKE3Info() zeros memory associated with the BLAKE3Info structure.
+%
+%  The format of the DestroyBLAKE3Info method is:
+%
+%      BLAKE3Info *DestroyBLAKE3Info(BLAKE3Info *blake_info)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The blake info.
+%
+*/
+WizardExport BLAKE3Info *DestroyBLAKE3Info(BLAKE3Info *blake_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(blake_info != (BLAKE3Info *) NULL);
+  assert(blake_info->signature == WizardSignature);
+  if (blake_info->digest != (StringInfo *) NULL)
+    blake_info->digest=DestroyStringInfo(blake_info->digest);
+  if (blake_info->chaining_values != (unsigned int *) NULL)
+    {
+      (void) ResetWizardMemory(blake_info->chaining_values,0,8*
+        BLAKE3Batchsize*sizeof(*blake_info->chaining_values));
+      blake_info->chaining_values=(unsigned int *)
+        RelinquishWizardMemory(blake_info->chaining_values);
+    }
+  (void) ResetWizardMemory(blake_info->chaining,0,
+    sizeof(blake_info->chaining));
+  (void) ResetWizardMemory(blake_info->stack,0,sizeof(blake_info->stack));
+  (void) ResetWizardMemory(blake_info->block,0,sizeof(blake_info->block));
+  blake_info->signature=(~WizardSignature);
+  blake_info=(BLAKE3Info *) RelinquishWizardMemory(blake_info);
+  return(blake_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E x p o r t B L A K E 3 S t a t e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportBLAKE3State() returns the in-progress BLAKE3 state as a byte string:
+%  the key, the chaining value and block of the current chunk, the chunk
+%  count, and the stack of subtree chaining values.  Resume it with
+%  ImportBLAKE3State().
+%
+%  The format of the ExportBLAKE3State method is:
+%
+%      StringInfo *ExportBLAKE3State(const BLAKE3Info *blake_info)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The address of a structure of type BLAKE3Info.
+%
+*/
+WizardExport StringInfo *ExportBLAKE3State(const BLAKE3Info *blake_info)
+{
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(blake_info != (BLAKE3Info *) NULL);
+  assert(blake_info->signature == WizardSignature);
+  state=AcquireStringInfo(16*4+BLAKE3Blocksize+20+32*blake_info->depth);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    ExportHashWord(&q,blake_info->key[i],4);
+  for (i=0; i < 8; i++)
+    ExportHashWord(&q,blake_info->chaining[i],4);
+  (void) memcpy(q,blake_info->block,BLAKE3Blocksize);
+  q+=BLAKE3Blocksize;
+  ExportHashWord(&q,blake_info->block_length,4);
+  ExportHashWord(&q,blake_info->blocks,4);
+  ExportHashWord(&q,blake_info->chunks,8);
+  ExportHashWord(&q,blake_info->depth,4);
+  for (i=0; i < (ssize_t) (8*blake_info->depth); i++)
+    ExportHashWord(&q,blake_info->stack[i],4);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   F i n a l i z e B L A K E 3                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FinalizeBLAKE3() finalizes the BLAKE3 message digest computation.
+%
+%  The format of the FinalizeBLAKE3 method is:
+%
+%      WizardBooleanType FinalizeBLAKE3(BLAKE3Info *blake_info)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The address of a structure of type BLAKE3Info.
+%
+*/
+
+static inline unsigned int LoadBLAKE3Word(const unsigned char *p)
+{
+  return((unsigned int) p[0] | ((unsigned int) p[1] << 8) |
+    ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24));
+}
+
+static void CompressBLAKE3(const unsigned int *chaining,const unsigned int *m,
+  const WizardSizeType counter,const unsigned int length,
+  const unsigned int flags,unsigned int *v)
+{
+  ssize_t
+    i;
+
+  v[0]=chaining[0];
+  v[1]=chaining[1];
+  v[2]=chaining[2];
+  v[3]=chaining[3];
+  v[4]=chaining[4];
+  v[5]=chaining[5];
+  v[6]=chaining[6];
+  v[7]=chaining[7];
+  v[8]=BLAKE3IV[0];
+  v[9]=BLAKE3IV[1];
+  v[10]=BLAKE3IV[2];
+  v[11]=BLAKE3IV[3];
+  v[12]=(unsigned int) counter;
+  v[13]=(unsigned int) (counter >> 32);
+  v[14]=length;
+  v[15]=flags;
+  for (i=0; i < BLAKE3Rounds; i++)
+    BLAKE3Round(BLAKE3G,v,m,BLAKE3Schedule[i]);
+  for (i=0; i < 8; i++)
+  {
+    v[i]^=v[i+8];
+    v[i+8]^=chaining[i];
+  }
+}
+
+static void CompressBLAKE3Block(const unsigned int *chaining,
+  const unsigned char *block,const WizardSizeType counter,
+  const unsigned int length,const unsigned int flags,unsigned int *v)
+{
+  ssize_t
+    i;
+
+  unsigned int
+    m[16];
+
+  for (i=0; i < 16; i++)
+    m[i]=LoadBLAKE3Word(block+4*i);
+  CompressBLAKE3(chaining,m,counter,length,flags,v);
+  /*
+    Reset working registers.
+  */
+  (void) ResetWizardMemory(m,0,sizeof(m));
+}
+
+WizardExport WizardBooleanType FinalizeBLAKE3(BLAKE3Info *blake_info)
+{
+  ssize_t
+    i;
+
+  unsigned char
+    *datum;
+
+  unsigned int
+    chaining[8],
+    flags,
+    m[16],
+    v[16];
+
+  /*
+    The last chunk is compressed without the root flag only if parents sit
+    above it; each stacked subtree is then merged from the right.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(blake_info != (BLAKE3Info *) NULL);
+  assert(blake_info->signature == WizardSignature);
+  (void) memset(blake_info->block+blake_info->block_length,0,BLAKE3Blocksize-
+    blake_info->block_length);
+  flags=BLAKE3ChunkEnd | (blake_info->blocks == 0 ? BLAKE3ChunkStart : 0);
+  if (blake_info->depth == 0)
+    CompressBLAKE3Block(blake_info->chaining,blake_info->block,
+      blake_info->chunks,(unsigned int) blake_info->block_length,flags |
+      BLAKE3Root,v);
+  else
+    {
+      CompressBLAKE3Block(blake_info->chaining,blake_info->block,
+        blake_info->chunks,(unsigned int) blake_info->block_length,flags,v);
+      for (i=(ssize_t) blake_info->depth-1; i >= 0; i--)
+      {
+        (void) memcpy(chaining,v,sizeof(chaining));
+        (void) memcpy(m,blake_info->stack+8*i,8*sizeof(*m));
+        (void) memcpy(m+8,chaining,sizeof(chaining));
+        CompressBLAKE3(blake_info->key,m,0,BLAKE3Blocksize,BLAKE3Parent |
+          (i == 0 ? BLAKE3Root : 0),v);
+      }
+    }
+  datum=GetStringInfoDatum(blake_info->digest);
+  for (i=0; i < 8; i++)
+  {
+    datum[4*i]=(unsigned char) v[i];
+    datum[4*i+1]=(unsigned char) (v[i] >> 8);
+    datum[4*i+2]=(unsigned char) (v[i] >> 16);
+    datum[4*i+3]=(unsigned char) (v[i] >> 24);
+  }
+  /*
+    Reset working registers.
+  */
+  (void) ResetWizardMemory(chaining,0,sizeof(chaining));
+  (void) ResetWizardMemory(m,0,sizeof(m));
+  (void) ResetWizardMemory(v,0,sizeof(v));
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t B L A K E 3 B l o c k s i z e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetBLAKE3Blocksize() returns the BLAKE3 blocksize.
+%
+%  The format of the GetBLAKE3Blocksize method is:
+%
+%      unsigned int *GetBLAKE3Blocksize(const BLAKE3Info *blake_info)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The blake info.
+%
+*/
+WizardExport unsigned int GetBLAKE3Blocksize(const BLAKE3Info *blake_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,blake_info != (BLAKE3Info *) NULL);
+  WizardAssert(HashDomain,blake_info->signature == WizardSignature);
+  return(blake_info->blocksize);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t B L A K E 3 D i g e s t                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetBLAKE3Digest() returns the BLAKE3 digest.
+%
+%  The format of the GetBLAKE3Digest method is:
+%
+%      const StringInfo *GetBLAKE3Digest(const BLAKE3Info *blake_info)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The blake info.
+%
+*/
+WizardExport const StringInfo *GetBLAKE3Digest(const BLAKE3Info *blake_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,blake_info != (BLAKE3Info *) NULL);
+  WizardAssert(HashDomain,blake_info->signature == WizardSignature);
+  return(blake_info->digest);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t B L A K E 3 D i g e s t s i z e                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetBLAKE3Digestsize() returns the BLAKE3 digest size.
+%
+%  The format of the GetBLAKE3Digestsize method is:
+%
+%      unsigned int *GetBLAKE3Digestsize(const BLAKE3Info *blake_info)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The blake info.
+%
+*/
+WizardExport unsigned int GetBLAKE3Digestsize(const BLAKE3Info *blake_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,blake_info != (BLAKE3Info *) NULL);
+  WizardAssert(HashDomain,blake_info->signature == WizardSignature);
+  return(blake_info->digestsize);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t B L A K E 3 S t a t e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportBLAKE3State() restores a state returned by ExportBLAKE3State().  An
+%  inconsistent state is rejected with WizardFalse.
+%
+%  The format of the ImportBLAKE3State method is:
+%
+%      WizardBooleanType ImportBLAKE3State(BLAKE3Info *blake_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The address of a structure of type BLAKE3Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportBLAKE3State(BLAKE3Info *blake_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    block_length,
+    blocks,
+    depth;
+
+  ssize_t
+    i;
+
+  assert(blake_info != (BLAKE3Info *) NULL);
+  assert(blake_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < (16*4+BLAKE3Blocksize+20))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+16*4+BLAKE3Blocksize;
+  block_length=(size_t) ImportHashWord(&p,4);
+  blocks=(size_t) ImportHashWord(&p,4);
+  p+=8;
+  depth=(size_t) ImportHashWord(&p,4);
+  if ((block_length > BLAKE3Blocksize) || (depth > BLAKE3MaxDepth) ||
+      ((blocks*BLAKE3Blocksize+block_length) > BLAKE3Chunksize) ||
+      (GetStringInfoLength(state) != (16*4+BLAKE3Blocksize+20+32*depth)))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    blake_info->key[i]=(unsigned int) ImportHashWord(&p,4);
+  for (i=0; i < 8; i++)
+    blake_info->chaining[i]=(unsigned int) ImportHashWord(&p,4);
+  (void) memcpy(blake_info->block,p,BLAKE3Blocksize);
+  p+=BLAKE3Blocksize+8;
+  blake_info->block_length=block_length;
+  blake_info->blocks=blocks;
+  blake_info->chunks=ImportHashWord(&p,8);
+  blake_info->depth=depth;
+  p+=4;
+  for (i=0; i < (ssize_t) (8*depth); i++)
+    blake_info->stack[i]=(unsigned int) ImportHashWord(&p,4);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n i t i a l i z e B L A K E 3                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  InitializeBLAKE3() initializes the BLAKE3 digest.
+%
+%  The format of the InitializeBLAKE3 method is:
+%
+%      WizardBooleanType InitializeBLAKE3(BLAKE3Info *blake_info)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The address of a structure of type BLAKE3Info.
+%
+*/
+WizardExport WizardBooleanType InitializeBLAKE3(BLAKE3Info *blake_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(blake_info != (BLAKE3Info *) NULL);
+  assert(blake_info->signature == WizardSignature);
+  (void) memcpy(blake_info->chaining,blake_info->key,
+    sizeof(blake_info->chaining));
+  blake_info->block_length=0;
+  blake_info->blocks=0;
+  blake_info->chunks=0;
+  blake_info->depth=0;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t B L A K E 3 T h r e a d s                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetBLAKE3Threads() sets the maximum number of threads used to hash the
+%  chunks of a large update.  The default is the OpenMP maximum; 1 hashes on
+%  the calling thread only.  The digest does not depend on the thread count.
+%
+%  The format of the SetBLAKE3Threads method is:
+%
+%      size_t SetBLAKE3Threads(BLAKE3Info *blake_info,const size_t threads)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The blake info.
+%
+%    o threads: The maximum number of threads.
+%
+*/
+WizardExport size_t SetBLAKE3Threads(BLAKE3Info *blake_info,
+  const size_t threads)
+{
+  size_t
+    previous_threads;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,blake_info != (BLAKE3Info *) NULL);
+  WizardAssert(HashDomain,blake_info->signature == WizardSignature);
+  previous_threads=blake_info->threads;
+  blake_info->threads=threads == 0 ? 1 : threads;
+  return(previous_threads);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e B L A K E 3                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateBLAKE3() updates the BLAKE3 message digest.
+%
+%  The format of the UpdateBLAKE3 method is:
+%
+%      WizardBooleanType UpdateBLAKE3(BLAKE3Info *blake_info,
+%        const StringInfo *message)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The address of a structure of type BLAKE3Info.
+%
+%    o message: The message.
+%
+*/
+WizardExport WizardBooleanType UpdateBLAKE3(BLAKE3Info *blake_info,
+  const StringInfo *message)
+{
+  return(UpdateBLAKE3Bytes(blake_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e B L A K E 3 B y t e s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateBLAKE3Bytes() updates the BLAKE3 message digest from the caller's
+%  memory without copying it into a StringInfo.
+%
+%  The format of the UpdateBLAKE3Bytes method is:
+%
+%      WizardBooleanType UpdateBLAKE3Bytes(BLAKE3Info *blake_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o blake_info: The address of a structure of type BLAKE3Info.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+#define BLAKE3GAVX2(a,b,c,d,x,y) \
+{ \
+  a=_mm256_add_epi32(_mm256_add_epi32(a,b),x); \
+  d=_mm256_shuffle_epi8(_mm256_xor_si256(d,a),rotate16); \
+  c=_mm256_add_epi32(c,d); \
+  b=RotateLeftAVX2(_mm256_xor_si256(b,c),20); \
+  a=_mm256_add_epi32(_mm256_add_epi32(a,b),y); \
+  d=_mm256_shuffle_epi8(_mm256_xor_si256(d,a),rotate8); \
+  c=_mm256_add_epi32(c,d); \
+  b=RotateLeftAVX2(_mm256_xor_si256(b,c),25); \
+}
+#define BLAKE3GSSE41(a,b,c,d,x,y) \
+{ \
+  a=_mm_add_epi32(_mm_add_epi32(a,b),x); \
+  d=_mm_shuffle_epi8(_mm_xor_si128(d,a),rotate16); \
+  c=_mm_add_epi32(c,d); \
+  b=RotateLeftSSE41(_mm_xor_si128(b,c),20); \
+  a=_mm_add_epi32(_mm_add_epi32(a,b),y); \
+  d=_mm_shuffle_epi8(_mm_xor_si128(d,a),rotate8); \
+  c=_mm_add_epi32(c,d); \
+  b=RotateLeftSSE41(_mm_xor_si128(b,c),25); \
+}
+#define RotateLeftSSE41(x,n)  _mm_or_si128(_mm_slli_epi32(x,n), \
+  _mm_srli_epi32(x,32-(n)))
+
+static WizardTarget("avx2") void HashBLAKE3ChunksAVX2(
+  const unsigned int *key,const unsigned char *chunks,
+  const WizardSizeType counter,unsigned int *chaining_values)
+{
+  __m256i
+    counter_high,
+    counter_low,
+    h[8],
+    m[16],
+    rotate16,
+    rotate8,
+    v[16];
+
+  const unsigned char
+    *message[HashLanes];
+
+  ssize_t
+    i,
+    j;
+
+  unsigned int
+    words[8*HashLanes];
+
+  /*
+    Hash eight adjacent chunks, one per 32-bit lane.
+  */
+  rotate16=_mm256_setr_epi8(2,3,0,1,6,7,4,5,10,11,8,9,14,15,12,13,2,3,0,1,6,
+    7,4,5,10,11,8,9,14,15,12,13);
+  rotate8=_mm256_setr_epi8(1,2,3,0,5,6,7,4,9,10,11,8,13,14,15,12,1,2,3,0,5,6,
+    7,4,9,10,11,8,13,14,15,12);
+  for (i=0; i < HashLanes; i++)
+    message[i]=chunks+i*BLAKE3Chunksize;
+  counter_low=_mm256_setr_epi32((int) counter,(int) (counter+1),
+    (int) (counter+2),(int) (counter+3),(int) (counter+4),(int) (counter+5),
+    (int) (counter+6),(int) (counter+7));
+  counter_high=_mm256_setr_epi32((int) (counter >> 32),
+    (int) ((counter+1) >> 32),(int) ((counter+2) >> 32),
+    (int) ((counter+3) >> 32),(int) ((counter+4) >> 32),
+    (int) ((counter+5) >> 32),(int) ((counter+6) >> 32),
+    (int) ((counter+7) >> 32));
+  for (i=0; i < 8; i++)
+    h[i]=_mm256_set1_epi32((int) key[i]);
+  for (i=0; i < (BLAKE3Chunksize/BLAKE3Blocksize); i++)
+  {
+    LoadHashLanesAVX2(message,(size_t) i*BLAKE3Blocksize,m);
+    for (j=0; j < 8; j++)
+      v[j]=h[j];
+    v[8]=_mm256_set1_epi32((int) BLAKE3IV[0]);
+    v[9]=_mm256_set1_epi32((int) BLAKE3IV[1]);
+    v[10]=_mm256_set1_epi32((int) BLAKE3IV[2]);
+    v[11]=_mm256_set1_epi32((int) BLAKE3IV[3]);
+    v[12]=counter_low;
+    v[13]=counter_high;
+    v[14]=_mm256_set1_epi32(BLAKE3Blocksize);
+    v[15]=_mm256_set1_epi32((i == 0 ? BLAKE3ChunkStart : 0) |
+      (i == (BLAKE3Chunksize/BLAKE3Blocksize-1) ? BLAKE3ChunkEnd : 0));
+    for (j=0; j < BLAKE3Rounds; j++)
+      BLAKE3Round(BLAKE3GAVX2,v,m,BLAKE3Schedule[j]);
+    for (j=0; j < 8; j++)
+      h[j]=_mm256_xor_si256(v[j],v[j+8]);
+  }
+  for (i=0; i < 8; i++)
+    _mm256_storeu_si256((__m256i *) (words+HashLanes*i),h[i]);
+  for (i=0; i < HashLanes; i++)
+    for (j=0; j < 8; j++)
+      chaining_values[8*i+j]=words[HashLanes*j+i];
+  /*
+    Reset working registers.
+  */
+  for (i=0; i < 16; i++)
+  {
+    m[i]=_mm256_setzero_si256();
+    v[i]=_mm256_setzero_si256();
+  }
+  (void) ResetWizardMemory(words,0,sizeof(words));
+}
+
+static WizardTarget("sse4.1") void HashBLAKE3ChunksSSE41(
+  const unsigned int *key,const unsigned char *chunks,
+  const WizardSizeType counter,unsigned int *chaining_values)
+{
+  __m128i
+    counter_high,
+    counter_low,
+    h[8],
+    m[16],
+    rotate16,
+    rotate8,
+    t[4],
+    v[16];
+
+  ssize_t
+    i,
+    j;
+
+  unsigned int
+    words[8*4];
+
+  /*
+    Hash four adjacent chunks, one per 32-bit lane.
+  */
+  rotate16=_mm_setr_epi8(2,3,0,1,6,7,4,5,10,11,8,9,14,15,12,13);
+  rotate8=_mm_setr_epi8(1,2,3,0,5,6,7,4,9,10,11,8,13,14,15,12);
+  counter_low=_mm_setr_epi32((int) counter,(int) (counter+1),
+    (int) (counter+2),(int) (counter+3));
+  counter_high=_mm_setr_epi32((int) (counter >> 32),(int) ((counter+1) >> 32),
+    (int) ((counter+2) >> 32),(int) ((counter+3) >> 32));
+  for (i=0; i < 8; i++)
+    h[i]=_mm_set1_epi32((int) key[i]);
+  for (i=0; i < (BLAKE3Chunksize/BLAKE3Blocksize); i++)
+  {
+    for (j=0; j < 4; j++)
+    {
+      const unsigned char
+        *p;
+
+      /*
+        Transpose 16 bytes of each lane so m[k] holds word k of all lanes.
+      */
+      p=chunks+i*BLAKE3Blocksize+16*j;
+      v[0]=_mm_loadu_si128((const __m128i *) p);
+      v[1]=_mm_loadu_si128((const __m128i *) (p+BLAKE3Chunksize));
+      v[2]=_mm_loadu_si128((const __m128i *) (p+2*BLAKE3Chunksize));
+      v[3]=_mm_loadu_si128((const __m128i *) (p+3*BLAKE3Chunksize));
+      t[0]=_mm_unpacklo_epi32(v[0],v[1]);
+      t[1]=_mm_unpackhi_epi32(v[0],v[1]);
+      t[2]=_mm_unpacklo_epi32(v[2],v[3]);
+      t[3]=_mm_unpackhi_epi32(v[2],v[3]);
+      m[4*j]=_mm_unpacklo_epi64(t[0],t[2]);
+      m[4*j+1]=_mm_unpackhi_epi64(t[0],t[2]);
+      m[4*j+2]=_mm_unpacklo_epi64(t[1],t[3]);
+      m[4*j+3]=_mm_unpackhi_epi64(t[1],t[3]);
+    }
+    for (j=0; j < 8; j++)
+      v[j]=h[j];
+    v[8]=_mm_set1_epi32((int) BLAKE3IV[0]);
+    v[9]=_mm_set1_epi32((int) BLAKE3IV[1]);
+    v[10]=_mm_set1_epi32((int) BLAKE3IV[2]);
+    v[11]=_mm_set1_epi32((int) BLAKE3IV[3]);
+    v[12]=counter_low;
+    v[13]=counter_high;
+    v[14]=_mm_set1_epi32(BLAKE3Blocksize);
+    v[15]=_mm_set1_epi32((i == 0 ? BLAKE3ChunkStart : 0) |
+      (i == (BLAKE3Chunksize/BLAKE3Blocksize-1) ? BLAKE3ChunkEnd : 0));
+    for (j=0; j < BLAKE3Rounds; j++)
+      BLAKE3Round(BLAKE3GSSE41,v,m,BLAKE3Schedule[j]);
+    for (j=0; j < 8; j++)
+      h[j]=_mm_xor_si128(v[j],v[j+8]);
+  }
+  for (i=0; i < 8; i++)
+    _mm_storeu_si128((__m128i *) (words+4*i),h[i]);
+  for (i=0; i < 4; i++)
+    for (j=0; j < 8; j++)
+      chaining_values[8*i+j]=words[4*j+i];
+  /*
+    Reset working registers.
+  */
+  for (i=0; i < 16; i++)
+  {
+    m[i]=_mm_setzero_si128();
+    v[i]=_mm_setzero_si128();
+  }
+  (void) ResetWizardMemory(words,0,sizeof(words));
+}
+#endif
+
+static void HashBLAKE3Chunk(const unsigned int *key,
+  const unsigned char *chunk,const WizardSizeType counter,
+  unsigned int *chaining_value)
+{
+  ssize_t
+    i;
+
+  unsigned int
+    chaining[8],
+    v[16];
+
+  (void) memcpy(chaining,key,sizeof(chaining));
+  for (i=0; i < (BLAKE3Chunksize/BLAKE3Blocksize); i++)
+  {
+    CompressBLAKE3Block(chaining,chunk+i*BLAKE3Blocksize,counter,
+      BLAKE3Blocksize,(i == 0 ? BLAKE3ChunkStart : 0) |
+      (i == (BLAKE3Chunksize/BLAKE3Blocksize-1) ? BLAKE3ChunkEnd : 0),v);
+    (void) memcpy(chaining,v,sizeof(chaining));
+  }
+  (void) memcpy(chaining_value,chaining,sizeof(chaining));
+  /*
+    Reset working registers.
+  */
+  (void) ResetWizardMemory(chaining,0,sizeof(chaining));
+  (void) ResetWizardMemory(v,0,sizeof(v));
+}
+
+static void HashBLAKE3ChunkRange(const unsigned int *key,
+  const unsigned char *chunks,WizardSizeType counter,size_t number_chunks,
+  unsigned int *chaining_values)
+{
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    while (number_chunks >= HashLanes)
+    {
+      HashBLAKE3ChunksAVX2(key,chunks,counter,chaining_values);
+      chunks+=HashLanes*BLAKE3Chunksize;
+      counter+=HashLanes;
+      chaining_values+=8*HashLanes;
+      number_chunks-=HashLanes;
+    }
+  if (HasCPUFeature(SSE41CPUFeature) != WizardFalse)
+    while (number_chunks >= 4)
+    {
+      HashBLAKE3ChunksSSE41(key,chunks,counter,chaining_values);
+      chunks+=4*BLAKE3Chunksize;
+      counter+=4;
+      chaining_values+=8*4;
+      number_chunks-=4;
+    }
+#endif
+  while (number_chunks != 0)
+  {
+    HashBLAKE3Chunk(key,chunks,counter,chaining_values);
+    chunks+=BLAKE3Chunksize;
+    counter++;
+    chaining_values+=8;
+    number_chunks--;
+  }
+}
+
+static void PushBLAKE3ChainingValue(BLAKE3Info *blake_info,
+  const unsigned int *chaining_value)
+{
+  unsigned int
+    m[16],
+    v[16];
+
+  WizardSizeType
+    chunks;
+
+  /*
+    Each completed chunk merges with the subtrees it now balances: one per
+    trailing zero bit of the chunk count.
+  */
+  (void) memcpy(v,chaining_value,8*sizeof(*v));
+  blake_info->chunks++;
+  for (chunks=blake_info->chunks; (chunks & 0x01) == 0; chunks>>=1)
+  {
+    blake_info->depth--;
+    (void) memcpy(m,blake_info->stack+8*blake_info->depth,8*sizeof(*m));
+    (void) memcpy(m+8,v,8*sizeof(*m));
+    CompressBLAKE3(blake_info->key,m,0,BLAKE3Blocksize,BLAKE3Parent,v);
+  }
+  (void) memcpy(blake_info->stack+8*blake_info->depth,v,8*sizeof(*v));
+  blake_info->depth++;
+  /*
+    Reset working registers.
+  */
+  (void) ResetWizardMemory(m,0,sizeof(m));
+  (void) ResetWizardMemory(v,0,sizeof(v));
+}
+
+static void HashBLAKE3Chunks(BLAKE3Info *blake_info,const unsigned char *p,
+  size_t number_chunks)
+{
+  if (blake_info->chaining_values == (unsigned int *) NULL)
+    {
+      blake_info->chaining_values=(unsigned int *) AcquireQuantumMemory(8*
+        BLAKE3Batchsize,sizeof(*blake_info->chaining_values));
+      if (blake_info->chaining_values == (unsigned int *) NULL)
+        ThrowWizardFatalError(HashDomain,MemoryError);
+    }
+  while (number_chunks != 0)
+  {
+    ssize_t
+      i;
+
+    size_t
+      count,
+      threads;
+
+    /*
+      The chunks of a batch are hashed independently, split across threads
+      if the batch is large enough, then folded into the tree in order.
+    */
+    count=Min(number_chunks,BLAKE3Batchsize);
+    threads=1;
+    if ((blake_info->threads > 1) &&
+        ((count*BLAKE3Chunksize) >= blake_info->threshold))
+      threads=Min(blake_info->threads,count/HashLanes);
+    if (threads == 0)
+      threads=1;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+    #pragma omp parallel for schedule(static) num_threads(threads) \
+      if (threads > 1)
+#endif
+    for (i=0; i < (ssize_t) threads; i++)
+    {
+      size_t
+        first,
+        last;
+
+      first=i*count/threads;
+      last=(i+1)*count/threads;
+      HashBLAKE3ChunkRange(blake_info->key,p+first*BLAKE3Chunksize,
+        blake_info->chunks+first,last-first,blake_info->chaining_values+8*
+        first);
+    }
+    for (i=0; i < (ssize_t) count; i++)
+      PushBLAKE3ChainingValue(blake_info,blake_info->chaining_values+8*i);
+    p+=count*BLAKE3Chunksize;
+    number_chunks-=count;
+  }
+}
+
+WizardExport WizardBooleanType UpdateBLAKE3Bytes(BLAKE3Info *blake_info,
+  const void *message,const size_t extent)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    length,
+    n;
+
+  unsigned int
+    v[16];
+
+  /*
+    Update the BLAKE3 chunk state.
+  */
+  assert(blake_info != (BLAKE3Info *) NULL);
+  assert(blake_info->signature == WizardSignature);
+  p=(const unsigned char *) message;
+  length=extent;
+  while (length != 0)
+  {
+    if ((blake_info->blocks*BLAKE3Blocksize+blake_info->block_length) ==
+        BLAKE3Chunksize)
+      {
+        /*
+          More input follows, so the full chunk is not the root.
+        */
+        CompressBLAKE3Block(blake_info->chaining,blake_info->block,
+          blake_info->chunks,BLAKE3Blocksize,BLAKE3ChunkEnd,v);
+        PushBLAKE3ChainingValue(blake_info,v);
+        (void) memcpy(blake_info->chaining,blake_info->key,
+          sizeof(blake_info->chaining));
+        blake_info->blocks=0;
+        blake_info->block_length=0;
+      }
+    if ((blake_info->blocks == 0) && (blake_info->block_length == 0) &&
+        (length > BLAKE3Chunksize))
+      {
+        /*
+          Whole chunks are hashed straight from the message; the last one
+          is held back in case it is the root.
+        */
+        n=(length-1)/BLAKE3Chunksize;
+        HashBLAKE3Chunks(blake_info,p,n);
+        p+=n*BLAKE3Chunksize;
+        length-=n*BLAKE3Chunksize;
+        continue;
+      }
+    if (blake_info->block_length == BLAKE3Blocksize)
+      {
+        CompressBLAKE3Block(blake_info->chaining,blake_info->block,
+          blake_info->chunks,BLAKE3Blocksize,blake_info->blocks == 0 ?
+          BLAKE3ChunkStart : 0,v);
+        (void) memcpy(blake_info->chaining,v,sizeof(blake_info->chaining));
+        blake_info->blocks++;
+        blake_info->block_length=0;
+      }
+    n=Min(BLAKE3Blocksize-blake_info->block_length,length);
+    (void) memcpy(blake_info->block+blake_info->block_length,p,n);
+    blake_info->block_length+=n;
+    p+=n;
+    length-=n;
+  }
+  /*
+    Reset working registers.
+  */
+  (void) ResetWizardMemory(v,0,sizeof(v));
+  return(WizardTrue);
+}
@@ -0,0 +1,56 @@
+/*
+  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard's Toolkit BLAKE3 hash methods.
+*/
+#ifndef _WIZARDSTOOLKIT_BLAKE3_H
+#define _WIZARDSTOOLKIT_BLAKE3_H
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+typedef struct _BLAKE3Info
+  BLAKE3Info;
+
+extern WizardExport BLAKE3Info
+  *AcquireBLAKE3Info(void),
+  *DestroyBLAKE3Info(BLAKE3Info *);
+
+extern WizardExport StringInfo
+  *ExportBLAKE3State(const BLAKE3Info *);
+
+extern WizardExport const StringInfo
+  *GetBLAKE3Digest(const BLAKE3Info *);
+
+extern WizardExport size_t
+  SetBLAKE3Threads(BLAKE3Info *,const size_t);
+
+extern WizardExport unsigned int
+  GetBLAKE3Blocksize(const BLAKE3Info *),
+  GetBLAKE3Digestsize(const BLAKE3Info *);
+
+extern WizardExport WizardBooleanType
+  ImportBLAKE3State(BLAKE3Info *,const StringInfo *),
+  InitializeBLAKE3(BLAKE3Info *),
+  FinalizeBLAKE3(BLAKE3Info *),
+  UpdateBLAKE3(BLAKE3Info *,const StringInfo *),
+  UpdateBLAKE3Bytes(BLAKE3Info *,const void *,const size_t);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
@@ -67,6 +67,7 @@ extern WizardExport WizardBooleanType
   SetBlobExtent(BlobInfo *,const WizardSizeType);
 
 extern WizardExport WizardOffsetType
+  SeekBlob(BlobInfo *,const WizardOffsetType,const int),
   TellBlob(const BlobInfo *);
 
 extern WizardExport WizardSizeType
@@ -1560,6 +1560,108 @@ WizardExport ssize_t ReadBlobChunk(BlobInfo *blob_info,const size_t length,
   return(i);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++  S e e k B l o b                                                            %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SeekBlob() sets the offset in bytes from the beginning of a blob or file
+%  and returns the resulting offset, or -1 if the stream cannot seek.
+%
+%  The format of the SeekBlob method is:
+%
+%      WizardOffsetType SeekBlob(BlobInfo *blob_info,
+%        const WizardOffsetType offset,const int whence)
+%
+%  A description of each parameter follows:
+%
+%    o blob_info: the blob info.
+%
+%    o offset:  Specifies an integer representing the offset in bytes.
+%
+%    o whence:  Specifies an integer representing how the offset is
+%      treated relative to the beginning of the blob as follows:
+%
+%        SEEK_SET  Set position equal to offset bytes.
+%        SEEK_CUR  Set position to current location plus offset.
+%        SEEK_END  Set position to EOF plus offset.
+%
+*/
+WizardExport WizardOffsetType SeekBlob(BlobInfo *blob_info,
+  const WizardOffsetType offset,const int whence)
+{
+  assert(blob_info != (BlobInfo *) NULL);
+  assert(blob_info->signature == WizardSignature);
+  assert(blob_info->type != UndefinedStream);
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",blob_info->filename);
+  switch (blob_info->type)
+  {
+    case UndefinedStream:
+      break;
+    case StandardStream:
+    case PipeStream:
+      return(-1);
+    case FileStream:
+    {
+      if ((offset < 0) && (whence == SEEK_SET))
+        return(-1);
+      if (fseek(blob_info->file_info.file,offset,whence) < 0)
+        return(-1);
+      blob_info->offset=TellBlob(blob_info);
+      break;
+    }
+    case ZipStream:
+    {
+#if defined(WIZARDSTOOLKIT_ZLIB_DELEGATE)
+      if (gzseek(blob_info->file_info.gzfile,offset,whence) < 0)
+        return(-1);
+#endif
+      blob_info->offset=TellBlob(blob_info);
+      break;
+    }
+    case BZipStream:
+      return(-1);
+    case BlobStream:
+    {
+      switch (whence)
+      {
+        case SEEK_SET:
+        default:
+        {
+          if (offset < 0)
+            return(-1);
+          blob_info->offset=offset;
+          break;
+        }
+        case SEEK_CUR:
+        {
+          if ((blob_info->offset+offset) < 0)
+            return(-1);
+          blob_info->offset+=offset;
+          break;
+        }
+        case SEEK_END:
+        {
+          if (((WizardOffsetType) blob_info->length+offset) < 0)
+            return(-1);
+          blob_info->offset=(WizardOffsetType) blob_info->length+offset;
+          break;
+        }
+      }
+      blob_info->eof=blob_info->offset > (WizardOffsetType) blob_info->length ?
+        WizardTrue : WizardFalse;
+      break;
+    }
+  }
+  return(blob_info->offset);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
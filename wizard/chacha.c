@@ -41,6 +41,7 @@
 */
 #include "wizard/studio.h"
 #include "wizard/chacha.h"
+#include "wizard/cpu-private.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
 #include "wizard/memory_.h"
@@ -141,6 +142,43 @@ WizardExport void DecipherChachaBlock(ChachaInfo *chacha_info,
   EncipherChachaBlock(chacha_info,ciphertext,plaintext);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e c i p h e r C h a c h a B l o c k s                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherChachaBlocks() deciphers consecutive blocks of ciphertext to
+%  produce blocks of plaintext.
+%
+%  The format of the DecipherChachaBlocks method is:
+%
+%     void DecipherChachaBlocks(ChachaInfo *chacha_info,
+%       const unsigned char *ciphertext,unsigned char *plaintext,
+%       const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o chacha_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+%    o plaintext: The plain text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+WizardExport void DecipherChachaBlocks(ChachaInfo *chacha_info,
+  const unsigned char *ciphertext,unsigned char *plaintext,const size_t blocks)
+{
+  EncipherChachaBlocks(chacha_info,ciphertext,plaintext,blocks);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -327,6 +365,65 @@ WizardExport void EncipherChachaBlock(ChachaInfo *chacha_info,
   x8=0;  x9=0; x10=0; x11=0; x12=0; x13=0; x14=0; x15=0;
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r C h a c h a B l o c k s                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherChachaBlocks() enciphers consecutive blocks of plaintext to
+%  produce blocks of ciphertext.  The keystream of a block depends only on the
+%  key and nonce, so it is computed once and applied to every block.
+%
+%  The format of the EncipherChachaBlocks method is:
+%
+%     void EncipherChachaBlocks(ChachaInfo *chacha_info,
+%       const unsigned char *plaintext,unsigned char *ciphertext,
+%       const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o chacha_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+%    o ciphertext: The cipher text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+WizardExport void EncipherChachaBlocks(ChachaInfo *chacha_info,
+  const unsigned char *plaintext,unsigned char *ciphertext,const size_t blocks)
+{
+  size_t
+    i;
+
+  ssize_t
+    j;
+
+  unsigned char
+    keystream[ChachaBlocksize];
+
+  (void) memset(keystream,0,sizeof(keystream));
+  EncipherChachaBlock(chacha_info,keystream,keystream);
+  for (i=0; i < blocks; i++)
+  {
+    for (j=0; j < ChachaBlocksize; j++)
+      ciphertext[j]=plaintext[j] ^ keystream[j];
+    plaintext+=ChachaBlocksize;
+    ciphertext+=ChachaBlocksize;
+  }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(keystream,0,sizeof(keystream));
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -357,6 +454,264 @@ WizardExport unsigned int GetChachaBlocksize(const ChachaInfo *chacha_info)
   return(chacha_info->blocksize);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C h a c h a K e y s t r e a m                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetChachaKeystream() returns consecutive blocks of the Chacha keystream
+%  starting at the block counter set with SetChachaNonce().  The counter is
+%  advanced past the returned blocks.  Four or eight blocks are generated at
+%  once with SSE2 or AVX2 when the processor supports them.
+%
+%  The format of the GetChachaKeystream method is:
+%
+%      void GetChachaKeystream(ChachaInfo *chacha_info,const size_t blocks,
+%        unsigned char *keystream)
+%
+%  A description of each parameter follows:
+%
+%    o chacha_info: The cipher context.
+%
+%    o blocks: The number of 64-byte blocks.
+%
+%    o keystream: The keystream.
+%
+*/
+
+static inline void IncrementChachaCounter(ChachaInfo *chacha_info,
+  const size_t blocks)
+{
+  WizardSizeType
+    counter;
+
+  counter=((WizardSizeType) chacha_info->key[13] << 32) |
+    chacha_info->key[12];
+  counter+=blocks;
+  chacha_info->key[12]=(unsigned int) (counter & 0xffffffffU);
+  chacha_info->key[13]=(unsigned int) (counter >> 32);
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+#define ChachaSSE2QuarterRound(a,b,c,d) \
+{ \
+  a=_mm_add_epi32(a,b); d=ChachaSSE2Rotate(_mm_xor_si128(d,a),16); \
+  c=_mm_add_epi32(c,d); b=ChachaSSE2Rotate(_mm_xor_si128(b,c),12); \
+  a=_mm_add_epi32(a,b); d=ChachaSSE2Rotate(_mm_xor_si128(d,a), 8); \
+  c=_mm_add_epi32(c,d); b=ChachaSSE2Rotate(_mm_xor_si128(b,c), 7); \
+}
+#define ChachaSSE2Rotate(v,n) \
+  _mm_or_si128(_mm_slli_epi32(v,n),_mm_srli_epi32(v,32-(n)))
+
+static WizardTarget("sse2") void GetChachaKeystream4(ChachaInfo *chacha_info,
+  unsigned char *keystream)
+{
+  __m128i
+    state[16],
+    x[16];
+
+  ssize_t
+    i,
+    j;
+
+  WizardSizeType
+    counter;
+
+  /*
+    Each vector holds the same state word of four consecutive blocks.
+  */
+  for (i=0; i < 16; i++)
+    state[i]=_mm_set1_epi32((int) chacha_info->key[i]);
+  counter=((WizardSizeType) chacha_info->key[13] << 32) |
+    chacha_info->key[12];
+  state[12]=_mm_set_epi32((int) (counter+3),(int) (counter+2),
+    (int) (counter+1),(int) counter);
+  state[13]=_mm_set_epi32((int) ((counter+3) >> 32),(int) ((counter+2) >> 32),
+    (int) ((counter+1) >> 32),(int) (counter >> 32));
+  for (i=0; i < 16; i++)
+    x[i]=state[i];
+  for (i=20; i > 0; i-=2)
+  {
+    ChachaSSE2QuarterRound(x[0],x[4],x[8],x[12]);
+    ChachaSSE2QuarterRound(x[1],x[5],x[9],x[13]);
+    ChachaSSE2QuarterRound(x[2],x[6],x[10],x[14]);
+    ChachaSSE2QuarterRound(x[3],x[7],x[11],x[15]);
+    ChachaSSE2QuarterRound(x[0],x[5],x[10],x[15]);
+    ChachaSSE2QuarterRound(x[1],x[6],x[11],x[12]);
+    ChachaSSE2QuarterRound(x[2],x[7],x[8],x[13]);
+    ChachaSSE2QuarterRound(x[3],x[4],x[9],x[14]);
+  }
+  for (i=0; i < 16; i++)
+    x[i]=_mm_add_epi32(x[i],state[i]);
+  for (i=0; i < 16; i+=4)
+  {
+    __m128i
+      t0,
+      t1,
+      t2,
+      t3;
+
+    /*
+      Transpose four words of four blocks into block order.
+    */
+    t0=_mm_unpacklo_epi32(x[i+0],x[i+1]);
+    t1=_mm_unpacklo_epi32(x[i+2],x[i+3]);
+    t2=_mm_unpackhi_epi32(x[i+0],x[i+1]);
+    t3=_mm_unpackhi_epi32(x[i+2],x[i+3]);
+    x[i+0]=_mm_unpacklo_epi64(t0,t1);
+    x[i+1]=_mm_unpackhi_epi64(t0,t1);
+    x[i+2]=_mm_unpacklo_epi64(t2,t3);
+    x[i+3]=_mm_unpackhi_epi64(t2,t3);
+    for (j=0; j < 4; j++)
+      _mm_storeu_si128((__m128i *) (keystream+64*j+4*i),x[i+j]);
+  }
+  IncrementChachaCounter(chacha_info,4);
+  /*
+    Reset registers.
+  */
+  for (i=0; i < 16; i++)
+  {
+    state[i]=_mm_setzero_si128();
+    x[i]=_mm_setzero_si128();
+  }
+}
+
+#define ChachaAVX2QuarterRound(a,b,c,d) \
+{ \
+  a=_mm256_add_epi32(a,b); \
+  d=_mm256_shuffle_epi8(_mm256_xor_si256(d,a),rotate16); \
+  c=_mm256_add_epi32(c,d); b=ChachaAVX2Rotate(_mm256_xor_si256(b,c),12); \
+  a=_mm256_add_epi32(a,b); \
+  d=_mm256_shuffle_epi8(_mm256_xor_si256(d,a),rotate8); \
+  c=_mm256_add_epi32(c,d); b=ChachaAVX2Rotate(_mm256_xor_si256(b,c), 7); \
+}
+#define ChachaAVX2Rotate(v,n) \
+  _mm256_or_si256(_mm256_slli_epi32(v,n),_mm256_srli_epi32(v,32-(n)))
+
+static WizardTarget("avx2") void GetChachaKeystream8(ChachaInfo *chacha_info,
+  unsigned char *keystream)
+{
+  __m256i
+    rotate8,
+    rotate16,
+    state[16],
+    x[16];
+
+  ssize_t
+    i,
+    j;
+
+  WizardSizeType
+    counter;
+
+  /*
+    Each vector holds the same state word of eight consecutive blocks.
+  */
+  rotate8=_mm256_set_epi8(14,13,12,15,10,9,8,11,6,5,4,7,2,1,0,3,
+    14,13,12,15,10,9,8,11,6,5,4,7,2,1,0,3);
+  rotate16=_mm256_set_epi8(13,12,15,14,9,8,11,10,5,4,7,6,1,0,3,2,
+    13,12,15,14,9,8,11,10,5,4,7,6,1,0,3,2);
+  for (i=0; i < 16; i++)
+    state[i]=_mm256_set1_epi32((int) chacha_info->key[i]);
+  counter=((WizardSizeType) chacha_info->key[13] << 32) |
+    chacha_info->key[12];
+  state[12]=_mm256_set_epi32((int) (counter+7),(int) (counter+6),
+    (int) (counter+5),(int) (counter+4),(int) (counter+3),(int) (counter+2),
+    (int) (counter+1),(int) counter);
+  state[13]=_mm256_set_epi32((int) ((counter+7) >> 32),
+    (int) ((counter+6) >> 32),(int) ((counter+5) >> 32),
+    (int) ((counter+4) >> 32),(int) ((counter+3) >> 32),
+    (int) ((counter+2) >> 32),(int) ((counter+1) >> 32),
+    (int) (counter >> 32));
+  for (i=0; i < 16; i++)
+    x[i]=state[i];
+  for (i=20; i > 0; i-=2)
+  {
+    ChachaAVX2QuarterRound(x[0],x[4],x[8],x[12]);
+    ChachaAVX2QuarterRound(x[1],x[5],x[9],x[13]);
+    ChachaAVX2QuarterRound(x[2],x[6],x[10],x[14]);
+    ChachaAVX2QuarterRound(x[3],x[7],x[11],x[15]);
+    ChachaAVX2QuarterRound(x[0],x[5],x[10],x[15]);
+    ChachaAVX2QuarterRound(x[1],x[6],x[11],x[12]);
+    ChachaAVX2QuarterRound(x[2],x[7],x[8],x[13]);
+    ChachaAVX2QuarterRound(x[3],x[4],x[9],x[14]);
+  }
+  for (i=0; i < 16; i++)
+    x[i]=_mm256_add_epi32(x[i],state[i]);
+  for (i=0; i < 16; i+=4)
+  {
+    __m256i
+      t0,
+      t1,
+      t2,
+      t3;
+
+    /*
+      Transpose four words of four blocks in each 128-bit lane; the high lane
+      holds blocks four through seven.
+    */
+    t0=_mm256_unpacklo_epi32(x[i+0],x[i+1]);
+    t1=_mm256_unpacklo_epi32(x[i+2],x[i+3]);
+    t2=_mm256_unpackhi_epi32(x[i+0],x[i+1]);
+    t3=_mm256_unpackhi_epi32(x[i+2],x[i+3]);
+    x[i+0]=_mm256_unpacklo_epi64(t0,t1);
+    x[i+1]=_mm256_unpackhi_epi64(t0,t1);
+    x[i+2]=_mm256_unpacklo_epi64(t2,t3);
+    x[i+3]=_mm256_unpackhi_epi64(t2,t3);
+    for (j=0; j < 4; j++)
+    {
+      _mm_storeu_si128((__m128i *) (keystream+64*j+4*i),
+        _mm256_castsi256_si128(x[i+j]));
+      _mm_storeu_si128((__m128i *) (keystream+64*(j+4)+4*i),
+        _mm256_extracti128_si256(x[i+j],1));
+    }
+  }
+  IncrementChachaCounter(chacha_info,8);
+  /*
+    Reset registers.
+  */
+  for (i=0; i < 16; i++)
+  {
+    state[i]=_mm256_setzero_si256();
+    x[i]=_mm256_setzero_si256();
+  }
+  _mm256_zeroupper();
+}
+#endif
+
+WizardExport void GetChachaKeystream(ChachaInfo *chacha_info,
+  const size_t blocks,unsigned char *keystream)
+{
+  size_t
+    i;
+
+  WizardAssert(CipherDomain,chacha_info != (ChachaInfo *) NULL);
+  WizardAssert(CipherDomain,chacha_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,keystream != (unsigned char *) NULL);
+  i=0;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    for ( ; (i+8) <= blocks; i+=8)
+      GetChachaKeystream8(chacha_info,keystream+i*ChachaBlocksize);
+  if (HasCPUFeature(SSE2CPUFeature) != WizardFalse)
+    for ( ; (i+4) <= blocks; i+=4)
+      GetChachaKeystream4(chacha_info,keystream+i*ChachaBlocksize);
+#endif
+  for ( ; i < blocks; i++)
+  {
+    (void) memset(keystream+i*ChachaBlocksize,0,ChachaBlocksize);
+    EncipherChachaBlock(chacha_info,keystream+i*ChachaBlocksize,
+      keystream+i*ChachaBlocksize);
+    IncrementChachaCounter(chacha_info,1);
+  }
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -449,7 +804,8 @@ WizardExport void SetChachaKey(ChachaInfo *chacha_info,const StringInfo *key)
 %
 %  SetChachaNonce() sets the nonce for the Chacha cipher.  The nonce must be
 %  at least 8 bytes.  The counter can be NULL, if not it must be at least
-%  8 bytes.
+%  8 bytes.  The counter is the little-endian index of the next block returned
+%  by GetChachaKeystream().
 %
 %  The format of the SetChachaKey method is:
 %
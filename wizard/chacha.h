@@ -34,7 +34,12 @@ extern WizardExport unsigned int
 
 extern WizardExport void
   DecipherChachaBlock(ChachaInfo *,const unsigned char *,unsigned char *),
+  DecipherChachaBlocks(ChachaInfo *,const unsigned char *,unsigned char *,
+    const size_t),
   EncipherChachaBlock(ChachaInfo *,const unsigned char *,unsigned char *),
+  EncipherChachaBlocks(ChachaInfo *,const unsigned char *,unsigned char *,
+    const size_t),
+  GetChachaKeystream(ChachaInfo *,const size_t,unsigned char *),
   SetChachaKey(ChachaInfo *,const StringInfo *),
   SetChachaNonce(ChachaInfo *,const unsigned char *,const unsigned char *);
 
@@ -43,9 +43,11 @@
 #include "wizard/aes.h"
 #include "wizard/chacha.h"
 #include "wizard/cipher.h"
+#include "wizard/cpu-private.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
 #include "wizard/memory_.h"
+#include "wizard/poly1305.h"
 #include "wizard/random_.h"
 #include "wizard/serpent.h"
 #include "wizard/twofish.h"
@@ -53,14 +55,38 @@
 /*
   Define declarations.
 */
+#define CipherBatchsize  (8*MaxCipherBlocksize)
 #define CipherRandomHash  SHA2256Hash
+#define CipherThreshold  (256*1024)
+#define GCMBlocksize  16
+#define GCMNoncesize  12
+#define Poly1305Noncesize  12
+#define XTSBlocksize  16
+#define XTSSectorsize  4096
 
 /*
   Typedef declarations.
 */
 typedef void
   (*DecipherBlock)(void *,const unsigned char *,const unsigned char *),
-  (*EncipherBlock)(void *,const unsigned char *,const unsigned char *);
+  (*DecipherBlocks)(void *,const unsigned char *,unsigned char *,
+    const size_t),
+  (*EncipherBlock)(void *,const unsigned char *,const unsigned char *),
+  (*EncipherBlocks)(void *,const unsigned char *,unsigned char *,
+    const size_t);
+
+typedef struct _GCMInfo
+{
+  WizardBooleanType
+    clmul;
+
+  unsigned char
+    powers[4*GCMBlocksize];
+
+  WizardSizeType
+    high[16],
+    low[16];
+} GCMInfo;
 
 struct _CipherInfo
 {
@@ -82,12 +108,36 @@ struct _CipherInfo
   DecipherBlock
     encipher_block;
 
+  DecipherBlocks
+    decipher_blocks;
+
+  EncipherBlocks
+    encipher_blocks;
+
   StringInfo
-    *nonce;
+    *additional_data,
+    *nonce,
+    *tag;
+
+  GCMInfo
+    *gcm_info;
+
+  Poly1305Info
+    *poly1305_info;
+
+  CipherInfo
+    *tweak_info;
+
+  WizardSizeType
+    offset;
 
   RandomInfo
     *random_info;
 
+  size_t
+    threads,
+    threshold;
+
   time_t
     timestamp;
 
@@ -101,10 +151,16 @@ struct _CipherInfo
 static StringInfo
   *DecipherCTRMode(CipherInfo *,StringInfo *),
   *DecipherECBMode(CipherInfo *,StringInfo *),
+  *DecipherGCMMode(CipherInfo *,StringInfo *),
   *DecipherOFBMode(CipherInfo *,StringInfo *),
+  *DecipherPoly1305Mode(CipherInfo *,StringInfo *),
+  *DecipherXTSMode(CipherInfo *,StringInfo *),
   *EncipherCTRMode(CipherInfo *,StringInfo *),
   *EncipherECBMode(CipherInfo *,StringInfo *),
-  *EncipherOFBMode(CipherInfo *,StringInfo *);
+  *EncipherGCMMode(CipherInfo *,StringInfo *),
+  *EncipherOFBMode(CipherInfo *,StringInfo *),
+  *EncipherPoly1305Mode(CipherInfo *,StringInfo *),
+  *EncipherXTSMode(CipherInfo *,StringInfo *);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -154,6 +210,8 @@ WizardExport CipherInfo *AcquireCipherInfo(const CipherType cipher,
       cipher_info->blocksize=GetAESBlocksize(aes_info);
       cipher_info->decipher_block=(DecipherBlock) DecipherAESBlock;
       cipher_info->encipher_block=(DecipherBlock) EncipherAESBlock;
+      cipher_info->decipher_blocks=(DecipherBlocks) DecipherAESBlocks;
+      cipher_info->encipher_blocks=(EncipherBlocks) EncipherAESBlocks;
       break;
     }
     case ChachaCipher:
@@ -166,6 +224,8 @@ WizardExport CipherInfo *AcquireCipherInfo(const CipherType cipher,
       cipher_info->blocksize=GetChachaBlocksize(chacha_info);
       cipher_info->decipher_block=(DecipherBlock) DecipherChachaBlock;
       cipher_info->encipher_block=(DecipherBlock) EncipherChachaBlock;
+      cipher_info->decipher_blocks=(DecipherBlocks) DecipherChachaBlocks;
+      cipher_info->encipher_blocks=(EncipherBlocks) EncipherChachaBlocks;
       break;
     }
     case SerpentCipher:
@@ -178,6 +238,8 @@ WizardExport CipherInfo *AcquireCipherInfo(const CipherType cipher,
       cipher_info->blocksize=GetSerpentBlocksize(serpent_info);
       cipher_info->decipher_block=(DecipherBlock) DecipherSerpentBlock;
       cipher_info->encipher_block=(DecipherBlock) EncipherSerpentBlock;
+      cipher_info->decipher_blocks=(DecipherBlocks) DecipherSerpentBlocks;
+      cipher_info->encipher_blocks=(EncipherBlocks) EncipherSerpentBlocks;
       break;
     }
     case TwofishCipher:
@@ -190,15 +252,59 @@ WizardExport CipherInfo *AcquireCipherInfo(const CipherType cipher,
       cipher_info->blocksize=GetTwofishBlocksize(twofish_info);
       cipher_info->decipher_block=(DecipherBlock) DecipherTwofishBlock;
       cipher_info->encipher_block=(DecipherBlock) EncipherTwofishBlock;
+      cipher_info->decipher_blocks=(DecipherBlocks) DecipherTwofishBlocks;
+      cipher_info->encipher_blocks=(EncipherBlocks) EncipherTwofishBlocks;
       break;
     }
     default:
       ThrowWizardFatalError(CipherDomain,EnumerateError);
   }
   cipher_info->mode=mode;
+  if (cipher_info->mode == GCMMode)
+    {
+      /*
+        GCM is defined for 128-bit block ciphers only.
+      */
+      if (cipher_info->blocksize != GCMBlocksize)
+        ThrowWizardFatalError(CipherDomain,EnumerateError);
+      cipher_info->gcm_info=(GCMInfo *) AcquireWizardMemory(
+        sizeof(*cipher_info->gcm_info));
+      if (cipher_info->gcm_info == (GCMInfo *) NULL)
+        ThrowWizardFatalError(CipherDomain,MemoryError);
+      (void) memset(cipher_info->gcm_info,0,sizeof(*cipher_info->gcm_info));
+      cipher_info->tag=AcquireStringInfo(GCMBlocksize);
+      ResetStringInfo(cipher_info->tag);
+    }
+  if (cipher_info->mode == Poly1305Mode)
+    {
+      /*
+        The Poly1305 one-time key is drawn from the Chacha keystream.
+      */
+      if (cipher_info->cipher != ChachaCipher)
+        ThrowWizardFatalError(CipherDomain,EnumerateError);
+      cipher_info->poly1305_info=AcquirePoly1305Info();
+      cipher_info->tag=AcquireStringInfo(GetPoly1305Digestsize(
+        cipher_info->poly1305_info));
+      ResetStringInfo(cipher_info->tag);
+    }
+  if (cipher_info->mode == XTSMode)
+    {
+      /*
+        XTS is defined for 128-bit block ciphers only, a second instance of
+        the cipher enciphers the tweaks.
+      */
+      if (cipher_info->blocksize != XTSBlocksize)
+        ThrowWizardFatalError(CipherDomain,EnumerateError);
+      cipher_info->tweak_info=AcquireCipherInfo(cipher,ECBMode);
+    }
   if (cipher_info->nonce != (StringInfo *) NULL)
     cipher_info->nonce=DestroyStringInfo(cipher_info->nonce);
   cipher_info->random_info=AcquireRandomInfo(CipherRandomHash);
+  cipher_info->threads=1;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  cipher_info->threads=(size_t) omp_get_max_threads();
+#endif
+  cipher_info->threshold=CipherThreshold;
   cipher_info->timestamp=time((time_t *) NULL);
   cipher_info->signature=WizardSignature;
   cipher_info->nonce=GenerateCipherNonce(cipher_info);
@@ -234,25 +340,168 @@ WizardExport CipherInfo *AcquireCipherInfo(const CipherType cipher,
 %    o ciphertext: The cipher text.
 %
 */
+static inline void DecipherCipherBlocks(CipherInfo *cipher_info,
+  const unsigned char *ciphertext,unsigned char *plaintext,const size_t blocks)
+{
+  size_t
+    i;
+
+  /*
+    Prefer the bulk method, it interleaves independent blocks.
+  */
+  if (cipher_info->decipher_blocks != (DecipherBlocks) NULL)
+    {
+      cipher_info->decipher_blocks(cipher_info->handle,ciphertext,plaintext,
+        blocks);
+      return;
+    }
+  for (i=0; i < blocks; i++)
+  {
+    if (plaintext != ciphertext)
+      (void) memcpy(plaintext,ciphertext,cipher_info->blocksize);
+    cipher_info->decipher_block(cipher_info->handle,plaintext,plaintext);
+    ciphertext+=cipher_info->blocksize;
+    plaintext+=cipher_info->blocksize;
+  }
+}
+
+static inline void EncipherCipherBlocks(CipherInfo *cipher_info,
+  const unsigned char *plaintext,unsigned char *ciphertext,const size_t blocks)
+{
+  size_t
+    i;
+
+  if (cipher_info->encipher_blocks != (EncipherBlocks) NULL)
+    {
+      cipher_info->encipher_blocks(cipher_info->handle,plaintext,ciphertext,
+        blocks);
+      return;
+    }
+  for (i=0; i < blocks; i++)
+  {
+    if (ciphertext != plaintext)
+      (void) memcpy(ciphertext,plaintext,cipher_info->blocksize);
+    cipher_info->encipher_block(cipher_info->handle,ciphertext,ciphertext);
+    plaintext+=cipher_info->blocksize;
+    ciphertext+=cipher_info->blocksize;
+  }
+}
+
+static inline unsigned char *AcquireCipherBlocks(const size_t threads,
+  const size_t blocksize,unsigned char *block)
+{
+  unsigned char
+    *blocks;
+
+  /*
+    One chaining block for each thread, the caller's block suffices for one.
+  */
+  if (threads <= 1)
+    return(block);
+  blocks=(unsigned char *) AcquireQuantumMemory(threads,blocksize);
+  if (blocks == (unsigned char *) NULL)
+    ThrowWizardFatalError(CipherDomain,MemoryError);
+  return(blocks);
+}
+
+static inline size_t GetCipherThreads(const CipherInfo *cipher_info,
+  const size_t length)
+{
+  size_t
+    threads;
+
+  /*
+    Split the text across threads only when it is worth the overhead.
+  */
+  if ((cipher_info->threads <= 1) || (length < cipher_info->threshold))
+    return(1);
+  threads=Min(cipher_info->threads,length/CipherBatchsize);
+  return(threads == 0 ? 1 : threads);
+}
+
+static inline unsigned char *RelinquishCipherBlocks(const size_t threads,
+  const size_t blocksize,unsigned char *blocks)
+{
+  (void) ResetWizardMemory(blocks,0,threads*blocksize);
+  if (threads > 1)
+    blocks=(unsigned char *) RelinquishWizardMemory(blocks);
+  return(blocks);
+}
+
+static inline void XorCipherBlock(unsigned char *target,
+  const unsigned char *source,const size_t length)
+{
+  size_t
+    alpha,
+    beta,
+    i;
+
+  /*
+    Exclusive-or a word at a time, the remaining bytes one at a time.
+  */
+  for (i=0; (i+sizeof(alpha)) <= length; i+=sizeof(alpha))
+  {
+    (void) memcpy(&alpha,target+i,sizeof(alpha));
+    (void) memcpy(&beta,source+i,sizeof(beta));
+    alpha^=beta;
+    (void) memcpy(target+i,&alpha,sizeof(alpha));
+  }
+  for ( ; i < length; i++)
+    target[i]^=source[i];
+}
+
+static void DecipherCBCBlocks(CipherInfo *cipher_info,
+  unsigned char *input_block,unsigned char *text,const size_t blocks)
+{
+  size_t
+    blocksize,
+    i,
+    length,
+    n;
+
+  unsigned char
+    output_blocks[CipherBatchsize];
+
+  /*
+    The deciphering of a block does not depend on the previous plaintext, so a
+    batch of blocks is deciphered at once and then chained.
+  */
+  blocksize=cipher_info->blocksize;
+  for (i=0; i < blocks; i+=n)
+  {
+    n=Min(blocks-i,CipherBatchsize/blocksize);
+    length=n*blocksize;
+    (void) memcpy(output_blocks,text,length);
+    DecipherCipherBlocks(cipher_info,text,text,n);
+    XorCipherBlock(text,input_block,blocksize);
+    XorCipherBlock(text+blocksize,output_blocks,length-blocksize);
+    (void) memcpy(input_block,output_blocks+length-blocksize,blocksize);
+    text+=length;
+  }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(output_blocks,0,sizeof(output_blocks));
+}
+
 static StringInfo *DecipherCBCMode(CipherInfo *cipher_info,
   StringInfo *ciphertext)
 {
-   size_t
+  ssize_t
     i;
 
-   unsigned char
-    *p,
-    *q;
-
   size_t
-    blocksize;
+    blocks,
+    blocksize,
+    threads;
 
   StringInfo
     *plaintext;
 
   unsigned char
+    *input_blocks,
     input_block[MaxCipherBlocksize],
-    output_block[MaxCipherBlocksize];
+    *p;
 
   /*
     Decipher in CBC mode.
@@ -261,28 +510,37 @@ static StringInfo *DecipherCBCMode(CipherInfo *cipher_info,
   WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
   WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
   blocksize=cipher_info->blocksize;
+  WizardAssert(CipherDomain,blocksize != 0);
   WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
   WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
   plaintext=ciphertext;
-  p=GetStringInfoDatum(cipher_info->nonce);
-  for (i=0; i < blocksize; i++)
-    input_block[i]=p[i];
-  q=GetStringInfoDatum(ciphertext)+GetStringInfoLength(ciphertext);
-  for (p=GetStringInfoDatum(ciphertext); p < q; p+=blocksize)
+  p=GetStringInfoDatum(ciphertext);
+  blocks=(GetStringInfoLength(ciphertext)+blocksize-1)/blocksize;
+  threads=GetCipherThreads(cipher_info,blocks*blocksize);
+  input_blocks=AcquireCipherBlocks(threads,blocksize,input_block);
+  (void) memcpy(input_blocks,GetStringInfoDatum(cipher_info->nonce),blocksize);
+  for (i=1; i < (ssize_t) threads; i++)
+    (void) memcpy(input_blocks+i*blocksize,p+(i*blocks/threads-1)*blocksize,
+      blocksize);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static) num_threads(threads) \
+    if (threads > 1)
+#endif
+  for (i=0; i < (ssize_t) threads; i++)
   {
-    for (i=0; i < blocksize; i++)
-      output_block[i]=p[i];
-    cipher_info->decipher_block(cipher_info->handle,p,p);
-    for (i=0; i < blocksize; i++)
-      p[i]^=input_block[i];
-    for (i=0; i < blocksize; i++)
-      input_block[i]=output_block[i];
+    size_t
+      first,
+      last;
+
+    first=i*blocks/threads;
+    last=(i+1)*blocks/threads;
+    DecipherCBCBlocks(cipher_info,input_blocks+i*blocksize,p+first*blocksize,
+      last-first);
   }
   /*
     Reset registers.
   */
-  (void) ResetWizardMemory(input_block,0,sizeof(input_block));
-  (void) ResetWizardMemory(output_block,0,sizeof(output_block));
+  input_blocks=RelinquishCipherBlocks(threads,blocksize,input_blocks);
   return(plaintext);
 }
 
@@ -316,25 +574,64 @@ static StringInfo *DecipherCBCMode(CipherInfo *cipher_info,
 %    o ciphertext: The cipher text.
 %
 */
+static void DecipherCFBBytes(CipherInfo *cipher_info,
+  const unsigned char *input_block,unsigned char *text,const size_t length)
+{
+  size_t
+    blocksize,
+    i,
+    j,
+    n;
+
+  unsigned char
+    output_blocks[CipherBatchsize],
+    shift_register[MaxCipherBlocksize+CipherBatchsize];
+
+  /*
+    The input block of each byte is the preceding ciphertext, so a batch of
+    input blocks is enciphered at once.
+  */
+  blocksize=cipher_info->blocksize;
+  (void) memcpy(shift_register,input_block,blocksize);
+  for (i=0; i < length; i+=n)
+  {
+    n=Min(length-i,CipherBatchsize/blocksize);
+    (void) memcpy(shift_register+blocksize,text+i,n);
+    for (j=0; j < n; j++)
+      (void) memcpy(output_blocks+j*blocksize,shift_register+j,blocksize);
+    EncipherCipherBlocks(cipher_info,output_blocks,output_blocks,n);
+    for (j=0; j < n; j++)
+      text[i+j]^=output_blocks[j*blocksize];
+    (void) memmove(shift_register,shift_register+n,blocksize);
+  }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(output_blocks,0,sizeof(output_blocks));
+  (void) ResetWizardMemory(shift_register,0,sizeof(shift_register));
+}
+
 static StringInfo *DecipherCFBMode(CipherInfo *cipher_info,
   StringInfo *ciphertext)
 {
-   size_t
+  ssize_t
     i;
 
-   unsigned char
-    *p,
-    *q;
-
   size_t
-    blocksize;
+    blocksize,
+    j,
+    length,
+    offset,
+    threads;
 
   StringInfo
     *plaintext;
 
   unsigned char
+    *input_blocks,
     input_block[MaxCipherBlocksize],
-    output_block[MaxCipherBlocksize];
+    *nonce,
+    *p;
 
   /*
     Decipher in CFB mode.
@@ -347,25 +644,39 @@ static StringInfo *DecipherCFBMode(CipherInfo *cipher_info,
   WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
   WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
   plaintext=ciphertext;
-  p=GetStringInfoDatum(cipher_info->nonce);
-  for (i=0; i < blocksize; i++)
-    input_block[i]=p[i];
-  q=GetStringInfoDatum(ciphertext)+GetStringInfoLength(ciphertext);
-  for (p=GetStringInfoDatum(ciphertext); p < q; p++)
+  p=GetStringInfoDatum(ciphertext);
+  length=GetStringInfoLength(ciphertext);
+  threads=GetCipherThreads(cipher_info,length);
+  input_blocks=AcquireCipherBlocks(threads,blocksize,input_block);
+  nonce=GetStringInfoDatum(cipher_info->nonce);
+  for (i=0; i < (ssize_t) threads; i++)
   {
-    for (i=0; i < blocksize; i++)
-      output_block[i]=input_block[i];
-    cipher_info->encipher_block(cipher_info->handle,output_block,output_block);
-    for (i=0; i < (blocksize-1); i++)
-      input_block[i]=input_block[i+1];
-    input_block[blocksize-1]=(*p);
-    *p^=(*output_block);
+    /*
+      The shift register of a range is the nonce followed by the ciphertext.
+    */
+    offset=i*length/threads;
+    for (j=0; j < blocksize; j++)
+      input_blocks[i*blocksize+j]=(offset+j) < blocksize ? nonce[offset+j] :
+        p[offset+j-blocksize];
+  }
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static) num_threads(threads) \
+    if (threads > 1)
+#endif
+  for (i=0; i < (ssize_t) threads; i++)
+  {
+    size_t
+      first,
+      last;
+
+    first=i*length/threads;
+    last=(i+1)*length/threads;
+    DecipherCFBBytes(cipher_info,input_blocks+i*blocksize,p+first,last-first);
   }
   /*
     Reset registers.
   */
-  (void) ResetWizardMemory(input_block,0,sizeof(input_block));
-  (void) ResetWizardMemory(output_block,0,sizeof(output_block));
+  input_blocks=RelinquishCipherBlocks(threads,blocksize,input_blocks);
   return(plaintext);
 }
 
@@ -435,17 +746,94 @@ WizardExport StringInfo *DecipherCipher(CipherInfo *cipher_info,
       plaintext=DecipherECBMode(cipher_info,ciphertext);
       break;
     }
+    case GCMMode:
+    {
+      plaintext=DecipherGCMMode(cipher_info,ciphertext);
+      break;
+    }
     case OFBMode:
     {
       plaintext=DecipherOFBMode(cipher_info,ciphertext);
       break;
     }
+    case Poly1305Mode:
+    {
+      plaintext=DecipherPoly1305Mode(cipher_info,ciphertext);
+      break;
+    }
+    case XTSMode:
+    {
+      plaintext=DecipherXTSMode(cipher_info,ciphertext);
+      break;
+    }
     default:
       ThrowWizardFatalError(CipherDomain,EnumerateError);
   }
   return(plaintext);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e c i p h e r C i p h e r R a n g e                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherCipherRange() deciphers part of a message that starts at the given
+%  byte offset, the length of the part is the length of the ciphertext string.
+%  Unlike the chaining modes, CTR, ECB, and XTS modes address each block by its
+%  position so a slice of a large message can be deciphered without
+%  processing everything before it.  The offset must be a multiple of the
+%  cipher blocksize.  Other modes accept an offset of zero only.
+%
+%  The format of the DecipherCipherRange method is:
+%
+%     StringInfo *DecipherCipherRange(CipherInfo *cipher_info,
+%       StringInfo *ciphertext,const WizardSizeType offset)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+%    o offset: The byte offset of the ciphertext within the message.
+%
+*/
+WizardExport StringInfo *DecipherCipherRange(CipherInfo *cipher_info,
+  StringInfo *ciphertext,const WizardSizeType offset)
+{
+  StringInfo
+    *plaintext;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
+  WizardAssert(CipherDomain,(offset % cipher_info->blocksize) == 0);
+  switch (cipher_info->mode)
+  {
+    case CTRMode:
+    case ECBMode:
+    case XTSMode:
+      break;
+    default:
+    {
+      if (offset != 0)
+        ThrowWizardFatalError(CipherDomain,EnumerateError);
+      break;
+    }
+  }
+  cipher_info->offset=offset;
+  plaintext=DecipherCipher(cipher_info,ciphertext);
+  cipher_info->offset=0;
+  return(plaintext);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -479,6 +867,29 @@ WizardExport StringInfo *DecipherCipher(CipherInfo *cipher_info,
 %
 */
 
+static inline void AddCipherNonce(const size_t length,
+  const WizardSizeType offset,unsigned char *nonce)
+{
+  WizardSizeType
+    carry;
+
+  ssize_t
+    i;
+
+  /*
+    Advance the nonce by offset counter values.
+  */
+  carry=offset;
+  for (i=(ssize_t) (length-1); (i >= 0) && (carry != 0); i--)
+  {
+    carry+=nonce[i];
+    nonce[i]=(unsigned char) carry;
+    carry>>=8;
+  }
+  if (carry != 0)
+    ThrowFatalException(CipherFatalError,"Sequence wrap error `%s'");
+}
+
 static inline void IncrementCipherNonce(const size_t length,
   unsigned char *nonce)
 {
@@ -494,62 +905,119 @@ static inline void IncrementCipherNonce(const size_t length,
   ThrowFatalException(CipherFatalError,"Sequence wrap error `%s'");
 }
 
-static StringInfo *DecipherCTRMode(CipherInfo *cipher_info,
-  StringInfo *ciphertext)
+static void TransformCTRBlocks(CipherInfo *cipher_info,unsigned char *counter,
+  unsigned char *text,const size_t blocks)
 {
-   size_t
-    i;
-
-   unsigned char
-    *p,
-    *q;
-
   size_t
-    blocksize;
-
-  StringInfo
-    *plaintext;
+    blocksize,
+    i,
+    j,
+    n;
 
   unsigned char
-    input_block[MaxCipherBlocksize],
-    output_block[MaxCipherBlocksize];
+    output_blocks[CipherBatchsize];
 
   /*
-    Decipher in CTR mode.
+    Encipher a batch of counters and exclusive-or the keystream with the text.
   */
-  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
-  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
-  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
   blocksize=cipher_info->blocksize;
-  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
-  WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
-  plaintext=ciphertext;
-  p=GetStringInfoDatum(cipher_info->nonce);
-  for (i=0; i < blocksize; i++)
-    input_block[i]=p[i];
-  q=GetStringInfoDatum(ciphertext)+GetStringInfoLength(ciphertext);
-  for (p=GetStringInfoDatum(ciphertext); p < q; p+=blocksize)
+  for (i=0; i < blocks; i+=n)
   {
-    for (i=0; i < blocksize; i++)
-      output_block[i]=input_block[i];
-    cipher_info->encipher_block(cipher_info->handle,output_block,output_block);
-    for (i=0; i < blocksize; i++)
-      p[i]^=output_block[i];
-    IncrementCipherNonce(blocksize,input_block);
+    n=Min(blocks-i,CipherBatchsize/blocksize);
+    for (j=0; j < n; j++)
+    {
+      (void) memcpy(output_blocks+j*blocksize,counter,blocksize);
+      IncrementCipherNonce(blocksize,counter);
+    }
+    EncipherCipherBlocks(cipher_info,output_blocks,output_blocks,n);
+    XorCipherBlock(text+i*blocksize,output_blocks,n*blocksize);
   }
   /*
     Reset registers.
   */
-  (void) ResetWizardMemory(input_block,0,sizeof(input_block));
-  (void) ResetWizardMemory(output_block,0,sizeof(output_block));
-  return(plaintext);
+  (void) ResetWizardMemory(output_blocks,0,sizeof(output_blocks));
 }
-
-/*
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%                                                                             %
-%                                                                             %
-%                                                                             %
+
+static void TransformCTRMode(CipherInfo *cipher_info,unsigned char *text,
+  const size_t blocks)
+{
+  ssize_t
+    i;
+
+  size_t
+    blocksize,
+    threads;
+
+  unsigned char
+    *counters,
+    input_block[MaxCipherBlocksize];
+
+  /*
+    Each thread derives the counter of its first block from the nonce and the
+    offset of the text within the message.
+  */
+  blocksize=cipher_info->blocksize;
+  threads=GetCipherThreads(cipher_info,blocks*blocksize);
+  counters=AcquireCipherBlocks(threads,blocksize,input_block);
+  for (i=0; i < (ssize_t) threads; i++)
+  {
+    (void) memcpy(counters+i*blocksize,GetStringInfoDatum(cipher_info->nonce),
+      blocksize);
+    AddCipherNonce(blocksize,cipher_info->offset/blocksize+i*blocks/threads,
+      counters+i*blocksize);
+  }
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static) num_threads(threads) \
+    if (threads > 1)
+#endif
+  for (i=0; i < (ssize_t) threads; i++)
+  {
+    size_t
+      first,
+      last;
+
+    first=i*blocks/threads;
+    last=(i+1)*blocks/threads;
+    TransformCTRBlocks(cipher_info,counters+i*blocksize,text+first*blocksize,
+      last-first);
+  }
+  /*
+    Reset registers.
+  */
+  counters=RelinquishCipherBlocks(threads,blocksize,counters);
+}
+
+static StringInfo *DecipherCTRMode(CipherInfo *cipher_info,
+  StringInfo *ciphertext)
+{
+  size_t
+    blocks,
+    blocksize;
+
+  StringInfo
+    *plaintext;
+
+  /*
+    Decipher in CTR mode.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  blocksize=cipher_info->blocksize;
+  WizardAssert(CipherDomain,blocksize != 0);
+  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
+  WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
+  plaintext=ciphertext;
+  blocks=(GetStringInfoLength(ciphertext)+blocksize-1)/blocksize;
+  TransformCTRMode(cipher_info,GetStringInfoDatum(ciphertext),blocks);
+  return(plaintext);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +   D e c i p h e r E C B M o d e                                             %
 %                                                                             %
 %                                                                             %
@@ -576,16 +1044,20 @@ static StringInfo *DecipherCTRMode(CipherInfo *cipher_info,
 static StringInfo *DecipherECBMode(CipherInfo *cipher_info,
   StringInfo *ciphertext)
 {
-   unsigned char
-    *p,
-    *q;
+  ssize_t
+    i;
 
   size_t
-    blocksize;
+    blocks,
+    blocksize,
+    threads;
 
   StringInfo
     *plaintext;
 
+  unsigned char
+    *p;
+
   /*
     Decipher in ECB mode.
   */
@@ -593,15 +1065,460 @@ static StringInfo *DecipherECBMode(CipherInfo *cipher_info,
   WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
   WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
   blocksize=cipher_info->blocksize;
+  WizardAssert(CipherDomain,blocksize != 0);
   WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
   WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
   plaintext=ciphertext;
-  q=GetStringInfoDatum(ciphertext)+GetStringInfoLength(ciphertext);
-  for (p=GetStringInfoDatum(ciphertext); p < q; p+=blocksize)
-    cipher_info->decipher_block(cipher_info->handle,p,p);
+  blocks=(GetStringInfoLength(ciphertext)+blocksize-1)/blocksize;
+  p=GetStringInfoDatum(ciphertext);
+  threads=GetCipherThreads(cipher_info,blocks*blocksize);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static) num_threads(threads) \
+    if (threads > 1)
+#endif
+  for (i=0; i < (ssize_t) threads; i++)
+  {
+    size_t
+      first,
+      last;
+
+    first=i*blocks/threads;
+    last=(i+1)*blocks/threads;
+    DecipherCipherBlocks(cipher_info,p+first*blocksize,p+first*blocksize,
+      last-first);
+  }
   return(plaintext);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D e c i p h e r G C M M o d e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherGCMMode() deciphers with the cipher in Galois/Counter mode.  This
+%  mode is an authenticated mode that combines counter mode confidentiality
+%  with the GHASH universal hash over the ciphertext, in a single pass.  The
+%  authentication tag of the ciphertext is available from GetCipherTag(); the
+%  plaintext must not be trusted unless it matches the tag that accompanied
+%  the ciphertext.  The nonce is the 96-bit IV followed by the 32-bit block
+%  counter, the IV is incremented after each message.
+%
+%  The format of the DecipherGCMMode method is:
+%
+%     StringInfo *DecipherGCMMode(CipherInfo *cipher_info,
+%       StringInfo *ciphertext)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+*/
+
+static void MultiplyGHASH(const GCMInfo *gcm_info,unsigned char *digest)
+{
+  static const WizardSizeType
+    reduction[16] =
+    {
+      0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+      0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+    };
+
+  size_t
+    high,
+    low,
+    remainder;
+
+  ssize_t
+    i;
+
+  WizardSizeType
+    z[2];
+
+  /*
+    Multiply the digest by H in GF(2^128), four bits at a time (Shoup).
+  */
+  z[0]=gcm_info->high[digest[15] & 0x0f];
+  z[1]=gcm_info->low[digest[15] & 0x0f];
+  for (i=15; i >= 0; i--)
+  {
+    low=(size_t) (digest[i] & 0x0f);
+    high=(size_t) ((digest[i] >> 4) & 0x0f);
+    if (i != 15)
+      {
+        remainder=(size_t) (z[1] & 0x0f);
+        z[1]=(z[0] << 60) | (z[1] >> 4);
+        z[0]=(z[0] >> 4) ^ (reduction[remainder] << 48);
+        z[0]^=gcm_info->high[low];
+        z[1]^=gcm_info->low[low];
+      }
+    remainder=(size_t) (z[1] & 0x0f);
+    z[1]=(z[0] << 60) | (z[1] >> 4);
+    z[0]=(z[0] >> 4) ^ (reduction[remainder] << 48);
+    z[0]^=gcm_info->high[high];
+    z[1]^=gcm_info->low[high];
+  }
+  for (i=0; i < 8; i++)
+  {
+    digest[i]=(unsigned char) (z[0] >> (56-8*i));
+    digest[i+8]=(unsigned char) (z[1] >> (56-8*i));
+  }
+  /*
+    Reset registers.
+  */
+  z[0]=0;
+  z[1]=0;
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static inline WizardTarget("pclmul,ssse3") void MultiplyGHASHCLMUL(
+  const __m128i x,const __m128i h,__m128i *low,__m128i *middle,__m128i *high)
+{
+  /*
+    Accumulate the unreduced 256-bit carry-less product of x and h.
+  */
+  *low=_mm_xor_si128(*low,_mm_clmulepi64_si128(x,h,0x00));
+  *middle=_mm_xor_si128(*middle,_mm_xor_si128(_mm_clmulepi64_si128(x,h,0x01),
+    _mm_clmulepi64_si128(x,h,0x10)));
+  *high=_mm_xor_si128(*high,_mm_clmulepi64_si128(x,h,0x11));
+}
+
+static inline WizardTarget("pclmul,ssse3") __m128i ReduceGHASHCLMUL(
+  __m128i low,const __m128i middle,__m128i high)
+{
+  __m128i
+    alpha,
+    beta,
+    gamma;
+
+  /*
+    The operands are bit-reflected: shift the product left one bit, then
+    reduce it modulo x^128+x^7+x^2+x+1.
+  */
+  low=_mm_xor_si128(low,_mm_slli_si128(middle,8));
+  high=_mm_xor_si128(high,_mm_srli_si128(middle,8));
+  alpha=_mm_srli_epi32(low,31);
+  beta=_mm_srli_epi32(high,31);
+  low=_mm_slli_epi32(low,1);
+  high=_mm_slli_epi32(high,1);
+  gamma=_mm_srli_si128(alpha,12);
+  beta=_mm_slli_si128(beta,4);
+  alpha=_mm_slli_si128(alpha,4);
+  low=_mm_or_si128(low,alpha);
+  high=_mm_or_si128(_mm_or_si128(high,beta),gamma);
+  alpha=_mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low,31),
+    _mm_slli_epi32(low,30)),_mm_slli_epi32(low,25));
+  beta=_mm_srli_si128(alpha,4);
+  alpha=_mm_slli_si128(alpha,12);
+  low=_mm_xor_si128(low,alpha);
+  gamma=_mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low,1),
+    _mm_srli_epi32(low,2)),_mm_srli_epi32(low,7));
+  low=_mm_xor_si128(low,_mm_xor_si128(gamma,beta));
+  return(_mm_xor_si128(high,low));
+}
+
+static WizardTarget("pclmul,ssse3") void SetGHASHCLMULKey(GCMInfo *gcm_info,
+  const unsigned char *hash_key)
+{
+  __m128i
+    high,
+    low,
+    middle,
+    power[4],
+    swap;
+
+  ssize_t
+    i;
+
+  /*
+    Precompute H, H^2, H^3, and H^4 to aggregate four blocks per reduction.
+  */
+  swap=_mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+  power[0]=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) hash_key),swap);
+  for (i=1; i < 4; i++)
+  {
+    low=_mm_setzero_si128();
+    middle=_mm_setzero_si128();
+    high=_mm_setzero_si128();
+    MultiplyGHASHCLMUL(power[i-1],power[0],&low,&middle,&high);
+    power[i]=ReduceGHASHCLMUL(low,middle,high);
+  }
+  for (i=0; i < 4; i++)
+    _mm_storeu_si128((__m128i *) (gcm_info->powers+i*GCMBlocksize),power[i]);
+  /*
+    Reset registers.
+  */
+  for (i=0; i < 4; i++)
+    power[i]=_mm_setzero_si128();
+}
+
+static WizardTarget("pclmul,ssse3") void UpdateGHASHCLMUL(
+  const GCMInfo *gcm_info,const unsigned char *text,const size_t length,
+  unsigned char *digest)
+{
+  __m128i
+    high,
+    low,
+    middle,
+    power[4],
+    swap,
+    x,
+    y;
+
+  size_t
+    i;
+
+  swap=_mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+  for (i=0; i < 4; i++)
+    power[i]=_mm_loadu_si128((const __m128i *) (gcm_info->powers+i*
+      GCMBlocksize));
+  y=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) digest),swap);
+  for (i=0; (i+4*GCMBlocksize) <= length; i+=4*GCMBlocksize)
+  {
+    /*
+      Y = (Y+X1)*H^4 + X2*H^3 + X3*H^2 + X4*H, with a single reduction.
+    */
+    low=_mm_setzero_si128();
+    middle=_mm_setzero_si128();
+    high=_mm_setzero_si128();
+    x=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (text+i)),swap);
+    MultiplyGHASHCLMUL(_mm_xor_si128(x,y),power[3],&low,&middle,&high);
+    x=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (text+i+16)),swap);
+    MultiplyGHASHCLMUL(x,power[2],&low,&middle,&high);
+    x=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (text+i+32)),swap);
+    MultiplyGHASHCLMUL(x,power[1],&low,&middle,&high);
+    x=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (text+i+48)),swap);
+    MultiplyGHASHCLMUL(x,power[0],&low,&middle,&high);
+    y=ReduceGHASHCLMUL(low,middle,high);
+  }
+  for ( ; i < length; i+=GCMBlocksize)
+  {
+    low=_mm_setzero_si128();
+    middle=_mm_setzero_si128();
+    high=_mm_setzero_si128();
+    x=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (text+i)),swap);
+    MultiplyGHASHCLMUL(_mm_xor_si128(x,y),power[0],&low,&middle,&high);
+    y=ReduceGHASHCLMUL(low,middle,high);
+  }
+  _mm_storeu_si128((__m128i *) digest,_mm_shuffle_epi8(y,swap));
+  /*
+    Reset registers.
+  */
+  for (i=0; i < 4; i++)
+    power[i]=_mm_setzero_si128();
+}
+#endif
+
+static void SetGCMKey(CipherInfo *cipher_info)
+{
+  GCMInfo
+    *gcm_info;
+
+  size_t
+    i,
+    j;
+
+  unsigned char
+    hash_key[GCMBlocksize];
+
+  WizardSizeType
+    high,
+    low,
+    reduction;
+
+  /*
+    The hash key H is the encipherment of the zero block.
+  */
+  gcm_info=cipher_info->gcm_info;
+  (void) memset(hash_key,0,sizeof(hash_key));
+  cipher_info->encipher_block(cipher_info->handle,hash_key,hash_key);
+  high=0;
+  low=0;
+  for (i=0; i < 8; i++)
+  {
+    high=(high << 8) | hash_key[i];
+    low=(low << 8) | hash_key[i+8];
+  }
+  gcm_info->high[0]=0;
+  gcm_info->low[0]=0;
+  gcm_info->high[8]=high;
+  gcm_info->low[8]=low;
+  for (i=4; i > 0; i>>=1)
+  {
+    reduction=(low & 0x01) != 0 ? (WizardSizeType) 0xe1 << 56 : 0;
+    low=(high << 63) | (low >> 1);
+    high=(high >> 1) ^ reduction;
+    gcm_info->high[i]=high;
+    gcm_info->low[i]=low;
+  }
+  for (i=2; i <= 8; i<<=1)
+    for (j=1; j < i; j++)
+    {
+      gcm_info->high[i+j]=gcm_info->high[i] ^ gcm_info->high[j];
+      gcm_info->low[i+j]=gcm_info->low[i] ^ gcm_info->low[j];
+    }
+  gcm_info->clmul=WizardFalse;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if ((HasCPUFeature(CLMULCPUFeature) != WizardFalse) &&
+      (HasCPUFeature(SSSE3CPUFeature) != WizardFalse))
+    {
+      SetGHASHCLMULKey(gcm_info,hash_key);
+      gcm_info->clmul=WizardTrue;
+    }
+#endif
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(hash_key,0,sizeof(hash_key));
+  high=0;
+  low=0;
+}
+
+static void UpdateGHASH(const GCMInfo *gcm_info,const unsigned char *text,
+  const size_t length,unsigned char *digest)
+{
+  size_t
+    blocks,
+    i;
+
+  unsigned char
+    block[GCMBlocksize];
+
+  /*
+    Hash whole blocks, a partial final block is padded with zeros.
+  */
+  blocks=length-length % GCMBlocksize;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (gcm_info->clmul != WizardFalse)
+    UpdateGHASHCLMUL(gcm_info,text,blocks,digest);
+  else
+#endif
+    for (i=0; i < blocks; i+=GCMBlocksize)
+    {
+      XorCipherBlock(digest,text+i,GCMBlocksize);
+      MultiplyGHASH(gcm_info,digest);
+    }
+  if (blocks == length)
+    return;
+  (void) memset(block,0,sizeof(block));
+  (void) memcpy(block,text+blocks,length-blocks);
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (gcm_info->clmul != WizardFalse)
+    UpdateGHASHCLMUL(gcm_info,block,GCMBlocksize,digest);
+  else
+#endif
+    {
+      XorCipherBlock(digest,block,GCMBlocksize);
+      MultiplyGHASH(gcm_info,digest);
+    }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(block,0,sizeof(block));
+}
+
+static void TransformGCMMode(CipherInfo *cipher_info,StringInfo *text,
+  const WizardBooleanType encipher)
+{
+  size_t
+    extent,
+    i,
+    length,
+    n;
+
+  unsigned char
+    counter[GCMBlocksize],
+    digest[GCMBlocksize],
+    input_block[GCMBlocksize],
+    *p;
+
+  WizardSizeType
+    bits;
+
+  /*
+    Counter blocks start at J0+1; the message cannot exhaust the 32-bit
+    counter, so a whole-block increment is inc32().
+  */
+  length=GetStringInfoLength(text);
+  WizardAssert(CipherDomain,(WizardSizeType) length <=
+    (((WizardSizeType) 1 << 32)-2)*GCMBlocksize);
+  (void) memset(input_block,0,sizeof(input_block));
+  (void) memcpy(input_block,GetStringInfoDatum(cipher_info->nonce),
+    GCMNoncesize);
+  input_block[GCMBlocksize-1]=1;
+  (void) memcpy(counter,input_block,sizeof(counter));
+  IncrementCipherNonce(GCMBlocksize,counter);
+  (void) memset(digest,0,sizeof(digest));
+  extent=0;
+  if (cipher_info->additional_data != (StringInfo *) NULL)
+    {
+      extent=GetStringInfoLength(cipher_info->additional_data);
+      UpdateGHASH(cipher_info->gcm_info,GetStringInfoDatum(
+        cipher_info->additional_data),extent,digest);
+    }
+  p=GetStringInfoDatum(text);
+  for (i=0; i < length; i+=n)
+  {
+    /*
+      Hash each batch of ciphertext while it is in cache.
+    */
+    n=Min(length-i,CipherBatchsize);
+    if (encipher == WizardFalse)
+      UpdateGHASH(cipher_info->gcm_info,p+i,n,digest);
+    TransformCTRBlocks(cipher_info,counter,p+i,(n+GCMBlocksize-1)/
+      GCMBlocksize);
+    if (encipher != WizardFalse)
+      UpdateGHASH(cipher_info->gcm_info,p+i,n,digest);
+  }
+  /*
+    Hash the bit lengths of the additional data and the ciphertext, then
+    encipher J0 to mask the tag.
+  */
+  bits=8*(WizardSizeType) extent;
+  for (i=0; i < 8; i++)
+    counter[7-i]=(unsigned char) (bits >> (8*i));
+  bits=8*(WizardSizeType) length;
+  for (i=0; i < 8; i++)
+    counter[GCMBlocksize-1-i]=(unsigned char) (bits >> (8*i));
+  UpdateGHASH(cipher_info->gcm_info,counter,GCMBlocksize,digest);
+  cipher_info->encipher_block(cipher_info->handle,input_block,input_block);
+  XorCipherBlock(digest,input_block,GCMBlocksize);
+  SetStringInfoDatum(cipher_info->tag,digest);
+  IncrementCipherNonce(GCMNoncesize,GetStringInfoDatum(cipher_info->nonce));
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(counter,0,sizeof(counter));
+  (void) ResetWizardMemory(digest,0,sizeof(digest));
+  (void) ResetWizardMemory(input_block,0,sizeof(input_block));
+}
+
+static StringInfo *DecipherGCMMode(CipherInfo *cipher_info,
+  StringInfo *ciphertext)
+{
+  StringInfo
+    *plaintext;
+
+  /*
+    Decipher in GCM mode.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,cipher_info->blocksize == GCMBlocksize);
+  WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
+  plaintext=ciphertext;
+  TransformGCMMode(cipher_info,ciphertext,WizardFalse);
+  return(plaintext);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -635,49 +1552,373 @@ static StringInfo *DecipherECBMode(CipherInfo *cipher_info,
 static StringInfo *DecipherOFBMode(CipherInfo *cipher_info,
   StringInfo *ciphertext)
 {
-   size_t
+   size_t
+    i;
+
+   unsigned char
+    *p,
+    *q;
+
+  size_t
+    blocksize;
+
+  StringInfo
+    *plaintext;
+
+  unsigned char
+    input_block[MaxCipherBlocksize];
+
+  /*
+    Decipher in OFB mode.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  blocksize=cipher_info->blocksize;
+  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
+  WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
+  plaintext=ciphertext;
+  p=GetStringInfoDatum(cipher_info->nonce);
+  for (i=0; i < blocksize; i++)
+    input_block[i]=p[i];
+  q=GetStringInfoDatum(ciphertext)+GetStringInfoLength(ciphertext);
+  for (p=GetStringInfoDatum(ciphertext); p < q; p+=blocksize)
+  {
+    cipher_info->encipher_block(cipher_info->handle,input_block,input_block);
+    XorCipherBlock(p,input_block,blocksize);
+  }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(input_block,0,sizeof(input_block));
+  return(plaintext);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D e c i p h e r P o l y 1 3 0 5 M o d e                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherPoly1305Mode() deciphers with the Chacha cipher in the
+%  ChaCha20-Poly1305 authenticated mode of RFC 8439.  The Poly1305 tag of the
+%  ciphertext is available from GetCipherTag() and must be compared with the
+%  received tag before the plaintext is trusted.
+%
+%  The format of the DecipherPoly1305Mode method is:
+%
+%     StringInfo *DecipherPoly1305Mode(CipherInfo *cipher_info,
+%       StringInfo *ciphertext)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+*/
+
+static void TransformPoly1305Mode(CipherInfo *cipher_info,StringInfo *text,
+  const WizardBooleanType encipher)
+{
+  ChachaInfo
+    *chacha_info;
+
+  size_t
+    extent,
+    i,
+    length,
+    n;
+
+  unsigned char
+    counter[8],
+    keystream[CipherBatchsize],
+    *nonce,
+    *p;
+
+  /*
+    Block 0 of the keystream keys Poly1305, the message starts at block 1.
+    The 32-bit block counter and the first nonce word form the 64-bit Chacha
+    counter.
+  */
+  chacha_info=(ChachaInfo *) cipher_info->handle;
+  nonce=GetStringInfoDatum(cipher_info->nonce);
+  (void) memset(counter,0,sizeof(counter));
+  (void) memcpy(counter+4,nonce,4);
+  SetChachaNonce(chacha_info,nonce+4,counter);
+  GetChachaKeystream(chacha_info,1,keystream);
+  (void) InitializePoly1305(cipher_info->poly1305_info,keystream);
+  /*
+    The additional data is authenticated first, padded to 16 bytes.
+  */
+  extent=0;
+  if (cipher_info->additional_data != (StringInfo *) NULL)
+    extent=GetStringInfoLength(cipher_info->additional_data);
+  if (extent != 0)
+    {
+      (void) UpdatePoly1305(cipher_info->poly1305_info,GetStringInfoDatum(
+        cipher_info->additional_data),extent);
+      if ((extent % 16) != 0)
+        {
+          (void) memset(keystream,0,16);
+          (void) UpdatePoly1305(cipher_info->poly1305_info,keystream,
+            16-extent % 16);
+        }
+    }
+  length=GetStringInfoLength(text);
+  p=GetStringInfoDatum(text);
+  for (i=0; i < length; i+=n)
+  {
+    /*
+      Authenticate each batch of ciphertext while it is in cache.
+    */
+    n=Min(length-i,CipherBatchsize);
+    if (encipher == WizardFalse)
+      (void) UpdatePoly1305(cipher_info->poly1305_info,p+i,n);
+    GetChachaKeystream(chacha_info,(n+cipher_info->blocksize-1)/
+      cipher_info->blocksize,keystream);
+    XorCipherBlock(p+i,keystream,n);
+    if (encipher != WizardFalse)
+      (void) UpdatePoly1305(cipher_info->poly1305_info,p+i,n);
+  }
+  /*
+    Pad the ciphertext to 16 bytes, then authenticate the little-endian
+    64-bit lengths of the additional data and the ciphertext.
+  */
+  (void) memset(keystream,0,32);
+  if ((length % 16) != 0)
+    (void) UpdatePoly1305(cipher_info->poly1305_info,keystream,16-length % 16);
+  for (i=0; i < 8; i++)
+  {
+    keystream[i]=(unsigned char) ((WizardSizeType) extent >> (8*i));
+    keystream[8+i]=(unsigned char) ((WizardSizeType) length >> (8*i));
+  }
+  (void) UpdatePoly1305(cipher_info->poly1305_info,keystream,16);
+  (void) FinalizePoly1305(cipher_info->poly1305_info);
+  SetStringInfo(cipher_info->tag,GetPoly1305Digest(
+    cipher_info->poly1305_info));
+  IncrementCipherNonce(Poly1305Noncesize,nonce);
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(counter,0,sizeof(counter));
+  (void) ResetWizardMemory(keystream,0,sizeof(keystream));
+}
+
+static StringInfo *DecipherPoly1305Mode(CipherInfo *cipher_info,
+  StringInfo *ciphertext)
+{
+  StringInfo
+    *plaintext;
+
+  /*
+    Decipher in ChaCha20-Poly1305 mode.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,cipher_info->cipher == ChachaCipher);
+  WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
+  plaintext=ciphertext;
+  TransformPoly1305Mode(cipher_info,ciphertext,WizardFalse);
+  return(plaintext);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D e c i p h e r X T S M o d e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherXTSMode() deciphers with the cipher in XTS mode (IEEE 1619).  This
+%  mode is a confidentiality mode for storage that features a tweak derived
+%  from the position of each block: the text is divided into data units of
+%  4096 bytes, each data unit number is enciphered under the second half of
+%  the key and then multiplied by a power of alpha for each block within the
+%  unit.  Any block can be deciphered independently of every other block, see
+%  DecipherCipherRange().  The nonce is the number of the first data unit.
+%
+%  The format of the DecipherXTSMode method is:
+%
+%     StringInfo *DecipherXTSMode(CipherInfo *cipher_info,
+%       StringInfo *ciphertext)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+*/
+
+static inline void MultiplyXTSTweak(unsigned char *tweak)
+{
+  ssize_t
+    i;
+
+  unsigned int
+    carry,
+    msb;
+
+  /*
+    Multiply by alpha in GF(2^128), the tweak is little-endian.
+  */
+  carry=0;
+  for (i=0; i < XTSBlocksize; i++)
+  {
+    msb=(unsigned int) tweak[i] >> 7;
+    tweak[i]=(unsigned char) ((tweak[i] << 1) | carry);
+    carry=msb;
+  }
+  tweak[0]^=(unsigned char) (0x87 & (0U-carry));
+}
+
+static void SetXTSTweak(CipherInfo *cipher_info,const WizardSizeType offset,
+  unsigned char *tweak)
+{
+  CipherInfo
+    *tweak_info;
+
+  size_t
+    blocks,
+    i;
+
+  unsigned char
+    *nonce;
+
+  WizardSizeType
+    carry;
+
+  /*
+    Encipher the number of the data unit that holds the offset, then advance
+    to the block within the unit.
+  */
+  nonce=GetStringInfoDatum(cipher_info->nonce);
+  carry=offset/XTSSectorsize;
+  for (i=0; i < XTSBlocksize; i++)
+  {
+    carry+=nonce[i];
+    tweak[i]=(unsigned char) carry;
+    carry>>=8;
+  }
+  tweak_info=cipher_info->tweak_info;
+  tweak_info->encipher_block(tweak_info->handle,tweak,tweak);
+  blocks=(size_t) (offset % XTSSectorsize)/XTSBlocksize;
+  for (i=0; i < blocks; i++)
+    MultiplyXTSTweak(tweak);
+}
+
+static void TransformXTSBlocks(CipherInfo *cipher_info,
+  const WizardSizeType offset,unsigned char *text,const size_t blocks,
+  const WizardBooleanType encipher)
+{
+  size_t
+    i,
+    j,
+    n;
+
+  unsigned char
+    tweak[XTSBlocksize],
+    tweaks[CipherBatchsize];
+
+  WizardSizeType
+    position;
+
+  /*
+    Batches stop at data unit boundaries where the tweak is recomputed.
+  */
+  for (i=0; i < blocks; i+=n)
+  {
+    position=offset+(WizardSizeType) i*XTSBlocksize;
+    if ((i == 0) || ((position % XTSSectorsize) == 0))
+      SetXTSTweak(cipher_info,position,tweak);
+    n=Min(blocks-i,CipherBatchsize/XTSBlocksize);
+    n=Min(n,(size_t) (XTSSectorsize-position % XTSSectorsize)/XTSBlocksize);
+    for (j=0; j < n; j++)
+    {
+      (void) memcpy(tweaks+j*XTSBlocksize,tweak,XTSBlocksize);
+      MultiplyXTSTweak(tweak);
+    }
+    XorCipherBlock(text+i*XTSBlocksize,tweaks,n*XTSBlocksize);
+    if (encipher != WizardFalse)
+      EncipherCipherBlocks(cipher_info,text+i*XTSBlocksize,
+        text+i*XTSBlocksize,n);
+    else
+      DecipherCipherBlocks(cipher_info,text+i*XTSBlocksize,
+        text+i*XTSBlocksize,n);
+    XorCipherBlock(text+i*XTSBlocksize,tweaks,n*XTSBlocksize);
+  }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(tweak,0,sizeof(tweak));
+  (void) ResetWizardMemory(tweaks,0,sizeof(tweaks));
+}
+
+static void TransformXTSMode(CipherInfo *cipher_info,unsigned char *text,
+  const size_t blocks,const WizardBooleanType encipher)
+{
+  ssize_t
     i;
 
-   unsigned char
-    *p,
-    *q;
+  size_t
+    threads;
+
+  /*
+    Each thread derives the tweak of its first block from its offset.
+  */
+  threads=GetCipherThreads(cipher_info,blocks*XTSBlocksize);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static) num_threads(threads) \
+    if (threads > 1)
+#endif
+  for (i=0; i < (ssize_t) threads; i++)
+  {
+    size_t
+      first,
+      last;
+
+    first=i*blocks/threads;
+    last=(i+1)*blocks/threads;
+    TransformXTSBlocks(cipher_info,cipher_info->offset+(WizardSizeType) first*
+      XTSBlocksize,text+first*XTSBlocksize,last-first,encipher);
+  }
+}
 
+static StringInfo *DecipherXTSMode(CipherInfo *cipher_info,
+  StringInfo *ciphertext)
+{
   size_t
-    blocksize;
+    blocks;
 
   StringInfo
     *plaintext;
 
-  unsigned char
-    input_block[MaxCipherBlocksize];
-
   /*
-    Decipher in OFB mode.
+    Decipher in XTS mode.
   */
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
   WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
-  blocksize=cipher_info->blocksize;
-  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
+  WizardAssert(CipherDomain,cipher_info->blocksize == XTSBlocksize);
   WizardAssert(CipherDomain,ciphertext != (StringInfo *) NULL);
   plaintext=ciphertext;
-  p=GetStringInfoDatum(cipher_info->nonce);
-  for (i=0; i < blocksize; i++)
-    input_block[i]=p[i];
-  q=GetStringInfoDatum(ciphertext)+GetStringInfoLength(ciphertext);
-  for (p=GetStringInfoDatum(ciphertext); p < q; p+=blocksize)
-  {
-    cipher_info->encipher_block(cipher_info->handle,input_block,input_block);
-    for (i=0; i < blocksize; i++)
-      p[i]^=input_block[i];
-  }
-  /*
-    Reset registers.
-  */
-  (void) ResetWizardMemory(input_block,0,sizeof(input_block));
+  blocks=(GetStringInfoLength(ciphertext)+XTSBlocksize-1)/XTSBlocksize;
+  TransformXTSMode(cipher_info,GetStringInfoDatum(ciphertext),blocks,
+    WizardFalse);
   return(plaintext);
 }
-
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -736,6 +1977,22 @@ WizardExport CipherInfo *DestroyCipherInfo(CipherInfo *cipher_info)
     }
   if (cipher_info->nonce != (StringInfo *) NULL)
     cipher_info->nonce=DestroyStringInfo(cipher_info->nonce);
+  if (cipher_info->tag != (StringInfo *) NULL)
+    cipher_info->tag=DestroyStringInfo(cipher_info->tag);
+  if (cipher_info->additional_data != (StringInfo *) NULL)
+    cipher_info->additional_data=DestroyStringInfo(
+      cipher_info->additional_data);
+  if (cipher_info->gcm_info != (GCMInfo *) NULL)
+    {
+      (void) ResetWizardMemory(cipher_info->gcm_info,0,
+        sizeof(*cipher_info->gcm_info));
+      cipher_info->gcm_info=(GCMInfo *) RelinquishWizardMemory(
+        cipher_info->gcm_info);
+    }
+  if (cipher_info->poly1305_info != (Poly1305Info *) NULL)
+    cipher_info->poly1305_info=DestroyPoly1305Info(cipher_info->poly1305_info);
+  if (cipher_info->tweak_info != (CipherInfo *) NULL)
+    cipher_info->tweak_info=DestroyCipherInfo(cipher_info->tweak_info);
   if (cipher_info->random_info != (RandomInfo *) NULL)
     cipher_info->random_info=DestroyRandomInfo(cipher_info->random_info);
   cipher_info->signature=(~WizardSignature);
@@ -814,11 +2071,9 @@ static StringInfo *EncipherCBCMode(CipherInfo *cipher_info,
     q+=blocksize;
   for (p=GetStringInfoDatum(plaintext); p < q; p+=blocksize)
   {
-    for (i=0; i < blocksize; i++)
-      p[i]^=input_block[i];
+    XorCipherBlock(p,input_block,blocksize);
     cipher_info->encipher_block(cipher_info->handle,p,p);
-    for (i=0; i < blocksize; i++)
-      input_block[i]=p[i];
+    (void) memcpy(input_block,p,blocksize);
   }
   /*
     Reset registers.
@@ -976,40 +2231,315 @@ WizardExport StringInfo *EncipherCipher(CipherInfo *cipher_info,
       ciphertext=EncipherECBMode(cipher_info,plaintext);
       break;
     }
+    case GCMMode:
+    {
+      ciphertext=EncipherGCMMode(cipher_info,plaintext);
+      break;
+    }
     case OFBMode:
     {
       ciphertext=EncipherOFBMode(cipher_info,plaintext);
       break;
     }
+    case Poly1305Mode:
+    {
+      ciphertext=EncipherPoly1305Mode(cipher_info,plaintext);
+      break;
+    }
+    case XTSMode:
+    {
+      ciphertext=EncipherXTSMode(cipher_info,plaintext);
+      break;
+    }
     default:
       ThrowWizardFatalError(CipherDomain,EnumerateError);
   }
   return(ciphertext);
 }
-
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r C i p h e r R a n g e                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherCipherRange() enciphers part of a message that starts at the given
+%  byte offset, the length of the part is the length of the plaintext string.
+%  Unlike the chaining modes, CTR, ECB, and XTS modes address each block by its
+%  position so a slice of a large message can be enciphered without
+%  processing everything before it.  The offset must be a multiple of the
+%  cipher blocksize.  Other modes accept an offset of zero only.
+%
+%  The format of the EncipherCipherRange method is:
+%
+%     StringInfo *EncipherCipherRange(CipherInfo *cipher_info,
+%       StringInfo *plaintext,const WizardSizeType offset)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+%    o offset: The byte offset of the plaintext within the message.
+%
+*/
+WizardExport StringInfo *EncipherCipherRange(CipherInfo *cipher_info,
+  StringInfo *plaintext,const WizardSizeType offset)
+{
+  StringInfo
+    *ciphertext;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,plaintext != (StringInfo *) NULL);
+  WizardAssert(CipherDomain,(offset % cipher_info->blocksize) == 0);
+  switch (cipher_info->mode)
+  {
+    case CTRMode:
+    case ECBMode:
+    case XTSMode:
+      break;
+    default:
+    {
+      if (offset != 0)
+        ThrowWizardFatalError(CipherDomain,EnumerateError);
+      break;
+    }
+  }
+  cipher_info->offset=offset;
+  ciphertext=EncipherCipher(cipher_info,plaintext);
+  cipher_info->offset=0;
+  return(ciphertext);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   E n c i p h e r C T R M o d e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherCTRMode() enciphers with the cipher in Counter mode.  This mode is a
+%  confidentiality mode that features the application of the forward cipher to
+%  a set of input blocks, called counters, to produce a sequence of output
+%  blocks that are exclusive-ORed with the plaintext to produce the ciphertext,
+%  and vice versa. The sequence of counters must have the property that each
+%  block in the sequence is different from every other block. This condition is
+%  not restricted to a single message: across all of the messages that are
+%  enciphered under the given key, all of the counters must be distinct.
+%
+%  The format of the EncipherCTRMode method is:
+%
+%      StringInfo *EncipherCTRMode(CipherInfo *cipher_info,
+%        StringInfo *plaintext)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+*/
+static StringInfo *EncipherCTRMode(CipherInfo *cipher_info,
+  StringInfo *plaintext)
+{
+   unsigned char
+    *q;
+
+  size_t
+    blocks,
+    blocksize,
+    pad;
+
+  StringInfo
+    *ciphertext;
+
+  /*
+    Encipher in CTR mode.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  blocksize=cipher_info->blocksize;
+  WizardAssert(CipherDomain,blocksize != 0);
+  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
+  WizardAssert(CipherDomain,plaintext != (StringInfo *) NULL);
+  ciphertext=plaintext;
+  q=GetStringInfoDatum(plaintext)+GetStringInfoLength(plaintext);
+  pad=blocksize-GetStringInfoLength(plaintext) % blocksize;
+  SetRandomKey(cipher_info->random_info,pad-1,q);
+  q[pad-1]=(unsigned char) (pad-1);
+  blocks=(GetStringInfoLength(plaintext)+pad)/blocksize;
+  TransformCTRMode(cipher_info,GetStringInfoDatum(plaintext),blocks);
+  return(ciphertext);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   E n c i p h e r E C B M o d e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherECBMode() enciphers with the cipher in Electronic Codebook mode.
+%  This mode is a confidentiality mode that features, for a given key, the
+%  assignment of a fixed ciphertext block to each plaintext block, analogous to
+%  the assignment of code words in a codebook.
+%
+%  The format of the EncipherECBMode method is:
+%
+%      StringInfo *EncipherECBMode(CipherInfo *cipher_info,
+%        StringInfo *plaintext)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+*/
+static StringInfo *EncipherECBMode(CipherInfo *cipher_info,
+  StringInfo *plaintext)
+{
+  ssize_t
+    i;
+
+  unsigned char
+    *p,
+    *q;
+
+  size_t
+    blocks,
+    blocksize,
+    pad,
+    threads;
+
+  StringInfo
+    *ciphertext;
+
+  /*
+    Encipher in ECB mode.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  blocksize=cipher_info->blocksize;
+  WizardAssert(CipherDomain,blocksize != 0);
+  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
+  WizardAssert(CipherDomain,plaintext != (StringInfo *) NULL);
+  ciphertext=plaintext;
+  q=GetStringInfoDatum(plaintext)+GetStringInfoLength(plaintext);
+  pad=blocksize-GetStringInfoLength(plaintext) % blocksize;
+  SetRandomKey(cipher_info->random_info,pad-1,q);
+  q[pad-1]=(unsigned char) (pad-1);
+  blocks=(GetStringInfoLength(plaintext)+pad)/blocksize;
+  p=GetStringInfoDatum(plaintext);
+  threads=GetCipherThreads(cipher_info,blocks*blocksize);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static) num_threads(threads) \
+    if (threads > 1)
+#endif
+  for (i=0; i < (ssize_t) threads; i++)
+  {
+    size_t
+      first,
+      last;
+
+    first=i*blocks/threads;
+    last=(i+1)*blocks/threads;
+    EncipherCipherBlocks(cipher_info,p+first*blocksize,p+first*blocksize,
+      last-first);
+  }
+  return(ciphertext);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   E n c i p h e r G C M M o d e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherGCMMode() enciphers with the cipher in Galois/Counter mode.  This
+%  mode is an authenticated mode that combines counter mode confidentiality
+%  with the GHASH universal hash over the ciphertext, in a single pass.  The
+%  ciphertext is the same length as the plaintext and its authentication tag
+%  is available from GetCipherTag().  Any additional data set with
+%  SetCipherAdditionalData() is authenticated but not enciphered.  The nonce
+%  is the 96-bit IV followed by the 32-bit block counter, the IV is
+%  incremented after each message.
+%
+%  The format of the EncipherGCMMode method is:
+%
+%      StringInfo *EncipherGCMMode(CipherInfo *cipher_info,
+%        StringInfo *plaintext)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+*/
+static StringInfo *EncipherGCMMode(CipherInfo *cipher_info,
+  StringInfo *plaintext)
+{
+  StringInfo
+    *ciphertext;
+
+  /*
+    Encipher in GCM mode.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,cipher_info->blocksize == GCMBlocksize);
+  WizardAssert(CipherDomain,plaintext != (StringInfo *) NULL);
+  ciphertext=plaintext;
+  TransformGCMMode(cipher_info,plaintext,WizardTrue);
+  return(ciphertext);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
 %                                                                             %
 %                                                                             %
-+   E n c i p h e r C T R M o d e                                             %
++   E n c i p h e r O F B M o d e                                             %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  EncipherCTRMode() enciphers with the cipher in Counter mode.  This mode is a
-%  confidentiality mode that features the application of the forward cipher to
-%  a set of input blocks, called counters, to produce a sequence of output
-%  blocks that are exclusive-ORed with the plaintext to produce the ciphertext,
-%  and vice versa. The sequence of counters must have the property that each
-%  block in the sequence is different from every other block. This condition is
-%  not restricted to a single message: across all of the messages that are
-%  enciphered under the given key, all of the counters must be distinct.
+%  EncipherOFBMode() enciphers with the cipher in Output Feedback mode.  This
+%  mode is a confidentiality mode that features the iteration of the forward
+%  cipher on a nonce to generate a sequence of output blocks that are
+%  exclusive-ORed with the plaintext to produce the ciphertext, and vice versa.
+%  The OFB mode requires that the IV is a nonce, i.e., the IV must be unique
+%  for each execution of the mode under the given key.
 %
-%  The format of the EncipherCTRMode method is:
+%  The format of the EncipherOFBMode method is:
 %
-%      StringInfo *EncipherCTRMode(CipherInfo *cipher_info,
+%      StringInfo *EncipherOFBMode(CipherInfo *cipher_info,
 %        StringInfo *plaintext)
 %
 %  A description of each parameter follows:
@@ -1019,7 +2549,7 @@ WizardExport StringInfo *EncipherCipher(CipherInfo *cipher_info,
 %    o plaintext: The plain text.
 %
 */
-static StringInfo *EncipherCTRMode(CipherInfo *cipher_info,
+static StringInfo *EncipherOFBMode(CipherInfo *cipher_info,
   StringInfo *plaintext)
 {
    size_t
@@ -1037,11 +2567,10 @@ static StringInfo *EncipherCTRMode(CipherInfo *cipher_info,
     *ciphertext;
 
   unsigned char
-    input_block[MaxCipherBlocksize],
-    output_block[MaxCipherBlocksize];
+    input_block[MaxCipherBlocksize];
 
   /*
-    Encipher in CTR mode.
+    Encipher in OBC mode.
   */
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
@@ -1062,40 +2591,37 @@ static StringInfo *EncipherCTRMode(CipherInfo *cipher_info,
     q+=blocksize;
   for (p=GetStringInfoDatum(plaintext); p < q; p+=blocksize)
   {
-    for (i=0; i < blocksize; i++)
-      output_block[i]=input_block[i];
-    cipher_info->encipher_block(cipher_info->handle,output_block,output_block);
-    for (i=0; i < blocksize; i++)
-      p[i]^=output_block[i];
-    IncrementCipherNonce(blocksize,input_block);
+    cipher_info->encipher_block(cipher_info->handle,input_block,input_block);
+    XorCipherBlock(p,input_block,blocksize);
   }
   /*
     Reset registers.
   */
   (void) ResetWizardMemory(input_block,0,sizeof(input_block));
-  (void) ResetWizardMemory(output_block,0,sizeof(output_block));
   return(ciphertext);
 }
-
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
 %                                                                             %
 %                                                                             %
-+   E n c i p h e r E C B M o d e                                             %
++   E n c i p h e r P o l y 1 3 0 5 M o d e                                   %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  EncipherECBMode() enciphers with the cipher in Electronic Codebook mode.
-%  This mode is a confidentiality mode that features, for a given key, the
-%  assignment of a fixed ciphertext block to each plaintext block, analogous to
-%  the assignment of code words in a codebook.
+%  EncipherPoly1305Mode() enciphers with the Chacha cipher in the
+%  ChaCha20-Poly1305 authenticated mode of RFC 8439.  The ciphertext is the
+%  same length as the plaintext and its Poly1305 tag is available from
+%  GetCipherTag().  Any additional data set with SetCipherAdditionalData() is
+%  authenticated but not enciphered.  The first 96 bits of the nonce are the
+%  RFC nonce, they are incremented after each message.
 %
-%  The format of the EncipherECBMode method is:
+%  The format of the EncipherPoly1305Mode method is:
 %
-%      StringInfo *EncipherECBMode(CipherInfo *cipher_info,
+%      StringInfo *EncipherPoly1305Mode(CipherInfo *cipher_info,
 %        StringInfo *plaintext)
 %
 %  A description of each parameter follows:
@@ -1105,38 +2631,22 @@ static StringInfo *EncipherCTRMode(CipherInfo *cipher_info,
 %    o plaintext: The plain text.
 %
 */
-static StringInfo *EncipherECBMode(CipherInfo *cipher_info,
+static StringInfo *EncipherPoly1305Mode(CipherInfo *cipher_info,
   StringInfo *plaintext)
 {
-   unsigned char
-    *p,
-    *q;
-
-  size_t
-    blocksize,
-    pad;
-
   StringInfo
     *ciphertext;
 
   /*
-    Encipher in ECB mode.
+    Encipher in ChaCha20-Poly1305 mode.
   */
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
   WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
-  blocksize=cipher_info->blocksize;
-  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
+  WizardAssert(CipherDomain,cipher_info->cipher == ChachaCipher);
   WizardAssert(CipherDomain,plaintext != (StringInfo *) NULL);
   ciphertext=plaintext;
-  q=GetStringInfoDatum(plaintext)+GetStringInfoLength(plaintext);
-  pad=blocksize-GetStringInfoLength(plaintext) % blocksize;
-  SetRandomKey(cipher_info->random_info,pad-1,q);
-  q[pad-1]=(unsigned char) (pad-1);
-  if (pad == blocksize)
-    q+=blocksize;
-  for (p=GetStringInfoDatum(plaintext); p < q; p+=blocksize)
-    cipher_info->encipher_block(cipher_info->handle,p,p);
+  TransformPoly1305Mode(cipher_info,plaintext,WizardTrue);
   return(ciphertext);
 }
 
@@ -1145,22 +2655,23 @@ static StringInfo *EncipherECBMode(CipherInfo *cipher_info,
 %                                                                             %
 %                                                                             %
 %                                                                             %
-+   E n c i p h e r O F B M o d e                                             %
++   E n c i p h e r X T S M o d e                                             %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  EncipherOFBMode() enciphers with the cipher in Output Feedback mode.  This
-%  mode is a confidentiality mode that features the iteration of the forward
-%  cipher on a nonce to generate a sequence of output blocks that are
-%  exclusive-ORed with the plaintext to produce the ciphertext, and vice versa.
-%  The OFB mode requires that the IV is a nonce, i.e., the IV must be unique
-%  for each execution of the mode under the given key.
+%  EncipherXTSMode() enciphers with the cipher in XTS mode (IEEE 1619).  This
+%  mode is a confidentiality mode for storage that features a tweak derived
+%  from the position of each block, so every block of a message is enciphered
+%  differently yet can be deciphered independently, see DecipherCipherRange().
+%  The key is split in half: the first half enciphers the data, the second the
+%  tweaks.  A partial final block is padded as in ECB mode rather than with
+%  ciphertext stealing.
 %
-%  The format of the EncipherOFBMode method is:
+%  The format of the EncipherXTSMode method is:
 %
-%      StringInfo *EncipherOFBMode(CipherInfo *cipher_info,
+%      StringInfo *EncipherXTSMode(CipherInfo *cipher_info,
 %        StringInfo *plaintext)
 %
 %  A description of each parameter follows:
@@ -1170,59 +2681,38 @@ static StringInfo *EncipherECBMode(CipherInfo *cipher_info,
 %    o plaintext: The plain text.
 %
 */
-static StringInfo *EncipherOFBMode(CipherInfo *cipher_info,
+static StringInfo *EncipherXTSMode(CipherInfo *cipher_info,
   StringInfo *plaintext)
 {
-   size_t
-    i;
-
-   unsigned char
-    *p,
+  unsigned char
     *q;
 
   size_t
-    blocksize,
+    blocks,
     pad;
 
   StringInfo
     *ciphertext;
 
-  unsigned char
-    input_block[MaxCipherBlocksize];
-
   /*
-    Encipher in OBC mode.
+    Encipher in XTS mode.
   */
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
   WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
-  blocksize=cipher_info->blocksize;
-  WizardAssert(CipherDomain,blocksize != 0);
-  WizardAssert(CipherDomain,blocksize <= MaxCipherBlocksize);
+  WizardAssert(CipherDomain,cipher_info->blocksize == XTSBlocksize);
   WizardAssert(CipherDomain,plaintext != (StringInfo *) NULL);
   ciphertext=plaintext;
-  p=GetStringInfoDatum(cipher_info->nonce);
-  for (i=0; i < blocksize; i++)
-    input_block[i]=p[i];
   q=GetStringInfoDatum(plaintext)+GetStringInfoLength(plaintext);
-  pad=blocksize-GetStringInfoLength(plaintext) % blocksize;
+  pad=XTSBlocksize-GetStringInfoLength(plaintext) % XTSBlocksize;
   SetRandomKey(cipher_info->random_info,pad-1,q);
   q[pad-1]=(unsigned char) (pad-1);
-  if (pad == blocksize)
-    q+=blocksize;
-  for (p=GetStringInfoDatum(plaintext); p < q; p+=blocksize)
-  {
-    cipher_info->encipher_block(cipher_info->handle,input_block,input_block);
-    for (i=0; i < blocksize; i++)
-      p[i]^=input_block[i];
-  }
-  /*
-    Reset registers.
-  */
-  (void) ResetWizardMemory(input_block,0,sizeof(input_block));
+  blocks=(GetStringInfoLength(plaintext)+pad)/XTSBlocksize;
+  TransformXTSMode(cipher_info,GetStringInfoDatum(plaintext),blocks,
+    WizardTrue);
   return(ciphertext);
 }
-
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1301,6 +2791,41 @@ WizardExport StringInfo *GenerateCipherNonce(CipherInfo *cipher_info)
         GetStringInfoDatum(nonce));
       break;
     }
+    case GCMMode:
+    {
+      /*
+        A 96-bit random IV followed by the 32-bit block counter.
+      */
+      nonce=AcquireStringInfo(cipher_info->blocksize);
+      ResetStringInfo(nonce);
+      SetRandomKey(cipher_info->random_info,GCMNoncesize,
+        GetStringInfoDatum(nonce));
+      GetStringInfoDatum(nonce)[cipher_info->blocksize-1]=1;
+      break;
+    }
+    case Poly1305Mode:
+    {
+      /*
+        A 96-bit random nonce, the block counter starts at zero.
+      */
+      nonce=AcquireStringInfo(cipher_info->blocksize);
+      ResetStringInfo(nonce);
+      SetRandomKey(cipher_info->random_info,Poly1305Noncesize,
+        GetStringInfoDatum(nonce));
+      break;
+    }
+    case XTSMode:
+    {
+      /*
+        The nonce is the little-endian number of the first data unit, a
+        random high half leaves 2^64 units for the message.
+      */
+      nonce=AcquireStringInfo(cipher_info->blocksize);
+      ResetStringInfo(nonce);
+      SetRandomKey(cipher_info->random_info,cipher_info->blocksize/2,
+        GetStringInfoDatum(nonce)+cipher_info->blocksize/2);
+      break;
+    }
     default:
       ThrowWizardFatalError(CipherDomain,EnumerateError);
   }
@@ -1337,6 +2862,39 @@ WizardExport const StringInfo *GetCipherNonce(CipherInfo *cipher_info)
   return(cipher_info->nonce);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C i p h e r T a g                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetCipherTag() returns the authentication tag of the last message
+%  enciphered or deciphered in an authenticated mode, GCM or Poly1305, or NULL
+%  for the other modes.  After DecipherCipher(), compare it with the tag that
+%  accompanied the ciphertext before trusting the plaintext.
+%
+%  The format of the GetCipherTag method is:
+%
+%     const StringInfo *GetCipherTag(CipherInfo *cipher_info)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+*/
+WizardExport const StringInfo *GetCipherTag(CipherInfo *cipher_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  return(cipher_info->tag);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1367,6 +2925,46 @@ WizardExport void ResetCipherNonce(CipherInfo *cipher_info)
   ResetStringInfo(cipher_info->nonce);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t C i p h e r A d d i t i o n a l D a t a                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetCipherAdditionalData() sets the additional data authenticated, but not
+%  enciphered, with each message in the GCM and Poly1305 modes.  It applies
+%  until it is set again; NULL authenticates no additional data.
+%
+%  The format of the SetCipherAdditionalData method is:
+%
+%      SetCipherAdditionalData(CipherInfo *cipher_info,
+%        const StringInfo *additional_data)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o additional_data: The additional authenticated data.
+%
+*/
+WizardExport void SetCipherAdditionalData(CipherInfo *cipher_info,
+  const StringInfo *additional_data)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  if (cipher_info->additional_data != (StringInfo *) NULL)
+    cipher_info->additional_data=DestroyStringInfo(
+      cipher_info->additional_data);
+  if (additional_data != (StringInfo *) NULL)
+    cipher_info->additional_data=CloneStringInfo(additional_data);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1428,33 +3026,133 @@ WizardExport void SetCipherNonce(CipherInfo *cipher_info,
 */
 WizardExport void SetCipherKey(CipherInfo *cipher_info,const StringInfo *key)
 {
+  const StringInfo
+    *cipher_key;
+
+  StringInfo
+    *data_key;
+
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
   WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
   WizardAssert(CipherDomain,key != (StringInfo *) NULL);
+  cipher_key=key;
+  data_key=(StringInfo *) NULL;
+  if (cipher_info->mode == XTSMode)
+    {
+      StringInfo
+        *tweak_key;
+
+      /*
+        The first half of the key enciphers the data, the second the tweaks.
+      */
+      tweak_key=CloneStringInfo(key);
+      data_key=SplitStringInfo(tweak_key,GetStringInfoLength(key)/2);
+      SetCipherKey(cipher_info->tweak_info,tweak_key);
+      ResetStringInfo(tweak_key);
+      tweak_key=DestroyStringInfo(tweak_key);
+      cipher_key=data_key;
+    }
   switch (cipher_info->cipher)
   {
     case AESCipher:
     {
-      SetAESKey((AESInfo *) cipher_info->handle,key);
+      SetAESKey((AESInfo *) cipher_info->handle,cipher_key);
       break;
     }
     case ChachaCipher:
     {
-      SetChachaKey((ChachaInfo *) cipher_info->handle,key);
+      SetChachaKey((ChachaInfo *) cipher_info->handle,cipher_key);
       break;
     }
     case SerpentCipher:
     {
-      SetSerpentKey((SerpentInfo *) cipher_info->handle,key);
+      SetSerpentKey((SerpentInfo *) cipher_info->handle,cipher_key);
       break;
     }
     case TwofishCipher:
     {
-      SetTwofishKey((TwofishInfo *) cipher_info->handle,key);
+      SetTwofishKey((TwofishInfo *) cipher_info->handle,cipher_key);
       break;
     }
     default:
       ThrowWizardFatalError(CipherDomain,EnumerateError);
   }
+  if (data_key != (StringInfo *) NULL)
+    {
+      ResetStringInfo(data_key);
+      data_key=DestroyStringInfo(data_key);
+    }
+  if (cipher_info->mode == GCMMode)
+    SetGCMKey(cipher_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t C i p h e r T h r e a d s                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetCipherThreads() sets the maximum number of threads used to encipher or
+%  decipher in the CTR and ECB modes, or to decipher in the CBC and CFB modes.
+%  Each thread transforms a contiguous range of blocks.  A value of 1 disables
+%  the parallel path.
+%
+%  The format of the SetCipherThreads method is:
+%
+%      SetCipherThreads(CipherInfo *cipher_info,const size_t threads)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o threads: The maximum number of threads.
+%
+*/
+WizardExport void SetCipherThreads(CipherInfo *cipher_info,
+  const size_t threads)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  cipher_info->threads=threads == 0 ? 1 : threads;
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t C i p h e r T h r e s h o l d                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetCipherThreshold() sets the text length, in bytes, below which the cipher
+%  modes run in a single thread.
+%
+%  The format of the SetCipherThreshold method is:
+%
+%      SetCipherThreshold(CipherInfo *cipher_info,const size_t threshold)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o threshold: The text length in bytes.
+%
+*/
+WizardExport void SetCipherThreshold(CipherInfo *cipher_info,
+  const size_t threshold)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  cipher_info->threshold=threshold;
 }
@@ -33,7 +33,10 @@ typedef enum
   CFBMode,
   CTRMode,
   ECBMode,
-  OFBMode
+  OFBMode,
+  GCMMode,
+  Poly1305Mode,
+  XTSMode
 } CipherMode;
 
 typedef enum
@@ -54,11 +57,14 @@ extern WizardExport CipherInfo
   *DestroyCipherInfo(CipherInfo *);
 
 extern WizardExport const StringInfo
-  *GetCipherNonce(CipherInfo *);
+  *GetCipherNonce(CipherInfo *),
+  *GetCipherTag(CipherInfo *);
 
 extern WizardExport StringInfo
   *DecipherCipher(CipherInfo *,StringInfo *),
+  *DecipherCipherRange(CipherInfo *,StringInfo *,const WizardSizeType),
   *EncipherCipher(CipherInfo *,StringInfo *),
+  *EncipherCipherRange(CipherInfo *,StringInfo *,const WizardSizeType),
   *GenerateCipherNonce(CipherInfo *);
 
 extern WizardExport size_t
@@ -66,8 +72,11 @@ extern WizardExport size_t
 
 extern WizardExport void
   ResetCipherNonce(CipherInfo *),
+  SetCipherAdditionalData(CipherInfo *,const StringInfo *),
   SetCipherNonce(CipherInfo *,const StringInfo *),
-  SetCipherKey(CipherInfo *,const StringInfo *);
+  SetCipherKey(CipherInfo *,const StringInfo *),
+  SetCipherThreads(CipherInfo *,const size_t),
+  SetCipherThreshold(CipherInfo *,const size_t);
 
 /*
   Deprecated methods.
@@ -0,0 +1,149 @@
+/*
+  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard Toolkit private methods for runtime CPU feature detection.
+*/
+#ifndef _WIZARDSTOOLKIT_CPU_PRIVATE_H
+#define _WIZARDSTOOLKIT_CPU_PRIVATE_H
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/*
+  Instruction set extensions are compiled with per-function target attributes
+  and selected at runtime, so the library still runs on any x86 processor.
+  The <cpuid.h> of GCC 7, clang 6, and Apple clang 10 is the first to declare
+  __get_cpuid_count(); older compilers use the portable code.
+*/
+#if defined(__clang__)
+# if defined(__apple_build_version__)
+#  define WizardSIMDCompiler  (__clang_major__ >= 10)
+# else
+#  define WizardSIMDCompiler  (__clang_major__ >= 6)
+# endif
+#elif defined(__GNUC__)
+# define WizardSIMDCompiler  (__GNUC__ >= 7)
+#else
+# define WizardSIMDCompiler  0
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && WizardSIMDCompiler && \
+    !defined(WIZARDSTOOLKIT_DISABLE_SIMD)
+#define WIZARDSTOOLKIT_HAVE_X86_SIMD  1
+#include <cpuid.h>
+#include <immintrin.h>
+#define WizardTarget(extensions)  __attribute__((target(extensions)))
+#else
+#define WizardTarget(extensions)
+#endif
+
+typedef enum
+{
+  UndefinedCPUFeature = 0x0000,
+  SSE2CPUFeature = 0x0001,
+  SSSE3CPUFeature = 0x0002,
+  SSE41CPUFeature = 0x0004,
+  SSE42CPUFeature = 0x0008,
+  AESNICPUFeature = 0x0010,
+  CLMULCPUFeature = 0x0020,
+  AVXCPUFeature = 0x0040,
+  AVX2CPUFeature = 0x0080,
+  SHACPUFeature = 0x0100
+} CPUFeatureType;
+
+static inline size_t GetCPUFeatures(void)
+{
+  static size_t
+    cpu_features = ~0UL;
+
+  size_t
+    features;
+
+  /*
+    The features are probed once; the WIZARD_CPU_FEATURES environment variable
+    masks them (e.g. 0 forces the portable code paths).
+  */
+  if (cpu_features != ~0UL)
+    return(cpu_features);
+  features=UndefinedCPUFeature;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  {
+    const char
+      *mask;
+
+    unsigned int
+      eax,
+      ebx,
+      ecx,
+      edx;
+
+    if (__get_cpuid(1,&eax,&ebx,&ecx,&edx) != 0)
+      {
+        if ((edx & bit_SSE2) != 0)
+          features|=SSE2CPUFeature;
+        if ((ecx & bit_SSSE3) != 0)
+          features|=SSSE3CPUFeature;
+        if ((ecx & bit_SSE4_1) != 0)
+          features|=SSE41CPUFeature;
+        if ((ecx & bit_SSE4_2) != 0)
+          features|=SSE42CPUFeature;
+        if ((ecx & bit_AES) != 0)
+          features|=AESNICPUFeature;
+        if ((ecx & bit_PCLMUL) != 0)
+          features|=CLMULCPUFeature;
+        if (((ecx & bit_OSXSAVE) != 0) && ((ecx & bit_AVX) != 0))
+          {
+            unsigned int
+              xcr0_eax,
+              xcr0_edx;
+
+            /*
+              The OS must preserve the YMM registers across context switches.
+            */
+            __asm__ __volatile__ ("xgetbv" : "=a" (xcr0_eax), "=d" (xcr0_edx) :
+              "c" (0));
+            (void) xcr0_edx;
+            if ((xcr0_eax & 0x06) == 0x06)
+              features|=AVXCPUFeature;
+          }
+      }
+    if (__get_cpuid_count(7,0,&eax,&ebx,&ecx,&edx) != 0)
+      {
+        if (((features & AVXCPUFeature) != 0) && ((ebx & bit_AVX2) != 0))
+          features|=AVX2CPUFeature;
+        if ((ebx & bit_SHA) != 0)
+          features|=SHACPUFeature;
+      }
+    mask=getenv("WIZARD_CPU_FEATURES");
+    if (mask != (const char *) NULL)
+      features&=(size_t) strtoul(mask,(char **) NULL,0);
+  }
+#endif
+  cpu_features=features;
+  return(cpu_features);
+}
+
+static inline WizardBooleanType HasCPUFeature(const CPUFeatureType feature)
+{
+  if ((GetCPUFeatures() & feature) != feature)
+    return(WizardFalse);
+  return(WizardTrue);
+}
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,726 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                    CCCC  RRRR    CCCC  3333    222    CCCC                  %
+%                   C      R   R  C          3  2   2  C                      %
+%                   C      RRRR   C       333      2   C                      %
+%                   C      R R    C          3    2    C                      %
+%                    CCCC  R  R    CCCC  3333   22222   CCCC                  %
+%                                                                             %
+%                                                                             %
+%        Wizard's Toolkit Castagnoli Cyclic Redundancy Checksum Methods       %
+%                                                                             %
+%                             Software Design                                 %
+%                                 Cristy                                      %
+%                               March  2003                                   %
+%                                                                             %
+%                                                                             %
+%  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization         %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "wizard/studio.h"
+#include "wizard/cpu-private.h"
+#include "wizard/crc32c.h"
+#include "wizard/exception.h"
+#include "wizard/exception-private.h"
+#include "wizard/hash-private.h"
+#include "wizard/memory_.h"
+
+/*
+  Define declarations.
+*/
+#define CRC32CBlocksize  16
+#define CRC32CDigestsize  4
+#define CRC32CLong  8192
+#define CRC32CPolynomial  0x82f63b78U
+#define CRC32CShort  256
+#define CRC32CSlices  8
+
+/*
+  Typedef declarations.
+*/
+struct _CRC32CInfo
+{
+  unsigned int
+    digestsize,
+    blocksize;
+
+  StringInfo
+    *digest;
+
+  unsigned int
+    *crc_xor,
+    *long_shift,
+    *short_shift,
+    crc;
+
+  time_t
+    timestamp;
+
+  size_t
+    signature;
+};
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   A c q u i r e C R C 3 2 C I n f o                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireCRC32CInfo() allocate the CRC32CInfo structure.
+%
+%  The format of the AcquireCRC32CInfo method is:
+%
+%      CRC32CInfo *AcquireCRC32CInfo(void)
+%
+*/
+
+static unsigned int MultiplyCRC32C(unsigned int alpha,unsigned int beta)
+{
+  unsigned int
+    mask,
+    product;
+
+  /*
+    Multiply modulo the CRC32C polynomial, both operands bit-reflected.
+  */
+  product=0;
+  for (mask=0x80000000U; mask != 0; mask>>=1)
+  {
+    if ((alpha & mask) != 0)
+      product^=beta;
+    if ((beta & 0x01) != 0)
+      beta=(beta >> 1) ^ CRC32CPolynomial;
+    else
+      beta>>=1;
+  }
+  return(product);
+}
+
+static void SetCRC32CShift(unsigned int *shift,const size_t length)
+{
+  size_t
+    n;
+
+  ssize_t
+    i,
+    j;
+
+  unsigned int
+    alpha,
+    power;
+
+  /*
+    Each table advances one byte of the accumulator past length zero bytes,
+    i.e. multiplies it by x^(8*length).
+  */
+  power=0x80000000U;
+  alpha=0x00800000U;
+  for (n=length; n != 0; n>>=1)
+  {
+    if ((n & 0x01) != 0)
+      power=MultiplyCRC32C(power,alpha);
+    alpha=MultiplyCRC32C(alpha,alpha);
+  }
+  for (i=0; i < 4; i++)
+    for (j=0; j < 256; j++)
+      shift[256*i+j]=MultiplyCRC32C((unsigned int) j << (8*i),power);
+}
+
+WizardExport CRC32CInfo *AcquireCRC32CInfo(void)
+{
+  CRC32CInfo
+    *crc_info;
+
+  ssize_t
+    i,
+    j;
+
+  unsigned int
+    alpha;
+
+  crc_info=(CRC32CInfo *) AcquireWizardMemory(sizeof(*crc_info));
+  if (crc_info == (CRC32CInfo *) NULL)
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  (void) memset(crc_info,0,sizeof(*crc_info));
+  crc_info->digestsize=CRC32CDigestsize;
+  crc_info->blocksize=CRC32CBlocksize;
+  crc_info->digest=AcquireStringInfo(CRC32CDigestsize);
+  crc_info->crc_xor=(unsigned int *) AcquireQuantumMemory(CRC32CSlices*256UL,
+    sizeof(*crc_info->crc_xor));
+  crc_info->long_shift=(unsigned int *) AcquireQuantumMemory(4*256UL,
+    sizeof(*crc_info->long_shift));
+  crc_info->short_shift=(unsigned int *) AcquireQuantumMemory(4*256UL,
+    sizeof(*crc_info->short_shift));
+  if ((crc_info->crc_xor == (unsigned int *) NULL) ||
+      (crc_info->long_shift == (unsigned int *) NULL) ||
+      (crc_info->short_shift == (unsigned int *) NULL))
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  /*
+    Table k holds the CRC of each byte followed by k zero bytes so that 8
+    message bytes are folded into the accumulator at once.
+  */
+  for (i=0; i < 256; i++)
+  {
+    alpha=(unsigned int) i;
+    for (j=0; j < 8; j++)
+      if ((alpha & 0x01) != 0)
+        alpha=(alpha >> 1) ^ CRC32CPolynomial;
+      else
+        alpha>>=1;
+    crc_info->crc_xor[i]=alpha;
+  }
+  for (i=256; i < (ssize_t) (CRC32CSlices*256); i++)
+  {
+    alpha=crc_info->crc_xor[i-256];
+    crc_info->crc_xor[i]=(alpha >> 8) ^ crc_info->crc_xor[alpha & 0xff];
+  }
+  SetCRC32CShift(crc_info->long_shift,CRC32CLong);
+  SetCRC32CShift(crc_info->short_shift,CRC32CShort);
+  crc_info->crc=0xffffffffU;
+  crc_info->timestamp=time((time_t *) NULL);
+  crc_info->signature=WizardSignature;
+  return(crc_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y C R C 3 2 C I n f o                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyCRC32CInfo() zeros memory associated with the CRC32CInfo structure.
+%
+%  The format of the DestroyCRC32CInfo method is:
+%
+%      CRC32CInfo *DestroyCRC32CInfo(CRC32CInfo *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The crc info.
+%
+*/
+WizardExport CRC32CInfo *DestroyCRC32CInfo(CRC32CInfo *crc_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(crc_info != (CRC32CInfo *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  if (crc_info->digest != (StringInfo *) NULL)
+    crc_info->digest=DestroyStringInfo(crc_info->digest);
+  if (crc_info->short_shift != (unsigned int *) NULL)
+    crc_info->short_shift=(unsigned int *)
+      RelinquishWizardMemory(crc_info->short_shift);
+  if (crc_info->long_shift != (unsigned int *) NULL)
+    crc_info->long_shift=(unsigned int *)
+      RelinquishWizardMemory(crc_info->long_shift);
+  if (crc_info->crc_xor != (unsigned int *) NULL)
+    crc_info->crc_xor=(unsigned int *)
+      RelinquishWizardMemory(crc_info->crc_xor);
+  crc_info->signature=(~WizardSignature);
+  crc_info=(CRC32CInfo *) RelinquishWizardMemory(crc_info);
+  return(crc_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E x p o r t C R C 3 2 C S t a t e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportCRC32CState() returns the running CRC32C as a byte string so the check
+%  can be resumed later with ImportCRC32CState().
+%
+%  The format of the ExportCRC32CState method is:
+%
+%      StringInfo *ExportCRC32CState(const CRC32CInfo *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC32CInfo.
+%
+*/
+WizardExport StringInfo *ExportCRC32CState(const CRC32CInfo *crc_info)
+{
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(crc_info != (CRC32CInfo *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  state=AcquireStringInfo(4);
+  q=GetStringInfoDatum(state);
+  ExportHashWord(&q,crc_info->crc,4);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   F i n a l i z e C R C 3 2 C                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FinalizeCRC32C() finalizes the CRC32C message digest computation.
+%
+%  The format of the FinalizeCRC32C method is:
+%
+%      WizardBooleanType FinalizeCRC32C(CRC32CInfo *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC32CInfo.
+%
+*/
+WizardExport WizardBooleanType FinalizeCRC32C(CRC32CInfo *crc_info)
+{
+  unsigned char
+    *datum;
+
+  unsigned int
+    crc;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(crc_info != (CRC32CInfo *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  crc=crc_info->crc ^ 0xffffffffU;
+  datum=GetStringInfoDatum(crc_info->digest);
+  datum[0]=(unsigned char) (crc >> 24);
+  datum[1]=(unsigned char) (crc >> 16);
+  datum[2]=(unsigned char) (crc >> 8);
+  datum[3]=(unsigned char) (crc >> 0);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C R C 3 2 C B l o c k s i z e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetCRC32CBlocksize() returns the CRC32C blocksize.
+%
+%  The format of the GetCRC32CBlocksize method is:
+%
+%      unsigned int *GetCRC32CBlocksize(const CRC32CInfo *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The crc info.
+%
+*/
+WizardExport unsigned int GetCRC32CBlocksize(const CRC32CInfo *crc_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,crc_info != (CRC32CInfo *) NULL);
+  WizardAssert(HashDomain,crc_info->signature == WizardSignature);
+  return(crc_info->blocksize);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C R C 3 2 C C y c l i c R e d u n d a n c y C h e c k               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetCRC32CCyclicRedundancyCheck() returns the CRC32C cyclic redundancy check
+%  of the message so far.
+%
+%  The format of the GetCRC32CCyclicRedundancyCheck method is:
+%
+%      unsigned int GetCRC32CCyclicRedundancyCheck(
+%        const CRC32CInfo *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The crc info.
+%
+*/
+WizardExport unsigned int GetCRC32CCyclicRedundancyCheck(
+  const CRC32CInfo *crc_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,crc_info != (CRC32CInfo *) NULL);
+  WizardAssert(HashDomain,crc_info->signature == WizardSignature);
+  return(crc_info->crc ^ 0xffffffffU);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C R C 3 2 C D i g e s t                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetCRC32CDigest() returns the CRC32C digest.
+%
+%  The format of the GetCRC32CDigest method is:
+%
+%      const StringInfo *GetCRC32CDigest(const CRC32CInfo *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The crc info.
+%
+*/
+WizardExport const StringInfo *GetCRC32CDigest(const CRC32CInfo *crc_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,crc_info != (CRC32CInfo *) NULL);
+  WizardAssert(HashDomain,crc_info->signature == WizardSignature);
+  return(crc_info->digest);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t C R C 3 2 C D i g e s t s i z e                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetCRC32CDigestsize() returns the CRC32C digest size.
+%
+%  The format of the GetCRC32CDigestsize method is:
+%
+%      unsigned int *GetCRC32CDigestsize(const CRC32CInfo *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The crc info.
+%
+*/
+WizardExport unsigned int GetCRC32CDigestsize(const CRC32CInfo *crc_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,crc_info != (CRC32CInfo *) NULL);
+  WizardAssert(HashDomain,crc_info->signature == WizardSignature);
+  return(crc_info->digestsize);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t C R C 3 2 C S t a t e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportCRC32CState() restores a running CRC32C returned by
+%  ExportCRC32CState().  WizardFalse is returned if the state has the wrong
+%  length.
+%
+%  The format of the ImportCRC32CState method is:
+%
+%      WizardBooleanType ImportCRC32CState(CRC32CInfo *crc_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC32CInfo.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportCRC32CState(CRC32CInfo *crc_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  assert(crc_info != (CRC32CInfo *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) != 4)
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  crc_info->crc=(unsigned int) ImportHashWord(&p,4);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n i t i a l i z e C R C 3 2 C                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IntializeCRC32C() intializes the CRC32C digest.
+%
+%  The format of the InitializeCRC32C method is:
+%
+%      WizardBooleanType InitializeCRC32C(crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC32CInfo.
+%
+*/
+WizardExport WizardBooleanType InitializeCRC32C(CRC32CInfo *crc_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(crc_info != (CRC32CInfo *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  crc_info->crc=0xffffffffU;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e C R C 3 2 C                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateCRC32C() updates the CRC32C message digest.
+%
+%  The format of the UpdateCRC32C method is:
+%
+%      WizardBooleanType UpdateCRC32C(CRC32CInfo *crc_info,
+%        const StringInfo *message)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC32CInfo.
+%
+%    o message: The message.
+%
+*/
+WizardExport WizardBooleanType UpdateCRC32C(CRC32CInfo *crc_info,
+  const StringInfo *message)
+{
+  return(UpdateCRC32CBytes(crc_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e C R C 3 2 C B y t e s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateCRC32CBytes() updates the CRC32C accumulator from the caller's memory.
+%
+%  The format of the UpdateCRC32CBytes method is:
+%
+%      WizardBooleanType UpdateCRC32CBytes(CRC32CInfo *crc_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC32CInfo.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+
+static unsigned int UpdateCRC32CSlices(const unsigned int *crc_xor,
+  unsigned int crc,const unsigned char *p,size_t length)
+{
+  while (length >= 8)
+  {
+    crc=crc_xor[7*256+((crc ^ p[0]) & 0xff)] ^
+      crc_xor[6*256+(((crc >> 8) ^ p[1]) & 0xff)] ^
+      crc_xor[5*256+(((crc >> 16) ^ p[2]) & 0xff)] ^
+      crc_xor[4*256+(((crc >> 24) ^ p[3]) & 0xff)] ^
+      crc_xor[3*256+p[4]] ^ crc_xor[2*256+p[5]] ^ crc_xor[256+p[6]] ^
+      crc_xor[p[7]];
+    p+=8;
+    length-=8;
+  }
+  while (length != 0)
+  {
+    crc=(crc >> 8) ^ crc_xor[(crc ^ *p) & 0xff];
+    p++;
+    length--;
+  }
+  return(crc);
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD) && defined(__x86_64__)
+static inline WizardSizeType LoadCRC32CWord(const unsigned char *p)
+{
+  WizardSizeType
+    word;
+
+  (void) memcpy(&word,p,sizeof(word));
+  return(word);
+}
+
+static inline unsigned int ShiftCRC32C(const unsigned int *shift,
+  const unsigned int crc)
+{
+  return(shift[crc & 0xff] ^ shift[256+((crc >> 8) & 0xff)] ^
+    shift[512+((crc >> 16) & 0xff)] ^ shift[768+(crc >> 24)]);
+}
+
+static WizardTarget("sse4.2") unsigned int UpdateCRC32CSSE42(
+  const CRC32CInfo *crc_info,const unsigned int crc,const unsigned char *p,
+  size_t length)
+{
+  const unsigned char
+    *q;
+
+  WizardSizeType
+    crc0,
+    crc1,
+    crc2;
+
+  /*
+    The crc32 instruction has a latency of three cycles but issues every
+    cycle, so three adjacent runs are checked at once and their CRCs merged
+    with the shift tables.
+  */
+  crc0=crc;
+  while ((length != 0) && (((size_t) p & 0x07) != 0))
+  {
+    crc0=_mm_crc32_u8((unsigned int) crc0,*p);
+    p++;
+    length--;
+  }
+  while (length >= (3*CRC32CLong))
+  {
+    crc1=0;
+    crc2=0;
+    for (q=p+CRC32CLong; p < q; p+=8)
+    {
+      crc0=_mm_crc32_u64(crc0,LoadCRC32CWord(p));
+      crc1=_mm_crc32_u64(crc1,LoadCRC32CWord(p+CRC32CLong));
+      crc2=_mm_crc32_u64(crc2,LoadCRC32CWord(p+2*CRC32CLong));
+    }
+    crc0=ShiftCRC32C(crc_info->long_shift,(unsigned int) crc0) ^ crc1;
+    crc0=ShiftCRC32C(crc_info->long_shift,(unsigned int) crc0) ^ crc2;
+    p+=2*CRC32CLong;
+    length-=3*CRC32CLong;
+  }
+  while (length >= (3*CRC32CShort))
+  {
+    crc1=0;
+    crc2=0;
+    for (q=p+CRC32CShort; p < q; p+=8)
+    {
+      crc0=_mm_crc32_u64(crc0,LoadCRC32CWord(p));
+      crc1=_mm_crc32_u64(crc1,LoadCRC32CWord(p+CRC32CShort));
+      crc2=_mm_crc32_u64(crc2,LoadCRC32CWord(p+2*CRC32CShort));
+    }
+    crc0=ShiftCRC32C(crc_info->short_shift,(unsigned int) crc0) ^ crc1;
+    crc0=ShiftCRC32C(crc_info->short_shift,(unsigned int) crc0) ^ crc2;
+    p+=2*CRC32CShort;
+    length-=3*CRC32CShort;
+  }
+  while (length >= 8)
+  {
+    crc0=_mm_crc32_u64(crc0,LoadCRC32CWord(p));
+    p+=8;
+    length-=8;
+  }
+  while (length != 0)
+  {
+    crc0=_mm_crc32_u8((unsigned int) crc0,*p);
+    p++;
+    length--;
+  }
+  return((unsigned int) crc0);
+}
+#endif
+
+WizardExport WizardBooleanType UpdateCRC32CBytes(CRC32CInfo *crc_info,
+  const void *message,const size_t extent)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    length;
+
+  /*
+    Update the CRC32C accumulator.
+  */
+  assert(crc_info != (CRC32CInfo *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  p=(const unsigned char *) message;
+  length=extent;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD) && defined(__x86_64__)
+  if (HasCPUFeature(SSE42CPUFeature) != WizardFalse)
+    {
+      crc_info->crc=UpdateCRC32CSSE42(crc_info,crc_info->crc,p,length);
+      return(WizardTrue);
+    }
+#endif
+  crc_info->crc=UpdateCRC32CSlices(crc_info->crc_xor,crc_info->crc,p,length);
+  return(WizardTrue);
+}
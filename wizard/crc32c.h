@@ -0,0 +1,54 @@
+/*
+  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard's Toolkit Castagnoli cyclic redundancy checksum methods.
+*/
+#ifndef _WIZARDSTOOLKIT_CRC32C_H
+#define _WIZARDSTOOLKIT_CRC32C_H
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+typedef struct _CRC32CInfo
+  CRC32CInfo;
+
+extern WizardExport CRC32CInfo
+  *AcquireCRC32CInfo(void),
+  *DestroyCRC32CInfo(CRC32CInfo *);
+
+extern WizardExport StringInfo
+  *ExportCRC32CState(const CRC32CInfo *);
+
+extern WizardExport const StringInfo
+  *GetCRC32CDigest(const CRC32CInfo *);
+
+extern WizardExport unsigned int
+  GetCRC32CBlocksize(const CRC32CInfo *),
+  GetCRC32CCyclicRedundancyCheck(const CRC32CInfo *),
+  GetCRC32CDigestsize(const CRC32CInfo *);
+
+extern WizardExport WizardBooleanType
+  ImportCRC32CState(CRC32CInfo *,const StringInfo *),
+  InitializeCRC32C(CRC32CInfo *),
+  FinalizeCRC32C(CRC32CInfo *),
+  UpdateCRC32C(CRC32CInfo *,const StringInfo *),
+  UpdateCRC32CBytes(CRC32CInfo *,const void *,const size_t);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
@@ -39,9 +39,11 @@
   Include declarations.
 */
 #include "wizard/studio.h"
+#include "wizard/cpu-private.h"
 #include "wizard/crc64.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
 
 /*
@@ -49,6 +51,8 @@
 */
 #define CRC64Blocksize  32
 #define CRC64Digestsize  8
+#define CRC64Polynomial  WizardULLConstant(0xd800000000000000)
+#define CRC64Slices  16
 
 /*
   Typedef declarations.
@@ -96,6 +100,13 @@ WizardExport CRC64Info *AcquireCRC64Info(void)
   CRC64Info
     *crc_info;
 
+  ssize_t
+    i,
+    j;
+
+  WizardSizeType
+    alpha;
+
   crc_info=(CRC64Info *) AcquireWizardMemory(sizeof(*crc_info));
   if (crc_info == (CRC64Info *) NULL)
     ThrowWizardFatalError(HashDomain,MemoryError);
@@ -103,10 +114,29 @@ WizardExport CRC64Info *AcquireCRC64Info(void)
   crc_info->digestsize=CRC64Digestsize;
   crc_info->blocksize=CRC64Blocksize;
   crc_info->digest=AcquireStringInfo(CRC64Digestsize);
-  crc_info->crc_xor=(WizardSizeType *) AcquireQuantumMemory(256UL,
-    sizeof(*crc_info->crc_xor));
+  crc_info->crc_xor=(WizardSizeType *) AcquireQuantumMemory(CRC64Slices*
+    256UL,sizeof(*crc_info->crc_xor));
   if (crc_info->crc_xor == (WizardSizeType *) NULL)
     ThrowWizardFatalError(HashDomain,MemoryError);
+  /*
+    Table k holds the CRC of each byte followed by k zero bytes so that 16
+    message bytes are folded into the accumulator at once.
+  */
+  for (i=0; i < 256; i++)
+  {
+    alpha=(WizardSizeType) i;
+    for (j=0; j < 8; j++)
+      if ((alpha & 0x01) != 0)
+        alpha=(WizardSizeType) ((alpha >> 1) ^ CRC64Polynomial);
+      else
+        alpha>>=1;
+    crc_info->crc_xor[i]=alpha;
+  }
+  for (i=256; i < (ssize_t) (CRC64Slices*256); i++)
+  {
+    alpha=crc_info->crc_xor[i-256];
+    crc_info->crc_xor[i]=(alpha >> 8) ^ crc_info->crc_xor[alpha & 0xff];
+  }
   crc_info->timestamp=time((time_t *) NULL);
   crc_info->signature=WizardSignature;
   return(crc_info);
@@ -117,6 +147,80 @@ WizardExport CRC64Info *AcquireCRC64Info(void)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   C o m b i n e C R C 6 4                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CombineCRC64() returns the CRC64 of two concatenated messages given the
+%  CRC64 of each message and the length of the second, so that chunks of a
+%  stream can be checked independently and merged afterwards.
+%
+%  The format of the CombineCRC64 method is:
+%
+%      WizardSizeType CombineCRC64(const WizardSizeType crc,
+%        const WizardSizeType next_crc,const WizardSizeType length)
+%
+%  A description of each parameter follows:
+%
+%    o crc: The CRC64 of the first message.
+%
+%    o next_crc: The CRC64 of the second message.
+%
+%    o length: The length of the second message in bytes.
+%
+*/
+
+static WizardSizeType MultiplyCRC64(WizardSizeType alpha,WizardSizeType beta)
+{
+  WizardSizeType
+    mask,
+    product;
+
+  /*
+    Multiply modulo the CRC64 polynomial, both operands bit-reflected.
+  */
+  product=0;
+  for (mask=WizardULLConstant(0x8000000000000000); mask != 0; mask>>=1)
+  {
+    if ((alpha & mask) != 0)
+      product^=beta;
+    if ((beta & 0x01) != 0)
+      beta=(beta >> 1) ^ CRC64Polynomial;
+    else
+      beta>>=1;
+  }
+  return(product);
+}
+
+WizardExport WizardSizeType CombineCRC64(const WizardSizeType crc,
+  const WizardSizeType next_crc,const WizardSizeType length)
+{
+  WizardSizeType
+    n,
+    power,
+    shift;
+
+  /*
+    Shift the first CRC past the second message: multiply by x^(8*length).
+  */
+  power=WizardULLConstant(0x8000000000000000);
+  shift=WizardULLConstant(0x0080000000000000);
+  for (n=length; n != 0; n>>=1)
+  {
+    if ((n & 0x01) != 0)
+      power=MultiplyCRC64(power,shift);
+    shift=MultiplyCRC64(shift,shift);
+  }
+  return(MultiplyCRC64(crc,power) ^ next_crc);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   D e s t r o y C R C 6 4 I n f o                                           %
 %                                                                             %
 %                                                                             %
@@ -154,6 +258,45 @@ WizardExport CRC64Info *DestroyCRC64Info(CRC64Info *crc_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t C R C 6 4 S t a t e                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportCRC64State() returns the running CRC64 as a byte string so the check
+%  can be resumed later with ImportCRC64State().
+%
+%  The format of the ExportCRC64State method is:
+%
+%      StringInfo *ExportCRC64State(const CRC64Info *crc_info)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC64Info.
+%
+*/
+WizardExport StringInfo *ExportCRC64State(const CRC64Info *crc_info)
+{
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(crc_info != (CRC64Info *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  state=AcquireStringInfo(8);
+  q=GetStringInfoDatum(state);
+  ExportHashWord(&q,crc_info->crc,8);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e C R C 6 4                                                 %
 %                                                                             %
 %                                                                             %
@@ -318,6 +461,47 @@ WizardExport unsigned int GetCRC64Digestsize(const CRC64Info *crc64_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   I m p o r t C R C 6 4 S t a t e                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportCRC64State() restores a running CRC64 returned by ExportCRC64State().
+%  WizardFalse is returned if the state has the wrong length.
+%
+%  The format of the ImportCRC64State method is:
+%
+%      WizardBooleanType ImportCRC64State(CRC64Info *crc_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC64Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportCRC64State(CRC64Info *crc_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  assert(crc_info != (CRC64Info *) NULL);
+  assert(crc_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) != 8)
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  crc_info->crc=ImportHashWord(&p,8);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e C R C 6 4                                             %
 %                                                                             %
 %                                                                             %
@@ -337,13 +521,6 @@ WizardExport unsigned int GetCRC64Digestsize(const CRC64Info *crc64_info)
 */
 WizardExport WizardBooleanType InitializeCRC64(CRC64Info *crc_info)
 {
-   ssize_t
-    i,
-    j;
-
-  WizardSizeType
-    alpha;
-
   /*
     Load magic initialization constants.
   */
@@ -351,17 +528,6 @@ WizardExport WizardBooleanType InitializeCRC64(CRC64Info *crc_info)
   assert(crc_info != (CRC64Info *) NULL);
   assert(crc_info->signature == WizardSignature);
   crc_info->crc=0;
-  for (i=0; i < 256; i++)
-  {
-    alpha=(WizardSizeType) i;
-    for (j=0; j < 8; j++)
-      if ((alpha & 0x01) != 0)
-        alpha=(WizardSizeType) ((alpha >> 1) ^
-          WizardULLConstant(0xd800000000000000));
-      else
-        alpha>>=1;
-    crc_info->crc_xor[i]=alpha;
-  }
   return(WizardTrue);
 }
 
@@ -391,24 +557,167 @@ WizardExport WizardBooleanType InitializeCRC64(CRC64Info *crc_info)
 WizardExport WizardBooleanType UpdateCRC64(CRC64Info *crc_info,
   const StringInfo *message)
 {
-   const unsigned char
+  return(UpdateCRC64Bytes(crc_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e C R C 6 4 B y t e s                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateCRC64Bytes() updates the CRC64 accumulator from the caller's memory.
+%
+%  The format of the UpdateCRC64Bytes method is:
+%
+%      WizardBooleanType UpdateCRC64Bytes(CRC64Info *crc_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o crc_info: The address of a structure of type CRC64Info.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+
+static WizardSizeType UpdateCRC64Slices(const WizardSizeType *crc_xor,
+  WizardSizeType crc,const unsigned char *p,size_t length)
+{
+  while (length >= 16)
+  {
+    crc=crc_xor[15*256+((crc ^ p[0]) & 0xff)] ^
+      crc_xor[14*256+(((crc >> 8) ^ p[1]) & 0xff)] ^
+      crc_xor[13*256+(((crc >> 16) ^ p[2]) & 0xff)] ^
+      crc_xor[12*256+(((crc >> 24) ^ p[3]) & 0xff)] ^
+      crc_xor[11*256+(((crc >> 32) ^ p[4]) & 0xff)] ^
+      crc_xor[10*256+(((crc >> 40) ^ p[5]) & 0xff)] ^
+      crc_xor[9*256+(((crc >> 48) ^ p[6]) & 0xff)] ^
+      crc_xor[8*256+(((crc >> 56) ^ p[7]) & 0xff)] ^
+      crc_xor[7*256+p[8]] ^ crc_xor[6*256+p[9]] ^ crc_xor[5*256+p[10]] ^
+      crc_xor[4*256+p[11]] ^ crc_xor[3*256+p[12]] ^ crc_xor[2*256+p[13]] ^
+      crc_xor[256+p[14]] ^ crc_xor[p[15]];
+    p+=16;
+    length-=16;
+  }
+  while (length != 0)
+  {
+    crc=(crc >> 8) ^ crc_xor[(crc ^ (WizardSizeType) *p) & 0xff];
+    p++;
+    length--;
+  }
+  return(crc);
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static inline WizardTarget("pclmul,sse2") __m128i FoldCRC64CLMUL(
+  const __m128i x,const __m128i k,const __m128i y)
+{
+  return(_mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x,k,0x00),
+    _mm_clmulepi64_si128(x,k,0x11)),y));
+}
+
+static WizardTarget("pclmul,sse2") WizardSizeType UpdateCRC64CLMUL(
+  const WizardSizeType *crc_xor,WizardSizeType crc,const unsigned char *p,
+  size_t length)
+{
+  __m128i
+    fold128,
+    fold512,
+    x0,
+    x1,
+    x2,
+    x3;
+
+  unsigned char
+    block[16];
+
+  /*
+    Fold four 128-bit accumulators across the message with carry-less
+    multiplies by x^575, x^511 (mod P), then fold them together by x^191,
+    x^127.  The constants are bit-reflected to match the CRC.  The remaining
+    128 bits are reduced with the tables.  Length is a multiple of 16 and at
+    least 64.
+  */
+  fold128=_mm_set_epi64x((long long) WizardULLConstant(0xf500000000000001),
+    (long long) WizardULLConstant(0x6b70000000000001));
+  fold512=_mm_set_epi64x((long long) WizardULLConstant(0xb100010100000001),
+    (long long) WizardULLConstant(0x01b001b1b0000001));
+  x0=_mm_xor_si128(_mm_loadu_si128((const __m128i *) p),_mm_set_epi64x(0,
+    (long long) crc));
+  x1=_mm_loadu_si128((const __m128i *) (p+16));
+  x2=_mm_loadu_si128((const __m128i *) (p+32));
+  x3=_mm_loadu_si128((const __m128i *) (p+48));
+  p+=64;
+  length-=64;
+  while (length >= 64)
+  {
+    x0=FoldCRC64CLMUL(x0,fold512,_mm_loadu_si128((const __m128i *) p));
+    x1=FoldCRC64CLMUL(x1,fold512,_mm_loadu_si128((const __m128i *) (p+16)));
+    x2=FoldCRC64CLMUL(x2,fold512,_mm_loadu_si128((const __m128i *) (p+32)));
+    x3=FoldCRC64CLMUL(x3,fold512,_mm_loadu_si128((const __m128i *) (p+48)));
+    p+=64;
+    length-=64;
+  }
+  x0=FoldCRC64CLMUL(x0,fold128,x1);
+  x0=FoldCRC64CLMUL(x0,fold128,x2);
+  x0=FoldCRC64CLMUL(x0,fold128,x3);
+  while (length >= 16)
+  {
+    x0=FoldCRC64CLMUL(x0,fold128,_mm_loadu_si128((const __m128i *) p));
+    p+=16;
+    length-=16;
+  }
+  _mm_storeu_si128((__m128i *) block,x0);
+  crc=UpdateCRC64Slices(crc_xor,0,block,16);
+  /*
+    Reset working registers.
+  */
+  x0=_mm_setzero_si128();
+  x1=_mm_setzero_si128();
+  x2=_mm_setzero_si128();
+  x3=_mm_setzero_si128();
+  (void) memset(block,0,sizeof(block));
+  return(crc);
+}
+#endif
+
+WizardExport WizardBooleanType UpdateCRC64Bytes(CRC64Info *crc_info,
+  const void *message,const size_t extent)
+{
+  const unsigned char
     *p;
 
-   size_t
-    i;
+  size_t
+    length;
 
   /*
     Update the CRC64 accumulator.
   */
-  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   assert(crc_info != (CRC64Info *) NULL);
   assert(crc_info->signature == WizardSignature);
-  p=GetStringInfoDatum(message);
-  for (i=0; i < GetStringInfoLength(message); i++)
-  {
-    crc_info->crc=(crc_info->crc >> 8) ^
-      crc_info->crc_xor[(crc_info->crc ^ (WizardSizeType) *p) & 0xff];
-    p++;
-  }
+  p=(const unsigned char *) message;
+  length=extent;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if ((length >= 64) && (HasCPUFeature(CLMULCPUFeature) != WizardFalse))
+    {
+      size_t
+        n;
+
+      n=length & ~((size_t) 15);
+      crc_info->crc=UpdateCRC64CLMUL(crc_info->crc_xor,crc_info->crc,p,n);
+      p+=n;
+      length-=n;
+    }
+#endif
+  crc_info->crc=UpdateCRC64Slices(crc_info->crc_xor,crc_info->crc,p,length);
   return(WizardTrue);
 }
@@ -29,6 +29,9 @@ extern WizardExport CRC64Info
   *AcquireCRC64Info(void),
   *DestroyCRC64Info(CRC64Info *);
 
+extern WizardExport StringInfo
+  *ExportCRC64State(const CRC64Info *);
+
 extern WizardExport const StringInfo
   *GetCRC64Digest(const CRC64Info *);
 
@@ -37,11 +40,14 @@ extern WizardExport unsigned int
   GetCRC64Digestsize(const CRC64Info *);
 
 extern WizardExport WizardBooleanType
+  ImportCRC64State(CRC64Info *,const StringInfo *),
   InitializeCRC64(CRC64Info *),
   FinalizeCRC64(CRC64Info *),
-  UpdateCRC64(CRC64Info *,const StringInfo *);
+  UpdateCRC64(CRC64Info *,const StringInfo *),
+  UpdateCRC64Bytes(CRC64Info *,const void *,const size_t);
 
 extern WizardExport WizardSizeType
+  CombineCRC64(const WizardSizeType,const WizardSizeType,const WizardSizeType),
   GetCRC64CyclicRedundancyCheck(const CRC64Info *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
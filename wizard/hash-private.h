@@ -0,0 +1,119 @@
+/*
+  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard's Toolkit private secure hash algorithm methods.
+*/
+#ifndef _WIZARDSTOOLKIT_HASH_PRIVATE_H
+#define _WIZARDSTOOLKIT_HASH_PRIVATE_H
+
+#include "wizard/cpu-private.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/*
+  A lanes transform advances HashLanes independent accumulators, each by the
+  same number of 64-byte blocks read from its own message.  Word i of lane j
+  is kept at accumulator[HashLanes*i+j] so a word of every lane is one vector.
+*/
+#define HashLanes  8
+
+typedef void
+  (*HashLanesTransformMethod)(unsigned int *,const unsigned char **,
+    const size_t);
+
+extern WizardExport HashLanesTransformMethod
+  GetMD5LanesTransform(void),
+  GetSHA1LanesTransform(void),
+  GetSHA2256LanesTransform(void);
+
+/*
+  Exported hash states store each word least-significant byte first, so a
+  state saved on one host resumes on any other.
+*/
+static inline void ExportHashWord(unsigned char **q,const WizardSizeType value,
+  const size_t octets)
+{
+  size_t
+    i;
+
+  for (i=0; i < octets; i++)
+    *(*q)++=(unsigned char) (value >> (8*i));
+}
+
+static inline WizardSizeType ImportHashWord(const unsigned char **p,
+  const size_t octets)
+{
+  size_t
+    i;
+
+  WizardSizeType
+    value;
+
+  value=0;
+  for (i=0; i < octets; i++)
+    value|=((WizardSizeType) *(*p)++) << (8*i);
+  return(value);
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+#define RotateLeftAVX2(x,n)  _mm256_or_si256(_mm256_slli_epi32(x,n), \
+  _mm256_srli_epi32(x,32-(n)))
+
+static inline WizardTarget("avx2") void LoadHashLanesAVX2(
+  const unsigned char **message,const size_t offset,__m256i *W)
+{
+  __m256i
+    T[8],
+    U[8];
+
+  size_t
+    i,
+    j;
+
+  /*
+    Transpose the 64-byte block at offset of each lane so that W[i] holds
+    message word i of all eight lanes.
+  */
+  for (i=0; i < 2; i++)
+  {
+    for (j=0; j < HashLanes; j++)
+      W[8*i+j]=_mm256_loadu_si256((const __m256i *) (message[j]+offset+32*i));
+    for (j=0; j < HashLanes; j+=4)
+    {
+      T[j]=_mm256_unpacklo_epi32(W[8*i+j],W[8*i+j+1]);
+      T[j+1]=_mm256_unpackhi_epi32(W[8*i+j],W[8*i+j+1]);
+      T[j+2]=_mm256_unpacklo_epi32(W[8*i+j+2],W[8*i+j+3]);
+      T[j+3]=_mm256_unpackhi_epi32(W[8*i+j+2],W[8*i+j+3]);
+      U[j]=_mm256_unpacklo_epi64(T[j],T[j+2]);
+      U[j+1]=_mm256_unpackhi_epi64(T[j],T[j+2]);
+      U[j+2]=_mm256_unpacklo_epi64(T[j+1],T[j+3]);
+      U[j+3]=_mm256_unpackhi_epi64(T[j+1],T[j+3]);
+    }
+    for (j=0; j < 4; j++)
+    {
+      W[8*i+j]=_mm256_permute2x128_si256(U[j],U[j+4],0x20);
+      W[8*i+j+4]=_mm256_permute2x128_si256(U[j],U[j+4],0x31);
+    }
+  }
+}
+#endif
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
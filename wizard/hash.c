@@ -40,11 +40,15 @@
   Include declarations.
 */
 #include "wizard/studio.h"
+#include "wizard/blake3.h"
+#include "wizard/crc32c.h"
 #include "wizard/crc64.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
 #include "wizard/hash.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
+#include "wizard/merkle.h"
 #include "wizard/md5.h"
 #include "wizard/sha1.h"
 #include "wizard/sha2224.h"
@@ -53,9 +57,67 @@
 #include "wizard/sha2512.h"
 #include "wizard/sha3.h"
 
+/*
+  Define declarations.
+*/
+#define HashStateHeaderSize  8
+#define HashStateMagic  0x53485457UL
+
 /*
   Typedef declarations.
 */
+struct _HashBatchInfo
+{
+  HashType
+    hash;
+
+  HashLanesTransformMethod
+    transform;
+
+  HashInfo
+    *hash_info;
+
+  size_t
+    digestsize,
+    lanes,
+    words;
+
+  unsigned int
+    accumulator[8*HashLanes];
+
+  const unsigned char
+    *message[HashLanes];
+
+  unsigned char
+    tail[HashLanes][128];
+
+  size_t
+    blocks[HashLanes],
+    id[HashLanes],
+    tail_blocks[HashLanes];
+
+  WizardBooleanType
+    active[HashLanes];
+
+  unsigned char
+    *digests;
+
+  size_t
+    *ids,
+    head,
+    number_digests,
+    extent;
+
+  StringInfo
+    *digest;
+
+  time_t
+    timestamp;
+
+  size_t
+    signature;
+};
+
 struct _HashInfo
 {   
   HashType
@@ -79,6 +141,77 @@ struct _HashInfo
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   A c q u i r e H a s h B a t c h I n f o                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireHashBatchInfo() allocates a HashBatchInfo structure that hashes many
+%  independent messages of the same hash type together.  MD5, SHA1, and
+%  SHA2256 messages are interleaved across SIMD lanes where the processor
+%  supports it; other hashes, or processors without lanes, hash one message
+%  at a time.
+%
+%  The format of the AcquireHashBatchInfo method is:
+%
+%      HashBatchInfo *AcquireHashBatchInfo(const HashType hash)
+%
+%  A description of each parameter follows:
+%
+%    o hash: The hash type.
+%
+*/
+WizardExport HashBatchInfo *AcquireHashBatchInfo(const HashType hash)
+{
+  HashBatchInfo
+    *batch_info;
+
+  batch_info=(HashBatchInfo *) AcquireWizardMemory(sizeof(*batch_info));
+  if (batch_info == (HashBatchInfo *) NULL)
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  (void) memset(batch_info,0,sizeof(*batch_info));
+  batch_info->hash=hash;
+  batch_info->hash_info=AcquireHashInfo(hash);
+  batch_info->digestsize=GetHashDigestsize(batch_info->hash_info);
+  switch (hash)
+  {
+    case MD5Hash:
+    {
+      batch_info->transform=GetMD5LanesTransform();
+      batch_info->words=4;
+      break;
+    }
+    case SHA1Hash:
+    {
+      batch_info->transform=GetSHA1LanesTransform();
+      batch_info->words=5;
+      break;
+    }
+    case SHA2256Hash:
+    case SHA2Hash:
+    {
+      batch_info->transform=GetSHA2256LanesTransform();
+      batch_info->words=8;
+      break;
+    }
+    default:
+      break;
+  }
+  batch_info->lanes=1;
+  if (batch_info->transform != (HashLanesTransformMethod) NULL)
+    batch_info->lanes=HashLanes;
+  batch_info->digest=AcquireStringInfo(batch_info->digestsize);
+  batch_info->timestamp=time((time_t *) NULL);
+  batch_info->signature=WizardSignature;
+  return(batch_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   A c q u i r e H a s h I n f o                                             %
 %                                                                             %
 %                                                                             %
@@ -111,6 +244,26 @@ WizardExport HashInfo *AcquireHashInfo(const HashType hash)
   hash_info->hash=hash;
   switch (hash_info->hash)
   {
+    case BLAKE3Hash:
+    {
+      BLAKE3Info
+        *blake_info;
+
+      blake_info=AcquireBLAKE3Info();
+      hash_info->handle=(HashInfo *) blake_info;
+      digestsize=GetBLAKE3Digestsize(blake_info);
+      break;
+    }
+    case CRC32CHash:
+    {
+      CRC32CInfo
+        *crc_info;
+
+      crc_info=AcquireCRC32CInfo();
+      hash_info->handle=(HashInfo *) crc_info;
+      digestsize=GetCRC32CDigestsize(crc_info);
+      break;
+    }
     case CRC64Hash:
     {
       CRC64Info
@@ -162,6 +315,16 @@ WizardExport HashInfo *AcquireHashInfo(const HashType hash)
       digestsize=GetSHA2256Digestsize(sha_info);
       break;
     }
+    case SHA2256TreeHash:
+    {
+      MerkleInfo
+        *merkle_info;
+
+      merkle_info=AcquireMerkleInfo(SHA2256Hash);
+      hash_info->handle=(HashInfo *) merkle_info;
+      digestsize=GetMerkleDigestsize(merkle_info);
+      break;
+    }
     case SHA2384Hash:
     {
       SHA2384Info
@@ -211,6 +374,100 @@ WizardExport HashInfo *AcquireHashInfo(const HashType hash)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   C l o n e H a s h I n f o                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CloneHashInfo() returns a copy of the hash, including its in-progress
+%  state.  Both copies may then be updated independently, for example to
+%  finish a shared prefix with several different suffixes.
+%
+%  The format of the CloneHashInfo method is:
+%
+%      HashInfo *CloneHashInfo(const HashInfo *hash_info)
+%
+%  A description of each parameter follows:
+%
+%    o hash_info: The hash info.
+%
+*/
+WizardExport HashInfo *CloneHashInfo(const HashInfo *hash_info)
+{
+  HashInfo
+    *clone_info;
+
+  StringInfo
+    *state;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(hash_info != (HashInfo *) NULL);
+  assert(hash_info->signature == WizardSignature);
+  clone_info=AcquireHashInfo(hash_info->hash);
+  /*
+    A hash that was never initialized yields an initialized clone.
+  */
+  (void) InitializeHash(clone_info);
+  state=ExportHashState(hash_info);
+  (void) ImportHashState(clone_info,state);
+  state=DestroyStringInfo(state);
+  SetStringInfo(clone_info->digest,hash_info->digest);
+  return(clone_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y H a s h B a t c h I n f o                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyHashBatchInfo() zeros memory associated with the HashBatchInfo
+%  structure.  Messages still in flight are discarded.
+%
+%  The format of the DestroyHashBatchInfo method is:
+%
+%      HashBatchInfo *DestroyHashBatchInfo(HashBatchInfo *batch_info)
+%
+%  A description of each parameter follows:
+%
+%    o batch_info: The hash batch info.
+%
+*/
+WizardExport HashBatchInfo *DestroyHashBatchInfo(HashBatchInfo *batch_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(batch_info != (HashBatchInfo *) NULL);
+  assert(batch_info->signature == WizardSignature);
+  if (batch_info->digests != (unsigned char *) NULL)
+    {
+      (void) memset(batch_info->digests,0,batch_info->extent*
+        batch_info->digestsize);
+      batch_info->digests=(unsigned char *) RelinquishWizardMemory(
+        batch_info->digests);
+    }
+  if (batch_info->ids != (size_t *) NULL)
+    batch_info->ids=(size_t *) RelinquishWizardMemory(batch_info->ids);
+  if (batch_info->digest != (StringInfo *) NULL)
+    batch_info->digest=DestroyStringInfo(batch_info->digest);
+  batch_info->hash_info=DestroyHashInfo(batch_info->hash_info);
+  (void) memset(batch_info->accumulator,0,sizeof(batch_info->accumulator));
+  (void) memset(batch_info->tail,0,sizeof(batch_info->tail));
+  batch_info->signature=(~WizardSignature);
+  batch_info=(HashBatchInfo *) RelinquishWizardMemory(batch_info);
+  return(batch_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   D e s t r o y H a s h I n f o                                             %
 %                                                                             %
 %                                                                             %
@@ -236,6 +493,18 @@ WizardExport HashInfo *DestroyHashInfo(HashInfo *hash_info)
   if (hash_info->handle != (HashInfo *) NULL)
     switch (hash_info->hash)
     {
+      case BLAKE3Hash:
+      {
+        hash_info->handle=(void *) DestroyBLAKE3Info((BLAKE3Info *)
+          hash_info->handle);
+        break;
+      }
+      case CRC32CHash:
+      {
+        hash_info->handle=(void *) DestroyCRC32CInfo((CRC32CInfo *)
+          hash_info->handle);
+        break;
+      }
       case CRC64Hash:
       {
         hash_info->handle=(void *) DestroyCRC64Info((CRC64Info *)
@@ -267,6 +536,12 @@ WizardExport HashInfo *DestroyHashInfo(HashInfo *hash_info)
           hash_info->handle);
         break;
       }
+      case SHA2256TreeHash:
+      {
+        hash_info->handle=(void *) DestroyMerkleInfo((MerkleInfo *)
+          hash_info->handle);
+        break;
+      }
       case SHA2384Hash:
       {
         hash_info->handle=(void *) DestroySHA2384Info((SHA2384Info *)
@@ -304,6 +579,123 @@ WizardExport HashInfo *DestroyHashInfo(HashInfo *hash_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t H a s h S t a t e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportHashState() returns the in-progress state of the hash as a byte
+%  string.  Save it to checkpoint a long computation and pass it to
+%  ImportHashState(), in this or a later process, to resume where it left
+%  off.  The state is tagged with the hash type and its words are stored in
+%  a byte order independent of the host.
+%
+%  The format of the ExportHashState method is:
+%
+%      StringInfo *ExportHashState(const HashInfo *hash_info)
+%
+%  A description of each parameter follows:
+%
+%    o hash_info: The hash info.
+%
+*/
+WizardExport StringInfo *ExportHashState(const HashInfo *hash_info)
+{
+  StringInfo
+    *payload,
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(hash_info != (HashInfo *) NULL);
+  assert(hash_info->signature == WizardSignature);
+  payload=(StringInfo *) NULL;
+  switch (hash_info->hash)
+  {
+    case BLAKE3Hash:
+    {
+      payload=ExportBLAKE3State((BLAKE3Info *) hash_info->handle);
+      break;
+    }
+    case CRC32CHash:
+    {
+      payload=ExportCRC32CState((CRC32CInfo *) hash_info->handle);
+      break;
+    }
+    case CRC64Hash:
+    {
+      payload=ExportCRC64State((CRC64Info *) hash_info->handle);
+      break;
+    }
+    case MD5Hash:
+    {
+      payload=ExportMD5State((MD5Info *) hash_info->handle);
+      break;
+    }
+    case SHA1Hash:
+    {
+      payload=ExportSHA1State((SHA1Info *) hash_info->handle);
+      break;
+    }
+    case SHA2224Hash:
+    {
+      payload=ExportSHA2224State((SHA2224Info *) hash_info->handle);
+      break;
+    }
+    case SHA2256Hash:
+    case SHA2Hash:
+    {
+      payload=ExportSHA2256State((SHA2256Info *) hash_info->handle);
+      break;
+    }
+    case SHA2256TreeHash:
+    {
+      payload=ExportMerkleState((MerkleInfo *) hash_info->handle);
+      break;
+    }
+    case SHA2384Hash:
+    {
+      payload=ExportSHA2384State((SHA2384Info *) hash_info->handle);
+      break;
+    }
+    case SHA2512Hash:
+    {
+      payload=ExportSHA2512State((SHA2512Info *) hash_info->handle);
+      break;
+    }
+    case SHA3Hash:
+    case SHA3224Hash:
+    case SHA3256Hash:
+    case SHA3384Hash:
+    case SHA3512Hash:
+    {
+      payload=ExportSHA3State((SHA3Info *) hash_info->handle);
+      break;
+    }
+    default:
+    {
+      break;
+    }
+  }
+  state=AcquireStringInfo(HashStateHeaderSize);
+  q=GetStringInfoDatum(state);
+  ExportHashWord(&q,HashStateMagic,4);
+  ExportHashWord(&q,(WizardSizeType) hash_info->hash,4);
+  if (payload != (StringInfo *) NULL)
+    {
+      ConcatenateStringInfo(state,payload);
+      payload=DestroyStringInfo(payload);
+    }
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e H a s h                                                   %
 %                                                                             %
 %                                                                             %
@@ -334,6 +726,26 @@ WizardExport WizardBooleanType FinalizeHash(HashInfo *hash_info)
   assert(hash_info->signature == WizardSignature);
   switch (hash_info->hash)
   {
+    case BLAKE3Hash:
+    {
+      BLAKE3Info
+        *blake_info;
+
+      blake_info=(BLAKE3Info *) hash_info->handle;
+      status=FinalizeBLAKE3(blake_info);
+      SetStringInfo(hash_info->digest,GetBLAKE3Digest(blake_info));
+      break;
+    }
+    case CRC32CHash:
+    {
+      CRC32CInfo
+        *crc_info;
+
+      crc_info=(CRC32CInfo *) hash_info->handle;
+      status=FinalizeCRC32C(crc_info);
+      SetStringInfo(hash_info->digest,GetCRC32CDigest(crc_info));
+      break;
+    }
     case CRC64Hash:
     {
       CRC64Info
@@ -385,6 +797,16 @@ WizardExport WizardBooleanType FinalizeHash(HashInfo *hash_info)
       SetStringInfo(hash_info->digest,GetSHA2256Digest(sha_info));
       break;
     }
+    case SHA2256TreeHash:
+    {
+      MerkleInfo
+        *merkle_info;
+
+      merkle_info=(MerkleInfo *) hash_info->handle;
+      status=FinalizeMerkle(merkle_info);
+      SetStringInfo(hash_info->digest,GetMerkleDigest(merkle_info));
+      break;
+    }
     case SHA2384Hash:
     {
       SHA2384Info
@@ -414,18 +836,249 @@ WizardExport WizardBooleanType FinalizeHash(HashInfo *hash_info)
       SHA3Info
         *sha_info;
 
-      sha_info=(SHA3Info *) hash_info->handle;
-      status=FinalizeSHA3(sha_info);
-      SetStringInfo(hash_info->digest,GetSHA3Digest(sha_info));
+      sha_info=(SHA3Info *) hash_info->handle;
+      status=FinalizeSHA3(sha_info);
+      SetStringInfo(hash_info->digest,GetSHA3Digest(sha_info));
+      break;
+    }
+    default:
+    {
+      status=WizardFalse;
+      break;
+    }
+  }
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   F l u s h H a s h B a t c h                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FlushHashBatch() runs every message still in the batch to completion so
+%  that all their digests are available from GetHashBatchDigest().
+%
+%  The format of the FlushHashBatch method is:
+%
+%      WizardBooleanType FlushHashBatch(HashBatchInfo *batch_info)
+%
+%  A description of each parameter follows:
+%
+%    o batch_info: The hash batch info.
+%
+*/
+
+static void EnqueueHashDigest(HashBatchInfo *batch_info,const size_t id,
+  const unsigned char *digest)
+{
+  if (batch_info->head == batch_info->number_digests)
+    {
+      batch_info->head=0;
+      batch_info->number_digests=0;
+    }
+  if (batch_info->number_digests == batch_info->extent)
+    {
+      batch_info->extent=2*batch_info->extent+HashLanes;
+      batch_info->digests=(unsigned char *) ResizeQuantumMemory(
+        batch_info->digests,batch_info->extent,batch_info->digestsize);
+      batch_info->ids=(size_t *) ResizeQuantumMemory(batch_info->ids,
+        batch_info->extent,sizeof(*batch_info->ids));
+      if ((batch_info->digests == (unsigned char *) NULL) ||
+          (batch_info->ids == (size_t *) NULL))
+        ThrowWizardFatalError(HashDomain,MemoryError);
+    }
+  (void) memcpy(batch_info->digests+batch_info->number_digests*
+    batch_info->digestsize,digest,batch_info->digestsize);
+  batch_info->ids[batch_info->number_digests++]=id;
+}
+
+static void CompleteHashLane(HashBatchInfo *batch_info,const size_t lane)
+{
+  size_t
+    i;
+
+  unsigned char
+    digest[32],
+    *q;
+
+  unsigned int
+    word;
+
+  /*
+    MD5 stores its accumulator little-endian, SHA big-endian.
+  */
+  q=digest;
+  for (i=0; i < batch_info->words; i++)
+  {
+    word=batch_info->accumulator[HashLanes*i+lane];
+    if (batch_info->hash == MD5Hash)
+      {
+        *q++=(unsigned char) (word & 0xff);
+        *q++=(unsigned char) ((word >> 8) & 0xff);
+        *q++=(unsigned char) ((word >> 16) & 0xff);
+        *q++=(unsigned char) ((word >> 24) & 0xff);
+      }
+    else
+      {
+        *q++=(unsigned char) ((word >> 24) & 0xff);
+        *q++=(unsigned char) ((word >> 16) & 0xff);
+        *q++=(unsigned char) ((word >> 8) & 0xff);
+        *q++=(unsigned char) (word & 0xff);
+      }
+  }
+  EnqueueHashDigest(batch_info,batch_info->id[lane],digest);
+  batch_info->active[lane]=WizardFalse;
+  batch_info->message[lane]=(const unsigned char *) NULL;
+  (void) memset(batch_info->tail[lane],0,sizeof(batch_info->tail[lane]));
+  (void) memset(digest,0,sizeof(digest));
+  word=0;
+}
+
+static void AdvanceHashBatch(HashBatchInfo *batch_info,
+  const WizardBooleanType flush)
+{
+  const unsigned char
+    *message[HashLanes];
+
+  size_t
+    blocks,
+    completed,
+    i,
+    lane;
+
+  /*
+    Run all lanes for as many blocks as the shortest one has left, then refill
+    or retire the lanes that ran dry.  Idle lanes hash a busy lane's message;
+    their results are never read.
+  */
+  for (completed=0; ; )
+  {
+    blocks=0;
+    lane=0;
+    for (i=0; i < batch_info->lanes; i++)
+      if ((batch_info->active[i] != WizardFalse) &&
+          ((blocks == 0) || (batch_info->blocks[i] < blocks)))
+        {
+          blocks=batch_info->blocks[i];
+          lane=i;
+        }
+    if (blocks == 0)
       break;
-    }
-    default:
-    {
-      status=WizardFalse;
+    if ((flush == WizardFalse) && (completed != 0))
       break;
+    for (i=0; i < batch_info->lanes; i++)
+      message[i]=batch_info->active[i] != WizardFalse ?
+        batch_info->message[i] : batch_info->message[lane];
+    batch_info->transform(batch_info->accumulator,message,blocks);
+    for (i=0; i < batch_info->lanes; i++)
+    {
+      if (batch_info->active[i] == WizardFalse)
+        continue;
+      batch_info->message[i]+=64*blocks;
+      batch_info->blocks[i]-=blocks;
+      if (batch_info->blocks[i] != 0)
+        continue;
+      if (batch_info->tail_blocks[i] != 0)
+        {
+          batch_info->message[i]=batch_info->tail[i];
+          batch_info->blocks[i]=batch_info->tail_blocks[i];
+          batch_info->tail_blocks[i]=0;
+          continue;
+        }
+      CompleteHashLane(batch_info,i);
+      completed++;
     }
   }
-  return(status);
+}
+
+WizardExport WizardBooleanType FlushHashBatch(HashBatchInfo *batch_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(batch_info != (HashBatchInfo *) NULL);
+  assert(batch_info->signature == WizardSignature);
+  if (batch_info->transform != (HashLanesTransformMethod) NULL)
+    AdvanceHashBatch(batch_info,WizardTrue);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t H a s h B a t c h D i g e s t                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetHashBatchDigest() returns the digest of the next completed message, in
+%  the order they complete, or NULL if none are waiting.  The digest is valid
+%  until the next call that uses the batch.
+%
+%  The format of the GetHashBatchDigest method is:
+%
+%      const StringInfo *GetHashBatchDigest(HashBatchInfo *batch_info,
+%        size_t *id)
+%
+%  A description of each parameter follows:
+%
+%    o batch_info: The hash batch info.
+%
+%    o id: Return the identifier the message was submitted with.
+%
+*/
+WizardExport const StringInfo *GetHashBatchDigest(HashBatchInfo *batch_info,
+  size_t *id)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(batch_info != (HashBatchInfo *) NULL);
+  assert(batch_info->signature == WizardSignature);
+  if (batch_info->head == batch_info->number_digests)
+    return((const StringInfo *) NULL);
+  SetStringInfoDatum(batch_info->digest,batch_info->digests+batch_info->head*
+    batch_info->digestsize);
+  if (id != (size_t *) NULL)
+    *id=batch_info->ids[batch_info->head];
+  batch_info->head++;
+  return(batch_info->digest);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t H a s h B a t c h L a n e s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetHashBatchLanes() returns the number of messages the batch hashes at
+%  once.
+%
+%  The format of the GetHashBatchLanes method is:
+%
+%      size_t GetHashBatchLanes(const HashBatchInfo *batch_info)
+%
+%  A description of each parameter follows:
+%
+%    o batch_info: The hash batch info.
+%
+*/
+WizardExport size_t GetHashBatchLanes(const HashBatchInfo *batch_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(batch_info != (HashBatchInfo *) NULL);
+  assert(batch_info->signature == WizardSignature);
+  return(batch_info->lanes);
 }
 
 /*
@@ -460,6 +1113,24 @@ WizardExport size_t GetHashBlocksize(const HashInfo *hash_info)
   WizardAssert(CipherDomain,hash_info->signature == WizardSignature);
   switch (hash_info->hash)
   {
+    case BLAKE3Hash:
+    {
+      BLAKE3Info
+        *blake_info;
+
+      blake_info=(BLAKE3Info *) hash_info->handle;
+      blocksize=GetBLAKE3Blocksize(blake_info);
+      break;
+    }
+    case CRC32CHash:
+    {
+      CRC32CInfo
+        *crc_info;
+
+      crc_info=(CRC32CInfo *) hash_info->handle;
+      blocksize=GetCRC32CBlocksize(crc_info);
+      break;
+    }
     case CRC64Hash:
     {
       CRC64Info
@@ -506,6 +1177,15 @@ WizardExport size_t GetHashBlocksize(const HashInfo *hash_info)
       blocksize=GetSHA2256Blocksize(sha_info);
       break;
     }
+    case SHA2256TreeHash:
+    {
+      MerkleInfo
+        *merkle_info;
+
+      merkle_info=(MerkleInfo *) hash_info->handle;
+      blocksize=GetMerkleBlocksize(merkle_info);
+      break;
+    }
     case SHA2384Hash:
     {
       SHA2384Info
@@ -605,6 +1285,24 @@ WizardExport size_t GetHashDigestsize(const HashInfo *hash_info)
   WizardAssert(CipherDomain,hash_info->signature == WizardSignature);
   switch (hash_info->hash)
   {
+    case BLAKE3Hash:
+    {
+      BLAKE3Info
+        *blake_info;
+
+      blake_info=(BLAKE3Info *) hash_info->handle;
+      digestsize=GetBLAKE3Digestsize(blake_info);
+      break;
+    }
+    case CRC32CHash:
+    {
+      CRC32CInfo
+        *crc_info;
+
+      crc_info=(CRC32CInfo *) hash_info->handle;
+      digestsize=GetCRC32CDigestsize(crc_info);
+      break;
+    }
     case CRC64Hash:
     {
       CRC64Info
@@ -651,6 +1349,15 @@ WizardExport size_t GetHashDigestsize(const HashInfo *hash_info)
       digestsize=GetSHA2256Digestsize(sha_info);
       break;
     }
+    case SHA2256TreeHash:
+    {
+      MerkleInfo
+        *merkle_info;
+
+      merkle_info=(MerkleInfo *) hash_info->handle;
+      digestsize=GetMerkleDigestsize(merkle_info);
+      break;
+    }
     case SHA2384Hash:
     {
       SHA2384Info
@@ -740,6 +1447,129 @@ WizardExport char *GetHashHexDigest(const HashInfo *hash_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   I m p o r t H a s h S t a t e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportHashState() restores a state returned by ExportHashState() so that
+%  further updates continue the original computation.  It returns
+%  WizardFalse if the state is malformed or was exported from a different
+%  hash type.
+%
+%  The format of the ImportHashState method is:
+%
+%      WizardBooleanType ImportHashState(HashInfo *hash_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o hash_info: The hash info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportHashState(HashInfo *hash_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  StringInfo
+    *payload;
+
+  WizardBooleanType
+    status;
+
+  assert(hash_info != (HashInfo *) NULL);
+  assert(hash_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < HashStateHeaderSize)
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  if (ImportHashWord(&p,4) != HashStateMagic)
+    return(WizardFalse);
+  if (ImportHashWord(&p,4) != (WizardSizeType) hash_info->hash)
+    return(WizardFalse);
+  payload=AcquireStringInfo(GetStringInfoLength(state)-HashStateHeaderSize);
+  SetStringInfoDatum(payload,p);
+  switch (hash_info->hash)
+  {
+    case BLAKE3Hash:
+    {
+      status=ImportBLAKE3State((BLAKE3Info *) hash_info->handle,payload);
+      break;
+    }
+    case CRC32CHash:
+    {
+      status=ImportCRC32CState((CRC32CInfo *) hash_info->handle,payload);
+      break;
+    }
+    case CRC64Hash:
+    {
+      status=ImportCRC64State((CRC64Info *) hash_info->handle,payload);
+      break;
+    }
+    case MD5Hash:
+    {
+      status=ImportMD5State((MD5Info *) hash_info->handle,payload);
+      break;
+    }
+    case SHA1Hash:
+    {
+      status=ImportSHA1State((SHA1Info *) hash_info->handle,payload);
+      break;
+    }
+    case SHA2224Hash:
+    {
+      status=ImportSHA2224State((SHA2224Info *) hash_info->handle,payload);
+      break;
+    }
+    case SHA2256Hash:
+    case SHA2Hash:
+    {
+      status=ImportSHA2256State((SHA2256Info *) hash_info->handle,payload);
+      break;
+    }
+    case SHA2256TreeHash:
+    {
+      status=ImportMerkleState((MerkleInfo *) hash_info->handle,payload);
+      break;
+    }
+    case SHA2384Hash:
+    {
+      status=ImportSHA2384State((SHA2384Info *) hash_info->handle,payload);
+      break;
+    }
+    case SHA2512Hash:
+    {
+      status=ImportSHA2512State((SHA2512Info *) hash_info->handle,payload);
+      break;
+    }
+    case SHA3Hash:
+    case SHA3224Hash:
+    case SHA3256Hash:
+    case SHA3384Hash:
+    case SHA3512Hash:
+    {
+      status=ImportSHA3State((SHA3Info *) hash_info->handle,payload);
+      break;
+    }
+    default:
+    {
+      status=GetStringInfoLength(payload) == 0 ? WizardTrue : WizardFalse;
+      break;
+    }
+  }
+  payload=DestroyStringInfo(payload);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e H a s h                                               %
 %                                                                             %
 %                                                                             %
@@ -767,6 +1597,16 @@ WizardExport WizardBooleanType InitializeHash(HashInfo *hash_info)
   assert(hash_info->signature == WizardSignature);
   switch (hash_info->hash)
   {
+    case BLAKE3Hash:
+    {
+      status=InitializeBLAKE3((BLAKE3Info *) hash_info->handle);
+      break;
+    }
+    case CRC32CHash:
+    {
+      status=InitializeCRC32C((CRC32CInfo *) hash_info->handle);
+      break;
+    }
     case CRC64Hash:
     {
       status=InitializeCRC64((CRC64Info *) hash_info->handle);
@@ -793,6 +1633,11 @@ WizardExport WizardBooleanType InitializeHash(HashInfo *hash_info)
       status=InitializeSHA2256((SHA2256Info *) hash_info->handle);
       break;
     }
+    case SHA2256TreeHash:
+    {
+      status=InitializeMerkle((MerkleInfo *) hash_info->handle);
+      break;
+    }
     case SHA2384Hash:
     {
       status=InitializeSHA2384((SHA2384Info *) hash_info->handle);
@@ -826,6 +1671,137 @@ WizardExport WizardBooleanType InitializeHash(HashInfo *hash_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   S u b m i t H a s h B a t c h                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SubmitHashBatch() adds a complete message to the batch.  It is placed in a
+%  free lane; once every lane is busy, the lanes are advanced until at least
+%  one message completes.  The message must remain valid until its digest is
+%  returned by GetHashBatchDigest().
+%
+%  The format of the SubmitHashBatch method is:
+%
+%      WizardBooleanType SubmitHashBatch(HashBatchInfo *batch_info,
+%        const StringInfo *message,const size_t id)
+%
+%  A description of each parameter follows:
+%
+%    o batch_info: The hash batch info.
+%
+%    o message: The message.
+%
+%    o id: An identifier returned with the message digest.
+%
+*/
+WizardExport WizardBooleanType SubmitHashBatch(HashBatchInfo *batch_info,
+  const StringInfo *message,const size_t id)
+{
+  static const unsigned int
+    md5_accumulator[4] =
+    {
+      0x67452301U, 0xefcdab89U, 0x98badcfeU, 0x10325476U
+    },
+    sha1_accumulator[5] =
+    {
+      0x67452301U, 0xefcdab89U, 0x98badcfeU, 0x10325476U, 0xc3d2e1f0U
+    },
+    sha2256_accumulator[8] =
+    {
+      0x6a09e667U, 0xbb67ae85U, 0x3c6ef372U, 0xa54ff53aU, 0x510e527fU,
+      0x9b05688cU, 0x1f83d9abU, 0x5be0cd19U
+    };
+
+  const unsigned int
+    *accumulator;
+
+  size_t
+    i,
+    lane,
+    length,
+    remainder;
+
+  unsigned char
+    *q;
+
+  WizardBooleanType
+    status;
+
+  WizardSizeType
+    bits;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(batch_info != (HashBatchInfo *) NULL);
+  assert(batch_info->signature == WizardSignature);
+  if (batch_info->transform == (HashLanesTransformMethod) NULL)
+    {
+      /*
+        No lanes for this hash: digest the message now.
+      */
+      status=InitializeHash(batch_info->hash_info);
+      if (status != WizardFalse)
+        status=UpdateHash(batch_info->hash_info,message);
+      if (status != WizardFalse)
+        status=FinalizeHash(batch_info->hash_info);
+      if (status == WizardFalse)
+        return(WizardFalse);
+      EnqueueHashDigest(batch_info,id,GetStringInfoDatum(GetHashDigest(
+        batch_info->hash_info)));
+      return(WizardTrue);
+    }
+  for (lane=0; lane < batch_info->lanes; lane++)
+    if (batch_info->active[lane] == WizardFalse)
+      break;
+  assert(lane < batch_info->lanes);
+  accumulator=sha2256_accumulator;
+  if (batch_info->hash == MD5Hash)
+    accumulator=md5_accumulator;
+  if (batch_info->hash == SHA1Hash)
+    accumulator=sha1_accumulator;
+  for (i=0; i < batch_info->words; i++)
+    batch_info->accumulator[HashLanes*i+lane]=accumulator[i];
+  /*
+    Whole blocks are read from the message in place; the remainder, the pad,
+    and the bit length go to one or two tail blocks.
+  */
+  length=GetStringInfoLength(message);
+  remainder=length % 64;
+  batch_info->message[lane]=GetStringInfoDatum(message);
+  batch_info->blocks[lane]=length/64;
+  batch_info->tail_blocks[lane]=(remainder+9) <= 64 ? 1 : 2;
+  q=batch_info->tail[lane];
+  (void) memset(q,0,sizeof(batch_info->tail[lane]));
+  (void) memcpy(q,GetStringInfoDatum(message)+length-remainder,remainder);
+  q[remainder]=0x80;
+  q+=64*batch_info->tail_blocks[lane]-8;
+  bits=(WizardSizeType) length << 3;
+  for (i=0; i < 8; i++)
+    if (batch_info->hash == MD5Hash)
+      q[i]=(unsigned char) (bits >> (8*i));
+    else
+      q[7-i]=(unsigned char) (bits >> (8*i));
+  if (batch_info->blocks[lane] == 0)
+    {
+      batch_info->message[lane]=batch_info->tail[lane];
+      batch_info->blocks[lane]=batch_info->tail_blocks[lane];
+      batch_info->tail_blocks[lane]=0;
+    }
+  batch_info->id[lane]=id;
+  batch_info->active[lane]=WizardTrue;
+  for (lane=0; lane < batch_info->lanes; lane++)
+    if (batch_info->active[lane] == WizardFalse)
+      return(WizardTrue);
+  AdvanceHashBatch(batch_info,WizardFalse);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   U p d a t e H a s h                                                       %
 %                                                                             %
 %                                                                             %
@@ -848,6 +1824,42 @@ WizardExport WizardBooleanType InitializeHash(HashInfo *hash_info)
 */
 WizardExport WizardBooleanType UpdateHash(HashInfo *hash_info,
   const StringInfo *message)
+{
+  return(UpdateHashBytes(hash_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e H a s h B y t e s                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateHashBytes() updates the Hash message accumulator from the caller's
+%  memory.  Whole blocks are hashed where they lie, so streaming callers need
+%  not wrap each chunk in a StringInfo.
+%
+%  The format of the UpdateHashBytes method is:
+%
+%      WizardBooleanType UpdateHashBytes(HashInfo *hash_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o hash_info: The address of a structure of type HashInfo.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+WizardExport WizardBooleanType UpdateHashBytes(HashInfo *hash_info,
+  const void *message,const size_t extent)
 {
   WizardBooleanType
     status;
@@ -860,40 +1872,59 @@ WizardExport WizardBooleanType UpdateHash(HashInfo *hash_info,
   assert(hash_info->signature == WizardSignature);
   switch (hash_info->hash)
   {
+    case BLAKE3Hash:
+    {
+      status=UpdateBLAKE3Bytes((BLAKE3Info *) hash_info->handle,message,extent);
+      break;
+    }
+    case CRC32CHash:
+    {
+      status=UpdateCRC32CBytes((CRC32CInfo *) hash_info->handle,message,extent);
+      break;
+    }
     case CRC64Hash:
     {
-      status=UpdateCRC64((CRC64Info *) hash_info->handle,message);
+      status=UpdateCRC64Bytes((CRC64Info *) hash_info->handle,message,extent);
       break;
     }
     case MD5Hash:
     {
-      status=UpdateMD5((MD5Info *) hash_info->handle,message);
+      status=UpdateMD5Bytes((MD5Info *) hash_info->handle,message,extent);
       break;
     }
     case SHA1Hash:
     {
-      status=UpdateSHA1((SHA1Info *) hash_info->handle,message);
+      status=UpdateSHA1Bytes((SHA1Info *) hash_info->handle,message,extent);
       break;
     }
     case SHA2224Hash:
     {
-      status=UpdateSHA2224((SHA2224Info *) hash_info->handle,message);
+      status=UpdateSHA2224Bytes((SHA2224Info *) hash_info->handle,message,
+        extent);
       break;
     }
     case SHA2256Hash:
     case SHA2Hash:
     {
-      status=UpdateSHA2256((SHA2256Info *) hash_info->handle,message);
+      status=UpdateSHA2256Bytes((SHA2256Info *) hash_info->handle,message,
+        extent);
+      break;
+    }
+    case SHA2256TreeHash:
+    {
+      status=UpdateMerkleBytes((MerkleInfo *) hash_info->handle,message,extent);
       break;
     }
     case SHA2384Hash:
     {
-      status=UpdateSHA2384((SHA2384Info *) hash_info->handle,message);
+      status=UpdateSHA2384Bytes((SHA2384Info *) hash_info->handle,message,
+        extent);
       break;
     }
     case SHA2512Hash:
     {
-      status=UpdateSHA2512((SHA2512Info *) hash_info->handle,message);
+      status=UpdateSHA2512Bytes((SHA2512Info *) hash_info->handle,message,
+        extent);
       break;
     }
     case SHA3Hash:
@@ -902,7 +1933,7 @@ WizardExport WizardBooleanType UpdateHash(HashInfo *hash_info,
     case SHA3384Hash:
     case SHA3512Hash:
     {
-      status=UpdateSHA3((SHA3Info *) hash_info->handle,message);
+      status=UpdateSHA3Bytes((SHA3Info *) hash_info->handle,message,extent);
       break;
     }
     default:
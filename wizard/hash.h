@@ -40,9 +40,15 @@ typedef enum
   SHA3224Hash,
   SHA3256Hash,
   SHA3384Hash,
-  SHA3512Hash
+  SHA3512Hash,
+  CRC32CHash,
+  BLAKE3Hash,
+  SHA2256TreeHash
 } HashType;
 
+typedef struct _HashBatchInfo
+  HashBatchInfo;
+
 typedef struct _HashInfo
   HashInfo;
 
@@ -50,20 +56,34 @@ extern WizardExport char
   *GetHashHexDigest(const HashInfo *);
 
 extern WizardExport const StringInfo
+  *GetHashBatchDigest(HashBatchInfo *,size_t *),
   *GetHashDigest(const HashInfo *);
 
+extern WizardExport HashBatchInfo
+  *AcquireHashBatchInfo(const HashType),
+  *DestroyHashBatchInfo(HashBatchInfo *);
+
 extern WizardExport HashInfo
+  *CloneHashInfo(const HashInfo *),
   *DestroyHashInfo(HashInfo *),
   *AcquireHashInfo(const HashType);
 
+extern WizardExport StringInfo
+  *ExportHashState(const HashInfo *);
+
 extern WizardExport size_t
+  GetHashBatchLanes(const HashBatchInfo *),
   GetHashBlocksize(const HashInfo *),
   GetHashDigestsize(const HashInfo *);
 
 extern WizardExport WizardBooleanType
+  FlushHashBatch(HashBatchInfo *),
+  ImportHashState(HashInfo *,const StringInfo *),
   InitializeHash(HashInfo *),
   FinalizeHash(HashInfo *),
-  UpdateHash(HashInfo *,const StringInfo *);
+  SubmitHashBatch(HashBatchInfo *,const StringInfo *,const size_t),
+  UpdateHash(HashInfo *,const StringInfo *),
+  UpdateHashBytes(HashInfo *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -894,9 +894,6 @@ WizardExport size_t HashStringType(const void *string)
   size_t
     hash;
 
-  StringInfo
-    *message;
-
   unsigned char
     *datum;
 
@@ -904,8 +901,7 @@ WizardExport size_t HashStringType(const void *string)
   if (hashmap_info == (HashInfo *) NULL)
     return((size_t) string);
   InitializeHash(hashmap_info);
-  message=StringToStringInfo((const char *) string);
-  UpdateHash(hashmap_info,message);
+  UpdateHashBytes(hashmap_info,string,strlen((const char *) string));
   FinalizeHash(hashmap_info);
   hash=0;
   digest=GetHashDigest(hashmap_info);
@@ -56,8 +56,9 @@ struct _HMACInfo
 
   StringInfo
     *digest,
-    *final_nonce,
-    *initial_nonce;
+    *fingerprint,
+    *inner_state,
+    *outer_state;
 
   time_t
     timestamp;
@@ -100,10 +101,6 @@ WizardExport HMACInfo *AcquireHMACInfo(const HashType hash)
   hmac_info->hash_info=AcquireHashInfo(hash);
   hmac_info->digest=AcquireStringInfo((size_t) GetHashDigestsize(
     hmac_info->hash_info));
-  hmac_info->initial_nonce=AcquireStringInfo((size_t) GetHashBlocksize(
-    hmac_info->hash_info));
-  hmac_info->final_nonce=AcquireStringInfo((size_t) GetHashBlocksize(
-    hmac_info->hash_info));
   hmac_info->timestamp=time((time_t *) NULL);
   hmac_info->signature=WizardSignature;
   return(hmac_info);
@@ -114,13 +111,65 @@ WizardExport HMACInfo *AcquireHMACInfo(const HashType hash)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   C l o n e H M A C I n f o                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CloneHMACInfo() returns a copy of the HMAC, including its keyed state and any
+%  message hashed so far.  Finalizing the copy yields a tag over the message
+%  to this point while the original continues to accept updates.
+%
+%  The format of the CloneHMACInfo method is:
+%
+%      HMACInfo *CloneHMACInfo(const HMACInfo *hmac_info)
+%
+%  A description of each parameter follows:
+%
+%    o hmac_info: The address of a structure of type HMACInfo.
+%
+*/
+WizardExport HMACInfo *CloneHMACInfo(const HMACInfo *hmac_info)
+{
+  HMACInfo
+    *clone_info;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(hmac_info != (HMACInfo *) NULL);
+  assert(hmac_info->signature == WizardSignature);
+  clone_info=(HMACInfo *) AcquireWizardMemory(sizeof(*clone_info));
+  if (clone_info == (HMACInfo *) NULL)
+    ThrowWizardFatalError(MACDomain,MemoryError);
+  (void) memset(clone_info,0,sizeof(*clone_info));
+  clone_info->hash_info=CloneHashInfo(hmac_info->hash_info);
+  clone_info->digest=CloneStringInfo(hmac_info->digest);
+  if (hmac_info->fingerprint != (StringInfo *) NULL)
+    clone_info->fingerprint=CloneStringInfo(hmac_info->fingerprint);
+  if (hmac_info->inner_state != (StringInfo *) NULL)
+    clone_info->inner_state=CloneStringInfo(hmac_info->inner_state);
+  if (hmac_info->outer_state != (StringInfo *) NULL)
+    clone_info->outer_state=CloneStringInfo(hmac_info->outer_state);
+  clone_info->timestamp=hmac_info->timestamp;
+  clone_info->signature=WizardSignature;
+  return(clone_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   C o n s t r u c t H M A C                                                 %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  ConstructHMAC() constructs the HMAC digest.
+%  ConstructHMAC() constructs the HMAC digest.  The padded key blocks are
+%  hashed only when the key differs from the previous call; otherwise the
+%  saved inner and outer states are reused.  Only a digest of the key is kept
+%  to tell, and it is compared in constant time.
 %
 %  The format of the ConstructHMAC method is:
 %
@@ -136,15 +185,62 @@ WizardExport HMACInfo *AcquireHMACInfo(const HashType hash)
 %    o message: The message.
 %
 */
+
+static StringInfo *AcquireHMACFingerprint(HMACInfo *hmac_info,
+  const StringInfo *key)
+{
+  InitializeHash(hmac_info->hash_info);
+  UpdateHash(hmac_info->hash_info,key);
+  FinalizeHash(hmac_info->hash_info);
+  return(CloneStringInfo(GetHashDigest(hmac_info->hash_info)));
+}
+
+static WizardBooleanType CompareHMACFingerprint(const StringInfo *target,
+  const StringInfo *source)
+{
+  const unsigned char
+    *p,
+    *q;
+
+  size_t
+    i;
+
+  unsigned char
+    difference;
+
+  /*
+    Every byte is compared so the time taken does not depend on the keys.
+  */
+  if (GetStringInfoLength(target) != GetStringInfoLength(source))
+    return(WizardFalse);
+  p=GetStringInfoDatum(target);
+  q=GetStringInfoDatum(source);
+  difference=0;
+  for (i=0; i < GetStringInfoLength(target); i++)
+    difference|=p[i] ^ q[i];
+  return(difference == 0 ? WizardTrue : WizardFalse);
+}
+
 WizardExport void ConstructHMAC(HMACInfo *hmac_info,const StringInfo *key,
   const StringInfo *message)
 {
+  StringInfo
+    *fingerprint;
+
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   assert(hmac_info != (HMACInfo *) NULL);
   assert(hmac_info->signature == WizardSignature);
   assert(key != (StringInfo *) NULL);
   assert(message != (StringInfo *) NULL);
-  InitializeHMAC(hmac_info,key);
+  fingerprint=AcquireHMACFingerprint(hmac_info,key);
+  if ((hmac_info->fingerprint == (StringInfo *) NULL) ||
+      (CompareHMACFingerprint(hmac_info->fingerprint,fingerprint) ==
+       WizardFalse))
+    InitializeHMAC(hmac_info,key);
+  else
+    ResetHMAC(hmac_info);
+  ResetStringInfo(fingerprint);
+  fingerprint=DestroyStringInfo(fingerprint);
   UpdateHMAC(hmac_info,message);
   FinalizeHMAC(hmac_info);
 }
@@ -176,10 +272,21 @@ WizardExport HMACInfo *DestroyHMACInfo(HMACInfo *hmac_info)
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   assert(hmac_info != (HMACInfo *) NULL);
   assert(hmac_info->signature == WizardSignature);
-  if (hmac_info->final_nonce != (StringInfo *)  NULL)
-    hmac_info->final_nonce=DestroyStringInfo(hmac_info->final_nonce);
-  if (hmac_info->initial_nonce != (StringInfo *)  NULL)
-    hmac_info->initial_nonce=DestroyStringInfo(hmac_info->initial_nonce);
+  if (hmac_info->outer_state != (StringInfo *) NULL)
+    {
+      ResetStringInfo(hmac_info->outer_state);
+      hmac_info->outer_state=DestroyStringInfo(hmac_info->outer_state);
+    }
+  if (hmac_info->inner_state != (StringInfo *) NULL)
+    {
+      ResetStringInfo(hmac_info->inner_state);
+      hmac_info->inner_state=DestroyStringInfo(hmac_info->inner_state);
+    }
+  if (hmac_info->fingerprint != (StringInfo *) NULL)
+    {
+      ResetStringInfo(hmac_info->fingerprint);
+      hmac_info->fingerprint=DestroyStringInfo(hmac_info->fingerprint);
+    }
   if (hmac_info->digest != (StringInfo *) NULL)
     hmac_info->digest=DestroyStringInfo(hmac_info->digest);
   if (hmac_info->hash_info != (HashInfo *) NULL)
@@ -211,15 +318,35 @@ WizardExport HMACInfo *DestroyHMACInfo(HMACInfo *hmac_info)
 %    o hmac_info: The address of a structure of type HMACInfo.
 %
 */
+
+static void InitializeEmptyHMAC(HMACInfo *hmac_info)
+{
+  StringInfo
+    *key,
+    *state;
+
+  /*
+    Without InitializeHMAC() the HMAC is keyed with an empty key; the message
+    hashed so far is kept.
+  */
+  state=ExportHashState(hmac_info->hash_info);
+  key=AcquireStringInfo(0);
+  InitializeHMAC(hmac_info,key);
+  key=DestroyStringInfo(key);
+  (void) ImportHashState(hmac_info->hash_info,state);
+  state=DestroyStringInfo(state);
+}
+
 WizardExport void FinalizeHMAC(HMACInfo *hmac_info)
 {
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   assert(hmac_info != (HMACInfo *) NULL);
   assert(hmac_info->signature == WizardSignature);
+  if (hmac_info->outer_state == (StringInfo *) NULL)
+    InitializeEmptyHMAC(hmac_info);
   FinalizeHash(hmac_info->hash_info);
   SetStringInfo(hmac_info->digest,GetHashDigest(hmac_info->hash_info));
-  InitializeHash(hmac_info->hash_info);
-  UpdateHash(hmac_info->hash_info,hmac_info->final_nonce);
+  (void) ImportHashState(hmac_info->hash_info,hmac_info->outer_state);
   UpdateHash(hmac_info->hash_info,hmac_info->digest);
   FinalizeHash(hmac_info->hash_info);
   SetStringInfo(hmac_info->digest,GetHashDigest(hmac_info->hash_info));
@@ -296,7 +423,9 @@ WizardExport size_t GetHMACDigestsize(const HMACInfo *hmac_info)
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  IntializeHMAC() intializes the HMAC digest.
+%  IntializeHMAC() intializes the HMAC digest.  The key is padded and the
+%  inner and outer pad blocks are hashed once here; ResetHMAC() and
+%  FinalizeHMAC() restore the saved states rather than rehashing them.
 %
 %  The format of the DestroyHMACInfo method is:
 %
@@ -314,31 +443,52 @@ WizardExport void InitializeHMAC(HMACInfo *hmac_info,const StringInfo *key)
    size_t
     i;
 
+  StringInfo
+    *pad;
+
   unsigned char
     *datum;
 
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   assert(hmac_info != (HMACInfo *) NULL);
   assert(hmac_info->signature == WizardSignature);
-  (void) ResetStringInfo(hmac_info->initial_nonce);
-  if (GetStringInfoLength(key) <= GetStringInfoLength(hmac_info->initial_nonce))
-    SetStringInfo(hmac_info->initial_nonce,key);
-  else
+  if (hmac_info->fingerprint != (StringInfo *) NULL)
     {
-      InitializeHash(hmac_info->hash_info);
-      UpdateHash(hmac_info->hash_info,key);
-      FinalizeHash(hmac_info->hash_info);
-      SetStringInfo(hmac_info->initial_nonce,GetHashDigest(
-        hmac_info->hash_info));
+      ResetStringInfo(hmac_info->fingerprint);
+      hmac_info->fingerprint=DestroyStringInfo(hmac_info->fingerprint);
     }
-  SetStringInfo(hmac_info->final_nonce,hmac_info->initial_nonce);
-  datum=GetStringInfoDatum(hmac_info->initial_nonce);
-  for (i=0; i < GetStringInfoLength(hmac_info->initial_nonce); i++)
-    datum[i]^=0x36;
-  datum=GetStringInfoDatum(hmac_info->final_nonce);
-  for (i=0; i < GetStringInfoLength(hmac_info->final_nonce); i++)
+  hmac_info->fingerprint=AcquireHMACFingerprint(hmac_info,key);
+  pad=AcquireStringInfo((size_t) GetHashBlocksize(hmac_info->hash_info));
+  if (GetStringInfoLength(key) <= GetStringInfoLength(pad))
+    SetStringInfo(pad,key);
+  else
+    SetStringInfo(pad,hmac_info->fingerprint);
+  /*
+    Save the hash state after the outer and inner pad blocks.
+  */
+  datum=GetStringInfoDatum(pad);
+  for (i=0; i < GetStringInfoLength(pad); i++)
     datum[i]^=0x5c;
-  ResetHMAC(hmac_info);
+  InitializeHash(hmac_info->hash_info);
+  UpdateHash(hmac_info->hash_info,pad);
+  if (hmac_info->outer_state != (StringInfo *) NULL)
+    {
+      ResetStringInfo(hmac_info->outer_state);
+      hmac_info->outer_state=DestroyStringInfo(hmac_info->outer_state);
+    }
+  hmac_info->outer_state=ExportHashState(hmac_info->hash_info);
+  for (i=0; i < GetStringInfoLength(pad); i++)
+    datum[i]^=0x5c ^ 0x36;
+  InitializeHash(hmac_info->hash_info);
+  UpdateHash(hmac_info->hash_info,pad);
+  if (hmac_info->inner_state != (StringInfo *) NULL)
+    {
+      ResetStringInfo(hmac_info->inner_state);
+      hmac_info->inner_state=DestroyStringInfo(hmac_info->inner_state);
+    }
+  hmac_info->inner_state=ExportHashState(hmac_info->hash_info);
+  ResetStringInfo(pad);
+  pad=DestroyStringInfo(pad);
 }
 
 /*
@@ -352,7 +502,8 @@ WizardExport void InitializeHMAC(HMACInfo *hmac_info,const StringInfo *key)
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  ResetHMAC() resets the HMAC message digest computation.
+%  ResetHMAC() resets the HMAC message digest computation to the saved inner
+%  state so another message can be authenticated with the same key.
 %
 %  The format of the ResetHMAC method is:
 %
@@ -368,8 +519,9 @@ WizardExport void ResetHMAC(HMACInfo *hmac_info)
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   assert(hmac_info != (HMACInfo *) NULL);
   assert(hmac_info->signature == WizardSignature);
-  InitializeHash(hmac_info->hash_info);
-  UpdateHash(hmac_info->hash_info,hmac_info->initial_nonce);
+  if (hmac_info->inner_state == (StringInfo *) NULL)
+    InitializeEmptyHMAC(hmac_info);
+  (void) ImportHashState(hmac_info->hash_info,hmac_info->inner_state);
 }
 
 /*
@@ -397,9 +549,43 @@ WizardExport void ResetHMAC(HMACInfo *hmac_info)
 %
 */
 WizardExport void UpdateHMAC(HMACInfo *hmac_info,const StringInfo *message)
+{
+  UpdateHMACBytes(hmac_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e H M A C B y t e s                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateHMACBytes() updates the HMAC message digest from the caller's memory.
+%
+%  The format of the UpdateHMACBytes method is:
+%
+%      UpdateHMACBytes(HMACInfo *hmac_info,const void *message,
+%        const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o hmac_info: The address of a structure of type HMACInfo.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+WizardExport void UpdateHMACBytes(HMACInfo *hmac_info,const void *message,
+  const size_t extent)
 {
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   assert(hmac_info != (HMACInfo *) NULL);
   assert(hmac_info->signature == WizardSignature);
-  UpdateHash(hmac_info->hash_info,message);
+  UpdateHashBytes(hmac_info->hash_info,message,extent);
 }
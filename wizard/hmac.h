@@ -29,6 +29,7 @@ typedef struct _HMACInfo
 
 extern WizardExport HMACInfo
   *AcquireHMACInfo(const HashType),
+  *CloneHMACInfo(const HMACInfo *),
   *DestroyHMACInfo(HMACInfo *);
 
 extern WizardExport const StringInfo
@@ -42,7 +43,8 @@ extern WizardExport void
   FinalizeHMAC(HMACInfo *),
   InitializeHMAC(HMACInfo *,const StringInfo *),
   ResetHMAC(HMACInfo *),
-  UpdateHMAC(HMACInfo *,const StringInfo *);
+  UpdateHMAC(HMACInfo *,const StringInfo *),
+  UpdateHMACBytes(HMACInfo *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -92,15 +92,11 @@ WizardExport StringInfo *GetWizardMagick(const unsigned char *signature,
     *hash_info;
 
   StringInfo
-    *magick,
-    *tag;
+    *magick;
 
   hash_info=AcquireHashInfo(SHA2256Hash);
   InitializeHash(hash_info);
-  tag=AcquireStringInfo(length);
-  SetStringInfoDatum(tag,signature);
-  UpdateHash(hash_info,tag);
-  tag=DestroyStringInfo(tag);
+  UpdateHashBytes(hash_info,signature,length);
   FinalizeHash(hash_info);
   magick=CloneStringInfo(GetHashDigest(hash_info));
   hash_info=DestroyHashInfo(hash_info);
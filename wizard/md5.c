@@ -41,6 +41,8 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/cpu-private.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
 #include "wizard/md5.h"
 
@@ -79,6 +81,9 @@ struct _MD5Info
   Forward declaraction.
 */
 static void
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  TransformMD5LanesAVX2(unsigned int *,const unsigned char **,const size_t),
+#endif
   TransformMD5(MD5Info *,const unsigned int *);
 
 /*
@@ -165,6 +170,58 @@ WizardExport MD5Info *DestroyMD5Info(MD5Info *md5_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t M D 5 S t a t e                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportMD5State() returns the in-progress MD5 state as a byte string: the
+%  accumulator, the message length in bits, and any buffered partial block.
+%  Pass it to ImportMD5State() to resume the computation.
+%
+%  The format of the ExportMD5State method is:
+%
+%      StringInfo *ExportMD5State(const MD5Info *md5_info)
+%
+%  A description of each parameter follows:
+%
+%    o md5_info: The address of a structure of type MD5Info.
+%
+*/
+WizardExport StringInfo *ExportMD5State(const MD5Info *md5_info)
+{
+  size_t
+    number_bytes;
+
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(md5_info != (MD5Info *) NULL);
+  assert(md5_info->signature == WizardSignature);
+  number_bytes=(size_t) ((md5_info->low_order >> 3) & 0x3F);
+  state=AcquireStringInfo(4*4+2*4+number_bytes);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < 4; i++)
+    ExportHashWord(&q,md5_info->accumulator[i],4);
+  ExportHashWord(&q,md5_info->low_order,4);
+  ExportHashWord(&q,md5_info->high_order,4);
+  (void) CopyWizardMemory(q,GetStringInfoDatum(md5_info->message),
+    number_bytes);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e M D 5                                                     %
 %                                                                             %
 %                                                                             %
@@ -351,6 +408,95 @@ WizardExport unsigned int GetMD5Digestsize(const MD5Info *md5_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   G e t M D 5 L a n e s T r a n s f o r m                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetMD5LanesTransform() returns a transform that compresses HashLanes
+%  independent MD5 messages at once, or NULL if this processor has none.
+%
+%  The format of the GetMD5LanesTransform method is:
+%
+%      HashLanesTransformMethod GetMD5LanesTransform(void)
+%
+*/
+WizardExport HashLanesTransformMethod GetMD5LanesTransform(void)
+{
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    return(TransformMD5LanesAVX2);
+#endif
+  return((HashLanesTransformMethod) NULL);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t M D 5 S t a t e                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportMD5State() restores a state returned by ExportMD5State().  It
+%  returns WizardFalse, leaving the MD5 state untouched, if the state is
+%  malformed.
+%
+%  The format of the ImportMD5State method is:
+%
+%      WizardBooleanType ImportMD5State(MD5Info *md5_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o md5_info: The address of a structure of type MD5Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportMD5State(MD5Info *md5_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    number_bytes;
+
+  ssize_t
+    i;
+
+  unsigned int
+    low_order;
+
+  assert(md5_info != (MD5Info *) NULL);
+  assert(md5_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < (4*4+2*4))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+4*4;
+  low_order=(unsigned int) ImportHashWord(&p,4);
+  number_bytes=(size_t) ((low_order >> 3) & 0x3F);
+  if (GetStringInfoLength(state) != (4*4+2*4+number_bytes))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < 4; i++)
+    md5_info->accumulator[i]=(unsigned int) ImportHashWord(&p,4);
+  md5_info->low_order=(unsigned int) ImportHashWord(&p,4);
+  md5_info->high_order=(unsigned int) ImportHashWord(&p,4);
+  (void) CopyWizardMemory(GetStringInfoDatum(md5_info->message),p,
+    number_bytes);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e M D 5                                                 %
 %                                                                             %
 %                                                                             %
@@ -443,6 +589,127 @@ static inline unsigned int RotateLeft(const unsigned int x,const unsigned int n)
   return(Trunc32((x << n) | (x >> (32-n))));
 }
 
+static const unsigned int
+  K[64] =
+  {
+    0xd76aa478U, 0xe8c7b756U, 0x242070dbU, 0xc1bdceeeU, 0xf57c0fafU,
+    0x4787c62aU, 0xa8304613U, 0xfd469501U, 0x698098d8U, 0x8b44f7afU,
+    0xffff5bb1U, 0x895cd7beU, 0x6b901122U, 0xfd987193U, 0xa679438eU,
+    0x49b40821U, 0xf61e2562U, 0xc040b340U, 0x265e5a51U, 0xe9b6c7aaU,
+    0xd62f105dU, 0x02441453U, 0xd8a1e681U, 0xe7d3fbc8U, 0x21e1cde6U,
+    0xc33707d6U, 0xf4d50d87U, 0x455a14edU, 0xa9e3e905U, 0xfcefa3f8U,
+    0x676f02d9U, 0x8d2a4c8aU, 0xfffa3942U, 0x8771f681U, 0x6d9d6122U,
+    0xfde5380cU, 0xa4beea44U, 0x4bdecfa9U, 0xf6bb4b60U, 0xbebfbc70U,
+    0x289b7ec6U, 0xeaa127faU, 0xd4ef3085U, 0x04881d05U, 0xd9d4d039U,
+    0xe6db99e5U, 0x1fa27cf8U, 0xc4ac5665U, 0xf4292244U, 0x432aff97U,
+    0xab9423a7U, 0xfc93a039U, 0x655b59c3U, 0x8f0ccc92U, 0xffeff47dU,
+    0x85845dd1U, 0x6fa87e4fU, 0xfe2ce6e0U, 0xa3014314U, 0x4e0811a1U,
+    0xf7537e82U, 0xbd3af235U, 0x2ad7d2bbU, 0xeb86d391U,
+  };  /* 4294967296*abs(sin(i)), i in radians */
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+#define MD5StepAVX2(f,a,b,c,d,j,s) \
+{ \
+  a=_mm256_add_epi32(_mm256_add_epi32(a,f),_mm256_add_epi32(W[(j) & 0x0f], \
+    _mm256_set1_epi32((int) (*p++)))); \
+  a=_mm256_add_epi32(RotateLeftAVX2(a,s),b); \
+}
+
+static WizardTarget("avx2") void TransformMD5LanesAVX2(
+  unsigned int *accumulator,const unsigned char **message,const size_t blocks)
+{
+  const unsigned int
+    *p;
+
+  __m256i
+    A,
+    B,
+    C,
+    D,
+    ones,
+    S[4],
+    W[16];
+
+  size_t
+    i,
+    j,
+    k;
+
+  /*
+    Each 32-bit element is one lane; the rounds are the portable ones applied
+    to eight messages at once.  MD5 words are little-endian, so the
+    transposed message needs no byte swap.
+  */
+  ones=_mm256_set1_epi32(-1);
+  for (i=0; i < 4; i++)
+    S[i]=_mm256_loadu_si256((const __m256i *) (accumulator+HashLanes*i));
+  for (k=0; k < blocks; k++)
+  {
+    LoadHashLanesAVX2(message,64*k,W);
+    A=S[0];
+    B=S[1];
+    C=S[2];
+    D=S[3];
+    p=K;
+    for (i=0, j=0; i < 4; i++, j+=4)
+    {
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(B,C),
+        _mm256_andnot_si256(B,D)),A,B,C,D,j,7);
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(A,B),
+        _mm256_andnot_si256(A,C)),D,A,B,C,j+1,12);
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(D,A),
+        _mm256_andnot_si256(D,B)),C,D,A,B,j+2,17);
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(C,D),
+        _mm256_andnot_si256(C,A)),B,C,D,A,j+3,22);
+    }
+    for (i=0, j=1; i < 4; i++, j+=20)
+    {
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(B,D),
+        _mm256_andnot_si256(D,C)),A,B,C,D,j,5);
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(A,C),
+        _mm256_andnot_si256(C,B)),D,A,B,C,j+5,9);
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(D,B),
+        _mm256_andnot_si256(B,A)),C,D,A,B,j+10,14);
+      MD5StepAVX2(_mm256_or_si256(_mm256_and_si256(C,A),
+        _mm256_andnot_si256(A,D)),B,C,D,A,j+15,20);
+    }
+    for (i=0, j=5; i < 4; i++, j+=12)
+    {
+      MD5StepAVX2(_mm256_xor_si256(_mm256_xor_si256(B,C),D),A,B,C,D,j,4);
+      MD5StepAVX2(_mm256_xor_si256(_mm256_xor_si256(A,B),C),D,A,B,C,j+3,11);
+      MD5StepAVX2(_mm256_xor_si256(_mm256_xor_si256(D,A),B),C,D,A,B,j+6,16);
+      MD5StepAVX2(_mm256_xor_si256(_mm256_xor_si256(C,D),A),B,C,D,A,j+9,23);
+    }
+    for (i=0, j=0; i < 4; i++, j+=28)
+    {
+      MD5StepAVX2(_mm256_xor_si256(C,_mm256_or_si256(B,_mm256_xor_si256(D,
+        ones))),A,B,C,D,j,6);
+      MD5StepAVX2(_mm256_xor_si256(B,_mm256_or_si256(A,_mm256_xor_si256(C,
+        ones))),D,A,B,C,j+7,10);
+      MD5StepAVX2(_mm256_xor_si256(A,_mm256_or_si256(D,_mm256_xor_si256(B,
+        ones))),C,D,A,B,j+14,15);
+      MD5StepAVX2(_mm256_xor_si256(D,_mm256_or_si256(C,_mm256_xor_si256(A,
+        ones))),B,C,D,A,j+21,21);
+    }
+    S[0]=_mm256_add_epi32(S[0],A);
+    S[1]=_mm256_add_epi32(S[1],B);
+    S[2]=_mm256_add_epi32(S[2],C);
+    S[3]=_mm256_add_epi32(S[3],D);
+  }
+  for (i=0; i < 4; i++)
+    _mm256_storeu_si256((__m256i *) (accumulator+HashLanes*i),S[i]);
+  /*
+    Reset working registers.
+  */
+  for (i=0; i < 16; i++)
+    W[i]=_mm256_setzero_si256();
+  A=_mm256_setzero_si256();
+  B=_mm256_setzero_si256();
+  C=_mm256_setzero_si256();
+  D=_mm256_setzero_si256();
+}
+#endif
+
 static void TransformMD5(MD5Info *md5_info,const unsigned int *message)
 {
    const unsigned int
@@ -454,24 +721,6 @@ static void TransformMD5(MD5Info *md5_info,const unsigned int *message)
    unsigned int
     j;
 
-  static const unsigned int
-    K[64]=
-    {
-      0xd76aa478U, 0xe8c7b756U, 0x242070dbU, 0xc1bdceeeU, 0xf57c0fafU,
-      0x4787c62aU, 0xa8304613U, 0xfd469501U, 0x698098d8U, 0x8b44f7afU,
-      0xffff5bb1U, 0x895cd7beU, 0x6b901122U, 0xfd987193U, 0xa679438eU,
-      0x49b40821U, 0xf61e2562U, 0xc040b340U, 0x265e5a51U, 0xe9b6c7aaU,
-      0xd62f105dU, 0x02441453U, 0xd8a1e681U, 0xe7d3fbc8U, 0x21e1cde6U,
-      0xc33707d6U, 0xf4d50d87U, 0x455a14edU, 0xa9e3e905U, 0xfcefa3f8U,
-      0x676f02d9U, 0x8d2a4c8aU, 0xfffa3942U, 0x8771f681U, 0x6d9d6122U,
-      0xfde5380cU, 0xa4beea44U, 0x4bdecfa9U, 0xf6bb4b60U, 0xbebfbc70U,
-      0x289b7ec6U, 0xeaa127faU, 0xd4ef3085U, 0x04881d05U, 0xd9d4d039U,
-      0xe6db99e5U, 0x1fa27cf8U, 0xc4ac5665U, 0xf4292244U, 0x432aff97U,
-      0xab9423a7U, 0xfc93a039U, 0x655b59c3U, 0x8f0ccc92U, 0xffeff47dU,
-      0x85845dd1U, 0x6fa87e4fU, 0xfe2ce6e0U, 0xa3014314U, 0x4e0811a1U,
-      0xf7537e82U, 0xbd3af235U, 0x2ad7d2bbU, 0xeb86d391U,
-    };  /* 4294967296*abs(sin(i)), i in radians */
-
   unsigned int
     A,
     B,
@@ -604,50 +853,110 @@ static void TransformMD5(MD5Info *md5_info,const unsigned int *message)
 WizardExport WizardBooleanType UpdateMD5(MD5Info *md5_info,
   const StringInfo *message)
 {
-   unsigned char
-    *p;
+  return(UpdateMD5Bytes(md5_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e M D 5 B y t e s                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateMD5Bytes() updates the MD5 message digest from the caller's memory.
+%  Whole blocks are decoded and transformed directly from it; only a trailing
+%  partial block is buffered.
+%
+%  The format of the UpdateMD5Bytes method is:
+%
+%      WizardBooleanType UpdateMD5Bytes(MD5Info *md5_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o md5_info: The address of a structure of type MD5Info.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
 
+static inline void LoadMD5Block(const unsigned char *p,unsigned int *buffer)
+{
    ssize_t
+    i;
+
+  for (i=0; i < 16; i++)
+  {
+    buffer[i]=(unsigned int) (*p++);
+    buffer[i]|=((unsigned int) (*p++)) << 8;
+    buffer[i]|=((unsigned int) (*p++)) << 16;
+    buffer[i]|=((unsigned int) (*p++)) << 24;
+  }
+}
+
+WizardExport WizardBooleanType UpdateMD5Bytes(MD5Info *md5_info,
+  const void *message,const size_t extent)
+{
+   const unsigned char
+    *p;
+
+  size_t
     i,
-    j;
+    n,
+    number_bytes;
 
   unsigned char
     *datum;
 
   unsigned int
     buffer[16],
-    number_bits,
-    number_bytes;
+    number_bits;
 
   /*
     Update the MD5 accumulator.
   */
   assert(md5_info != (MD5Info *) NULL);
   assert(md5_info->signature == WizardSignature);
-  number_bytes=(unsigned int) ((md5_info->low_order >> 3) & 0x3F);
-  number_bits=(unsigned int) (md5_info->low_order+(GetStringInfoLength(message)
-    << 3));
+  number_bytes=(size_t) ((md5_info->low_order >> 3) & 0x3F);
+  number_bits=(unsigned int) (md5_info->low_order+(extent << 3));
   if ((number_bits & 0xffffffff) < md5_info->low_order)
     md5_info->high_order++;
-  md5_info->low_order+=(unsigned int) (GetStringInfoLength(message) << 3);
-  md5_info->high_order+=(unsigned int) (GetStringInfoLength(message) >> 29);
-  datum=GetStringInfoDatum(message);
-  for (i=0; i < (ssize_t) GetStringInfoLength(message); i++)
-  {
-    p=GetStringInfoDatum(md5_info->message);
-    p[number_bytes++]=datum[i];
-    if (number_bytes != 0x40)
-      continue;
-    for (j=0; j < 16; j++)
+  md5_info->low_order+=(unsigned int) (extent << 3);
+  md5_info->high_order+=(unsigned int) (extent >> 29);
+  p=(const unsigned char *) message;
+  n=extent;
+  datum=GetStringInfoDatum(md5_info->message);
+  if (number_bytes != 0)
     {
-      buffer[j]=(unsigned int) (*p++);
-      buffer[j]|=((unsigned int) (*p++)) << 8;
-      buffer[j]|=((unsigned int) (*p++)) << 16;
-      buffer[j]|=((unsigned int) (*p++)) << 24;
+      i=MD5Blocksize-number_bytes;
+      if (i > n)
+        i=n;
+      (void) CopyWizardMemory(datum+number_bytes,p,i);
+      n-=i;
+      p+=i;
+      number_bytes+=i;
+      if (number_bytes != MD5Blocksize)
+        return(WizardTrue);
+      LoadMD5Block(datum,buffer);
+      TransformMD5(md5_info,buffer);
     }
+  for ( ; n >= MD5Blocksize; n-=MD5Blocksize)
+  {
+    /*
+      Transform whole blocks directly from the message.
+    */
+    LoadMD5Block(p,buffer);
     TransformMD5(md5_info,buffer);
-    number_bytes=0;
+    p+=MD5Blocksize;
   }
+  (void) CopyWizardMemory(datum,p,n);
   /*
     Reset working registers.
   */
@@ -29,6 +29,9 @@ extern WizardExport MD5Info
   *AcquireMD5Info(void),
   *DestroyMD5Info(MD5Info *);
 
+extern WizardExport StringInfo
+  *ExportMD5State(const MD5Info *);
+
 extern WizardExport const StringInfo
   *GetMD5Digest(const MD5Info *);
 
@@ -37,9 +40,11 @@ extern WizardExport unsigned int
   GetMD5Digestsize(const MD5Info *);
 
 extern WizardExport WizardBooleanType
+  ImportMD5State(MD5Info *,const StringInfo *),
   InitializeMD5(MD5Info *),
   FinalizeMD5(MD5Info *),
-  UpdateMD5(MD5Info *,const StringInfo *);
+  UpdateMD5(MD5Info *,const StringInfo *),
+  UpdateMD5Bytes(MD5Info *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -0,0 +1,705 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%             M   M  EEEEE  RRRR   K   K  L      EEEEE                        %
+%             MM MM  E      R   R  K  K   L      E                            %
+%             M M M  EEE    RRRR   KKK    L      EEE                          %
+%             M   M  E      R R    K  K   L      E                            %
+%             M   M  EEEEE  R  R   K   K  LLLLL  EEEEE                        %
+%                                                                             %
+%                                                                             %
+%                   Wizard's Toolkit Merkle Tree Hash Methods                 %
+%                                                                             %
+%                             Software Design                                 %
+%                                 Cristy                                      %
+%                               March  2003                                   %
+%                                                                             %
+%                                                                             %
+%  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization         %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+% A Merkle tree hash splits the message into fixed-size leaves that are hashed
+% independently, so several leaves can be hashed at once on separate threads.
+% The tree follows RFC 6962: a leaf hash is H(0x00 || leaf), an interior node
+% is H(0x01 || left || right), and the empty message hashes to H("").
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "wizard/studio.h"
+#include "wizard/exception.h"
+#include "wizard/exception-private.h"
+#include "wizard/hash.h"
+#include "wizard/hash-private.h"
+#include "wizard/memory_.h"
+#include "wizard/merkle.h"
+
+/*
+  Define declarations.
+*/
+#define MerkleLeafPrefix  0x00
+#define MerkleLeafsize  1048576
+#define MerkleMaxDepth  64
+#define MerkleNodePrefix  0x01
+
+/*
+  Typedef declarations.
+*/
+struct _MerkleInfo
+{
+  unsigned int
+    digestsize,
+    blocksize;
+
+  StringInfo
+    *digest;
+
+  HashType
+    hash;
+
+  HashInfo
+    **hash_info;
+
+  unsigned char
+    *leaves,
+    *stack;
+
+  size_t
+    extent,
+    depth;
+
+  WizardSizeType
+    count;
+
+  size_t
+    threads;
+
+  time_t
+    timestamp;
+
+  size_t
+    signature;
+};
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   A c q u i r e M e r k l e I n f o                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireMerkleInfo() allocate the MerkleInfo structure.  Leaves are hashed
+%  with the given hash, one leaf per thread at a time.
+%
+%  The format of the AcquireMerkleInfo method is:
+%
+%      MerkleInfo *AcquireMerkleInfo(const HashType hash)
+%
+%  A description of each parameter follows:
+%
+%    o hash: The hash type of the leaves and interior nodes.
+%
+*/
+WizardExport MerkleInfo *AcquireMerkleInfo(const HashType hash)
+{
+  MerkleInfo
+    *merkle_info;
+
+  ssize_t
+    i;
+
+  merkle_info=(MerkleInfo *) AcquireWizardMemory(sizeof(*merkle_info));
+  if (merkle_info == (MerkleInfo *) NULL)
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  (void) memset(merkle_info,0,sizeof(*merkle_info));
+  merkle_info->hash=hash;
+  merkle_info->threads=1;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  merkle_info->threads=(size_t) omp_get_max_threads();
+#endif
+  merkle_info->hash_info=(HashInfo **) AcquireQuantumMemory(
+    merkle_info->threads,sizeof(*merkle_info->hash_info));
+  if (merkle_info->hash_info == (HashInfo **) NULL)
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  for (i=0; i < (ssize_t) merkle_info->threads; i++)
+    merkle_info->hash_info[i]=AcquireHashInfo(hash);
+  merkle_info->digestsize=(unsigned int) GetHashDigestsize(
+    merkle_info->hash_info[0]);
+  merkle_info->blocksize=(unsigned int) GetHashBlocksize(
+    merkle_info->hash_info[0]);
+  merkle_info->digest=AcquireStringInfo(merkle_info->digestsize);
+  merkle_info->stack=(unsigned char *) AcquireQuantumMemory(MerkleMaxDepth,
+    merkle_info->digestsize*sizeof(*merkle_info->stack));
+  if (merkle_info->stack == (unsigned char *) NULL)
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  merkle_info->timestamp=time((time_t *) NULL);
+  merkle_info->signature=WizardSignature;
+  return(merkle_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y M e r k l e I n f o                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyMerkleInfo() zeros memory associated with the MerkleInfo structure.
+%
+%  The format of the DestroyMerkleInfo method is:
+%
+%      MerkleInfo *DestroyMerkleInfo(MerkleInfo *merkle_info)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The merkle info.
+%
+*/
+WizardExport MerkleInfo *DestroyMerkleInfo(MerkleInfo *merkle_info)
+{
+  ssize_t
+    i;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(merkle_info != (MerkleInfo *) NULL);
+  assert(merkle_info->signature == WizardSignature);
+  for (i=0; i < (ssize_t) merkle_info->threads; i++)
+    merkle_info->hash_info[i]=DestroyHashInfo(merkle_info->hash_info[i]);
+  if (merkle_info->leaves != (unsigned char *) NULL)
+    {
+      (void) ResetWizardMemory(merkle_info->leaves,0,merkle_info->threads*
+        MerkleLeafsize);
+      merkle_info->leaves=(unsigned char *) RelinquishWizardMemory(
+        merkle_info->leaves);
+    }
+  merkle_info->hash_info=(HashInfo **) RelinquishWizardMemory(
+    merkle_info->hash_info);
+  (void) ResetWizardMemory(merkle_info->stack,0,MerkleMaxDepth*
+    merkle_info->digestsize);
+  merkle_info->stack=(unsigned char *) RelinquishWizardMemory(
+    merkle_info->stack);
+  if (merkle_info->digest != (StringInfo *) NULL)
+    merkle_info->digest=DestroyStringInfo(merkle_info->digest);
+  merkle_info->signature=(~WizardSignature);
+  merkle_info=(MerkleInfo *) RelinquishWizardMemory(merkle_info);
+  return(merkle_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E x p o r t M e r k l e S t a t e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportMerkleState() returns the in-progress tree as a byte string: the
+%  leaf count, the stack of subtree digests, and the input not yet hashed
+%  into a leaf.  Resume it with ImportMerkleState().
+%
+%  The format of the ExportMerkleState method is:
+%
+%      StringInfo *ExportMerkleState(const MerkleInfo *merkle_info)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The address of a structure of type MerkleInfo.
+%
+*/
+WizardExport StringInfo *ExportMerkleState(const MerkleInfo *merkle_info)
+{
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(merkle_info != (MerkleInfo *) NULL);
+  assert(merkle_info->signature == WizardSignature);
+  state=AcquireStringInfo(20+merkle_info->depth*merkle_info->digestsize+
+    merkle_info->extent);
+  q=GetStringInfoDatum(state);
+  ExportHashWord(&q,merkle_info->count,8);
+  ExportHashWord(&q,merkle_info->depth,4);
+  ExportHashWord(&q,merkle_info->extent,8);
+  (void) memcpy(q,merkle_info->stack,merkle_info->depth*
+    merkle_info->digestsize);
+  q+=merkle_info->depth*merkle_info->digestsize;
+  if (merkle_info->extent != 0)
+    (void) memcpy(q,merkle_info->leaves,merkle_info->extent);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   F i n a l i z e M e r k l e                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FinalizeMerkle() finalizes the Merkle tree message digest computation.
+%
+%  The format of the FinalizeMerkle method is:
+%
+%      WizardBooleanType FinalizeMerkle(MerkleInfo *merkle_info)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The address of a structure of type MerkleInfo.
+%
+*/
+
+static void HashMerkleNode(MerkleInfo *merkle_info,const unsigned char *left,
+  const unsigned char *right,unsigned char *digest)
+{
+  HashInfo
+    *hash_info;
+
+  static const unsigned char
+    prefix = MerkleNodePrefix;
+
+  hash_info=merkle_info->hash_info[0];
+  InitializeHash(hash_info);
+  UpdateHashBytes(hash_info,&prefix,1);
+  UpdateHashBytes(hash_info,left,merkle_info->digestsize);
+  UpdateHashBytes(hash_info,right,merkle_info->digestsize);
+  FinalizeHash(hash_info);
+  (void) memcpy(digest,GetStringInfoDatum(GetHashDigest(hash_info)),
+    merkle_info->digestsize);
+}
+
+static void PushMerkleDigest(MerkleInfo *merkle_info,
+  const unsigned char *digest)
+{
+  unsigned char
+    *top;
+
+  WizardSizeType
+    count;
+
+  /*
+    Each completed leaf merges with the subtrees it now balances: one per
+    trailing zero bit of the leaf count.
+  */
+  top=merkle_info->stack+merkle_info->depth*merkle_info->digestsize;
+  (void) memcpy(top,digest,merkle_info->digestsize);
+  merkle_info->count++;
+  for (count=merkle_info->count; (count & 0x01) == 0; count>>=1)
+  {
+    top-=merkle_info->digestsize;
+    HashMerkleNode(merkle_info,top,top+merkle_info->digestsize,top);
+    merkle_info->depth--;
+  }
+  merkle_info->depth++;
+}
+
+static void HashMerkleLeaves(MerkleInfo *merkle_info,const unsigned char *p,
+  const size_t leaves,const size_t length)
+{
+  static const unsigned char
+    prefix = MerkleLeafPrefix;
+
+  ssize_t
+    i;
+
+  /*
+    Each leaf is hashed on its own thread straight from memory, then folded
+    into the tree in order.  Only the last leaf may be short.
+  */
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static) num_threads(leaves) \
+    if (leaves > 1)
+#endif
+  for (i=0; i < (ssize_t) leaves; i++)
+  {
+    InitializeHash(merkle_info->hash_info[i]);
+    UpdateHashBytes(merkle_info->hash_info[i],&prefix,1);
+    UpdateHashBytes(merkle_info->hash_info[i],p+i*MerkleLeafsize,
+      i == (ssize_t) (leaves-1) ? length : MerkleLeafsize);
+    FinalizeHash(merkle_info->hash_info[i]);
+  }
+  for (i=0; i < (ssize_t) leaves; i++)
+    PushMerkleDigest(merkle_info,GetStringInfoDatum(GetHashDigest(
+      merkle_info->hash_info[i])));
+}
+
+WizardExport WizardBooleanType FinalizeMerkle(MerkleInfo *merkle_info)
+{
+  HashInfo
+    *hash_info;
+
+  ssize_t
+    i;
+
+  unsigned char
+    *datum,
+    *digest;
+
+  /*
+    Hash the buffered leaves, the last one possibly partial, then merge each
+    stacked subtree from the right.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(merkle_info != (MerkleInfo *) NULL);
+  assert(merkle_info->signature == WizardSignature);
+  if (merkle_info->extent != 0)
+    {
+      size_t
+        leaves;
+
+      leaves=(merkle_info->extent+MerkleLeafsize-1)/MerkleLeafsize;
+      HashMerkleLeaves(merkle_info,merkle_info->leaves,leaves,
+        merkle_info->extent-(leaves-1)*MerkleLeafsize);
+      merkle_info->extent=0;
+    }
+  datum=GetStringInfoDatum(merkle_info->digest);
+  if (merkle_info->depth == 0)
+    {
+      hash_info=merkle_info->hash_info[0];
+      InitializeHash(hash_info);
+      FinalizeHash(hash_info);
+      SetStringInfo(merkle_info->digest,GetHashDigest(hash_info));
+      return(WizardTrue);
+    }
+  digest=merkle_info->stack+(merkle_info->depth-1)*merkle_info->digestsize;
+  for (i=(ssize_t) merkle_info->depth-2; i >= 0; i--)
+    HashMerkleNode(merkle_info,merkle_info->stack+i*merkle_info->digestsize,
+      digest,digest);
+  (void) memcpy(datum,digest,merkle_info->digestsize);
+  /*
+    Reset working registers.
+  */
+  (void) ResetWizardMemory(merkle_info->stack,0,merkle_info->depth*
+    merkle_info->digestsize);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t M e r k l e B l o c k s i z e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetMerkleBlocksize() returns the blocksize of the underlying hash.
+%
+%  The format of the GetMerkleBlocksize method is:
+%
+%      unsigned int *GetMerkleBlocksize(const MerkleInfo *merkle_info)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The merkle info.
+%
+*/
+WizardExport unsigned int GetMerkleBlocksize(const MerkleInfo *merkle_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,merkle_info != (MerkleInfo *) NULL);
+  WizardAssert(HashDomain,merkle_info->signature == WizardSignature);
+  return(merkle_info->blocksize);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t M e r k l e D i g e s t                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetMerkleDigest() returns the Merkle tree digest.
+%
+%  The format of the GetMerkleDigest method is:
+%
+%      const StringInfo *GetMerkleDigest(const MerkleInfo *merkle_info)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The merkle info.
+%
+*/
+WizardExport const StringInfo *GetMerkleDigest(const MerkleInfo *merkle_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,merkle_info != (MerkleInfo *) NULL);
+  WizardAssert(HashDomain,merkle_info->signature == WizardSignature);
+  return(merkle_info->digest);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t M e r k l e D i g e s t s i z e                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetMerkleDigestsize() returns the Merkle tree digest size.
+%
+%  The format of the GetMerkleDigestsize method is:
+%
+%      unsigned int *GetMerkleDigestsize(const MerkleInfo *merkle_info)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The merkle info.
+%
+*/
+WizardExport unsigned int GetMerkleDigestsize(const MerkleInfo *merkle_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(HashDomain,merkle_info != (MerkleInfo *) NULL);
+  WizardAssert(HashDomain,merkle_info->signature == WizardSignature);
+  return(merkle_info->digestsize);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t M e r k l e S t a t e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportMerkleState() restores a tree returned by ExportMerkleState().  The
+%  pending input is rehashed here, so the state resumes correctly whatever
+%  the thread count of either side.  WizardFalse is returned if the state is
+%  inconsistent.
+%
+%  The format of the ImportMerkleState method is:
+%
+%      WizardBooleanType ImportMerkleState(MerkleInfo *merkle_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The address of a structure of type MerkleInfo.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportMerkleState(MerkleInfo *merkle_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    bits,
+    depth,
+    extent;
+
+  WizardSizeType
+    count,
+    n;
+
+  assert(merkle_info != (MerkleInfo *) NULL);
+  assert(merkle_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < 20)
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  count=ImportHashWord(&p,8);
+  depth=(size_t) ImportHashWord(&p,4);
+  extent=(size_t) ImportHashWord(&p,8);
+  /*
+    The stack holds one subtree per set bit of the leaf count.
+  */
+  bits=0;
+  for (n=count; n != 0; n>>=1)
+    bits+=(size_t) (n & 0x01);
+  if ((depth != bits) || (depth > MerkleMaxDepth) ||
+      (GetStringInfoLength(state) != (20+depth*merkle_info->digestsize+
+       extent)))
+    return(WizardFalse);
+  (void) memcpy(merkle_info->stack,p,depth*merkle_info->digestsize);
+  p+=depth*merkle_info->digestsize;
+  merkle_info->count=count;
+  merkle_info->depth=depth;
+  merkle_info->extent=0;
+  return(UpdateMerkleBytes(merkle_info,p,extent));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n i t i a l i z e M e r k l e                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  InitializeMerkle() initializes the Merkle tree digest.
+%
+%  The format of the InitializeMerkle method is:
+%
+%      WizardBooleanType InitializeMerkle(MerkleInfo *merkle_info)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The address of a structure of type MerkleInfo.
+%
+*/
+WizardExport WizardBooleanType InitializeMerkle(MerkleInfo *merkle_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  assert(merkle_info != (MerkleInfo *) NULL);
+  assert(merkle_info->signature == WizardSignature);
+  merkle_info->extent=0;
+  merkle_info->depth=0;
+  merkle_info->count=0;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e M e r k l e                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateMerkle() updates the Merkle tree digest.
+%
+%  The format of the UpdateMerkle method is:
+%
+%      WizardBooleanType UpdateMerkle(MerkleInfo *merkle_info,
+%        const StringInfo *message)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The address of a structure of type MerkleInfo.
+%
+%    o message: The message.
+%
+*/
+WizardExport WizardBooleanType UpdateMerkle(MerkleInfo *merkle_info,
+  const StringInfo *message)
+{
+  return(UpdateMerkleBytes(merkle_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e M e r k l e B y t e s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateMerkleBytes() updates the Merkle tree digest from the caller's
+%  memory.  Whole leaves are hashed in parallel where they lie; any other
+%  input is buffered, one leaf per thread, and hashed once the buffer fills.
+%
+%  The format of the UpdateMerkleBytes method is:
+%
+%      WizardBooleanType UpdateMerkleBytes(MerkleInfo *merkle_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o merkle_info: The address of a structure of type MerkleInfo.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+WizardExport WizardBooleanType UpdateMerkleBytes(MerkleInfo *merkle_info,
+  const void *message,const size_t extent)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    length,
+    n;
+
+  assert(merkle_info != (MerkleInfo *) NULL);
+  assert(merkle_info->signature == WizardSignature);
+  p=(const unsigned char *) message;
+  length=extent;
+  while (length != 0)
+  {
+    if ((merkle_info->extent == 0) && (length >= MerkleLeafsize))
+      {
+        n=Min(length/MerkleLeafsize,merkle_info->threads);
+        HashMerkleLeaves(merkle_info,p,n,MerkleLeafsize);
+        p+=n*MerkleLeafsize;
+        length-=n*MerkleLeafsize;
+        continue;
+      }
+    if (merkle_info->leaves == (unsigned char *) NULL)
+      {
+        merkle_info->leaves=(unsigned char *) AcquireQuantumMemory(
+          merkle_info->threads,MerkleLeafsize*sizeof(*merkle_info->leaves));
+        if (merkle_info->leaves == (unsigned char *) NULL)
+          ThrowWizardFatalError(HashDomain,MemoryError);
+      }
+    n=Min(merkle_info->threads*MerkleLeafsize-merkle_info->extent,length);
+    (void) memcpy(merkle_info->leaves+merkle_info->extent,p,n);
+    merkle_info->extent+=n;
+    p+=n;
+    length-=n;
+    if (merkle_info->extent == (merkle_info->threads*MerkleLeafsize))
+      {
+        HashMerkleLeaves(merkle_info,merkle_info->leaves,merkle_info->threads,
+          MerkleLeafsize);
+        merkle_info->extent=0;
+      }
+  }
+  return(WizardTrue);
+}
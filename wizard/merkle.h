@@ -0,0 +1,55 @@
+/*
+  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard's Toolkit Merkle tree hash methods.
+*/
+#ifndef _WIZARDSTOOLKIT_MERKLE_H
+#define _WIZARDSTOOLKIT_MERKLE_H
+
+#include "wizard/hash.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+typedef struct _MerkleInfo
+  MerkleInfo;
+
+extern WizardExport MerkleInfo
+  *AcquireMerkleInfo(const HashType),
+  *DestroyMerkleInfo(MerkleInfo *);
+
+extern WizardExport StringInfo
+  *ExportMerkleState(const MerkleInfo *);
+
+extern WizardExport const StringInfo
+  *GetMerkleDigest(const MerkleInfo *);
+
+extern WizardExport unsigned int
+  GetMerkleBlocksize(const MerkleInfo *),
+  GetMerkleDigestsize(const MerkleInfo *);
+
+extern WizardExport WizardBooleanType
+  ImportMerkleState(MerkleInfo *,const StringInfo *),
+  InitializeMerkle(MerkleInfo *),
+  FinalizeMerkle(MerkleInfo *),
+  UpdateMerkle(MerkleInfo *,const StringInfo *),
+  UpdateMerkleBytes(MerkleInfo *,const void *,const size_t);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
@@ -162,12 +162,15 @@ static const OptionInfo
   HashOptions[] =
   {
     { "Undefined", (ssize_t) UndefinedHash },
+    { "BLAKE3", (ssize_t) BLAKE3Hash },
+    { "CRC32C", (ssize_t) CRC32CHash },
     { "CRC64", (ssize_t) CRC64Hash },
     { "MD5", (ssize_t) MD5Hash },
     { "None", (ssize_t) NoHash },
     { "SHA1", (ssize_t) SHA1Hash },
     { "SHA224", (ssize_t) SHA2224Hash },
     { "SHA256", (ssize_t) SHA2256Hash },
+    { "SHA256-Tree", (ssize_t) SHA2256TreeHash },
     { "SHA384", (ssize_t) SHA2384Hash },
     { "SHA512", (ssize_t) SHA2512Hash },
     { "SHA2", (ssize_t) SHA2Hash },
@@ -220,7 +223,10 @@ static const OptionInfo
     { "CFB", (ssize_t) CFBMode },
     { "CTR", (ssize_t) CTRMode },
     { "ECB", (ssize_t) ECBMode },
+    { "GCM", (ssize_t) GCMMode },
     { "OFB", (ssize_t) OFBMode },
+    { "Poly1305", (ssize_t) Poly1305Mode },
+    { "XTS", (ssize_t) XTSMode },
     { (char *) NULL, UndefinedMode }
   },
   ResourceOptions[] =
@@ -0,0 +1,811 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%           PPPP    OOO   L      Y   Y    1    3333    000   55555            %
+%           P   P  O   O  L       Y Y    11        3  0   0  5                %
+%           PPPP   O   O  L        Y      1     333   0   0  5555             %
+%           P      O   O  L        Y      1        3  0   0      5            %
+%           P       OOO   LLLLL    Y    11111  3333    000   5555             %
+%                                                                             %
+%                                                                             %
+%          Wizard's Toolkit Poly1305 Message Authentication Code Methods      %
+%                                                                             %
+%                               Software Design                               %
+%                                   Cristy                                    %
+%                                 March 2003                                  %
+%                                                                             %
+%                                                                             %
+%  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization         %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+% Poly1305 is a one-time authenticator: it evaluates the message as a
+% polynomial at the key r modulo 2^130-5 and adds s.  See RFC 8439.
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "wizard/studio.h"
+#include "wizard/cpu-private.h"
+#include "wizard/exception.h"
+#include "wizard/exception-private.h"
+#include "wizard/memory_.h"
+#include "wizard/poly1305.h"
+
+/*
+  Define declarations.
+*/
+#define Poly1305Blocksize  16
+#define Poly1305Digestsize  16
+#define Poly1305Mask  0x3ffffffU
+#define PushPoly1305Word(p) \
+  (((unsigned int) ((p)[0]) <<  0) | \
+   ((unsigned int) ((p)[1]) <<  8) | \
+   ((unsigned int) ((p)[2]) << 16) | \
+   ((unsigned int) ((p)[3]) << 24))
+
+/*
+  Typedef declarations.
+*/
+#if defined(__SIZEOF_INT128__)
+typedef unsigned __int128
+  Poly1305Product;
+#endif
+
+struct _Poly1305Info
+{
+  unsigned int
+    digestsize,
+    blocksize;
+
+  StringInfo
+    *digest;
+
+  unsigned int
+    accumulator[5],
+    pad[4],
+    powers[4][5];
+
+  unsigned char
+    buffer[Poly1305Blocksize];
+
+  size_t
+    count;
+
+  WizardBooleanType
+    avx2;
+
+  time_t
+    timestamp;
+
+  size_t
+    signature;
+};
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   A c q u i r e P o l y 1 3 0 5 I n f o                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquirePoly1305Info() allocate the Poly1305Info structure.
+%
+%  The format of the AcquirePoly1305Info method is:
+%
+%      Poly1305Info *AcquirePoly1305Info(void)
+%
+*/
+WizardExport Poly1305Info *AcquirePoly1305Info(void)
+{
+  Poly1305Info
+    *poly1305_info;
+
+  poly1305_info=(Poly1305Info *) AcquireWizardMemory(sizeof(*poly1305_info));
+  if (poly1305_info == (Poly1305Info *) NULL)
+    ThrowWizardFatalError(MACDomain,MemoryError);
+  (void) memset(poly1305_info,0,sizeof(*poly1305_info));
+  poly1305_info->digestsize=Poly1305Digestsize;
+  poly1305_info->blocksize=Poly1305Blocksize;
+  poly1305_info->digest=AcquireStringInfo(Poly1305Digestsize);
+  poly1305_info->avx2=HasCPUFeature(AVX2CPUFeature);
+  poly1305_info->timestamp=time((time_t *) NULL);
+  poly1305_info->signature=WizardSignature;
+  return(poly1305_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y P o l y 1 3 0 5 I n f o                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyPoly1305Info() zeros memory associated with the Poly1305Info
+%  structure.
+%
+%  The format of the DestroyPoly1305Info method is:
+%
+%      Poly1305Info *DestroyPoly1305Info(Poly1305Info *poly1305_info)
+%
+%  A description of each parameter follows:
+%
+%    o poly1305_info: The poly1305 info.
+%
+*/
+WizardExport Poly1305Info *DestroyPoly1305Info(Poly1305Info *poly1305_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(MACDomain,poly1305_info != (Poly1305Info *) NULL);
+  WizardAssert(MACDomain,poly1305_info->signature == WizardSignature);
+  if (poly1305_info->digest != (StringInfo *) NULL)
+    poly1305_info->digest=DestroyStringInfo(poly1305_info->digest);
+  (void) ResetWizardMemory(poly1305_info,0,sizeof(*poly1305_info));
+  poly1305_info->signature=(~WizardSignature);
+  poly1305_info=(Poly1305Info *) RelinquishWizardMemory(poly1305_info);
+  return(poly1305_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   F i n a l i z e P o l y 1 3 0 5                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FinalizePoly1305() finalizes the Poly1305 message authentication code.
+%
+%  The format of the FinalizePoly1305 method is:
+%
+%      WizardBooleanType FinalizePoly1305(Poly1305Info *poly1305_info)
+%
+%  A description of each parameter follows:
+%
+%    o poly1305_info: The address of a structure of type Poly1305Info.
+%
+*/
+
+static inline void MultiplyPoly1305(const unsigned int *alpha,
+  const unsigned int *beta,unsigned int *product)
+{
+  unsigned int
+    s1,
+    s2,
+    s3,
+    s4;
+
+  WizardSizeType
+    carry,
+    d0,
+    d1,
+    d2,
+    d3,
+    d4;
+
+  /*
+    Multiply modulo 2^130-5 in five 26-bit limbs, 2^130 = 5.
+  */
+  s1=5*beta[1];
+  s2=5*beta[2];
+  s3=5*beta[3];
+  s4=5*beta[4];
+  d0=(WizardSizeType) alpha[0]*beta[0]+(WizardSizeType) alpha[1]*s4+
+    (WizardSizeType) alpha[2]*s3+(WizardSizeType) alpha[3]*s2+
+    (WizardSizeType) alpha[4]*s1;
+  d1=(WizardSizeType) alpha[0]*beta[1]+(WizardSizeType) alpha[1]*beta[0]+
+    (WizardSizeType) alpha[2]*s4+(WizardSizeType) alpha[3]*s3+
+    (WizardSizeType) alpha[4]*s2;
+  d2=(WizardSizeType) alpha[0]*beta[2]+(WizardSizeType) alpha[1]*beta[1]+
+    (WizardSizeType) alpha[2]*beta[0]+(WizardSizeType) alpha[3]*s4+
+    (WizardSizeType) alpha[4]*s3;
+  d3=(WizardSizeType) alpha[0]*beta[3]+(WizardSizeType) alpha[1]*beta[2]+
+    (WizardSizeType) alpha[2]*beta[1]+(WizardSizeType) alpha[3]*beta[0]+
+    (WizardSizeType) alpha[4]*s4;
+  d4=(WizardSizeType) alpha[0]*beta[4]+(WizardSizeType) alpha[1]*beta[3]+
+    (WizardSizeType) alpha[2]*beta[2]+(WizardSizeType) alpha[3]*beta[1]+
+    (WizardSizeType) alpha[4]*beta[0];
+  carry=d0 >> 26;
+  product[0]=(unsigned int) (d0 & Poly1305Mask);
+  d1+=carry;
+  carry=d1 >> 26;
+  product[1]=(unsigned int) (d1 & Poly1305Mask);
+  d2+=carry;
+  carry=d2 >> 26;
+  product[2]=(unsigned int) (d2 & Poly1305Mask);
+  d3+=carry;
+  carry=d3 >> 26;
+  product[3]=(unsigned int) (d3 & Poly1305Mask);
+  d4+=carry;
+  carry=d4 >> 26;
+  product[4]=(unsigned int) (d4 & Poly1305Mask);
+  product[0]+=(unsigned int) (5*carry);
+  carry=product[0] >> 26;
+  product[0]&=Poly1305Mask;
+  product[1]+=(unsigned int) carry;
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static WizardTarget("avx2") void TransformPoly1305AVX2(
+  Poly1305Info *poly1305_info,const unsigned char *message,const size_t blocks)
+{
+#define MultiplyPoly1305AVX2(x,y)  _mm256_mul_epu32(x,y)
+
+  __m256i
+    accumulator[5],
+    carry,
+    d[5],
+    mask,
+    power[5],
+    powers[5],
+    scale[5],
+    scales[5],
+    x,
+    y;
+
+  ssize_t
+    i;
+
+  size_t
+    j;
+
+  WizardSizeType
+    carries,
+    lanes[4],
+    sum[5];
+
+  /*
+    Four interleaved Horner chains in r^4; the last step multiplies each
+    chain by r^4, r^3, r^2, and r so they sum to the serial result.
+  */
+  mask=_mm256_set1_epi64x(Poly1305Mask);
+  for (i=0; i < 5; i++)
+  {
+    accumulator[i]=_mm256_set_epi64x(0,0,0,(long long)
+      poly1305_info->accumulator[i]);
+    power[i]=_mm256_set1_epi64x(poly1305_info->powers[3][i]);
+    powers[i]=_mm256_set_epi64x(poly1305_info->powers[0][i],
+      poly1305_info->powers[1][i],poly1305_info->powers[2][i],
+      poly1305_info->powers[3][i]);
+    scale[i]=_mm256_add_epi64(_mm256_slli_epi64(power[i],2),power[i]);
+    scales[i]=_mm256_add_epi64(_mm256_slli_epi64(powers[i],2),powers[i]);
+  }
+  for (j=0; j < blocks; j+=4)
+  {
+    const __m256i
+      *r,
+      *s;
+
+    x=_mm256_loadu_si256((const __m256i *) message);
+    y=_mm256_loadu_si256((const __m256i *) (message+32));
+    carry=_mm256_permute4x64_epi64(_mm256_unpacklo_epi64(x,y),0xd8);
+    y=_mm256_permute4x64_epi64(_mm256_unpackhi_epi64(x,y),0xd8);
+    x=carry;
+    accumulator[0]=_mm256_add_epi64(accumulator[0],_mm256_and_si256(x,mask));
+    accumulator[1]=_mm256_add_epi64(accumulator[1],_mm256_and_si256(
+      _mm256_srli_epi64(x,26),mask));
+    accumulator[2]=_mm256_add_epi64(accumulator[2],_mm256_and_si256(
+      _mm256_or_si256(_mm256_srli_epi64(x,52),_mm256_slli_epi64(y,12)),mask));
+    accumulator[3]=_mm256_add_epi64(accumulator[3],_mm256_and_si256(
+      _mm256_srli_epi64(y,14),mask));
+    accumulator[4]=_mm256_add_epi64(accumulator[4],_mm256_or_si256(
+      _mm256_srli_epi64(y,40),_mm256_set1_epi64x(1 << 24)));
+    r=(j+4) < blocks ? power : powers;
+    s=(j+4) < blocks ? scale : scales;
+    d[0]=_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[0],r[0]),
+      MultiplyPoly1305AVX2(accumulator[1],s[4])),_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[2],s[3]),
+      MultiplyPoly1305AVX2(accumulator[3],s[2]))),
+      MultiplyPoly1305AVX2(accumulator[4],s[1]));
+    d[1]=_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[0],r[1]),
+      MultiplyPoly1305AVX2(accumulator[1],r[0])),_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[2],s[4]),
+      MultiplyPoly1305AVX2(accumulator[3],s[3]))),
+      MultiplyPoly1305AVX2(accumulator[4],s[2]));
+    d[2]=_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[0],r[2]),
+      MultiplyPoly1305AVX2(accumulator[1],r[1])),_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[2],r[0]),
+      MultiplyPoly1305AVX2(accumulator[3],s[4]))),
+      MultiplyPoly1305AVX2(accumulator[4],s[3]));
+    d[3]=_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[0],r[3]),
+      MultiplyPoly1305AVX2(accumulator[1],r[2])),_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[2],r[1]),
+      MultiplyPoly1305AVX2(accumulator[3],r[0]))),
+      MultiplyPoly1305AVX2(accumulator[4],s[4]));
+    d[4]=_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[0],r[4]),
+      MultiplyPoly1305AVX2(accumulator[1],r[3])),_mm256_add_epi64(
+      MultiplyPoly1305AVX2(accumulator[2],r[2]),
+      MultiplyPoly1305AVX2(accumulator[3],r[1]))),
+      MultiplyPoly1305AVX2(accumulator[4],r[0]));
+    for (i=0; i < 4; i++)
+    {
+      carry=_mm256_srli_epi64(d[i],26);
+      accumulator[i]=_mm256_and_si256(d[i],mask);
+      d[i+1]=_mm256_add_epi64(d[i+1],carry);
+    }
+    carry=_mm256_srli_epi64(d[4],26);
+    accumulator[4]=_mm256_and_si256(d[4],mask);
+    accumulator[0]=_mm256_add_epi64(accumulator[0],_mm256_add_epi64(
+      _mm256_slli_epi64(carry,2),carry));
+    carry=_mm256_srli_epi64(accumulator[0],26);
+    accumulator[0]=_mm256_and_si256(accumulator[0],mask);
+    accumulator[1]=_mm256_add_epi64(accumulator[1],carry);
+    message+=4*Poly1305Blocksize;
+  }
+  /*
+    Sum the chains.
+  */
+  for (i=0; i < 5; i++)
+  {
+    _mm256_storeu_si256((__m256i *) lanes,accumulator[i]);
+    sum[i]=lanes[0]+lanes[1]+lanes[2]+lanes[3];
+  }
+  carries=0;
+  for (i=0; i < 5; i++)
+  {
+    sum[i]+=carries;
+    carries=sum[i] >> 26;
+    sum[i]&=Poly1305Mask;
+  }
+  sum[0]+=5*carries;
+  carries=sum[0] >> 26;
+  sum[0]&=Poly1305Mask;
+  sum[1]+=carries;
+  for (i=0; i < 5; i++)
+    poly1305_info->accumulator[i]=(unsigned int) sum[i];
+  /*
+    Reset registers.
+  */
+  for (i=0; i < 5; i++)
+  {
+    accumulator[i]=_mm256_setzero_si256();
+    power[i]=_mm256_setzero_si256();
+    powers[i]=_mm256_setzero_si256();
+  }
+  (void) ResetWizardMemory(lanes,0,sizeof(lanes));
+}
+#endif
+
+static void TransformPoly1305(Poly1305Info *poly1305_info,
+  const unsigned char *message,size_t blocks,const unsigned int final)
+{
+  unsigned int
+    *h,
+    hibit;
+
+  /*
+    Accumulate blocks, a final partial block carries its own 2^(8*n) bit.
+  */
+  hibit=final != 0 ? 0 : (1U << 24);
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if ((poly1305_info->avx2 != WizardFalse) && (final == 0) && (blocks >= 16))
+    {
+      size_t
+        n;
+
+      n=blocks & ~(size_t) 0x03;
+      TransformPoly1305AVX2(poly1305_info,message,n);
+      message+=n*Poly1305Blocksize;
+      blocks-=n;
+    }
+#endif
+  h=poly1305_info->accumulator;
+#if defined(__SIZEOF_INT128__)
+  {
+    Poly1305Product
+      d0,
+      d1,
+      d2;
+
+    WizardSizeType
+      carry,
+      h0,
+      h1,
+      h2,
+      r0,
+      r1,
+      r2,
+      s1,
+      s2,
+      t0,
+      t1;
+
+    unsigned int
+      *r;
+
+    /*
+      Three 44-bit limbs with 128-bit products, 2^130 = 5.
+    */
+    r=poly1305_info->powers[0];
+    r0=(WizardSizeType) r[0] | ((WizardSizeType) r[1] << 26);
+    r1=(r0 >> 44) | ((WizardSizeType) r[2] << 8) |
+      ((WizardSizeType) r[3] << 34);
+    r0&=WizardULLConstant(0xfffffffffff);
+    r2=(r1 >> 44) | ((WizardSizeType) r[4] << 16);
+    r1&=WizardULLConstant(0xfffffffffff);
+    s1=r1*(5 << 2);
+    s2=r2*(5 << 2);
+    h0=(WizardSizeType) h[0]+((WizardSizeType) h[1] << 26);
+    carry=h0 >> 44;
+    h0&=WizardULLConstant(0xfffffffffff);
+    h1=carry+((WizardSizeType) h[2] << 8)+((WizardSizeType) h[3] << 34);
+    carry=h1 >> 44;
+    h1&=WizardULLConstant(0xfffffffffff);
+    h2=carry+((WizardSizeType) h[4] << 16);
+    for ( ; blocks != 0; blocks--)
+    {
+      t0=(WizardSizeType) PushPoly1305Word(message) |
+        ((WizardSizeType) PushPoly1305Word(message+4) << 32);
+      t1=(WizardSizeType) PushPoly1305Word(message+8) |
+        ((WizardSizeType) PushPoly1305Word(message+12) << 32);
+      h0+=t0 & WizardULLConstant(0xfffffffffff);
+      h1+=((t0 >> 44) | (t1 << 20)) & WizardULLConstant(0xfffffffffff);
+      h2+=((t1 >> 24) & WizardULLConstant(0x3ffffffffff)) |
+        ((WizardSizeType) hibit << 16);
+      d0=(Poly1305Product) h0*r0+(Poly1305Product) h1*s2+
+        (Poly1305Product) h2*s1;
+      d1=(Poly1305Product) h0*r1+(Poly1305Product) h1*r0+
+        (Poly1305Product) h2*s2;
+      d2=(Poly1305Product) h0*r2+(Poly1305Product) h1*r1+
+        (Poly1305Product) h2*r0;
+      carry=(WizardSizeType) (d0 >> 44);
+      h0=(WizardSizeType) d0 & WizardULLConstant(0xfffffffffff);
+      d1+=carry;
+      carry=(WizardSizeType) (d1 >> 44);
+      h1=(WizardSizeType) d1 & WizardULLConstant(0xfffffffffff);
+      d2+=carry;
+      carry=(WizardSizeType) (d2 >> 42);
+      h2=(WizardSizeType) d2 & WizardULLConstant(0x3ffffffffff);
+      h0+=5*carry;
+      carry=h0 >> 44;
+      h0&=WizardULLConstant(0xfffffffffff);
+      h1+=carry;
+      message+=Poly1305Blocksize;
+    }
+    /*
+      Back to 26-bit limbs.
+    */
+    h[0]=(unsigned int) (h0 & Poly1305Mask);
+    carry=(h0 >> 26)+(h1 << 18);
+    h[1]=(unsigned int) (carry & Poly1305Mask);
+    carry>>=26;
+    h[2]=(unsigned int) (carry & Poly1305Mask);
+    carry=(carry >> 26)+(h2 << 10);
+    h[3]=(unsigned int) (carry & Poly1305Mask);
+    h[4]=(unsigned int) (carry >> 26);
+    /*
+      Reset registers.
+    */
+    r0=0;
+    r1=0;
+    r2=0;
+    s1=0;
+    s2=0;
+  }
+#else
+  for ( ; blocks != 0; blocks--)
+  {
+    h[0]+=PushPoly1305Word(message) & Poly1305Mask;
+    h[1]+=(PushPoly1305Word(message+3) >> 2) & Poly1305Mask;
+    h[2]+=(PushPoly1305Word(message+6) >> 4) & Poly1305Mask;
+    h[3]+=(PushPoly1305Word(message+9) >> 6) & Poly1305Mask;
+    h[4]+=(PushPoly1305Word(message+12) >> 8) | hibit;
+    MultiplyPoly1305(h,poly1305_info->powers[0],h);
+    message+=Poly1305Blocksize;
+  }
+#endif
+}
+
+WizardExport WizardBooleanType FinalizePoly1305(Poly1305Info *poly1305_info)
+{
+  ssize_t
+    i;
+
+  unsigned char
+    *datum;
+
+  unsigned int
+    carry,
+    g[5],
+    *h,
+    mask;
+
+  WizardSizeType
+    sum;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(MACDomain,poly1305_info != (Poly1305Info *) NULL);
+  WizardAssert(MACDomain,poly1305_info->signature == WizardSignature);
+  if (poly1305_info->count != 0)
+    {
+      /*
+        Pad the final partial block with a one and zeros.
+      */
+      poly1305_info->buffer[poly1305_info->count]=1;
+      for (i=(ssize_t) poly1305_info->count+1; i < Poly1305Blocksize; i++)
+        poly1305_info->buffer[i]=0;
+      TransformPoly1305(poly1305_info,poly1305_info->buffer,1,1);
+    }
+  /*
+    Fully carry h, then subtract p if h >= p, in constant time.
+  */
+  h=poly1305_info->accumulator;
+  carry=h[1] >> 26;
+  h[1]&=Poly1305Mask;
+  for (i=2; i < 5; i++)
+  {
+    h[i]+=carry;
+    carry=h[i] >> 26;
+    h[i]&=Poly1305Mask;
+  }
+  h[0]+=5*carry;
+  carry=h[0] >> 26;
+  h[0]&=Poly1305Mask;
+  h[1]+=carry;
+  g[0]=h[0]+5;
+  carry=g[0] >> 26;
+  g[0]&=Poly1305Mask;
+  for (i=1; i < 5; i++)
+  {
+    g[i]=h[i]+carry;
+    carry=g[i] >> 26;
+    g[i]&=Poly1305Mask;
+  }
+  g[4]=(g[4] | (carry << 26))-(1U << 26);
+  mask=(g[4] >> 31)-1;
+  for (i=0; i < 5; i++)
+    h[i]=(h[i] & ~mask) | (g[i] & mask);
+  /*
+    The digest is (h + s) mod 2^128, little-endian.
+  */
+  g[0]=h[0] | (h[1] << 26);
+  g[1]=(h[1] >> 6) | (h[2] << 20);
+  g[2]=(h[2] >> 12) | (h[3] << 14);
+  g[3]=(h[3] >> 18) | (h[4] << 8);
+  datum=GetStringInfoDatum(poly1305_info->digest);
+  sum=0;
+  for (i=0; i < 4; i++)
+  {
+    sum+=(WizardSizeType) g[i]+poly1305_info->pad[i];
+    datum[4*i+0]=(unsigned char) sum;
+    datum[4*i+1]=(unsigned char) (sum >> 8);
+    datum[4*i+2]=(unsigned char) (sum >> 16);
+    datum[4*i+3]=(unsigned char) (sum >> 24);
+    sum>>=32;
+  }
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(g,0,sizeof(g));
+  (void) ResetWizardMemory(poly1305_info->accumulator,0,
+    sizeof(poly1305_info->accumulator));
+  (void) ResetWizardMemory(poly1305_info->pad,0,sizeof(poly1305_info->pad));
+  (void) ResetWizardMemory(poly1305_info->powers,0,
+    sizeof(poly1305_info->powers));
+  (void) ResetWizardMemory(poly1305_info->buffer,0,
+    sizeof(poly1305_info->buffer));
+  poly1305_info->count=0;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t P o l y 1 3 0 5 D i g e s t                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetPoly1305Digest() returns the Poly1305 message authentication code.
+%
+%  The format of the GetPoly1305Digest method is:
+%
+%      const StringInfo *GetPoly1305Digest(const Poly1305Info *poly1305_info)
+%
+%  A description of each parameter follows:
+%
+%    o poly1305_info: The poly1305 info.
+%
+*/
+WizardExport const StringInfo *GetPoly1305Digest(
+  const Poly1305Info *poly1305_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(MACDomain,poly1305_info != (Poly1305Info *) NULL);
+  WizardAssert(MACDomain,poly1305_info->signature == WizardSignature);
+  return(poly1305_info->digest);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t P o l y 1 3 0 5 D i g e s t s i z e                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetPoly1305Digestsize() returns the Poly1305 digest size.
+%
+%  The format of the GetPoly1305Digestsize method is:
+%
+%      unsigned int GetPoly1305Digestsize(const Poly1305Info *poly1305_info)
+%
+%  A description of each parameter follows:
+%
+%    o poly1305_info: The poly1305 info.
+%
+*/
+WizardExport unsigned int GetPoly1305Digestsize(
+  const Poly1305Info *poly1305_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(MACDomain,poly1305_info != (Poly1305Info *) NULL);
+  WizardAssert(MACDomain,poly1305_info->signature == WizardSignature);
+  return(poly1305_info->digestsize);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n i t i a l i z e P o l y 1 3 0 5                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  InitializePoly1305() initializes the Poly1305 message authentication code
+%  with a one-time key.  The key must never authenticate two messages.
+%
+%  The format of the InitializePoly1305 method is:
+%
+%      WizardBooleanType InitializePoly1305(Poly1305Info *poly1305_info,
+%        const unsigned char *key)
+%
+%  A description of each parameter follows:
+%
+%    o poly1305_info: The address of a structure of type Poly1305Info.
+%
+%    o key: The 32-byte one-time key, r followed by s.
+%
+*/
+WizardExport WizardBooleanType InitializePoly1305(Poly1305Info *poly1305_info,
+  const unsigned char *key)
+{
+  ssize_t
+    i;
+
+  unsigned int
+    *r;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(MACDomain,poly1305_info != (Poly1305Info *) NULL);
+  WizardAssert(MACDomain,poly1305_info->signature == WizardSignature);
+  WizardAssert(MACDomain,key != (const unsigned char *) NULL);
+  /*
+    Clamp r, then precompute r^2, r^3, and r^4 for the interleaved chains.
+  */
+  r=poly1305_info->powers[0];
+  r[0]=PushPoly1305Word(key+0) & 0x3ffffff;
+  r[1]=(PushPoly1305Word(key+3) >> 2) & 0x3ffff03;
+  r[2]=(PushPoly1305Word(key+6) >> 4) & 0x3ffc0ff;
+  r[3]=(PushPoly1305Word(key+9) >> 6) & 0x3f03fff;
+  r[4]=(PushPoly1305Word(key+12) >> 8) & 0x00fffff;
+  for (i=1; i < 4; i++)
+    MultiplyPoly1305(poly1305_info->powers[i-1],r,poly1305_info->powers[i]);
+  for (i=0; i < 4; i++)
+    poly1305_info->pad[i]=PushPoly1305Word(key+16+4*i);
+  (void) memset(poly1305_info->accumulator,0,
+    sizeof(poly1305_info->accumulator));
+  poly1305_info->count=0;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e P o l y 1 3 0 5                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdatePoly1305() authenticates a message in place, it can be called
+%  repeatedly with successive parts of the message.  Long runs of whole blocks
+%  are accumulated four at a time with AVX2 when the processor supports it.
+%
+%  The format of the UpdatePoly1305 method is:
+%
+%      WizardBooleanType UpdatePoly1305(Poly1305Info *poly1305_info,
+%        const unsigned char *message,const size_t length)
+%
+%  A description of each parameter follows:
+%
+%    o poly1305_info: The address of a structure of type Poly1305Info.
+%
+%    o message: The message.
+%
+%    o length: The length of the message in bytes.
+%
+*/
+WizardExport WizardBooleanType UpdatePoly1305(Poly1305Info *poly1305_info,
+  const unsigned char *message,const size_t length)
+{
+  size_t
+    n,
+    remaining;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(MACDomain,poly1305_info != (Poly1305Info *) NULL);
+  WizardAssert(MACDomain,poly1305_info->signature == WizardSignature);
+  remaining=length;
+  if (poly1305_info->count != 0)
+    {
+      /*
+        Complete the buffered block.
+      */
+      n=Min(remaining,Poly1305Blocksize-poly1305_info->count);
+      (void) memcpy(poly1305_info->buffer+poly1305_info->count,message,n);
+      poly1305_info->count+=n;
+      message+=n;
+      remaining-=n;
+      if (poly1305_info->count < Poly1305Blocksize)
+        return(WizardTrue);
+      TransformPoly1305(poly1305_info,poly1305_info->buffer,1,0);
+      poly1305_info->count=0;
+    }
+  n=remaining/Poly1305Blocksize;
+  if (n != 0)
+    {
+      TransformPoly1305(poly1305_info,message,n,0);
+      message+=n*Poly1305Blocksize;
+      remaining-=n*Poly1305Blocksize;
+    }
+  if (remaining != 0)
+    {
+      (void) memcpy(poly1305_info->buffer,message,remaining);
+      poly1305_info->count=remaining;
+    }
+  return(WizardTrue);
+}
@@ -0,0 +1,47 @@
+/*
+  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard's Toolkit Poly1305 message authentication code methods.
+*/
+#ifndef _WIZARDSTOOLKIT_POLY1305_H
+#define _WIZARDSTOOLKIT_POLY1305_H
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+typedef struct _Poly1305Info
+  Poly1305Info;
+
+extern WizardExport const StringInfo
+  *GetPoly1305Digest(const Poly1305Info *);
+
+extern WizardExport Poly1305Info
+  *AcquirePoly1305Info(void),
+  *DestroyPoly1305Info(Poly1305Info *);
+
+extern WizardExport unsigned int
+  GetPoly1305Digestsize(const Poly1305Info *);
+
+extern WizardExport WizardBooleanType
+  FinalizePoly1305(Poly1305Info *),
+  InitializePoly1305(Poly1305Info *,const unsigned char *),
+  UpdatePoly1305(Poly1305Info *,const unsigned char *,const size_t);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
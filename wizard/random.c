@@ -43,6 +43,8 @@
 #include <sys/time.h>
 #endif
 #include "wizard/studio.h"
+#include "wizard/aes.h"
+#include "wizard/chacha.h"
 #include "wizard/entropy.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
@@ -55,7 +57,8 @@
 #include "wizard/thread-private.h"
 #include "wizard/semaphore.h"
 #include "wizard/utility-private.h"
-#if defined(WIZARDSTOOLKIT_HAVE_GETENTROPY)
+#if defined(WIZARDSTOOLKIT_HAVE_GETENTROPY) || \
+    defined(WIZARDSTOOLKIT_HAVE_GETRANDOM)
 #include <sys/random.h>
 #endif
 
@@ -66,8 +69,12 @@
 #define RandomEntropyLevel  9
 #define RandomFilename  "reservoir.xdm"
 #define RandomFiletype  "random"
+#define RandomKeystreamExtent  512
 #define RandomProtocolMajorVersion  1
 #define RandomProtocolMinorVersion  1
+#define RandomRekeyExtent  1048576
+#define RandomSeedExtent  64
+#define ThreadRandomHash  SHA2256Hash
 
 /*
   Typedef declarations.
@@ -84,6 +91,29 @@ struct _RandomInfo
   size_t
     i;
 
+  RandomGenerator
+    generator;
+
+  AESInfo
+    *aes_info;
+
+  ChachaInfo
+    *chacha_info;
+
+  unsigned char
+    counter[16],
+    keystream[RandomKeystreamExtent];
+
+  size_t
+    offset,
+    extent;
+
+  WizardBooleanType
+    shared;
+
+  size_t
+    generation;
+
   WizardSizeType
     seed[4];
 
@@ -121,9 +151,24 @@ extern char
 /*
   Global declarations.
 */
+static RandomInfo
+  *random_root = (RandomInfo *) NULL;
+
 static SemaphoreInfo
   *random_semaphore = (SemaphoreInfo *) NULL;
 
+static size_t
+  random_generation = 0;
+
+static RandomInfo
+  *random_shared = (RandomInfo *) NULL;
+
+static WizardThreadKey
+  random_key;
+
+static WizardBooleanType
+  random_key_created = WizardFalse;
+
 static unsigned long
   secret_key = ~0UL;
 
@@ -133,6 +178,9 @@ static WizardBooleanType
 /*
   Forward declarations.
 */
+static void
+  RekeyRandomKeystream(RandomInfo *);
+
 static WizardBooleanType
   SaveEntropyToReservoir(RandomInfo *,ExceptionInfo *);
 
@@ -151,7 +199,9 @@ static StringInfo
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  AcquireRandomInfo() allocates the RandomInfo structure.
+%  AcquireRandomInfo() allocates the RandomInfo structure.  It is keyed from
+%  a process-wide root generator, which alone gathers entropy and reads and
+%  updates the random reservoir, once per process.
 %
 %  The format of the AcquireRandomInfo method is:
 %
@@ -162,22 +212,11 @@ static StringInfo
 %    o hash: the hash type.
 %
 */
-WizardExport RandomInfo *AcquireRandomInfo(const HashType hash)
+static RandomInfo *AllocateRandomInfo(const HashType hash)
 {
-  ExceptionInfo
-    *exception;
-
   RandomInfo
     *random_info;
 
-  WizardBooleanType
-    status;
-
-  StringInfo
-    *entropy,
-    *key,
-    *nonce;
-
   random_info=(RandomInfo *) AcquireWizardMemory(sizeof(*random_info));
   if (random_info == (RandomInfo *) NULL)
     ThrowWizardFatalError(HashDomain,MemoryError);
@@ -189,6 +228,9 @@ WizardExport RandomInfo *AcquireRandomInfo(const HashType hash)
   random_info->reservoir=AcquireStringInfo(GetHMACDigestsize(
     random_info->hmac_info));
   ResetStringInfo(random_info->reservoir);
+  random_info->generator=HMACRandomGenerator;
+  random_info->offset=RandomKeystreamExtent;
+  random_info->shared=WizardTrue;
   random_info->normalize=(double) (1.0/(WizardULLConstant(~0) >> 11));
   random_info->seed[0]=WizardULLConstant(0x76e15d3efefdcbbf);
   random_info->seed[1]=WizardULLConstant(0xc5004e441c522fb3);
@@ -200,36 +242,107 @@ WizardExport RandomInfo *AcquireRandomInfo(const HashType hash)
   random_info->semaphore=AcquireSemaphoreInfo();
   random_info->timestamp=time(0);
   random_info->signature=WizardSignature;
+  return(random_info);
+}
+
+static RandomInfo *AcquireRootRandomInfo(void)
+{
+  ExceptionInfo
+    *exception;
+
+  RandomInfo
+    *root_info;
+
+  StringInfo
+    *entropy,
+    *key;
+
+  WizardBooleanType
+    status;
+
   /*
-    Seed random nonce.
+    Only the root generator gathers entropy and updates the reservoir.
   */
+  root_info=AllocateRandomInfo(PseudoRandomHash);
   exception=AcquireExceptionInfo();
-  nonce=GenerateEntropicChaos(random_info,exception);
-  if (nonce == (StringInfo *) NULL)
-    ThrowFatalException(RandomFatalError,"Failed to initialize random "
-      "reservoir `%s'");
-  InitializeHMAC(random_info->hmac_info,nonce);
-  SetStringInfoLength(nonce,(GetHMACDigestsize(random_info->hmac_info)+1)/2);
-  SetStringInfo(nonce,GetHMACDigest(random_info->hmac_info));
-  SetStringInfo(random_info->nonce,nonce);
-  nonce=DestroyStringInfo(nonce);
-  /*
-    Seed random reservoir with entropic data.
-  */
-  entropy=GenerateEntropicChaos(random_info,exception);
+  entropy=GenerateEntropicChaos(root_info,exception);
   if (entropy == (StringInfo *) NULL)
     ThrowFatalException(RandomFatalError,"Failed to initialize random "
       "reservoir `%s'");
-  InitializeHMAC(random_info->hmac_info,entropy);
-  SetStringInfo(random_info->reservoir,GetHMACDigest(random_info->hmac_info));
-  status=SaveEntropyToReservoir(random_info,exception);
+  InitializeHMAC(root_info->hmac_info,entropy);
+  ResetStringInfo(entropy);
   entropy=DestroyStringInfo(entropy);
+  /*
+    The reservoir saves output that no generator ever returns.
+  */
+  key=AcquireStringInfo(GetHMACDigestsize(root_info->hmac_info));
+  SetRandomKey(root_info,GetStringInfoLength(key),GetStringInfoDatum(key));
+  ResetStringInfo(key);
+  key=DestroyStringInfo(key);
+  status=SaveEntropyToReservoir(root_info,exception);
   exception=DestroyExceptionInfo(exception);
   if (status == WizardFalse)
     {
+      root_info=DestroyRandomInfo(root_info);
+      return((RandomInfo *) NULL);
+    }
+  root_info->generation=random_generation;
+  return(root_info);
+}
+
+WizardExport RandomInfo *AcquireRandomInfo(const HashType hash)
+{
+  RandomInfo
+    *random_info;
+
+  StringInfo
+    *chaos,
+    *key;
+
+  random_info=AllocateRandomInfo(hash);
+  /*
+    Key from the root generator, created on first use and again in a child
+    process after fork().
+  */
+  if (random_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&random_semaphore);
+  LockSemaphoreInfo(random_semaphore);
+  if ((random_root != (RandomInfo *) NULL) &&
+      (random_root->generation != random_generation))
+    random_root=DestroyRandomInfo(random_root);
+  if (random_root == (RandomInfo *) NULL)
+    random_root=AcquireRootRandomInfo();
+  if (random_root == (RandomInfo *) NULL)
+    {
+      UnlockSemaphoreInfo(random_semaphore);
       random_info=DestroyRandomInfo(random_info);
       return((RandomInfo *) NULL);
     }
+  chaos=AcquireStringInfo(RandomSeedExtent);
+  SetRandomKey(random_root,GetStringInfoLength(chaos),GetStringInfoDatum(
+    chaos));
+  SetRandomKey(random_root,(GetHMACDigestsize(random_info->hmac_info)+1)/2,
+    GetStringInfoDatum(random_info->nonce));
+  UnlockSemaphoreInfo(random_semaphore);
+#if defined(WIZARDSTOOLKIT_HAVE_GETRANDOM)
+  {
+    StringInfo
+      *entropy;
+
+    /*
+      Mix in fresh entropy from the kernel.
+    */
+    entropy=AcquireStringInfo(RandomSeedExtent);
+    if (getrandom(GetStringInfoDatum(entropy),GetStringInfoLength(entropy),0) ==
+        (ssize_t) GetStringInfoLength(entropy))
+      ConcatenateStringInfo(chaos,entropy);
+    ResetStringInfo(entropy);
+    entropy=DestroyStringInfo(entropy);
+  }
+#endif
+  InitializeHMAC(random_info->hmac_info,chaos);
+  ResetStringInfo(chaos);
+  chaos=DestroyStringInfo(chaos);
   /*
     Seed pseudo random number generator.
   */
@@ -292,6 +405,12 @@ WizardExport RandomInfo *DestroyRandomInfo(RandomInfo *random_info)
   WizardAssert(CipherDomain,random_info != (RandomInfo *) NULL);
   WizardAssert(CipherDomain,random_info->signature == WizardSignature);
   LockSemaphoreInfo(random_info->semaphore);
+  if (random_info->chacha_info != (ChachaInfo *) NULL)
+    random_info->chacha_info=DestroyChachaInfo(random_info->chacha_info);
+  if (random_info->aes_info != (AESInfo *) NULL)
+    random_info->aes_info=DestroyAESInfo(random_info->aes_info);
+  (void) ResetWizardMemory(random_info->keystream,0,
+    sizeof(random_info->keystream));
   if (random_info->reservoir != (StringInfo *) NULL)
     random_info->reservoir=DestroyStringInfo(random_info->reservoir);
   if (random_info->nonce != (StringInfo *) NULL)
@@ -385,18 +504,28 @@ static StringInfo *GenerateEntropicChaos(RandomInfo *random_info,
   if (entropy == (StringInfo *) NULL)
     entropy=AcquireStringInfo(0);
   LockSemaphoreInfo(random_info->semaphore);
-#if defined(WIZARDSTOOLKIT_HAVE_GETENTROPY)
+#if defined(WIZARDSTOOLKIT_HAVE_GETENTROPY) || \
+    defined(WIZARDSTOOLKIT_HAVE_GETRANDOM)
   {
     int
       status;
 
-    SetStringInfoLength(entropy,MaxEntropyExtent);
-    status=getentropy(GetStringInfoDatum(entropy),MaxEntropyExtent);
+    chaos=AcquireStringInfo(MaxEntropyExtent);
+#if defined(WIZARDSTOOLKIT_HAVE_GETRANDOM)
+    status=getrandom(GetStringInfoDatum(chaos),MaxEntropyExtent,0) ==
+      MaxEntropyExtent ? 0 : -1;
+#else
+    status=getentropy(GetStringInfoDatum(chaos),MaxEntropyExtent);
+#endif
     if (status == 0)
       {
+        ConcatenateStringInfo(entropy,chaos);
+        ResetStringInfo(chaos);
+        chaos=DestroyStringInfo(chaos);
         UnlockSemaphoreInfo(random_info->semaphore);
         return(entropy);
       }
+    chaos=DestroyStringInfo(chaos);
   }
 #endif
   chaos=AcquireStringInfo(sizeof(unsigned char *));
@@ -793,6 +922,35 @@ WizardExport double GetPseudoRandomValue(RandomInfo *random_info)
   return((double) ((value >> 11)*random_info->normalize));
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t R a n d o m G e n e r a t o r                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetRandomGenerator() returns the generator that SetRandomKey() draws from.
+%
+%  The format of the GetRandomGenerator method is:
+%
+%      RandomGenerator GetRandomGenerator(const RandomInfo *random_info)
+%
+%  A description of each parameter follows:
+%
+%    o random_info: the random info.
+%
+*/
+WizardExport RandomGenerator GetRandomGenerator(const RandomInfo *random_info)
+{
+  WizardAssert(CipherDomain,random_info != (RandomInfo *) NULL);
+  WizardAssert(CipherDomain,random_info->signature == WizardSignature);
+  return(random_info->generator);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -889,6 +1047,110 @@ WizardExport double GetRandomValue(RandomInfo *random_info)
   return((double) key/range);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t T h r e a d R a n d o m I n f o                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetThreadRandomInfo() returns a random generator that belongs to the
+%  calling thread.  It is created and seeded on first use, draws from the
+%  ChaCha20 keystream, is never shared with another thread so its methods do
+%  not lock, and is destroyed when the thread exits.  After a fork() the child
+%  reseeds it rather than repeat the sequence of its parent.  Without POSIX
+%  threads a thread cannot release its generator on exit, so every thread
+%  shares one generator that locks instead.  Do not destroy the returned
+%  generator.
+%
+%  The format of the GetThreadRandomInfo method is:
+%
+%      RandomInfo *GetThreadRandomInfo(void)
+%
+*/
+
+static void DestroyThreadRandomInfo(void *random_info)
+{
+  if (random_info != (void *) NULL)
+    (void) DestroyRandomInfo((RandomInfo *) random_info);
+}
+
+WizardExport RandomInfo *GetThreadRandomInfo(void)
+{
+  RandomInfo
+    *random_info;
+
+#if !defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  if (random_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&random_semaphore);
+  LockSemaphoreInfo(random_semaphore);
+  random_info=random_shared;
+  if ((random_info != (RandomInfo *) NULL) &&
+      (random_info->generation != random_generation))
+    random_info=(RandomInfo *) NULL;
+  UnlockSemaphoreInfo(random_semaphore);
+  if (random_info != (RandomInfo *) NULL)
+    return(random_info);
+  random_info=AcquireRandomInfo(ThreadRandomHash);
+  if (random_info == (RandomInfo *) NULL)
+    return((RandomInfo *) NULL);
+  SetRandomGenerator(random_info,ChachaRandomGenerator);
+  random_info->generation=random_generation;
+  LockSemaphoreInfo(random_semaphore);
+  if ((random_shared != (RandomInfo *) NULL) &&
+      (random_shared->generation == random_generation))
+    random_info=DestroyRandomInfo(random_info);
+  else
+    {
+      if (random_shared != (RandomInfo *) NULL)
+        random_shared=DestroyRandomInfo(random_shared);
+      random_shared=random_info;
+    }
+  random_info=random_shared;
+  UnlockSemaphoreInfo(random_semaphore);
+  return(random_info);
+#else
+  if (random_key_created == WizardFalse)
+    {
+      if (random_semaphore == (SemaphoreInfo *) NULL)
+        ActivateSemaphoreInfo(&random_semaphore);
+      LockSemaphoreInfo(random_semaphore);
+      if (random_key_created == WizardFalse)
+        random_key_created=WizardCreateThreadKey(&random_key,
+          DestroyThreadRandomInfo);
+      UnlockSemaphoreInfo(random_semaphore);
+      if (random_key_created == WizardFalse)
+        ThrowFatalException(RandomFatalError,"unable to create thread key "
+          "`%s'");
+    }
+  random_info=(RandomInfo *) WizardGetThreadValue(random_key);
+  if ((random_info != (RandomInfo *) NULL) &&
+      (random_info->generation != random_generation))
+    {
+      /*
+        Forked, the parent holds the same state.
+      */
+      random_info=DestroyRandomInfo(random_info);
+      (void) WizardSetThreadValue(random_key,(void *) NULL);
+    }
+  if (random_info == (RandomInfo *) NULL)
+    {
+      random_info=AcquireRandomInfo(ThreadRandomHash);
+      if (random_info == (RandomInfo *) NULL)
+        return((RandomInfo *) NULL);
+      SetRandomGenerator(random_info,ChachaRandomGenerator);
+      random_info->shared=WizardFalse;
+      random_info->generation=random_generation;
+      (void) WizardSetThreadValue(random_key,random_info);
+    }
+  return(random_info);
+#endif
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -907,10 +1169,30 @@ WizardExport double GetRandomValue(RandomInfo *random_info)
 %      RandomComponentGenesis(void)
 %
 */
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+static void ForkRandomComponent(void)
+{
+  random_generation++;
+}
+#endif
+
 WizardExport WizardBooleanType RandomComponentGenesis(void)
 {
   if (random_semaphore == (SemaphoreInfo *) NULL)
     random_semaphore=AcquireSemaphoreInfo();
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  {
+    static WizardBooleanType
+      fork_handler = WizardFalse;
+
+    /*
+      A child process reseeds its thread random generators on next use.
+    */
+    if (fork_handler == WizardFalse)
+      fork_handler=pthread_atfork((void (*)(void)) NULL,(void (*)(void)) NULL,
+        ForkRandomComponent) == 0 ? WizardTrue : WizardFalse;
+  }
+#endif
   return(WizardTrue);
 }
 
@@ -936,6 +1218,19 @@ WizardExport void RandomComponentTerminus(void)
 {
   if (random_semaphore == (SemaphoreInfo *) NULL)
     ActivateSemaphoreInfo(&random_semaphore);
+  LockSemaphoreInfo(random_semaphore);
+  if (random_root != (RandomInfo *) NULL)
+    random_root=DestroyRandomInfo(random_root);
+  if (random_shared != (RandomInfo *) NULL)
+    random_shared=DestroyRandomInfo(random_shared);
+  if (random_key_created != WizardFalse)
+    {
+      DestroyThreadRandomInfo(WizardGetThreadValue(random_key));
+      (void) WizardSetThreadValue(random_key,(void *) NULL);
+      (void) WizardDeleteThreadKey(random_key);
+      random_key_created=WizardFalse;
+    }
+  UnlockSemaphoreInfo(random_semaphore);
   RelinquishSemaphoreInfo(&random_semaphore);
 }
 
@@ -1019,6 +1314,47 @@ static WizardBooleanType SaveEntropyToReservoir(RandomInfo *random_info,
   return(WizardTrue);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t R a n d o m G e n e r a t o r                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetRandomGenerator() selects the generator that SetRandomKey() draws from.
+%  HMACRandomGenerator hashes an incremented nonce for each digest of output.
+%  ChachaRandomGenerator and AESRandomGenerator expand a ChaCha20 or AES-256
+%  counter mode keystream instead, keyed from the HMAC generator and rekeyed
+%  from it after each megabyte of output.
+%
+%  The format of the SetRandomGenerator method is:
+%
+%      void SetRandomGenerator(RandomInfo *random_info,
+%        const RandomGenerator generator)
+%
+%  A description of each parameter follows:
+%
+%    o random_info: the random info.
+%
+%    o generator: the random generator.
+%
+*/
+WizardExport void SetRandomGenerator(RandomInfo *random_info,
+  const RandomGenerator generator)
+{
+  WizardAssert(CipherDomain,random_info != (RandomInfo *) NULL);
+  WizardAssert(CipherDomain,random_info->signature == WizardSignature);
+  LockSemaphoreInfo(random_info->semaphore);
+  random_info->generator=generator;
+  if (generator != HMACRandomGenerator)
+    RekeyRandomKeystream(random_info);
+  UnlockSemaphoreInfo(random_info->semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1030,7 +1366,8 @@ static WizardBooleanType SaveEntropyToReservoir(RandomInfo *random_info,
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  SetRandomKey() sets a random key from the reservoir.
+%  SetRandomKey() sets a random key from the reservoir, or from the keystream
+%  of the generator selected with SetRandomGenerator().
 %
 %  The format of the SetRandomKey method is:
 %
@@ -1065,7 +1402,7 @@ static inline void IncrementRandomNonce(StringInfo *nonce)
   ThrowFatalException(RandomFatalError,"Sequence wrap error `%s'");
 }
 
-WizardExport void SetRandomKey(RandomInfo *random_info,const size_t length,
+static void SetRandomHMACKey(RandomInfo *random_info,const size_t length,
   unsigned char *key)
 {
   HMACInfo
@@ -1080,10 +1417,6 @@ WizardExport void SetRandomKey(RandomInfo *random_info,const size_t length,
   unsigned char
     *datum;
 
-  WizardAssert(CipherDomain,random_info != (RandomInfo *) NULL);
-  if (length == 0)
-    return;
-  LockSemaphoreInfo(random_info->semaphore);
   i=length;
   hmac_info=random_info->hmac_info;
   datum=GetStringInfoDatum(random_info->reservoir);
@@ -1117,7 +1450,136 @@ WizardExport void SetRandomKey(RandomInfo *random_info,const size_t length,
       while (i-- != 0)
         p[i]=datum[i];
     }
-  UnlockSemaphoreInfo(random_info->semaphore);
+}
+
+static void GenerateRandomKeystream(RandomInfo *random_info,
+  const size_t length,unsigned char *keystream)
+{
+  size_t
+    i;
+
+  ssize_t
+    j;
+
+  /*
+    Generate whole blocks of keystream, length is a multiple of 64.
+  */
+  if (random_info->generator == ChachaRandomGenerator)
+    {
+      GetChachaKeystream(random_info->chacha_info,length/64,keystream);
+      return;
+    }
+  for (i=0; i < length; i+=16)
+  {
+    (void) memcpy(keystream+i,random_info->counter,16);
+    for (j=15; j >= 0; j--)
+      if (++random_info->counter[j] != 0)
+        break;
+  }
+  EncipherAESBlocks(random_info->aes_info,keystream,keystream,length/16);
+}
+
+static void RekeyRandomKeystream(RandomInfo *random_info)
+{
+  StringInfo
+    *key;
+
+  unsigned char
+    nonce[8];
+
+  /*
+    Key the keystream from the HMAC generator.
+  */
+  key=AcquireStringInfo(32);
+  SetRandomHMACKey(random_info,GetStringInfoLength(key),
+    GetStringInfoDatum(key));
+  if (random_info->generator == ChachaRandomGenerator)
+    {
+      if (random_info->chacha_info == (ChachaInfo *) NULL)
+        random_info->chacha_info=AcquireChachaInfo();
+      SetChachaKey(random_info->chacha_info,key);
+      SetRandomHMACKey(random_info,sizeof(nonce),nonce);
+      SetChachaNonce(random_info->chacha_info,nonce,(unsigned char *) NULL);
+    }
+  else
+    {
+      if (random_info->aes_info == (AESInfo *) NULL)
+        random_info->aes_info=AcquireAESInfo();
+      SetAESKey(random_info->aes_info,key);
+      SetRandomHMACKey(random_info,sizeof(random_info->counter),
+        random_info->counter);
+    }
+  ResetStringInfo(key);
+  key=DestroyStringInfo(key);
+  (void) ResetWizardMemory(random_info->keystream,0,
+    sizeof(random_info->keystream));
+  random_info->offset=RandomKeystreamExtent;
+  random_info->extent=0;
+  /*
+    Reset registers.
+  */
+  (void) ResetWizardMemory(nonce,0,sizeof(nonce));
+}
+
+static void SetRandomKeystreamKey(RandomInfo *random_info,const size_t length,
+  unsigned char *key)
+{
+  size_t
+    i,
+    n;
+
+  unsigned char
+    *p;
+
+  p=key;
+  for (i=length; i != 0; i-=n)
+  {
+    if (random_info->extent >= RandomRekeyExtent)
+      RekeyRandomKeystream(random_info);
+    if (random_info->offset == RandomKeystreamExtent)
+      {
+        if (i >= RandomKeystreamExtent)
+          {
+            /*
+              Bulk requests are generated in place.
+            */
+            n=RandomKeystreamExtent*(i/RandomKeystreamExtent);
+            n=WizardMin(n,RandomRekeyExtent-random_info->extent);
+            GenerateRandomKeystream(random_info,n,p);
+            random_info->extent+=n;
+            p+=n;
+            continue;
+          }
+        GenerateRandomKeystream(random_info,RandomKeystreamExtent,
+          random_info->keystream);
+        random_info->extent+=RandomKeystreamExtent;
+        random_info->offset=0;
+      }
+    /*
+      Erase keystream bytes as they are returned.
+    */
+    n=WizardMin(i,RandomKeystreamExtent-random_info->offset);
+    (void) memcpy(p,random_info->keystream+random_info->offset,n);
+    (void) ResetWizardMemory(random_info->keystream+random_info->offset,0,n);
+    random_info->offset+=n;
+    p+=n;
+  }
+}
+
+WizardExport void SetRandomKey(RandomInfo *random_info,const size_t length,
+  unsigned char *key)
+{
+  WizardAssert(CipherDomain,random_info != (RandomInfo *) NULL);
+  if (length == 0)
+    return;
+  if (random_info->shared != WizardFalse)
+    LockSemaphoreInfo(random_info->semaphore);
+  if (random_info->generator == HMACRandomGenerator)
+    SetRandomHMACKey(random_info,length,key);
+  else
+    SetRandomKeystreamKey(random_info,length,key);
+  if (random_info->shared != WizardFalse)
+    UnlockSemaphoreInfo(random_info->semaphore);
 }
 
 /*
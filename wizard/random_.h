@@ -27,6 +27,14 @@ extern "C" {
 /*
   Typedef declarations.
 */
+typedef enum
+{
+  UndefinedRandomGenerator,
+  HMACRandomGenerator,
+  ChachaRandomGenerator,
+  AESRandomGenerator
+} RandomGenerator;
+
 typedef struct _RandomInfo
   RandomInfo;
 
@@ -37,9 +45,13 @@ extern WizardExport double
   GetPseudoRandomValue(RandomInfo *),
   GetRandomValue(RandomInfo *);
 
+extern WizardExport RandomGenerator
+  GetRandomGenerator(const RandomInfo *);
+
 extern WizardExport RandomInfo
   *AcquireRandomInfo(const HashType),
-  *DestroyRandomInfo(RandomInfo *);
+  *DestroyRandomInfo(RandomInfo *),
+  *GetThreadRandomInfo(void);
 
 extern WizardExport StringInfo
   *GetRandomKey(RandomInfo *,const size_t);
@@ -49,6 +61,7 @@ extern WizardExport unsigned long
 
 extern WizardExport void
   RandomComponentTerminus(void),
+  SetRandomGenerator(RandomInfo *,const RandomGenerator),
   SetRandomKey(RandomInfo *,const size_t,unsigned char *),
   SetRandomSecretKey(const unsigned long),
   SetRandomTrueRandom(const WizardBooleanType);
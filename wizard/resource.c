@@ -85,9 +85,6 @@ typedef struct _ResourceInfo
 /*
   Global declarations.
 */
-static RandomInfo
-  *random_info = (RandomInfo *) NULL;
-
 static ResourceInfo
   resource_info =
   {
@@ -267,6 +264,9 @@ WizardExport int AcquireUniqueFileResource(const char *path,char *filename,
    ssize_t
     i;
 
+  RandomInfo
+    *random_info;
+
   static const char
     portable_filename[] =
       "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_-";
@@ -280,13 +280,7 @@ WizardExport int AcquireUniqueFileResource(const char *path,char *filename,
   WizardAssert(ResourceDomain,path != (const char *) NULL);
   WizardAssert(ResourceDomain,filename != (char *) NULL);
   (void) LogWizardEvent(ResourceEvent,GetWizardModule(),"%s",path);
-  if (random_info == (RandomInfo *) NULL)
-    {
-      LockSemaphoreInfo(resource_semaphore);
-      if (random_info == (RandomInfo *) NULL)
-        random_info=AcquireRandomInfo(SHA2256Hash);
-      UnlockSemaphoreInfo(resource_semaphore);
-    }
+  random_info=GetThreadRandomInfo();
   file=(-1);
   for (i=0; i < (ssize_t) TMP_MAX; i++)
   {
@@ -525,8 +519,6 @@ WizardExport void AsynchronousResourceComponentTerminus(void)
     (void) remove_utf8(path);
     path=(const char *) GetNextKeyInSplayTree(temporary_resources);
   }
-  if (random_info != (RandomInfo *) NULL)
-    random_info=DestroyRandomInfo(random_info);
 }
 
 /*
@@ -39,6 +39,7 @@
   Include declarations.
 */
 #include "wizard/studio.h"
+#include "wizard/cpu-private.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
 #include "wizard/memory_.h"
@@ -70,7 +71,10 @@ struct _SerpentInfo
   (value)|=(*p++) << 16; \
   (value)|=(*p++) << 24; \
 }
+#define RotateLeft(x,n)  (((x) << (n)) | ((x) >> (32-(n))))
+#define RotateRight(x,n)  (((x) >> (n)) | ((x) << (32-(n))))
 #define SerpentBlocksize 32
+#define SerpentTextsize  16
 #define Write32Bits(p,value) \
 { \
   *p++=(unsigned char) (value); \
@@ -141,19 +145,77 @@ WizardExport SerpentInfo *AcquireSerpentInfo(void)
 %
 */
 
-static inline unsigned int Trunc32(unsigned int x)
-{
-  return((unsigned int) (x & 0xffffffffUL));
-}
-
-static inline unsigned int RotateRight(unsigned int x,unsigned int n)
-{
-  return(Trunc32((x >> n) | (x << (32-n))));
-}
-
 WizardExport void DecipherSerpentBlock(SerpentInfo *serpent_info,
   const unsigned char *ciphertext,unsigned char *plaintext)
 {
+#define DecipherRounds(alpha,beta,gamma,delta,epsilon) \
+{ \
+  MixKey(alpha,beta,gamma,delta,32); \
+  DecipherSbox7(alpha,beta,gamma,delta,epsilon); \
+  DecipherK(beta,delta,alpha,epsilon,gamma,31); \
+  DecipherSbox6(beta,delta,alpha,epsilon,gamma); \
+  DecipherK(alpha,gamma,epsilon,beta,delta,30); \
+  DecipherSbox5(alpha,gamma,epsilon,beta,delta); \
+  DecipherK(gamma,delta,alpha,epsilon,beta,29); \
+  DecipherSbox4(gamma,delta,alpha,epsilon,beta); \
+  DecipherK(gamma,alpha,beta,epsilon,delta,28); \
+  DecipherSbox3(gamma,alpha,beta,epsilon,delta); \
+  DecipherK(beta,gamma,delta,epsilon,alpha,27); \
+  DecipherSbox2(beta,gamma,delta,epsilon,alpha); \
+  DecipherK(gamma,alpha,epsilon,delta,beta,26); \
+  DecipherSbox1(gamma,alpha,epsilon,delta,beta); \
+  DecipherK(beta,alpha,epsilon,delta,gamma,25); \
+  DecipherSbox0(beta,alpha,epsilon,delta,gamma); \
+  DecipherK(epsilon,gamma,alpha,beta,delta,24); \
+  DecipherSbox7(epsilon,gamma,alpha,beta,delta); \
+  DecipherK(gamma,beta,epsilon,delta,alpha,23); \
+  DecipherSbox6(gamma,beta,epsilon,delta,alpha); \
+  DecipherK(epsilon,alpha,delta,gamma,beta,22); \
+  DecipherSbox5(epsilon,alpha,delta,gamma,beta); \
+  DecipherK(alpha,beta,epsilon,delta,gamma,21); \
+  DecipherSbox4(alpha,beta,epsilon,delta,gamma); \
+  DecipherK(alpha,epsilon,gamma,delta,beta,20); \
+  DecipherSbox3(alpha,epsilon,gamma,delta,beta); \
+  DecipherK(gamma,alpha,beta,delta,epsilon,19); \
+  DecipherSbox2(gamma,alpha,beta,delta,epsilon); \
+  DecipherK(alpha,epsilon,delta,beta,gamma,18); \
+  DecipherSbox1(alpha,epsilon,delta,beta,gamma); \
+  DecipherK(gamma,epsilon,delta,beta,alpha,17); \
+  DecipherSbox0(gamma,epsilon,delta,beta,alpha); \
+  DecipherK(delta,alpha,epsilon,gamma,beta,16); \
+  DecipherSbox7(delta,alpha,epsilon,gamma,beta); \
+  DecipherK(alpha,gamma,delta,beta,epsilon,15); \
+  DecipherSbox6(alpha,gamma,delta,beta,epsilon); \
+  DecipherK(delta,epsilon,beta,alpha,gamma,14); \
+  DecipherSbox5(delta,epsilon,beta,alpha,gamma); \
+  DecipherK(epsilon,gamma,delta,beta,alpha,13); \
+  DecipherSbox4(epsilon,gamma,delta,beta,alpha); \
+  DecipherK(epsilon,delta,alpha,beta,gamma,12); \
+  DecipherSbox3(epsilon,delta,alpha,beta,gamma); \
+  DecipherK(alpha,epsilon,gamma,beta,delta,11); \
+  DecipherSbox2(alpha,epsilon,gamma,beta,delta); \
+  DecipherK(epsilon,delta,beta,gamma,alpha,10); \
+  DecipherSbox1(epsilon,delta,beta,gamma,alpha); \
+  DecipherK(alpha,delta,beta,gamma,epsilon,9); \
+  DecipherSbox0(alpha,delta,beta,gamma,epsilon); \
+  DecipherK(beta,epsilon,delta,alpha,gamma,8); \
+  DecipherSbox7(beta,epsilon,delta,alpha,gamma); \
+  DecipherK(epsilon,alpha,beta,gamma,delta,7); \
+  DecipherSbox6(epsilon,alpha,beta,gamma,delta); \
+  DecipherK(beta,delta,gamma,epsilon,alpha,6); \
+  DecipherSbox5(beta,delta,gamma,epsilon,alpha); \
+  DecipherK(delta,alpha,beta,gamma,epsilon,5); \
+  DecipherSbox4(delta,alpha,beta,gamma,epsilon); \
+  DecipherK(delta,beta,epsilon,gamma,alpha,4); \
+  DecipherSbox3(delta,beta,epsilon,gamma,alpha); \
+  DecipherK(epsilon,delta,alpha,gamma,beta,3); \
+  DecipherSbox2(epsilon,delta,alpha,gamma,beta); \
+  DecipherK(delta,beta,gamma,alpha,epsilon,2); \
+  DecipherSbox1(delta,beta,gamma,alpha,epsilon); \
+  DecipherK(epsilon,beta,gamma,alpha,delta,1); \
+  DecipherSbox0(epsilon,beta,gamma,alpha,delta); \
+  MixKey(gamma,delta,beta,epsilon,0); \
+}
 #define DecipherSbox0(alpha,beta,gamma,delta,epsilon) \
 { \
   beta^=alpha; epsilon=delta; delta|=beta; epsilon^=beta; \
@@ -254,71 +316,7 @@ WizardExport void DecipherSerpentBlock(SerpentInfo *serpent_info,
   Read32Bits(gamma,p);
   Read32Bits(delta,p);
   crypt_key=serpent_info->crypt_key;
-  MixKey(alpha,beta,gamma,delta,32);
-  DecipherSbox7(alpha,beta,gamma,delta,epsilon);
-  DecipherK(beta,delta,alpha,epsilon,gamma,31);
-  DecipherSbox6(beta,delta,alpha,epsilon,gamma);
-  DecipherK(alpha,gamma,epsilon,beta,delta,30);
-  DecipherSbox5(alpha,gamma,epsilon,beta,delta);
-  DecipherK(gamma,delta,alpha,epsilon,beta,29);
-  DecipherSbox4(gamma,delta,alpha,epsilon,beta);
-  DecipherK(gamma,alpha,beta,epsilon,delta,28);
-  DecipherSbox3(gamma,alpha,beta,epsilon,delta);
-  DecipherK(beta,gamma,delta,epsilon,alpha,27);
-  DecipherSbox2(beta,gamma,delta,epsilon,alpha);
-  DecipherK(gamma,alpha,epsilon,delta,beta,26);
-  DecipherSbox1(gamma,alpha,epsilon,delta,beta);
-  DecipherK(beta,alpha,epsilon,delta,gamma,25);
-  DecipherSbox0(beta,alpha,epsilon,delta,gamma);
-  DecipherK(epsilon,gamma,alpha,beta,delta,24);
-  DecipherSbox7(epsilon,gamma,alpha,beta,delta);
-  DecipherK(gamma,beta,epsilon,delta,alpha,23);
-  DecipherSbox6(gamma,beta,epsilon,delta,alpha);
-  DecipherK(epsilon,alpha,delta,gamma,beta,22);
-  DecipherSbox5(epsilon,alpha,delta,gamma,beta);
-  DecipherK(alpha,beta,epsilon,delta,gamma,21);
-  DecipherSbox4(alpha,beta,epsilon,delta,gamma);
-  DecipherK(alpha,epsilon,gamma,delta,beta,20);
-  DecipherSbox3(alpha,epsilon,gamma,delta,beta);
-  DecipherK(gamma,alpha,beta,delta,epsilon,19);
-  DecipherSbox2(gamma,alpha,beta,delta,epsilon);
-  DecipherK(alpha,epsilon,delta,beta,gamma,18);
-  DecipherSbox1(alpha,epsilon,delta,beta,gamma);
-  DecipherK(gamma,epsilon,delta,beta,alpha,17);
-  DecipherSbox0(gamma,epsilon,delta,beta,alpha);
-  DecipherK(delta,alpha,epsilon,gamma,beta,16);
-  DecipherSbox7(delta,alpha,epsilon,gamma,beta);
-  DecipherK(alpha,gamma,delta,beta,epsilon,15);
-  DecipherSbox6(alpha,gamma,delta,beta,epsilon);
-  DecipherK(delta,epsilon,beta,alpha,gamma,14);
-  DecipherSbox5(delta,epsilon,beta,alpha,gamma);
-  DecipherK(epsilon,gamma,delta,beta,alpha,13);
-  DecipherSbox4(epsilon,gamma,delta,beta,alpha);
-  DecipherK(epsilon,delta,alpha,beta,gamma,12);
-  DecipherSbox3(epsilon,delta,alpha,beta,gamma);
-  DecipherK(alpha,epsilon,gamma,beta,delta,11);
-  DecipherSbox2(alpha,epsilon,gamma,beta,delta);
-  DecipherK(epsilon,delta,beta,gamma,alpha,10);
-  DecipherSbox1(epsilon,delta,beta,gamma,alpha);
-  DecipherK(alpha,delta,beta,gamma,epsilon,9);
-  DecipherSbox0(alpha,delta,beta,gamma,epsilon);
-  DecipherK(beta,epsilon,delta,alpha,gamma,8);
-  DecipherSbox7(beta,epsilon,delta,alpha,gamma);
-  DecipherK(epsilon,alpha,beta,gamma,delta,7);
-  DecipherSbox6(epsilon,alpha,beta,gamma,delta);
-  DecipherK(beta,delta,gamma,epsilon,alpha,6);
-  DecipherSbox5(beta,delta,gamma,epsilon,alpha);
-  DecipherK(delta,alpha,beta,gamma,epsilon,5);
-  DecipherSbox4(delta,alpha,beta,gamma,epsilon);
-  DecipherK(delta,beta,epsilon,gamma,alpha,4);
-  DecipherSbox3(delta,beta,epsilon,gamma,alpha);
-  DecipherK(epsilon,delta,alpha,gamma,beta,3);
-  DecipherSbox2(epsilon,delta,alpha,gamma,beta);
-  DecipherK(delta,beta,gamma,alpha,epsilon,2);
-  DecipherSbox1(delta,beta,gamma,alpha,epsilon);
-  DecipherK(epsilon,beta,gamma,alpha,delta,1);
-  DecipherSbox0(epsilon,beta,gamma,alpha,delta);
-  MixKey(gamma,delta,beta,epsilon,0);
+  DecipherRounds(alpha,beta,gamma,delta,epsilon);
   q=(unsigned char *) plaintext;
   Write32Bits(q,gamma);
   Write32Bits(q,delta);
@@ -334,6 +332,245 @@ WizardExport void DecipherSerpentBlock(SerpentInfo *serpent_info,
   epsilon=0;
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e c i p h e r S e r p e n t B l o c k s                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherSerpentBlocks() deciphers consecutive blocks of ciphertext to
+%  produce blocks of plaintext.
+%
+%  The format of the DecipherSerpentBlocks method is:
+%
+%     void DecipherSerpentBlocks(SerpentInfo *serpent_info,
+%       const unsigned char *ciphertext,unsigned char *plaintext,
+%       const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o serpent_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+%    o plaintext: The plain text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+typedef unsigned int
+  SerpentVector4 __attribute__((vector_size(16))),
+  SerpentVector8 __attribute__((vector_size(32)));
+
+static inline WizardTarget("sse2") void TransposeSerpentSSE2(__m128i *x)
+{
+  __m128i
+    t0,
+    t1,
+    t2,
+    t3;
+
+  t0=_mm_unpacklo_epi32(x[0],x[1]);
+  t1=_mm_unpacklo_epi32(x[2],x[3]);
+  t2=_mm_unpackhi_epi32(x[0],x[1]);
+  t3=_mm_unpackhi_epi32(x[2],x[3]);
+  x[0]=_mm_unpacklo_epi64(t0,t1);
+  x[1]=_mm_unpackhi_epi64(t0,t1);
+  x[2]=_mm_unpacklo_epi64(t2,t3);
+  x[3]=_mm_unpackhi_epi64(t2,t3);
+}
+
+static inline WizardTarget("sse2") void LoadSerpentSSE2(
+  const unsigned char *text,__m128i *x)
+{
+  ssize_t
+    i;
+
+  /*
+    Bitslice four blocks: each vector holds the same word of every block.
+  */
+  for (i=0; i < 4; i++)
+    x[i]=_mm_loadu_si128((const __m128i *) (text+i*SerpentBlocksize));
+  TransposeSerpentSSE2(x);
+}
+
+static inline WizardTarget("sse2") void StoreSerpentSSE2(
+  __m128i *x,unsigned char *text)
+{
+  ssize_t
+    i;
+
+  TransposeSerpentSSE2(x);
+  for (i=0; i < 4; i++)
+    _mm_storeu_si128((__m128i *) (text+i*SerpentBlocksize),x[i]);
+}
+
+static inline WizardTarget("avx2") void TransposeSerpentAVX2(__m256i *x)
+{
+  __m256i
+    t0,
+    t1,
+    t2,
+    t3;
+
+  t0=_mm256_unpacklo_epi32(x[0],x[1]);
+  t1=_mm256_unpacklo_epi32(x[2],x[3]);
+  t2=_mm256_unpackhi_epi32(x[0],x[1]);
+  t3=_mm256_unpackhi_epi32(x[2],x[3]);
+  x[0]=_mm256_unpacklo_epi64(t0,t1);
+  x[1]=_mm256_unpackhi_epi64(t0,t1);
+  x[2]=_mm256_unpacklo_epi64(t2,t3);
+  x[3]=_mm256_unpackhi_epi64(t2,t3);
+}
+
+static inline WizardTarget("avx2") void LoadSerpentAVX2(
+  const unsigned char *text,__m256i *x)
+{
+  ssize_t
+    i;
+
+  /*
+    Bitslice eight blocks; the high lane holds blocks four through seven.
+  */
+  for (i=0; i < 4; i++)
+    x[i]=_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(
+      (const __m128i *) (text+i*SerpentBlocksize))),_mm_loadu_si128(
+      (const __m128i *) (text+(i+4)*SerpentBlocksize)),1);
+  TransposeSerpentAVX2(x);
+}
+
+static inline WizardTarget("avx2") void StoreSerpentAVX2(
+  __m256i *x,unsigned char *text)
+{
+  ssize_t
+    i;
+
+  TransposeSerpentAVX2(x);
+  for (i=0; i < 4; i++)
+  {
+    _mm_storeu_si128((__m128i *) (text+i*SerpentBlocksize),
+      _mm256_castsi256_si128(x[i]));
+    _mm_storeu_si128((__m128i *) (text+(i+4)*SerpentBlocksize),
+      _mm256_extracti128_si256(x[i],1));
+  }
+}
+
+static WizardTarget("sse2") void DecipherSerpentSSE2Blocks(
+  SerpentInfo *serpent_info,const unsigned char *ciphertext,
+  unsigned char *plaintext)
+{
+  __m128i
+    x[4];
+
+  SerpentVector4
+    alpha,
+    beta,
+    gamma,
+    delta,
+    epsilon;
+
+  unsigned int
+    *crypt_key;
+
+  LoadSerpentSSE2(ciphertext,x);
+  alpha=(SerpentVector4) x[0];
+  beta=(SerpentVector4) x[1];
+  gamma=(SerpentVector4) x[2];
+  delta=(SerpentVector4) x[3];
+  crypt_key=serpent_info->crypt_key;
+  DecipherRounds(alpha,beta,gamma,delta,epsilon);
+  x[0]=(__m128i) gamma;
+  x[1]=(__m128i) delta;
+  x[2]=(__m128i) beta;
+  x[3]=(__m128i) epsilon;
+  StoreSerpentSSE2(x,plaintext);
+  /*
+    Reset registers.
+  */
+  alpha^=alpha;
+  beta^=beta;
+  gamma^=gamma;
+  delta^=delta;
+  epsilon^=epsilon;
+  x[0]=x[1]=x[2]=x[3]=_mm_setzero_si128();
+}
+
+static WizardTarget("avx2") void DecipherSerpentAVX2Blocks(
+  SerpentInfo *serpent_info,const unsigned char *ciphertext,
+  unsigned char *plaintext)
+{
+  __m256i
+    x[4];
+
+  SerpentVector8
+    alpha,
+    beta,
+    gamma,
+    delta,
+    epsilon;
+
+  unsigned int
+    *crypt_key;
+
+  LoadSerpentAVX2(ciphertext,x);
+  alpha=(SerpentVector8) x[0];
+  beta=(SerpentVector8) x[1];
+  gamma=(SerpentVector8) x[2];
+  delta=(SerpentVector8) x[3];
+  crypt_key=serpent_info->crypt_key;
+  DecipherRounds(alpha,beta,gamma,delta,epsilon);
+  x[0]=(__m256i) gamma;
+  x[1]=(__m256i) delta;
+  x[2]=(__m256i) beta;
+  x[3]=(__m256i) epsilon;
+  StoreSerpentAVX2(x,plaintext);
+  /*
+    Reset registers.
+  */
+  alpha^=alpha;
+  beta^=beta;
+  gamma^=gamma;
+  delta^=delta;
+  epsilon^=epsilon;
+  x[0]=x[1]=x[2]=x[3]=_mm256_setzero_si256();
+  _mm256_zeroupper();
+}
+#endif
+
+WizardExport void DecipherSerpentBlocks(SerpentInfo *serpent_info,
+  const unsigned char *ciphertext,unsigned char *plaintext,const size_t blocks)
+{
+  size_t
+    i;
+
+  if (plaintext != ciphertext)
+    for (i=0; i < blocks; i++)
+      (void) memcpy(plaintext+i*SerpentBlocksize+SerpentTextsize,
+        ciphertext+i*SerpentBlocksize+SerpentTextsize,
+        SerpentBlocksize-SerpentTextsize);
+  i=0;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    for ( ; (i+8) <= blocks; i+=8)
+      DecipherSerpentAVX2Blocks(serpent_info,ciphertext+i*SerpentBlocksize,
+        plaintext+i*SerpentBlocksize);
+  if (HasCPUFeature(SSE2CPUFeature) != WizardFalse)
+    for ( ; (i+4) <= blocks; i+=4)
+      DecipherSerpentSSE2Blocks(serpent_info,ciphertext+i*SerpentBlocksize,
+        plaintext+i*SerpentBlocksize);
+#endif
+  for ( ; i < blocks; i++)
+    DecipherSerpentBlock(serpent_info,ciphertext+i*SerpentBlocksize,
+      plaintext+i*SerpentBlocksize);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -395,11 +632,6 @@ WizardExport SerpentInfo *DestroySerpentInfo(SerpentInfo *serpent_info)
 %
 */
 
-static inline unsigned int RotateLeft(unsigned int x,unsigned int n)
-{
-  return(Trunc32((x << n) | (x >> (32-n))));
-}
-
 WizardExport void EncipherSerpentBlock(SerpentInfo *serpent_info,
   const unsigned char *plaintext,unsigned char *ciphertext)
 {
@@ -413,6 +645,74 @@ WizardExport void EncipherSerpentBlock(SerpentInfo *serpent_info,
   alpha=RotateLeft(alpha,5); gamma=RotateLeft(gamma,22); \
   alpha^=crypt_key[4*(i)+0]; gamma^=crypt_key[4*(i)+2]; \
 }
+#define EncipherRounds(alpha,beta,gamma,delta,epsilon) \
+{ \
+  MixKey(alpha,beta,gamma,delta,0); \
+  EncipherSbox0(alpha,beta,gamma,delta,epsilon); \
+  EncipherK(gamma,beta,delta,alpha,epsilon,1); \
+  EncipherSbox1(gamma,beta,delta,alpha,epsilon); \
+  EncipherK(epsilon,delta,alpha,gamma,beta,2); \
+  EncipherSbox2(epsilon,delta,alpha,gamma,beta); \
+  EncipherK(beta,delta,epsilon,gamma,alpha,3); \
+  EncipherSbox3(beta,delta,epsilon,gamma,alpha); \
+  EncipherK(gamma,alpha,delta,beta,epsilon,4); \
+  EncipherSbox4(gamma,alpha,delta,beta,epsilon); \
+  EncipherK(alpha,delta,beta,epsilon,gamma,5); \
+  EncipherSbox5(alpha,delta,beta,epsilon,gamma); \
+  EncipherK(gamma,alpha,delta,epsilon,beta,6); \
+  EncipherSbox6(gamma,alpha,delta,epsilon,beta); \
+  EncipherK(delta,beta,alpha,epsilon,gamma,7); \
+  EncipherSbox7(delta,beta,alpha,epsilon,gamma); \
+  EncipherK(gamma,alpha,epsilon,delta,beta,8); \
+  EncipherSbox0(gamma,alpha,epsilon,delta,beta); \
+  EncipherK(epsilon,alpha,delta,gamma,beta,9); \
+  EncipherSbox1(epsilon,alpha,delta,gamma,beta); \
+  EncipherK(beta,delta,gamma,epsilon,alpha,10); \
+  EncipherSbox2(beta,delta,gamma,epsilon,alpha); \
+  EncipherK(alpha,delta,beta,epsilon,gamma,11); \
+  EncipherSbox3(alpha,delta,beta,epsilon,gamma); \
+  EncipherK(epsilon,gamma,delta,alpha,beta,12); \
+  EncipherSbox4(epsilon,gamma,delta,alpha,beta); \
+  EncipherK(gamma,delta,alpha,beta,epsilon,13); \
+  EncipherSbox5(gamma,delta,alpha,beta,epsilon); \
+  EncipherK(epsilon,gamma,delta,beta,alpha,14); \
+  EncipherSbox6(epsilon,gamma,delta,beta,alpha); \
+  EncipherK(delta,alpha,gamma,beta,epsilon,15); \
+  EncipherSbox7(delta,alpha,gamma,beta,epsilon); \
+  EncipherK(epsilon,gamma,beta,delta,alpha,16); \
+  EncipherSbox0(epsilon,gamma,beta,delta,alpha); \
+  EncipherK(beta,gamma,delta,epsilon,alpha,17); \
+  EncipherSbox1(beta,gamma,delta,epsilon,alpha); \
+  EncipherK(alpha,delta,epsilon,beta,gamma,18); \
+  EncipherSbox2(alpha,delta,epsilon,beta,gamma); \
+  EncipherK(gamma,delta,alpha,beta,epsilon,19); \
+  EncipherSbox3(gamma,delta,alpha,beta,epsilon); \
+  EncipherK(beta,epsilon,delta,gamma,alpha,20); \
+  EncipherSbox4(beta,epsilon,delta,gamma,alpha); \
+  EncipherK(epsilon,delta,gamma,alpha,beta,21); \
+  EncipherSbox5(epsilon,delta,gamma,alpha,beta); \
+  EncipherK(beta,epsilon,delta,alpha,gamma,22); \
+  EncipherSbox6(beta,epsilon,delta,alpha,gamma); \
+  EncipherK(delta,gamma,epsilon,alpha,beta,23); \
+  EncipherSbox7(delta,gamma,epsilon,alpha,beta); \
+  EncipherK(beta,epsilon,alpha,delta,gamma,24); \
+  EncipherSbox0(beta,epsilon,alpha,delta,gamma); \
+  EncipherK(alpha,epsilon,delta,beta,gamma,25); \
+  EncipherSbox1(alpha,epsilon,delta,beta,gamma); \
+  EncipherK(gamma,delta,beta,alpha,epsilon,26); \
+  EncipherSbox2(gamma,delta,beta,alpha,epsilon); \
+  EncipherK(epsilon,delta,gamma,alpha,beta,27); \
+  EncipherSbox3(epsilon,delta,gamma,alpha,beta); \
+  EncipherK(alpha,beta,delta,epsilon,gamma,28); \
+  EncipherSbox4(alpha,beta,delta,epsilon,gamma); \
+  EncipherK(beta,delta,epsilon,gamma,alpha,29); \
+  EncipherSbox5(beta,delta,epsilon,gamma,alpha); \
+  EncipherK(alpha,beta,delta,gamma,epsilon,30); \
+  EncipherSbox6(alpha,beta,delta,gamma,epsilon); \
+  EncipherK(delta,epsilon,beta,gamma,alpha,31); \
+  EncipherSbox7(delta,epsilon,beta,gamma,alpha); \
+  MixKey(alpha,beta,gamma,delta,32); \
+}
 #define EncipherSbox0(alpha,beta,gamma,delta,epsilon) \
 { \
   epsilon=delta; delta|=alpha; alpha^=epsilon; epsilon^=gamma; \
@@ -498,71 +798,7 @@ WizardExport void EncipherSerpentBlock(SerpentInfo *serpent_info,
   Read32Bits(gamma,p);
   Read32Bits(delta,p);
   crypt_key=serpent_info->crypt_key;
-  MixKey(alpha,beta,gamma,delta,0);
-  EncipherSbox0(alpha,beta,gamma,delta,epsilon);
-  EncipherK(gamma,beta,delta,alpha,epsilon,1);
-  EncipherSbox1(gamma,beta,delta,alpha,epsilon);
-  EncipherK(epsilon,delta,alpha,gamma,beta,2);
-  EncipherSbox2(epsilon,delta,alpha,gamma,beta);
-  EncipherK(beta,delta,epsilon,gamma,alpha,3);
-  EncipherSbox3(beta,delta,epsilon,gamma,alpha);
-  EncipherK(gamma,alpha,delta,beta,epsilon,4);
-  EncipherSbox4(gamma,alpha,delta,beta,epsilon);
-  EncipherK(alpha,delta,beta,epsilon,gamma,5);
-  EncipherSbox5(alpha,delta,beta,epsilon,gamma);
-  EncipherK(gamma,alpha,delta,epsilon,beta,6);
-  EncipherSbox6(gamma,alpha,delta,epsilon,beta);
-  EncipherK(delta,beta,alpha,epsilon,gamma,7);
-  EncipherSbox7(delta,beta,alpha,epsilon,gamma);
-  EncipherK(gamma,alpha,epsilon,delta,beta,8);
-  EncipherSbox0(gamma,alpha,epsilon,delta,beta);
-  EncipherK(epsilon,alpha,delta,gamma,beta,9);
-  EncipherSbox1(epsilon,alpha,delta,gamma,beta);
-  EncipherK(beta,delta,gamma,epsilon,alpha,10);
-  EncipherSbox2(beta,delta,gamma,epsilon,alpha);
-  EncipherK(alpha,delta,beta,epsilon,gamma,11);
-  EncipherSbox3(alpha,delta,beta,epsilon,gamma);
-  EncipherK(epsilon,gamma,delta,alpha,beta,12);
-  EncipherSbox4(epsilon,gamma,delta,alpha,beta);
-  EncipherK(gamma,delta,alpha,beta,epsilon,13);
-  EncipherSbox5(gamma,delta,alpha,beta,epsilon);
-  EncipherK(epsilon,gamma,delta,beta,alpha,14);
-  EncipherSbox6(epsilon,gamma,delta,beta,alpha);
-  EncipherK(delta,alpha,gamma,beta,epsilon,15);
-  EncipherSbox7(delta,alpha,gamma,beta,epsilon);
-  EncipherK(epsilon,gamma,beta,delta,alpha,16);
-  EncipherSbox0(epsilon,gamma,beta,delta,alpha);
-  EncipherK(beta,gamma,delta,epsilon,alpha,17);
-  EncipherSbox1(beta,gamma,delta,epsilon,alpha);
-  EncipherK(alpha,delta,epsilon,beta,gamma,18);
-  EncipherSbox2(alpha,delta,epsilon,beta,gamma);
-  EncipherK(gamma,delta,alpha,beta,epsilon,19);
-  EncipherSbox3(gamma,delta,alpha,beta,epsilon);
-  EncipherK(beta,epsilon,delta,gamma,alpha,20);
-  EncipherSbox4(beta,epsilon,delta,gamma,alpha);
-  EncipherK(epsilon,delta,gamma,alpha,beta,21);
-  EncipherSbox5(epsilon,delta,gamma,alpha,beta);
-  EncipherK(beta,epsilon,delta,alpha,gamma,22);
-  EncipherSbox6(beta,epsilon,delta,alpha,gamma);
-  EncipherK(delta,gamma,epsilon,alpha,beta,23);
-  EncipherSbox7(delta,gamma,epsilon,alpha,beta);
-  EncipherK(beta,epsilon,alpha,delta,gamma,24);
-  EncipherSbox0(beta,epsilon,alpha,delta,gamma);
-  EncipherK(alpha,epsilon,delta,beta,gamma,25);
-  EncipherSbox1(alpha,epsilon,delta,beta,gamma);
-  EncipherK(gamma,delta,beta,alpha,epsilon,26);
-  EncipherSbox2(gamma,delta,beta,alpha,epsilon);
-  EncipherK(epsilon,delta,gamma,alpha,beta,27);
-  EncipherSbox3(epsilon,delta,gamma,alpha,beta);
-  EncipherK(alpha,beta,delta,epsilon,gamma,28);
-  EncipherSbox4(alpha,beta,delta,epsilon,gamma);
-  EncipherK(beta,delta,epsilon,gamma,alpha,29);
-  EncipherSbox5(beta,delta,epsilon,gamma,alpha);
-  EncipherK(alpha,beta,delta,gamma,epsilon,30);
-  EncipherSbox6(alpha,beta,delta,gamma,epsilon);
-  EncipherK(delta,epsilon,beta,gamma,alpha,31);
-  EncipherSbox7(delta,epsilon,beta,gamma,alpha);
-  MixKey(alpha,beta,gamma,delta,32);
+  EncipherRounds(alpha,beta,gamma,delta,epsilon);
   q=(unsigned char * ) ciphertext;
   Write32Bits(q,alpha);
   Write32Bits(q,beta);
@@ -578,6 +814,147 @@ WizardExport void EncipherSerpentBlock(SerpentInfo *serpent_info,
   epsilon=0;
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r S e r p e n t B l o c k s                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherSerpentBlocks() enciphers consecutive blocks of plaintext to
+%  produce blocks of ciphertext.
+%
+%  The format of the EncipherSerpentBlocks method is:
+%
+%     void EncipherSerpentBlocks(SerpentInfo *serpent_info,
+%       const unsigned char *plaintext,unsigned char *ciphertext,
+%       const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o serpent_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+%    o ciphertext: The cipher text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static WizardTarget("sse2") void EncipherSerpentSSE2Blocks(
+  SerpentInfo *serpent_info,const unsigned char *plaintext,
+  unsigned char *ciphertext)
+{
+  __m128i
+    x[4];
+
+  SerpentVector4
+    alpha,
+    beta,
+    gamma,
+    delta,
+    epsilon;
+
+  unsigned int
+    *crypt_key;
+
+  LoadSerpentSSE2(plaintext,x);
+  alpha=(SerpentVector4) x[0];
+  beta=(SerpentVector4) x[1];
+  gamma=(SerpentVector4) x[2];
+  delta=(SerpentVector4) x[3];
+  crypt_key=serpent_info->crypt_key;
+  EncipherRounds(alpha,beta,gamma,delta,epsilon);
+  x[0]=(__m128i) alpha;
+  x[1]=(__m128i) beta;
+  x[2]=(__m128i) gamma;
+  x[3]=(__m128i) delta;
+  StoreSerpentSSE2(x,ciphertext);
+  /*
+    Reset registers.
+  */
+  alpha^=alpha;
+  beta^=beta;
+  gamma^=gamma;
+  delta^=delta;
+  epsilon^=epsilon;
+  x[0]=x[1]=x[2]=x[3]=_mm_setzero_si128();
+}
+
+static WizardTarget("avx2") void EncipherSerpentAVX2Blocks(
+  SerpentInfo *serpent_info,const unsigned char *plaintext,
+  unsigned char *ciphertext)
+{
+  __m256i
+    x[4];
+
+  SerpentVector8
+    alpha,
+    beta,
+    gamma,
+    delta,
+    epsilon;
+
+  unsigned int
+    *crypt_key;
+
+  LoadSerpentAVX2(plaintext,x);
+  alpha=(SerpentVector8) x[0];
+  beta=(SerpentVector8) x[1];
+  gamma=(SerpentVector8) x[2];
+  delta=(SerpentVector8) x[3];
+  crypt_key=serpent_info->crypt_key;
+  EncipherRounds(alpha,beta,gamma,delta,epsilon);
+  x[0]=(__m256i) alpha;
+  x[1]=(__m256i) beta;
+  x[2]=(__m256i) gamma;
+  x[3]=(__m256i) delta;
+  StoreSerpentAVX2(x,ciphertext);
+  /*
+    Reset registers.
+  */
+  alpha^=alpha;
+  beta^=beta;
+  gamma^=gamma;
+  delta^=delta;
+  epsilon^=epsilon;
+  x[0]=x[1]=x[2]=x[3]=_mm256_setzero_si256();
+  _mm256_zeroupper();
+}
+#endif
+
+WizardExport void EncipherSerpentBlocks(SerpentInfo *serpent_info,
+  const unsigned char *plaintext,unsigned char *ciphertext,const size_t blocks)
+{
+  size_t
+    i;
+
+  if (ciphertext != plaintext)
+    for (i=0; i < blocks; i++)
+      (void) memcpy(ciphertext+i*SerpentBlocksize+SerpentTextsize,
+        plaintext+i*SerpentBlocksize+SerpentTextsize,
+        SerpentBlocksize-SerpentTextsize);
+  i=0;
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    for ( ; (i+8) <= blocks; i+=8)
+      EncipherSerpentAVX2Blocks(serpent_info,plaintext+i*SerpentBlocksize,
+        ciphertext+i*SerpentBlocksize);
+  if (HasCPUFeature(SSE2CPUFeature) != WizardFalse)
+    for ( ; (i+4) <= blocks; i+=4)
+      EncipherSerpentSSE2Blocks(serpent_info,plaintext+i*SerpentBlocksize,
+        ciphertext+i*SerpentBlocksize);
+#endif
+  for ( ; i < blocks; i++)
+    EncipherSerpentBlock(serpent_info,plaintext+i*SerpentBlocksize,
+      ciphertext+i*SerpentBlocksize);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
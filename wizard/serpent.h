@@ -34,7 +34,11 @@ extern WizardExport unsigned int
 
 extern WizardExport void
   DecipherSerpentBlock(SerpentInfo *,const unsigned char *,unsigned char *),
+  DecipherSerpentBlocks(SerpentInfo *,const unsigned char *,unsigned char *,
+    const size_t),
   EncipherSerpentBlock(SerpentInfo *,const unsigned char *,unsigned char *),
+  EncipherSerpentBlocks(SerpentInfo *,const unsigned char *,unsigned char *,
+    const size_t),
   SetSerpentKey(SerpentInfo *,const StringInfo *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
@@ -42,6 +42,8 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/cpu-private.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
 #include "wizard/sha1.h"
 
@@ -73,7 +75,8 @@ struct _SHA1Info
     offset;
 
   WizardBooleanType
-    lsb_first;
+    lsb_first,
+    shani;
 
   time_t
     timestamp;
@@ -86,7 +89,10 @@ struct _SHA1Info
   Forward declarations.
 */
 static void
-  TransformSHA1(SHA1Info *);
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  TransformSHA1LanesAVX2(unsigned int *,const unsigned char **,const size_t),
+#endif
+  TransformSHA1(SHA1Info *,const unsigned char *,const size_t);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -129,6 +135,8 @@ WizardExport SHA1Info *AcquireSHA1Info(void)
   lsb_first=1;
   sha_info->lsb_first=(int)
     (*(char *) &lsb_first) == 1 ? WizardTrue : WizardFalse;
+  sha_info->shani=(HasCPUFeature(SHACPUFeature) != WizardFalse) &&
+    (HasCPUFeature(SSE41CPUFeature) != WizardFalse) ? WizardTrue : WizardFalse;
   sha_info->timestamp=time((time_t *) NULL);
   sha_info->signature=WizardSignature;
   (void) InitializeSHA1(sha_info);
@@ -179,6 +187,55 @@ WizardExport SHA1Info *DestroySHA1Info(SHA1Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t S H A 1 S t a t e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportSHA1State() returns the in-progress SHA1 state as a byte string
+%  holding the accumulator, the message length, and the buffered partial
+%  block.  ImportSHA1State() resumes from it.
+%
+%  The format of the ExportSHA1State method is:
+%
+%      StringInfo *ExportSHA1State(const SHA1Info *sha_info)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA1Info.
+%
+*/
+WizardExport StringInfo *ExportSHA1State(const SHA1Info *sha_info)
+{
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(sha_info != (SHA1Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  state=AcquireStringInfo(5*4+2*4+4+sha_info->offset);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < 5; i++)
+    ExportHashWord(&q,sha_info->accumulator[i],4);
+  ExportHashWord(&q,sha_info->low_order,4);
+  ExportHashWord(&q,sha_info->high_order,4);
+  ExportHashWord(&q,sha_info->offset,4);
+  (void) CopyWizardMemory(q,GetStringInfoDatum(sha_info->message),
+    sha_info->offset);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e S H A                                                     %
 %                                                                             %
 %                                                                             %
@@ -235,7 +292,7 @@ WizardExport WizardBooleanType FinalizeSHA1(SHA1Info *sha_info)
     {
       (void) memset(datum+count,0,GetStringInfoLength(
         sha_info->message)-count);
-      TransformSHA1(sha_info);
+      TransformSHA1(sha_info,datum,1);
       (void) memset(datum,0,GetStringInfoLength(sha_info->message)-
         8);
     }
@@ -247,7 +304,7 @@ WizardExport WizardBooleanType FinalizeSHA1(SHA1Info *sha_info)
   datum[61]=(unsigned char) (low_order >> 16);
   datum[62]=(unsigned char) (low_order >> 8);
   datum[63]=(unsigned char) low_order;
-  TransformSHA1(sha_info);
+  TransformSHA1(sha_info,datum,1);
   p=sha_info->accumulator;
   q=GetStringInfoDatum(sha_info->digest);
   for (i=0; i < (SHA1Digestsize/4); i++)
@@ -362,6 +419,93 @@ WizardExport unsigned int GetSHA1Digestsize(const SHA1Info *sha1_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   G e t S H A 1 L a n e s T r a n s f o r m                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetSHA1LanesTransform() returns a transform that compresses HashLanes
+%  independent SHA1 messages at once, or NULL if this processor has none.
+%
+%  The format of the GetSHA1LanesTransform method is:
+%
+%      HashLanesTransformMethod GetSHA1LanesTransform(void)
+%
+*/
+WizardExport HashLanesTransformMethod GetSHA1LanesTransform(void)
+{
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    return(TransformSHA1LanesAVX2);
+#endif
+  return((HashLanesTransformMethod) NULL);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t S H A 1 S t a t e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportSHA1State() restores a state returned by ExportSHA1State().  A
+%  malformed state is rejected with WizardFalse and the SHA1 state is left
+%  as it was.
+%
+%  The format of the ImportSHA1State method is:
+%
+%      WizardBooleanType ImportSHA1State(SHA1Info *sha_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA1Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportSHA1State(SHA1Info *sha_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    offset;
+
+  ssize_t
+    i;
+
+  assert(sha_info != (SHA1Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < (5*4+2*4+4))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+5*4+2*4;
+  offset=(size_t) ImportHashWord(&p,4);
+  if ((offset >= SHA1Blocksize) ||
+      (GetStringInfoLength(state) != (5*4+2*4+4+offset)))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < 5; i++)
+    sha_info->accumulator[i]=(unsigned int) ImportHashWord(&p,4);
+  sha_info->low_order=(unsigned int) ImportHashWord(&p,4);
+  sha_info->high_order=(unsigned int) ImportHashWord(&p,4);
+  sha_info->offset=offset;
+  p+=4;
+  (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,offset);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e S H A                                                 %
 %                                                                             %
 %                                                                             %
@@ -406,16 +550,23 @@ WizardExport WizardBooleanType InitializeSHA1(SHA1Info *sha_info)
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  TransformSHA1() transforms the SHA1 message accumulator.
+%  TransformSHA1() transforms the SHA1 message accumulator.  A run of blocks
+%  is transformed in one call, with SHA extensions where the processor has
+%  them.
 %
 %  The format of the TransformSHA1 method is:
 %
-%      TransformSHA1(SHA1Info *sha_info)
+%      void TransformSHA1(SHA1Info *sha_info,const unsigned char *message,
+%        const size_t blocks)
 %
 %  A description of each parameter follows:
 %
 %    o sha_info: The address of a structure of type SHA1Info.
 %
+%    o message: the message blocks.
+%
+%    o blocks: the number of 64-byte blocks.
+%
 */
 
 static inline unsigned int Trunc32(const unsigned int x)
@@ -428,14 +579,236 @@ static unsigned int RotateLeft(const unsigned int x,const unsigned int n)
   return(Trunc32((x << n) | (x >> (32-n))));
 }
 
-static void TransformSHA1(SHA1Info *sha_info)
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static WizardTarget("sha,sse4.1") void TransformSHA1SHANI(
+  unsigned int *accumulator,const unsigned char *message,const size_t blocks)
 {
-   ssize_t
-    i;
+#define SHA1NIRounds(e,f,m0,m1,m2,m3,k) \
+{ \
+  e=_mm_sha1nexte_epu32(e,m0); \
+  f=abcd; \
+  m1=_mm_sha1msg2_epu32(m1,m0); \
+  abcd=_mm_sha1rnds4_epu32(abcd,e,k); \
+  m3=_mm_sha1msg1_epu32(m3,m0); \
+  m2=_mm_xor_si128(m2,m0); \
+}
 
-   unsigned char
+  const unsigned char
     *p;
 
+  __m128i
+    abcd,
+    abcd_save,
+    e0,
+    e0_save,
+    e1,
+    mask,
+    X0,
+    X1,
+    X2,
+    X3;
+
+  size_t
+    j;
+
+  /*
+    Each SHA1NIRounds() does four rounds and advances the message schedule;
+    the schedule words beyond the 80th it computes are unused.
+  */
+  mask=_mm_set_epi64x(0x0001020304050607ULL,0x08090a0b0c0d0e0fULL);
+  abcd=_mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) accumulator),0x1b);
+  e0=_mm_set_epi32((int) accumulator[4],0,0,0);
+  p=message;
+  for (j=0; j < blocks; j++)
+  {
+    abcd_save=abcd;
+    e0_save=e0;
+    X0=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) p),mask);
+    e0=_mm_add_epi32(e0,X0);
+    e1=abcd;
+    abcd=_mm_sha1rnds4_epu32(abcd,e0,0);
+    X1=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p+16)),mask);
+    e1=_mm_sha1nexte_epu32(e1,X1);
+    e0=abcd;
+    abcd=_mm_sha1rnds4_epu32(abcd,e1,0);
+    X0=_mm_sha1msg1_epu32(X0,X1);
+    X2=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p+32)),mask);
+    e0=_mm_sha1nexte_epu32(e0,X2);
+    e1=abcd;
+    abcd=_mm_sha1rnds4_epu32(abcd,e0,0);
+    X1=_mm_sha1msg1_epu32(X1,X2);
+    X0=_mm_xor_si128(X0,X2);
+    X3=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p+48)),mask);
+    SHA1NIRounds(e1,e0,X3,X0,X1,X2,0);
+    SHA1NIRounds(e0,e1,X0,X1,X2,X3,0);
+    SHA1NIRounds(e1,e0,X1,X2,X3,X0,1);
+    SHA1NIRounds(e0,e1,X2,X3,X0,X1,1);
+    SHA1NIRounds(e1,e0,X3,X0,X1,X2,1);
+    SHA1NIRounds(e0,e1,X0,X1,X2,X3,1);
+    SHA1NIRounds(e1,e0,X1,X2,X3,X0,1);
+    SHA1NIRounds(e0,e1,X2,X3,X0,X1,2);
+    SHA1NIRounds(e1,e0,X3,X0,X1,X2,2);
+    SHA1NIRounds(e0,e1,X0,X1,X2,X3,2);
+    SHA1NIRounds(e1,e0,X1,X2,X3,X0,2);
+    SHA1NIRounds(e0,e1,X2,X3,X0,X1,2);
+    SHA1NIRounds(e1,e0,X3,X0,X1,X2,3);
+    SHA1NIRounds(e0,e1,X0,X1,X2,X3,3);
+    SHA1NIRounds(e1,e0,X1,X2,X3,X0,3);
+    SHA1NIRounds(e0,e1,X2,X3,X0,X1,3);
+    e1=_mm_sha1nexte_epu32(e1,X3);
+    e0=abcd;
+    abcd=_mm_sha1rnds4_epu32(abcd,e1,3);
+    e0=_mm_sha1nexte_epu32(e0,e0_save);
+    abcd=_mm_add_epi32(abcd,abcd_save);
+    p+=64;
+  }
+  _mm_storeu_si128((__m128i *) accumulator,_mm_shuffle_epi32(abcd,0x1b));
+  accumulator[4]=(unsigned int) _mm_extract_epi32(e0,3);
+  /*
+    Reset working registers.
+  */
+  abcd=_mm_setzero_si128();
+  abcd_save=_mm_setzero_si128();
+  e0=_mm_setzero_si128();
+  e0_save=_mm_setzero_si128();
+  e1=_mm_setzero_si128();
+  X0=_mm_setzero_si128();
+  X1=_mm_setzero_si128();
+  X2=_mm_setzero_si128();
+  X3=_mm_setzero_si128();
+}
+
+static inline WizardTarget("avx2") __m256i SHA1ChAVX2(const __m256i x,
+  const __m256i y,const __m256i z)
+{
+  return(_mm256_xor_si256(_mm256_and_si256(x,y),_mm256_andnot_si256(x,z)));
+}
+
+static inline WizardTarget("avx2") __m256i SHA1MajAVX2(const __m256i x,
+  const __m256i y,const __m256i z)
+{
+  return(_mm256_or_si256(_mm256_and_si256(x,y),_mm256_and_si256(z,
+    _mm256_or_si256(x,y))));
+}
+
+static inline WizardTarget("avx2") __m256i SHA1ParityAVX2(const __m256i x,
+  const __m256i y,const __m256i z)
+{
+  return(_mm256_xor_si256(_mm256_xor_si256(x,y),z));
+}
+
+#define SHA1RoundAVX2(a,b,c,d,e,f,j) \
+{ \
+  if ((i+(j)) >= 16) \
+    W[(i+(j)) & 0x0f]=RotateLeftAVX2(_mm256_xor_si256(_mm256_xor_si256( \
+      W[(i+(j)+13) & 0x0f],W[(i+(j)+8) & 0x0f]),_mm256_xor_si256( \
+      W[(i+(j)+2) & 0x0f],W[(i+(j)) & 0x0f])),1); \
+  e=_mm256_add_epi32(_mm256_add_epi32(RotateLeftAVX2(a,5),f(b,c,d)), \
+    _mm256_add_epi32(_mm256_add_epi32(e,W[(i+(j)) & 0x0f]),k)); \
+  b=RotateLeftAVX2(b,30); \
+}
+
+static WizardTarget("avx2") void TransformSHA1LanesAVX2(
+  unsigned int *accumulator,const unsigned char **message,const size_t blocks)
+{
+  __m256i
+    A,
+    B,
+    C,
+    D,
+    E,
+    k,
+    mask,
+    S[5],
+    W[16];
+
+  size_t
+    i,
+    j;
+
+  /*
+    Each 32-bit element is one lane; the rounds are the portable ones applied
+    to eight messages at once.
+  */
+  mask=_mm256_broadcastsi128_si256(_mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+    0x0405060700010203ULL));
+  for (i=0; i < 5; i++)
+    S[i]=_mm256_loadu_si256((const __m256i *) (accumulator+HashLanes*i));
+  for (j=0; j < blocks; j++)
+  {
+    LoadHashLanesAVX2(message,64*j,W);
+    for (i=0; i < 16; i++)
+      W[i]=_mm256_shuffle_epi8(W[i],mask);
+    A=S[0];
+    B=S[1];
+    C=S[2];
+    D=S[3];
+    E=S[4];
+    k=_mm256_set1_epi32((int) 0x5a827999U);
+    for (i=0; i < 20; i+=5)
+    {
+      SHA1RoundAVX2(A,B,C,D,E,SHA1ChAVX2,0);
+      SHA1RoundAVX2(E,A,B,C,D,SHA1ChAVX2,1);
+      SHA1RoundAVX2(D,E,A,B,C,SHA1ChAVX2,2);
+      SHA1RoundAVX2(C,D,E,A,B,SHA1ChAVX2,3);
+      SHA1RoundAVX2(B,C,D,E,A,SHA1ChAVX2,4);
+    }
+    k=_mm256_set1_epi32((int) 0x6ed9eba1U);
+    for ( ; i < 40; i+=5)
+    {
+      SHA1RoundAVX2(A,B,C,D,E,SHA1ParityAVX2,0);
+      SHA1RoundAVX2(E,A,B,C,D,SHA1ParityAVX2,1);
+      SHA1RoundAVX2(D,E,A,B,C,SHA1ParityAVX2,2);
+      SHA1RoundAVX2(C,D,E,A,B,SHA1ParityAVX2,3);
+      SHA1RoundAVX2(B,C,D,E,A,SHA1ParityAVX2,4);
+    }
+    k=_mm256_set1_epi32((int) 0x8f1bbcdcU);
+    for ( ; i < 60; i+=5)
+    {
+      SHA1RoundAVX2(A,B,C,D,E,SHA1MajAVX2,0);
+      SHA1RoundAVX2(E,A,B,C,D,SHA1MajAVX2,1);
+      SHA1RoundAVX2(D,E,A,B,C,SHA1MajAVX2,2);
+      SHA1RoundAVX2(C,D,E,A,B,SHA1MajAVX2,3);
+      SHA1RoundAVX2(B,C,D,E,A,SHA1MajAVX2,4);
+    }
+    k=_mm256_set1_epi32((int) 0xca62c1d6U);
+    for ( ; i < 80; i+=5)
+    {
+      SHA1RoundAVX2(A,B,C,D,E,SHA1ParityAVX2,0);
+      SHA1RoundAVX2(E,A,B,C,D,SHA1ParityAVX2,1);
+      SHA1RoundAVX2(D,E,A,B,C,SHA1ParityAVX2,2);
+      SHA1RoundAVX2(C,D,E,A,B,SHA1ParityAVX2,3);
+      SHA1RoundAVX2(B,C,D,E,A,SHA1ParityAVX2,4);
+    }
+    S[0]=_mm256_add_epi32(S[0],A);
+    S[1]=_mm256_add_epi32(S[1],B);
+    S[2]=_mm256_add_epi32(S[2],C);
+    S[3]=_mm256_add_epi32(S[3],D);
+    S[4]=_mm256_add_epi32(S[4],E);
+  }
+  for (i=0; i < 5; i++)
+    _mm256_storeu_si256((__m256i *) (accumulator+HashLanes*i),S[i]);
+  /*
+    Reset working registers.
+  */
+  for (i=0; i < 16; i++)
+    W[i]=_mm256_setzero_si256();
+  k=_mm256_setzero_si256();
+}
+#endif
+
+static void TransformSHA1(SHA1Info *sha_info,const unsigned char *message,
+  const size_t blocks)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    j;
+
+   ssize_t
+    i;
+
    unsigned int
     *q;
 
@@ -445,113 +818,89 @@ static void TransformSHA1(SHA1Info *sha_info)
     C,
     D,
     E,
-    shift,
     T,
     W[80];
 
-  shift=32;
-  p=GetStringInfoDatum(sha_info->message);
-  if (sha_info->lsb_first == WizardFalse)
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (sha_info->shani != WizardFalse)
     {
-      if (sizeof(unsigned int) <= 4)
-        for (i=0; i < 16; i++)
-        {
-          T=(*((unsigned int *) p));
-          p+=4;
-          W[i]=Trunc32(T);
-        }
-      else
-        for (i=0; i < 16; i+=2)
-        {
-          T=(*((unsigned int *) p));
-          p+=8;
-          W[i]=Trunc32(T >> shift);
-          W[i+1]=Trunc32(T);
-        }
+      TransformSHA1SHANI(sha_info->accumulator,message,blocks);
+      return;
     }
-  else
-    if (sizeof(unsigned int) <= 4)
-      for (i=0; i < 16; i++)
-      {
-        T=(*((unsigned int *) p));
-        p+=4;
-        W[i]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-      }
-    else
-      for (i=0; i < 16; i+=2)
-      {
-        T=(*((unsigned int *) p));
-        p+=8;
-        W[i]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-        T>>=shift;
-        W[i+1]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-      }
-  /*
-    Copy accumulator to registers.
-  */
-  A=sha_info->accumulator[0];
-  B=sha_info->accumulator[1];
-  C=sha_info->accumulator[2];
-  D=sha_info->accumulator[3];
-  E=sha_info->accumulator[4];
-  for (i=16; i < 80; i++)
-  {
-    W[i]=W[i-3] ^ W[i-8] ^ W[i-14] ^ W[i-16];
-    W[i]=RotateLeft(W[i],1);
-  }
-  q=W;
-  for (i=0; i < 20; i++)
+#endif
+  p=message;
+  for (j=0; j < blocks; j++)
   {
-    T=Trunc32(RotateLeft(A,5)+((B & C) | (~B & D))+E+(*q)+0x5a827999U);
-    E=D;
-    D=C;
-    C=RotateLeft(B,30);
-    B=A;
-    A=T;
-    q++;
-  }
-  for ( ; i < 40; i++)
-  {
-    T=Trunc32(RotateLeft(A,5)+(B ^ C ^ D)+E+(*q)+0x6ed9eba1U);
-    E=D;
-    D=C;
-    C=RotateLeft(B,30);
-    B=A;
-    A=T;
-    q++;
-  }
-  for ( ; i < 60; i++)
-  {
-    T=Trunc32(RotateLeft(A,5)+((B & C) | (B & D) | (C & D))+E+(*q)+
-      0x8F1bbcdcU);
-    E=D;
-    D=C;
-    C=RotateLeft(B,30);
-    B=A;
-    A=T;
-    q++;
-  }
-  for ( ; i < 80; i++)
-  {
-    T=Trunc32(RotateLeft(A,5)+(B ^ C ^ D)+E+(*q)+0xca62c1d6U);
-    E=D;
-    D=C;
-    C=RotateLeft(B,30);
-    B=A;
-    A=T;
-    q++;
+    for (i=0; i < 16; i++)
+    {
+      W[i]=((unsigned int) p[0] << 24) | ((unsigned int) p[1] << 16) |
+        ((unsigned int) p[2] << 8) | (unsigned int) p[3];
+      p+=4;
+    }
+    /*
+      Copy accumulator to registers.
+    */
+    A=sha_info->accumulator[0];
+    B=sha_info->accumulator[1];
+    C=sha_info->accumulator[2];
+    D=sha_info->accumulator[3];
+    E=sha_info->accumulator[4];
+    for (i=16; i < 80; i++)
+    {
+      W[i]=W[i-3] ^ W[i-8] ^ W[i-14] ^ W[i-16];
+      W[i]=RotateLeft(W[i],1);
+    }
+    q=W;
+    for (i=0; i < 20; i++)
+    {
+      T=Trunc32(RotateLeft(A,5)+((B & C) | (~B & D))+E+(*q)+0x5a827999U);
+      E=D;
+      D=C;
+      C=RotateLeft(B,30);
+      B=A;
+      A=T;
+      q++;
+    }
+    for ( ; i < 40; i++)
+    {
+      T=Trunc32(RotateLeft(A,5)+(B ^ C ^ D)+E+(*q)+0x6ed9eba1U);
+      E=D;
+      D=C;
+      C=RotateLeft(B,30);
+      B=A;
+      A=T;
+      q++;
+    }
+    for ( ; i < 60; i++)
+    {
+      T=Trunc32(RotateLeft(A,5)+((B & C) | (B & D) | (C & D))+E+(*q)+
+        0x8F1bbcdcU);
+      E=D;
+      D=C;
+      C=RotateLeft(B,30);
+      B=A;
+      A=T;
+      q++;
+    }
+    for ( ; i < 80; i++)
+    {
+      T=Trunc32(RotateLeft(A,5)+(B ^ C ^ D)+E+(*q)+0xca62c1d6U);
+      E=D;
+      D=C;
+      C=RotateLeft(B,30);
+      B=A;
+      A=T;
+      q++;
+    }
+    /*
+      Add registers back to accumulator.
+    */
+    sha_info->accumulator[0]=Trunc32(sha_info->accumulator[0]+A);
+    sha_info->accumulator[1]=Trunc32(sha_info->accumulator[1]+B);
+    sha_info->accumulator[2]=Trunc32(sha_info->accumulator[2]+C);
+    sha_info->accumulator[3]=Trunc32(sha_info->accumulator[3]+D);
+    sha_info->accumulator[4]=Trunc32(sha_info->accumulator[4]+E);
   }
-  /*
-    Add registers back to accumulator.
-  */
-  sha_info->accumulator[0]=Trunc32(sha_info->accumulator[0]+A);
-  sha_info->accumulator[1]=Trunc32(sha_info->accumulator[1]+B);
-  sha_info->accumulator[2]=Trunc32(sha_info->accumulator[2]+C);
-  sha_info->accumulator[3]=Trunc32(sha_info->accumulator[3]+D);
-  sha_info->accumulator[4]=Trunc32(sha_info->accumulator[4]+E);
   /*
     Reset working registers.
   */
@@ -563,6 +912,7 @@ static void TransformSHA1(SHA1Info *sha_info)
   T=0;
   (void) memset(W,0,sizeof(W));
 }
+
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -591,11 +941,47 @@ static void TransformSHA1(SHA1Info *sha_info)
 */
 WizardExport WizardBooleanType UpdateSHA1(SHA1Info *sha_info,
   const StringInfo *message)
+{
+  return(UpdateSHA1Bytes(sha_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e S H A 1 B y t e s                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateSHA1Bytes() updates the SHA1 message accumulator from the caller's
+%  memory.  Whole blocks are transformed directly from it; only a trailing
+%  partial block is buffered.
+%
+%  The format of the UpdateSHA1Bytes method is:
+%
+%      WizardBooleanType UpdateSHA1Bytes(SHA1Info *sha_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA1Info.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+WizardExport WizardBooleanType UpdateSHA1Bytes(SHA1Info *sha_info,
+  const void *message,const size_t extent)
 {
    size_t
     i;
 
-   unsigned char
+   const unsigned char
     *p;
 
   size_t
@@ -609,13 +995,13 @@ WizardExport WizardBooleanType UpdateSHA1(SHA1Info *sha_info,
   */
   assert(sha_info != (SHA1Info *) NULL);
   assert(sha_info->signature == WizardSignature);
-  n=GetStringInfoLength(message);
+  n=extent;
   length=Trunc32((unsigned int) (sha_info->low_order+(n << 3)));
   if (length < sha_info->low_order)
     sha_info->high_order++;
   sha_info->low_order=length;
   sha_info->high_order+=(unsigned int) n >> 29;
-  p=GetStringInfoDatum(message);
+  p=(const unsigned char *) message;
   if (sha_info->offset != 0)
     {
       i=GetStringInfoLength(sha_info->message)-sha_info->offset;
@@ -628,15 +1014,18 @@ WizardExport WizardBooleanType UpdateSHA1(SHA1Info *sha_info,
       sha_info->offset+=i;
       if (sha_info->offset != GetStringInfoLength(sha_info->message))
         return(WizardTrue);
-      TransformSHA1(sha_info);
+      TransformSHA1(sha_info,GetStringInfoDatum(sha_info->message),1);
+    }
+  if (n >= SHA1Blocksize)
+    {
+      /*
+        Transform whole blocks directly from the message.
+      */
+      i=n/SHA1Blocksize;
+      TransformSHA1(sha_info,p,i);
+      p+=i*SHA1Blocksize;
+      n-=i*SHA1Blocksize;
     }
-  while (n >= GetStringInfoLength(sha_info->message))
-  {
-    SetStringInfoDatum(sha_info->message,p);
-    p+=GetStringInfoLength(sha_info->message);
-    n-=GetStringInfoLength(sha_info->message);
-    TransformSHA1(sha_info);
-  }
   (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,n);
   sha_info->offset=n;
   /*
@@ -29,6 +29,9 @@ extern WizardExport SHA1Info
   *AcquireSHA1Info(void),
   *DestroySHA1Info(SHA1Info *);
 
+extern WizardExport StringInfo
+  *ExportSHA1State(const SHA1Info *);
+
 extern WizardExport const StringInfo
   *GetSHA1Digest(const SHA1Info *);
 
@@ -37,9 +40,11 @@ extern WizardExport unsigned int
   GetSHA1Digestsize(const SHA1Info *);
 
 extern WizardExport WizardBooleanType
+  ImportSHA1State(SHA1Info *,const StringInfo *),
   InitializeSHA1(SHA1Info *),
   FinalizeSHA1(SHA1Info *),
-  UpdateSHA1(SHA1Info *,const StringInfo *);
+  UpdateSHA1(SHA1Info *,const StringInfo *),
+  UpdateSHA1Bytes(SHA1Info *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -42,8 +42,10 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
 #include "wizard/sha2224.h"
+#include "wizard/sha2256-private.h"
 /*
   Define declarations.
 */
@@ -74,6 +76,9 @@ struct _SHA2224Info
   WizardBooleanType
     lsb_first;
 
+  SHA2256TransformMethod
+    transform;
+
   time_t
     timestamp;
 
@@ -81,12 +86,6 @@ struct _SHA2224Info
     signature;
 };
 
-/*
-  Forward declarations.
-*/
-static void
-  TransformSHA2224(SHA2224Info *);
-
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -127,6 +126,7 @@ WizardExport SHA2224Info *AcquireSHA2224Info(void)
     ThrowWizardFatalError(HashError,MemoryError);
   lsb_first=1;
   sha_info->lsb_first=(*(char *) &lsb_first) != 0 ? WizardTrue : WizardFalse;
+  sha_info->transform=GetSHA2256Transform();
   sha_info->timestamp=time((time_t *) NULL);
   sha_info->signature=WizardSignature;
   (void) InitializeSHA2224(sha_info);
@@ -177,6 +177,55 @@ WizardExport SHA2224Info *DestroySHA2224Info(SHA2224Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t S H A 2 2 2 4 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportSHA2224State() returns the in-progress SHA2224 state as a byte string
+%  holding the accumulator, the message length, and the buffered partial
+%  block.  ImportSHA2224State() resumes from it.
+%
+%  The format of the ExportSHA2224State method is:
+%
+%      StringInfo *ExportSHA2224State(const SHA2224Info *sha_info)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2224Info.
+%
+*/
+WizardExport StringInfo *ExportSHA2224State(const SHA2224Info *sha_info)
+{
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(sha_info != (SHA2224Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  state=AcquireStringInfo(8*4+2*4+4+sha_info->offset);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    ExportHashWord(&q,sha_info->accumulator[i],4);
+  ExportHashWord(&q,sha_info->low_order,4);
+  ExportHashWord(&q,sha_info->high_order,4);
+  ExportHashWord(&q,sha_info->offset,4);
+  (void) CopyWizardMemory(q,GetStringInfoDatum(sha_info->message),
+    sha_info->offset);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e S H A                                                     %
 %                                                                             %
 %                                                                             %
@@ -233,7 +282,7 @@ WizardExport WizardBooleanType FinalizeSHA2224(SHA2224Info *sha_info)
     {
       (void) memset(datum+count,0,GetStringInfoLength(
         sha_info->message)-count);
-      TransformSHA2224(sha_info);
+      sha_info->transform(sha_info->accumulator,datum,1);
       (void) memset(datum,0,GetStringInfoLength(sha_info->message)-
         8);
     }
@@ -245,7 +294,7 @@ WizardExport WizardBooleanType FinalizeSHA2224(SHA2224Info *sha_info)
   datum[61]=(unsigned char) (low_order >> 16);
   datum[62]=(unsigned char) (low_order >> 8);
   datum[63]=(unsigned char) low_order;
-  TransformSHA2224(sha_info);
+  sha_info->transform(sha_info->accumulator,datum,1);
   p=sha_info->accumulator;
   q=GetStringInfoDatum(sha_info->digest);
   for (i=0; i < (SHA2224Digestsize/4); i++)
@@ -360,6 +409,65 @@ WizardExport unsigned int GetSHA2224Digestsize(const SHA2224Info *sha2224_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   I m p o r t S H A 2 2 2 4 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportSHA2224State() restores a state returned by ExportSHA2224State().  A
+%  malformed state is rejected with WizardFalse and the SHA2224 state is left
+%  as it was.
+%
+%  The format of the ImportSHA2224State method is:
+%
+%      WizardBooleanType ImportSHA2224State(SHA2224Info *sha_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2224Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportSHA2224State(SHA2224Info *sha_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    offset;
+
+  ssize_t
+    i;
+
+  assert(sha_info != (SHA2224Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < (8*4+2*4+4))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+8*4+2*4;
+  offset=(size_t) ImportHashWord(&p,4);
+  if ((offset >= SHA2224Blocksize) ||
+      (GetStringInfoLength(state) != (8*4+2*4+4+offset)))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    sha_info->accumulator[i]=(unsigned int) ImportHashWord(&p,4);
+  sha_info->low_order=(unsigned int) ImportHashWord(&p,4);
+  sha_info->high_order=(unsigned int) ImportHashWord(&p,4);
+  sha_info->offset=offset;
+  p+=4;
+  (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,offset);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e S H A                                                 %
 %                                                                             %
 %                                                                             %
@@ -401,186 +509,31 @@ WizardExport WizardBooleanType InitializeSHA2224(SHA2224Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   T r a n s f o r m S H A                                                   %
+%   U p d a t e S H A                                                         %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  TransformSHA2224() transforms the SHA2224 message accumulator.
+%  UpdateSHA2224() updates the SHA2224 message accumulator.
 %
-%  The format of the TransformSHA2224 method is:
+%  The format of the UpdateSHA2224 method is:
 %
-%      TransformSHA2224(SHA2224Info *sha_info)
+%      WizardBooleanType UpdateSHA2224(SHA2224Info *sha_info,
+%        const StringInfo *message)
 %
 %  A description of each parameter follows:
 %
 %    o sha_info: The address of a structure of type SHA2224Info.
 %
+%    o message: The message.
+%
 */
-
-static inline unsigned int Ch(const unsigned int x,const unsigned int y,
-  const unsigned int z)
-{
-  return((x & y) ^ (~x & z));
-}
-
-static inline unsigned int Maj(const unsigned int x,const unsigned int y,
-  const unsigned int z)
-{
-  return((x & y) ^ (x & z) ^ (y & z));
-}
-
-static inline unsigned int Trunc32(const unsigned int x)
-{
-  return((unsigned int) (x & 0xffffffffU));
-}
-
-static unsigned int RotateRight(const unsigned int x,const unsigned int n)
-{
-  return(Trunc32((x >> n) | (x << (32-n))));
-}
-
-static void TransformSHA2224(SHA2224Info *sha_info)
+WizardExport WizardBooleanType UpdateSHA2224(SHA2224Info *sha_info,
+  const StringInfo *message)
 {
-#define Sigma0(x)  (RotateRight(x,7) ^ RotateRight(x,18) ^ Trunc32((x) >> 3))
-#define Sigma1(x)  (RotateRight(x,17) ^ RotateRight(x,19) ^ Trunc32((x) >> 10))
-#define Suma0(x)  (RotateRight(x,2) ^ RotateRight(x,13) ^ RotateRight(x,22))
-#define Suma1(x)  (RotateRight(x,6) ^ RotateRight(x,11) ^ RotateRight(x,25))
-
-  ssize_t
-    j;
-
-   ssize_t
-    i;
-
-   unsigned char
-    *p;
-
-  static unsigned int
-    K[64] =
-    {
-      0x428a2f98U, 0x71374491U, 0xb5c0fbcfU, 0xe9b5dba5U, 0x3956c25bU,
-      0x59f111f1U, 0x923f82a4U, 0xab1c5ed5U, 0xd807aa98U, 0x12835b01U,
-      0x243185beU, 0x550c7dc3U, 0x72be5d74U, 0x80deb1feU, 0x9bdc06a7U,
-      0xc19bf174U, 0xe49b69c1U, 0xefbe4786U, 0x0fc19dc6U, 0x240ca1ccU,
-      0x2de92c6fU, 0x4a7484aaU, 0x5cb0a9dcU, 0x76f988daU, 0x983e5152U,
-      0xa831c66dU, 0xb00327c8U, 0xbf597fc7U, 0xc6e00bf3U, 0xd5a79147U,
-      0x06ca6351U, 0x14292967U, 0x27b70a85U, 0x2e1b2138U, 0x4d2c6dfcU,
-      0x53380d13U, 0x650a7354U, 0x766a0abbU, 0x81c2c92eU, 0x92722c85U,
-      0xa2bfe8a1U, 0xa81a664bU, 0xc24b8b70U, 0xc76c51a3U, 0xd192e819U,
-      0xd6990624U, 0xf40e3585U, 0x106aa070U, 0x19a4c116U, 0x1e376c08U,
-      0x2748774cU, 0x34b0bcb5U, 0x391c0cb3U, 0x4ed8aa4aU, 0x5b9cca4fU,
-      0x682e6ff3U, 0x748f82eeU, 0x78a5636fU, 0x84c87814U, 0x8cc70208U,
-      0x90befffaU, 0xa4506cebU, 0xbef9a3f7U, 0xc67178f2U
-    };  /* 32-bit fractional part of the cube root of the first 64 primes */
-
-  unsigned int
-    A,
-    B,
-    C,
-    D,
-    E,
-    F,
-    G,
-    H,
-    shift,
-    T,
-    T1,
-    T2,
-    W[64];
-
-  shift=32;
-  p=GetStringInfoDatum(sha_info->message);
-  if (sha_info->lsb_first == WizardFalse)
-    {
-      if (sizeof(unsigned int) <= 4)
-        for (i=0; i < 16; i++)
-        {
-          T=(*((unsigned int *) p));
-          p+=4;
-          W[i]=Trunc32(T);
-        }
-      else
-        for (i=0; i < 16; i+=2)
-        {
-          T=(*((unsigned int *) p));
-          p+=8;
-          W[i]=Trunc32(T >> shift);
-          W[i+1]=Trunc32(T);
-        }
-    }
-  else
-    if (sizeof(unsigned int) <= 4)
-      for (i=0; i < 16; i++)
-      {
-        T=(*((unsigned int *) p));
-        p+=4;
-        W[i]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-      }
-    else
-      for (i=0; i < 16; i+=2)
-      {
-        T=(*((unsigned int *) p));
-        p+=8;
-        W[i]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-        T>>=shift;
-        W[i+1]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-      }
-  /*
-    Copy accumulator to registers.
-  */
-  A=sha_info->accumulator[0];
-  B=sha_info->accumulator[1];
-  C=sha_info->accumulator[2];
-  D=sha_info->accumulator[3];
-  E=sha_info->accumulator[4];
-  F=sha_info->accumulator[5];
-  G=sha_info->accumulator[6];
-  H=sha_info->accumulator[7];
-  for (i=16; i < 64; i++)
-    W[i]=Trunc32(Sigma1(W[i-2])+W[i-7]+Sigma0(W[i-15])+W[i-16]);
-  for (j=0; j < 64; j++)
-  {
-    T1=Trunc32(H+Suma1(E)+Ch(E,F,G)+K[j]+W[j]);
-    T2=Trunc32(Suma0(A)+Maj(A,B,C));
-    H=G;
-    G=F;
-    F=E;
-    E=Trunc32(D+T1);
-    D=C;
-    C=B;
-    B=A;
-    A=Trunc32(T1+T2);
-  }
-  /*
-    Add registers back to accumulator.
-  */
-  sha_info->accumulator[0]=Trunc32(sha_info->accumulator[0]+A);
-  sha_info->accumulator[1]=Trunc32(sha_info->accumulator[1]+B);
-  sha_info->accumulator[2]=Trunc32(sha_info->accumulator[2]+C);
-  sha_info->accumulator[3]=Trunc32(sha_info->accumulator[3]+D);
-  sha_info->accumulator[4]=Trunc32(sha_info->accumulator[4]+E);
-  sha_info->accumulator[5]=Trunc32(sha_info->accumulator[5]+F);
-  sha_info->accumulator[6]=Trunc32(sha_info->accumulator[6]+G);
-  /*
-    Reset working registers.
-  */
-  A=0;
-  B=0;
-  C=0;
-  D=0;
-  E=0;
-  F=0;
-  G=0;
-  H=0;
-  T=0;
-  T1=0;
-  T2=0;
-  (void) memset(W,0,sizeof(W));
+  return(UpdateSHA2224Bytes(sha_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
 }
 
 /*
@@ -588,18 +541,20 @@ static void TransformSHA2224(SHA2224Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   U p d a t e S H A                                                         %
+%   U p d a t e S H A 2 2 2 4 B y t e s                                       %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  UpdateSHA2224() updates the SHA2224 message accumulator.
+%  UpdateSHA2224Bytes() updates the SHA2224 message accumulator from the
+%  caller's memory.  Whole blocks are transformed directly from it; only a
+%  trailing partial block is buffered.
 %
-%  The format of the UpdateSHA2224 method is:
+%  The format of the UpdateSHA2224Bytes method is:
 %
-%      WizardBooleanType UpdateSHA2224(SHA2224Info *sha_info,
-%        const StringInfo *message)
+%      WizardBooleanType UpdateSHA2224Bytes(SHA2224Info *sha_info,
+%        const void *message,const size_t extent)
 %
 %  A description of each parameter follows:
 %
@@ -607,14 +562,22 @@ static void TransformSHA2224(SHA2224Info *sha_info)
 %
 %    o message: The message.
 %
+%    o extent: The length of the message in bytes.
+%
 */
-WizardExport WizardBooleanType UpdateSHA2224(SHA2224Info *sha_info,
-  const StringInfo *message)
+
+static inline unsigned int Trunc32(const unsigned int x)
+{
+  return((unsigned int) (x & 0xffffffffU));
+}
+
+WizardExport WizardBooleanType UpdateSHA2224Bytes(SHA2224Info *sha_info,
+  const void *message,const size_t extent)
 {
    size_t
     i;
 
-   unsigned char
+   const unsigned char
     *p;
 
   size_t
@@ -628,13 +591,13 @@ WizardExport WizardBooleanType UpdateSHA2224(SHA2224Info *sha_info,
   */
   assert(sha_info != (SHA2224Info *) NULL);
   assert(sha_info->signature == WizardSignature);
-  n=GetStringInfoLength(message);
+  n=extent;
   length=Trunc32((unsigned int) (sha_info->low_order+(n << 3)));
   if (length < sha_info->low_order)
     sha_info->high_order++;
   sha_info->low_order=length;
   sha_info->high_order+=(unsigned int) n >> 29;
-  p=GetStringInfoDatum(message);
+  p=(const unsigned char *) message;
   if (sha_info->offset != 0)
     {
       i=GetStringInfoLength(sha_info->message)-sha_info->offset;
@@ -647,15 +610,19 @@ WizardExport WizardBooleanType UpdateSHA2224(SHA2224Info *sha_info,
       sha_info->offset+=i;
       if (sha_info->offset != GetStringInfoLength(sha_info->message))
         return(WizardTrue);
-      TransformSHA2224(sha_info);
+      sha_info->transform(sha_info->accumulator,GetStringInfoDatum(
+        sha_info->message),1);
+    }
+  if (n >= SHA2224Blocksize)
+    {
+      /*
+        Transform whole blocks directly from the message.
+      */
+      i=n/SHA2224Blocksize;
+      sha_info->transform(sha_info->accumulator,p,i);
+      p+=i*SHA2224Blocksize;
+      n-=i*SHA2224Blocksize;
     }
-  while (n >= GetStringInfoLength(sha_info->message))
-  {
-    SetStringInfoDatum(sha_info->message,p);
-    p+=GetStringInfoLength(sha_info->message);
-    n-=GetStringInfoLength(sha_info->message);
-    TransformSHA2224(sha_info);
-  }
   (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,n);
   sha_info->offset=n;
   /*
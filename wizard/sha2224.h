@@ -29,6 +29,9 @@ extern WizardExport SHA2224Info
   *AcquireSHA2224Info(void),
   *DestroySHA2224Info(SHA2224Info *);
 
+extern WizardExport StringInfo
+  *ExportSHA2224State(const SHA2224Info *);
+
 extern WizardExport const StringInfo
   *GetSHA2224Digest(const SHA2224Info *);
 
@@ -37,9 +40,11 @@ extern WizardExport unsigned int
   GetSHA2224Digestsize(const SHA2224Info *);
 
 extern WizardExport WizardBooleanType
+  ImportSHA2224State(SHA2224Info *,const StringInfo *),
   InitializeSHA2224(SHA2224Info *),
   FinalizeSHA2224(SHA2224Info *),
-  UpdateSHA2224(SHA2224Info *,const StringInfo *);
+  UpdateSHA2224(SHA2224Info *,const StringInfo *),
+  UpdateSHA2224Bytes(SHA2224Info *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
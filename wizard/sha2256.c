@@ -42,8 +42,11 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/cpu-private.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
 #include "wizard/sha2256.h"
+#include "wizard/sha2256-private.h"
 /*
   Define declarations.
 */
@@ -74,6 +77,9 @@ struct _SHA2256Info
   WizardBooleanType
     lsb_first;
 
+  SHA2256TransformMethod
+    transform;
+
   time_t
     timestamp;
 
@@ -85,7 +91,14 @@ struct _SHA2256Info
   Forward declarations.
 */
 static void
-  TransformSHA2256(SHA2256Info *);
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  TransformSHA2256AVX2(unsigned int *,const unsigned char *,const size_t),
+  TransformSHA2256LanesAVX2(unsigned int *,const unsigned char **,
+    const size_t),
+  TransformSHA2256SHANI(unsigned int *,const unsigned char *,const size_t),
+  TransformSHA2256SSSE3(unsigned int *,const unsigned char *,const size_t),
+#endif
+  TransformSHA2256(unsigned int *,const unsigned char *,const size_t);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -128,6 +141,7 @@ WizardExport SHA2256Info *AcquireSHA2256Info(void)
   lsb_first=1;
   sha_info->lsb_first=(int) (*(char *) &lsb_first) == 1 ? WizardTrue :
     WizardFalse;
+  sha_info->transform=GetSHA2256Transform();
   sha_info->timestamp=time((time_t *) NULL);
   sha_info->signature=WizardSignature;
   (void) InitializeSHA2256(sha_info);
@@ -178,6 +192,55 @@ WizardExport SHA2256Info *DestroySHA2256Info(SHA2256Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t S H A 2 2 5 6 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportSHA2256State() returns the in-progress SHA2256 state as a byte string
+%  holding the accumulator, the message length, and the buffered partial
+%  block.  ImportSHA2256State() resumes from it.
+%
+%  The format of the ExportSHA2256State method is:
+%
+%      StringInfo *ExportSHA2256State(const SHA2256Info *sha_info)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2256Info.
+%
+*/
+WizardExport StringInfo *ExportSHA2256State(const SHA2256Info *sha_info)
+{
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(sha_info != (SHA2256Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  state=AcquireStringInfo(8*4+2*4+4+sha_info->offset);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    ExportHashWord(&q,sha_info->accumulator[i],4);
+  ExportHashWord(&q,sha_info->low_order,4);
+  ExportHashWord(&q,sha_info->high_order,4);
+  ExportHashWord(&q,sha_info->offset,4);
+  (void) CopyWizardMemory(q,GetStringInfoDatum(sha_info->message),
+    sha_info->offset);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e S H A                                                     %
 %                                                                             %
 %                                                                             %
@@ -234,7 +297,7 @@ WizardExport WizardBooleanType FinalizeSHA2256(SHA2256Info *sha_info)
     {
       (void) memset(datum+count,0,GetStringInfoLength(
         sha_info->message)-count);
-      TransformSHA2256(sha_info);
+      sha_info->transform(sha_info->accumulator,datum,1);
       (void) memset(datum,0,GetStringInfoLength(sha_info->message)-
         8);
     }
@@ -246,7 +309,7 @@ WizardExport WizardBooleanType FinalizeSHA2256(SHA2256Info *sha_info)
   datum[61]=(unsigned char) (low_order >> 16);
   datum[62]=(unsigned char) (low_order >> 8);
   datum[63]=(unsigned char) low_order;
-  TransformSHA2256(sha_info);
+  sha_info->transform(sha_info->accumulator,datum,1);
   p=sha_info->accumulator;
   q=GetStringInfoDatum(sha_info->digest);
   for (i=0; i < (SHA2256Digestsize/4); i++)
@@ -361,6 +424,126 @@ WizardExport unsigned int GetSHA2256Digestsize(const SHA2256Info *sha2256_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   G e t S H A 2 2 5 6 L a n e s T r a n s f o r m                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetSHA2256LanesTransform() returns a transform that compresses HashLanes
+%  independent SHA2256 messages at once, or NULL if this processor has none.
+%
+%  The format of the GetSHA2256LanesTransform method is:
+%
+%      HashLanesTransformMethod GetSHA2256LanesTransform(void)
+%
+*/
+WizardExport HashLanesTransformMethod GetSHA2256LanesTransform(void)
+{
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    return(TransformSHA2256LanesAVX2);
+#endif
+  return((HashLanesTransformMethod) NULL);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t S H A 2 5 6 T r a n s f o r m                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetSHA2256Transform() returns the fastest SHA2256 block transform this
+%  processor supports.
+%
+%  The format of the GetSHA2256Transform method is:
+%
+%      SHA2256TransformMethod GetSHA2256Transform(void)
+%
+*/
+WizardExport SHA2256TransformMethod GetSHA2256Transform(void)
+{
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if ((HasCPUFeature(SHACPUFeature) != WizardFalse) &&
+      (HasCPUFeature(SSE41CPUFeature) != WizardFalse))
+    return(TransformSHA2256SHANI);
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    return(TransformSHA2256AVX2);
+  if (HasCPUFeature(SSSE3CPUFeature) != WizardFalse)
+    return(TransformSHA2256SSSE3);
+#endif
+  return(TransformSHA2256);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t S H A 2 2 5 6 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportSHA2256State() restores a state returned by ExportSHA2256State().  A
+%  malformed state is rejected with WizardFalse and the SHA2256 state is left
+%  as it was.
+%
+%  The format of the ImportSHA2256State method is:
+%
+%      WizardBooleanType ImportSHA2256State(SHA2256Info *sha_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2256Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportSHA2256State(SHA2256Info *sha_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    offset;
+
+  ssize_t
+    i;
+
+  assert(sha_info != (SHA2256Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < (8*4+2*4+4))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+8*4+2*4;
+  offset=(size_t) ImportHashWord(&p,4);
+  if ((offset >= SHA2256Blocksize) ||
+      (GetStringInfoLength(state) != (8*4+2*4+4+offset)))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    sha_info->accumulator[i]=(unsigned int) ImportHashWord(&p,4);
+  sha_info->low_order=(unsigned int) ImportHashWord(&p,4);
+  sha_info->high_order=(unsigned int) ImportHashWord(&p,4);
+  sha_info->offset=offset;
+  p+=4;
+  (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,offset);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e S H A                                                 %
 %                                                                             %
 %                                                                             %
@@ -408,18 +591,49 @@ WizardExport WizardBooleanType InitializeSHA2256(SHA2256Info *sha_info)
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  TransformSHA2256() transforms the SHA2256 message accumulator.
+%  TransformSHA2256() transforms the SHA2256 message accumulator.  A run of
+%  blocks is transformed in one call, with SHA extensions where the processor
+%  has them, otherwise with an SSSE3 or AVX2 message schedule feeding scalar
+%  rounds.
 %
 %  The format of the TransformSHA2256 method is:
 %
-%      TransformSHA2256(SHA2256Info *sha_info)
+%      void TransformSHA2256(unsigned int *accumulator,
+%        const unsigned char *message,const size_t blocks)
 %
 %  A description of each parameter follows:
 %
-%    o sha_info: The address of a structure of type SHA2256Info.
+%    o accumulator: the SHA2256 message accumulator.
+%
+%    o message: the message blocks.
+%
+%    o blocks: the number of 64-byte blocks.
 %
 */
 
+#define Sigma0(x)  (RotateRight(x,7) ^ RotateRight(x,18) ^ Trunc32((x) >> 3))
+#define Sigma1(x)  (RotateRight(x,17) ^ RotateRight(x,19) ^ Trunc32((x) >> 10))
+#define Suma0(x)  (RotateRight(x,2) ^ RotateRight(x,13) ^ RotateRight(x,22))
+#define Suma1(x)  (RotateRight(x,6) ^ RotateRight(x,11) ^ RotateRight(x,25))
+
+static const unsigned int
+  K[64] =
+  {
+    0x428a2f98U, 0x71374491U, 0xb5c0fbcfU, 0xe9b5dba5U, 0x3956c25bU,
+    0x59f111f1U, 0x923f82a4U, 0xab1c5ed5U, 0xd807aa98U, 0x12835b01U,
+    0x243185beU, 0x550c7dc3U, 0x72be5d74U, 0x80deb1feU, 0x9bdc06a7U,
+    0xc19bf174U, 0xe49b69c1U, 0xefbe4786U, 0x0fc19dc6U, 0x240ca1ccU,
+    0x2de92c6fU, 0x4a7484aaU, 0x5cb0a9dcU, 0x76f988daU, 0x983e5152U,
+    0xa831c66dU, 0xb00327c8U, 0xbf597fc7U, 0xc6e00bf3U, 0xd5a79147U,
+    0x06ca6351U, 0x14292967U, 0x27b70a85U, 0x2e1b2138U, 0x4d2c6dfcU,
+    0x53380d13U, 0x650a7354U, 0x766a0abbU, 0x81c2c92eU, 0x92722c85U,
+    0xa2bfe8a1U, 0xa81a664bU, 0xc24b8b70U, 0xc76c51a3U, 0xd192e819U,
+    0xd6990624U, 0xf40e3585U, 0x106aa070U, 0x19a4c116U, 0x1e376c08U,
+    0x2748774cU, 0x34b0bcb5U, 0x391c0cb3U, 0x4ed8aa4aU, 0x5b9cca4fU,
+    0x682e6ff3U, 0x748f82eeU, 0x78a5636fU, 0x84c87814U, 0x8cc70208U,
+    0x90befffaU, 0xa4506cebU, 0xbef9a3f7U, 0xc67178f2U
+  };  /* 32-bit fractional part of the cube root of the first 64 primes */
+
 static inline unsigned int Ch(const unsigned int x,const unsigned int y,
   const unsigned int z)
 {
@@ -442,40 +656,12 @@ static unsigned int RotateRight(const unsigned int x,const unsigned int n)
   return(Trunc32((x >> n) | (x << (32-n))));
 }
 
-static void TransformSHA2256(SHA2256Info *sha_info)
+static inline void RoundsSHA2256(unsigned int *accumulator,
+  const unsigned int *W)
 {
-#define Sigma0(x)  (RotateRight(x,7) ^ RotateRight(x,18) ^ Trunc32((x) >> 3))
-#define Sigma1(x)  (RotateRight(x,17) ^ RotateRight(x,19) ^ Trunc32((x) >> 10))
-#define Suma0(x)  (RotateRight(x,2) ^ RotateRight(x,13) ^ RotateRight(x,22))
-#define Suma1(x)  (RotateRight(x,6) ^ RotateRight(x,11) ^ RotateRight(x,25))
-
   ssize_t
     j;
 
-   ssize_t
-    i;
-
-   unsigned char
-    *p;
-
-  static unsigned int
-    K[64] =
-    {
-      0x428a2f98U, 0x71374491U, 0xb5c0fbcfU, 0xe9b5dba5U, 0x3956c25bU,
-      0x59f111f1U, 0x923f82a4U, 0xab1c5ed5U, 0xd807aa98U, 0x12835b01U,
-      0x243185beU, 0x550c7dc3U, 0x72be5d74U, 0x80deb1feU, 0x9bdc06a7U,
-      0xc19bf174U, 0xe49b69c1U, 0xefbe4786U, 0x0fc19dc6U, 0x240ca1ccU,
-      0x2de92c6fU, 0x4a7484aaU, 0x5cb0a9dcU, 0x76f988daU, 0x983e5152U,
-      0xa831c66dU, 0xb00327c8U, 0xbf597fc7U, 0xc6e00bf3U, 0xd5a79147U,
-      0x06ca6351U, 0x14292967U, 0x27b70a85U, 0x2e1b2138U, 0x4d2c6dfcU,
-      0x53380d13U, 0x650a7354U, 0x766a0abbU, 0x81c2c92eU, 0x92722c85U,
-      0xa2bfe8a1U, 0xa81a664bU, 0xc24b8b70U, 0xc76c51a3U, 0xd192e819U,
-      0xd6990624U, 0xf40e3585U, 0x106aa070U, 0x19a4c116U, 0x1e376c08U,
-      0x2748774cU, 0x34b0bcb5U, 0x391c0cb3U, 0x4ed8aa4aU, 0x5b9cca4fU,
-      0x682e6ff3U, 0x748f82eeU, 0x78a5636fU, 0x84c87814U, 0x8cc70208U,
-      0x90befffaU, 0xa4506cebU, 0xbef9a3f7U, 0xc67178f2U
-    };  /* 32-bit fractional part of the cube root of the first 64 primes */
-
   unsigned int
     A,
     B,
@@ -485,68 +671,23 @@ static void TransformSHA2256(SHA2256Info *sha_info)
     F,
     G,
     H,
-    shift,
-    T,
     T1,
-    T2,
-    W[64];
+    T2;
 
-  shift=32;
-  p=GetStringInfoDatum(sha_info->message);
-  if (sha_info->lsb_first == WizardFalse)
-    {
-      if (sizeof(unsigned int) <= 4)
-        for (i=0; i < 16; i++)
-        {
-          T=(*((unsigned int *) p));
-          p+=4;
-          W[i]=Trunc32(T);
-        }
-      else
-        for (i=0; i < 16; i+=2)
-        {
-          T=(*((unsigned int *) p));
-          p+=8;
-          W[i]=Trunc32(T >> shift);
-          W[i+1]=Trunc32(T);
-        }
-    }
-  else
-    if (sizeof(unsigned int) <= 4)
-      for (i=0; i < 16; i++)
-      {
-        T=(*((unsigned int *) p));
-        p+=4;
-        W[i]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-      }
-    else
-      for (i=0; i < 16; i+=2)
-      {
-        T=(*((unsigned int *) p));
-        p+=8;
-        W[i]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-        T>>=shift;
-        W[i+1]=((T << 24) & 0xff000000) | ((T << 8) & 0x00ff0000) |
-          ((T >> 8) & 0x0000ff00) | ((T >> 24) & 0x000000ff);
-      }
   /*
-    Copy accumulator to registers.
+    Copy accumulator to registers, W holds the message schedule plus K.
   */
-  A=sha_info->accumulator[0];
-  B=sha_info->accumulator[1];
-  C=sha_info->accumulator[2];
-  D=sha_info->accumulator[3];
-  E=sha_info->accumulator[4];
-  F=sha_info->accumulator[5];
-  G=sha_info->accumulator[6];
-  H=sha_info->accumulator[7];
-  for (i=16; i < 64; i++)
-    W[i]=Trunc32(Sigma1(W[i-2])+W[i-7]+Sigma0(W[i-15])+W[i-16]);
+  A=accumulator[0];
+  B=accumulator[1];
+  C=accumulator[2];
+  D=accumulator[3];
+  E=accumulator[4];
+  F=accumulator[5];
+  G=accumulator[6];
+  H=accumulator[7];
   for (j=0; j < 64; j++)
   {
-    T1=Trunc32(H+Suma1(E)+Ch(E,F,G)+K[j]+W[j]);
+    T1=Trunc32(H+Suma1(E)+Ch(E,F,G)+W[j]);
     T2=Trunc32(Suma0(A)+Maj(A,B,C));
     H=G;
     G=F;
@@ -560,14 +701,14 @@ static void TransformSHA2256(SHA2256Info *sha_info)
   /*
     Add registers back to accumulator.
   */
-  sha_info->accumulator[0]=Trunc32(sha_info->accumulator[0]+A);
-  sha_info->accumulator[1]=Trunc32(sha_info->accumulator[1]+B);
-  sha_info->accumulator[2]=Trunc32(sha_info->accumulator[2]+C);
-  sha_info->accumulator[3]=Trunc32(sha_info->accumulator[3]+D);
-  sha_info->accumulator[4]=Trunc32(sha_info->accumulator[4]+E);
-  sha_info->accumulator[5]=Trunc32(sha_info->accumulator[5]+F);
-  sha_info->accumulator[6]=Trunc32(sha_info->accumulator[6]+G);
-  sha_info->accumulator[7]=Trunc32(sha_info->accumulator[7]+H);
+  accumulator[0]=Trunc32(accumulator[0]+A);
+  accumulator[1]=Trunc32(accumulator[1]+B);
+  accumulator[2]=Trunc32(accumulator[2]+C);
+  accumulator[3]=Trunc32(accumulator[3]+D);
+  accumulator[4]=Trunc32(accumulator[4]+E);
+  accumulator[5]=Trunc32(accumulator[5]+F);
+  accumulator[6]=Trunc32(accumulator[6]+G);
+  accumulator[7]=Trunc32(accumulator[7]+H);
   /*
     Reset working registers.
   */
@@ -579,9 +720,411 @@ static void TransformSHA2256(SHA2256Info *sha_info)
   F=0;
   G=0;
   H=0;
-  T=0;
   T1=0;
   T2=0;
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static inline WizardTarget("ssse3") __m128i Sigma0SSSE3(const __m128i x)
+{
+  return(_mm_xor_si128(_mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(x,7),
+    _mm_slli_epi32(x,25)),_mm_xor_si128(_mm_srli_epi32(x,18),
+    _mm_slli_epi32(x,14))),_mm_srli_epi32(x,3)));
+}
+
+static inline WizardTarget("ssse3") __m128i Sigma1SSSE3(const __m128i x)
+{
+  return(_mm_xor_si128(_mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(x,17),
+    _mm_slli_epi32(x,15)),_mm_xor_si128(_mm_srli_epi32(x,19),
+    _mm_slli_epi32(x,13))),_mm_srli_epi32(x,10)));
+}
+
+static inline WizardTarget("ssse3") __m128i ScheduleSHA2256SSSE3(
+  const __m128i X0,const __m128i X1,const __m128i X2,const __m128i X3)
+{
+  __m128i
+    W;
+
+  W=_mm_add_epi32(_mm_add_epi32(X0,Sigma0SSSE3(_mm_alignr_epi8(X1,X0,4))),
+    _mm_alignr_epi8(X3,X2,4));
+  W=_mm_add_epi32(W,_mm_srli_si128(Sigma1SSSE3(X3),8));
+  return(_mm_add_epi32(W,_mm_slli_si128(Sigma1SSSE3(W),8)));
+}
+
+static WizardTarget("ssse3") void TransformSHA2256SSSE3(
+  unsigned int *accumulator,const unsigned char *message,const size_t blocks)
+{
+  const unsigned char
+    *p;
+
+  __m128i
+    mask,
+    X[4];
+
+  size_t
+    i,
+    j;
+
+  unsigned int
+    W[64];
+
+  mask=_mm_set_epi64x(0x0c0d0e0f08090a0bULL,0x0405060700010203ULL);
+  p=message;
+  for (j=0; j < blocks; j++)
+  {
+    for (i=0; i < 4; i++)
+    {
+      X[i]=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p+16*i)),mask);
+      _mm_storeu_si128((__m128i *) (W+4*i),_mm_add_epi32(X[i],
+        _mm_loadu_si128((const __m128i *) (K+4*i))));
+    }
+    for (i=4; i < 16; i++)
+    {
+      X[i & 0x03]=ScheduleSHA2256SSSE3(X[i & 0x03],X[(i+1) & 0x03],
+        X[(i+2) & 0x03],X[(i+3) & 0x03]);
+      _mm_storeu_si128((__m128i *) (W+4*i),_mm_add_epi32(X[i & 0x03],
+        _mm_loadu_si128((const __m128i *) (K+4*i))));
+    }
+    RoundsSHA2256(accumulator,W);
+    p+=64;
+  }
+  /*
+    Reset working registers.
+  */
+  X[0]=_mm_setzero_si128();
+  X[1]=_mm_setzero_si128();
+  X[2]=_mm_setzero_si128();
+  X[3]=_mm_setzero_si128();
+  (void) memset(W,0,sizeof(W));
+}
+static inline WizardTarget("avx2") __m256i Sigma0AVX2(const __m256i x)
+{
+  return(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(
+    _mm256_srli_epi32(x,7),_mm256_slli_epi32(x,25)),_mm256_xor_si256(
+    _mm256_srli_epi32(x,18),_mm256_slli_epi32(x,14))),_mm256_srli_epi32(x,3)));
+}
+
+static inline WizardTarget("avx2") __m256i Sigma1AVX2(const __m256i x)
+{
+  return(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(
+    _mm256_srli_epi32(x,17),_mm256_slli_epi32(x,15)),_mm256_xor_si256(
+    _mm256_srli_epi32(x,19),_mm256_slli_epi32(x,13))),
+    _mm256_srli_epi32(x,10)));
+}
+
+static inline WizardTarget("avx2") __m256i ScheduleSHA2256AVX2(
+  const __m256i X0,const __m256i X1,const __m256i X2,const __m256i X3)
+{
+  __m256i
+    W;
+
+  /*
+    The next four schedule words from the previous sixteen; the last two of
+    them depend on the first two.
+  */
+  W=_mm256_add_epi32(_mm256_add_epi32(X0,Sigma0AVX2(_mm256_alignr_epi8(X1,X0,
+    4))),_mm256_alignr_epi8(X3,X2,4));
+  W=_mm256_add_epi32(W,_mm256_srli_si256(Sigma1AVX2(X3),8));
+  return(_mm256_add_epi32(W,_mm256_slli_si256(Sigma1AVX2(W),8)));
+}
+
+static WizardTarget("avx2") void TransformSHA2256AVX2(
+  unsigned int *accumulator,const unsigned char *message,const size_t blocks)
+{
+  const unsigned char
+    *p;
+
+  __m256i
+    k,
+    mask,
+    X[4];
+
+  size_t
+    i,
+    j;
+
+  unsigned int
+    W[2][64];
+
+  /*
+    Schedule two blocks at once, one in each 128-bit lane.
+  */
+  mask=_mm256_broadcastsi128_si256(_mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+    0x0405060700010203ULL));
+  p=message;
+  for (j=0; (j+2) <= blocks; j+=2)
+  {
+    for (i=0; i < 4; i++)
+    {
+      X[i]=_mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(
+        _mm_loadu_si128((const __m128i *) (p+16*i))),_mm_loadu_si128(
+        (const __m128i *) (p+64+16*i)),1),mask);
+      k=_mm256_add_epi32(X[i],_mm256_broadcastsi128_si256(_mm_loadu_si128(
+        (const __m128i *) (K+4*i))));
+      _mm_storeu_si128((__m128i *) (W[0]+4*i),_mm256_castsi256_si128(k));
+      _mm_storeu_si128((__m128i *) (W[1]+4*i),_mm256_extracti128_si256(k,1));
+    }
+    for (i=4; i < 16; i++)
+    {
+      X[i & 0x03]=ScheduleSHA2256AVX2(X[i & 0x03],X[(i+1) & 0x03],
+        X[(i+2) & 0x03],X[(i+3) & 0x03]);
+      k=_mm256_add_epi32(X[i & 0x03],_mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) (K+4*i))));
+      _mm_storeu_si128((__m128i *) (W[0]+4*i),_mm256_castsi256_si128(k));
+      _mm_storeu_si128((__m128i *) (W[1]+4*i),_mm256_extracti128_si256(k,1));
+    }
+    RoundsSHA2256(accumulator,W[0]);
+    RoundsSHA2256(accumulator,W[1]);
+    p+=128;
+  }
+  if (j < blocks)
+    TransformSHA2256SSSE3(accumulator,p,blocks-j);
+  /*
+    Reset working registers.
+  */
+  X[0]=_mm256_setzero_si256();
+  X[1]=_mm256_setzero_si256();
+  X[2]=_mm256_setzero_si256();
+  X[3]=_mm256_setzero_si256();
+  k=_mm256_setzero_si256();
+  (void) memset(W,0,sizeof(W));
+}
+
+static inline WizardTarget("sha,sse4.1") __m128i ScheduleSHA2256SHANI(
+  const __m128i X0,const __m128i X1,const __m128i X2,const __m128i X3)
+{
+  return(_mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(X0,X1),
+    _mm_alignr_epi8(X3,X2,4)),X3));
+}
+
+static inline WizardTarget("sha,sse4.1") void RoundsSHA2256SHANI(__m128i *abef,
+  __m128i *cdgh,const __m128i message,const ssize_t i)
+{
+  __m128i
+    k;
+
+  k=_mm_add_epi32(message,_mm_loadu_si128((const __m128i *) (K+4*i)));
+  *cdgh=_mm_sha256rnds2_epu32(*cdgh,*abef,k);
+  *abef=_mm_sha256rnds2_epu32(*abef,*cdgh,_mm_shuffle_epi32(k,0x0e));
+}
+
+static WizardTarget("sha,sse4.1") void TransformSHA2256SHANI(
+  unsigned int *accumulator,const unsigned char *message,const size_t blocks)
+{
+  const unsigned char
+    *p;
+
+  __m128i
+    abef,
+    abef_save,
+    cdgh,
+    cdgh_save,
+    mask,
+    X0,
+    X1,
+    X2,
+    X3;
+
+  size_t
+    j;
+
+  ssize_t
+    i;
+
+  /*
+    The SHA extensions keep the state as ABEF and CDGH.
+  */
+  mask=_mm_set_epi64x(0x0c0d0e0f08090a0bULL,0x0405060700010203ULL);
+  X0=_mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) accumulator),0xb1);
+  cdgh=_mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) (accumulator+4)),
+    0x1b);
+  abef=_mm_alignr_epi8(X0,cdgh,8);
+  cdgh=_mm_blend_epi16(cdgh,X0,0xf0);
+  p=message;
+  for (j=0; j < blocks; j++)
+  {
+    abef_save=abef;
+    cdgh_save=cdgh;
+    X0=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) p),mask);
+    RoundsSHA2256SHANI(&abef,&cdgh,X0,0);
+    X1=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p+16)),mask);
+    RoundsSHA2256SHANI(&abef,&cdgh,X1,1);
+    X2=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p+32)),mask);
+    RoundsSHA2256SHANI(&abef,&cdgh,X2,2);
+    X3=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p+48)),mask);
+    RoundsSHA2256SHANI(&abef,&cdgh,X3,3);
+    for (i=4; i < 16; i+=4)
+    {
+      X0=ScheduleSHA2256SHANI(X0,X1,X2,X3);
+      RoundsSHA2256SHANI(&abef,&cdgh,X0,i);
+      X1=ScheduleSHA2256SHANI(X1,X2,X3,X0);
+      RoundsSHA2256SHANI(&abef,&cdgh,X1,i+1);
+      X2=ScheduleSHA2256SHANI(X2,X3,X0,X1);
+      RoundsSHA2256SHANI(&abef,&cdgh,X2,i+2);
+      X3=ScheduleSHA2256SHANI(X3,X0,X1,X2);
+      RoundsSHA2256SHANI(&abef,&cdgh,X3,i+3);
+    }
+    abef=_mm_add_epi32(abef,abef_save);
+    cdgh=_mm_add_epi32(cdgh,cdgh_save);
+    p+=64;
+  }
+  X0=_mm_shuffle_epi32(abef,0x1b);
+  cdgh=_mm_shuffle_epi32(cdgh,0xb1);
+  _mm_storeu_si128((__m128i *) accumulator,_mm_blend_epi16(X0,cdgh,0xf0));
+  _mm_storeu_si128((__m128i *) (accumulator+4),_mm_alignr_epi8(cdgh,X0,8));
+  /*
+    Reset working registers.
+  */
+  abef=_mm_setzero_si128();
+  abef_save=_mm_setzero_si128();
+  cdgh=_mm_setzero_si128();
+  cdgh_save=_mm_setzero_si128();
+  X0=_mm_setzero_si128();
+  X1=_mm_setzero_si128();
+  X2=_mm_setzero_si128();
+  X3=_mm_setzero_si128();
+}
+
+static inline WizardTarget("avx2") __m256i Suma0AVX2(const __m256i x)
+{
+  return(_mm256_xor_si256(_mm256_xor_si256(RotateLeftAVX2(x,30),
+    RotateLeftAVX2(x,19)),RotateLeftAVX2(x,10)));
+}
+
+static inline WizardTarget("avx2") __m256i Suma1AVX2(const __m256i x)
+{
+  return(_mm256_xor_si256(_mm256_xor_si256(RotateLeftAVX2(x,26),
+    RotateLeftAVX2(x,21)),RotateLeftAVX2(x,7)));
+}
+
+#define SHA2256RoundAVX2(a,b,c,d,e,f,g,h,j) \
+{ \
+  if (i != 0) \
+    W[j]=_mm256_add_epi32(_mm256_add_epi32(W[j],Sigma0AVX2( \
+      W[((j)+1) & 0x0f])),_mm256_add_epi32(W[((j)+9) & 0x0f],Sigma1AVX2( \
+      W[((j)+14) & 0x0f]))); \
+  T1=_mm256_add_epi32(_mm256_add_epi32(h,Suma1AVX2(e)),_mm256_add_epi32( \
+    _mm256_xor_si256(_mm256_and_si256(e,f),_mm256_andnot_si256(e,g)), \
+    _mm256_add_epi32(_mm256_set1_epi32((int) K[i+(j)]),W[j]))); \
+  d=_mm256_add_epi32(d,T1); \
+  h=_mm256_add_epi32(T1,_mm256_add_epi32(Suma0AVX2(a),_mm256_or_si256( \
+    _mm256_and_si256(a,b),_mm256_and_si256(c,_mm256_or_si256(a,b))))); \
+}
+
+static WizardTarget("avx2") void TransformSHA2256LanesAVX2(
+  unsigned int *accumulator,const unsigned char **message,const size_t blocks)
+{
+  __m256i
+    A,
+    B,
+    C,
+    D,
+    E,
+    F,
+    G,
+    H,
+    mask,
+    S[8],
+    T1,
+    W[16];
+
+  size_t
+    i,
+    j;
+
+  /*
+    Each 32-bit element is one lane; the rounds are the portable ones applied
+    to eight messages at once.
+  */
+  mask=_mm256_broadcastsi128_si256(_mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+    0x0405060700010203ULL));
+  for (i=0; i < 8; i++)
+    S[i]=_mm256_loadu_si256((const __m256i *) (accumulator+HashLanes*i));
+  for (j=0; j < blocks; j++)
+  {
+    LoadHashLanesAVX2(message,64*j,W);
+    for (i=0; i < 16; i++)
+      W[i]=_mm256_shuffle_epi8(W[i],mask);
+    A=S[0];
+    B=S[1];
+    C=S[2];
+    D=S[3];
+    E=S[4];
+    F=S[5];
+    G=S[6];
+    H=S[7];
+    for (i=0; i < 64; i+=16)
+    {
+      SHA2256RoundAVX2(A,B,C,D,E,F,G,H,0);
+      SHA2256RoundAVX2(H,A,B,C,D,E,F,G,1);
+      SHA2256RoundAVX2(G,H,A,B,C,D,E,F,2);
+      SHA2256RoundAVX2(F,G,H,A,B,C,D,E,3);
+      SHA2256RoundAVX2(E,F,G,H,A,B,C,D,4);
+      SHA2256RoundAVX2(D,E,F,G,H,A,B,C,5);
+      SHA2256RoundAVX2(C,D,E,F,G,H,A,B,6);
+      SHA2256RoundAVX2(B,C,D,E,F,G,H,A,7);
+      SHA2256RoundAVX2(A,B,C,D,E,F,G,H,8);
+      SHA2256RoundAVX2(H,A,B,C,D,E,F,G,9);
+      SHA2256RoundAVX2(G,H,A,B,C,D,E,F,10);
+      SHA2256RoundAVX2(F,G,H,A,B,C,D,E,11);
+      SHA2256RoundAVX2(E,F,G,H,A,B,C,D,12);
+      SHA2256RoundAVX2(D,E,F,G,H,A,B,C,13);
+      SHA2256RoundAVX2(C,D,E,F,G,H,A,B,14);
+      SHA2256RoundAVX2(B,C,D,E,F,G,H,A,15);
+    }
+    S[0]=_mm256_add_epi32(S[0],A);
+    S[1]=_mm256_add_epi32(S[1],B);
+    S[2]=_mm256_add_epi32(S[2],C);
+    S[3]=_mm256_add_epi32(S[3],D);
+    S[4]=_mm256_add_epi32(S[4],E);
+    S[5]=_mm256_add_epi32(S[5],F);
+    S[6]=_mm256_add_epi32(S[6],G);
+    S[7]=_mm256_add_epi32(S[7],H);
+  }
+  for (i=0; i < 8; i++)
+    _mm256_storeu_si256((__m256i *) (accumulator+HashLanes*i),S[i]);
+  /*
+    Reset working registers.
+  */
+  for (i=0; i < 16; i++)
+    W[i]=_mm256_setzero_si256();
+  T1=_mm256_setzero_si256();
+}
+#endif
+
+static void TransformSHA2256(unsigned int *accumulator,
+  const unsigned char *message,const size_t blocks)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    j;
+
+  ssize_t
+    i;
+
+  unsigned int
+    W[64];
+
+  p=message;
+  for (j=0; j < blocks; j++)
+  {
+    for (i=0; i < 16; i++)
+    {
+      W[i]=((unsigned int) p[0] << 24) | ((unsigned int) p[1] << 16) |
+        ((unsigned int) p[2] << 8) | (unsigned int) p[3];
+      p+=4;
+    }
+    for (i=16; i < 64; i++)
+      W[i]=Trunc32(Sigma1(W[i-2])+W[i-7]+Sigma0(W[i-15])+W[i-16]);
+    for (i=0; i < 64; i++)
+      W[i]=Trunc32(W[i]+K[i]);
+    RoundsSHA2256(accumulator,W);
+  }
+  /*
+    Reset working registers.
+  */
   (void) memset(W,0,sizeof(W));
 }
 
@@ -612,11 +1155,47 @@ static void TransformSHA2256(SHA2256Info *sha_info)
 */
 WizardExport WizardBooleanType UpdateSHA2256(SHA2256Info *sha_info,
   const StringInfo *message)
+{
+  return(UpdateSHA2256Bytes(sha_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e S H A 2 2 5 6 B y t e s                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateSHA2256Bytes() updates the SHA2256 message accumulator from the
+%  caller's memory.  Whole blocks are transformed directly from it; only a
+%  trailing partial block is buffered.
+%
+%  The format of the UpdateSHA2256Bytes method is:
+%
+%      WizardBooleanType UpdateSHA2256Bytes(SHA2256Info *sha_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2256Info.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+WizardExport WizardBooleanType UpdateSHA2256Bytes(SHA2256Info *sha_info,
+  const void *message,const size_t extent)
 {
    size_t
     i;
 
-   unsigned char
+   const unsigned char
     *p;
 
   size_t
@@ -630,13 +1209,13 @@ WizardExport WizardBooleanType UpdateSHA2256(SHA2256Info *sha_info,
   */
   assert(sha_info != (SHA2256Info *) NULL);
   assert(sha_info->signature == WizardSignature);
-  n=GetStringInfoLength(message);
+  n=extent;
   length=Trunc32((unsigned int) (sha_info->low_order+(n << 3)));
   if (length < sha_info->low_order)
     sha_info->high_order++;
   sha_info->low_order=length;
   sha_info->high_order+=(unsigned int) n >> 29;
-  p=GetStringInfoDatum(message);
+  p=(const unsigned char *) message;
   if (sha_info->offset != 0)
     {
       i=GetStringInfoLength(sha_info->message)-sha_info->offset;
@@ -649,15 +1228,19 @@ WizardExport WizardBooleanType UpdateSHA2256(SHA2256Info *sha_info,
       sha_info->offset+=i;
       if (sha_info->offset != GetStringInfoLength(sha_info->message))
         return(WizardTrue);
-      TransformSHA2256(sha_info);
+      sha_info->transform(sha_info->accumulator,GetStringInfoDatum(
+        sha_info->message),1);
+    }
+  if (n >= SHA2256Blocksize)
+    {
+      /*
+        Transform whole blocks directly from the message.
+      */
+      i=n/SHA2256Blocksize;
+      sha_info->transform(sha_info->accumulator,p,i);
+      p+=i*SHA2256Blocksize;
+      n-=i*SHA2256Blocksize;
     }
-  while (n >= GetStringInfoLength(sha_info->message))
-  {
-    SetStringInfoDatum(sha_info->message,p);
-    p+=GetStringInfoLength(sha_info->message);
-    n-=GetStringInfoLength(sha_info->message);
-    TransformSHA2256(sha_info);
-  }
   (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,n);
   sha_info->offset=n;
   /*
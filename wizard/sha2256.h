@@ -29,6 +29,9 @@ extern WizardExport SHA2256Info
   *AcquireSHA2256Info(void),
   *DestroySHA2256Info(SHA2256Info *);
 
+extern WizardExport StringInfo
+  *ExportSHA2256State(const SHA2256Info *);
+
 extern WizardExport const StringInfo
   *GetSHA2256Digest(const SHA2256Info *);
 
@@ -37,9 +40,11 @@ extern WizardExport unsigned int
   GetSHA2256Digestsize(const SHA2256Info *);
 
 extern WizardExport WizardBooleanType
+  ImportSHA2256State(SHA2256Info *,const StringInfo *),
   InitializeSHA2256(SHA2256Info *),
   FinalizeSHA2256(SHA2256Info *),
-  UpdateSHA2256(SHA2256Info *,const StringInfo *);
+  UpdateSHA2256(SHA2256Info *,const StringInfo *),
+  UpdateSHA2256Bytes(SHA2256Info *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
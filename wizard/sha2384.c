@@ -42,8 +42,10 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
 #include "wizard/sha2384.h"
+#include "wizard/sha2512-private.h"
 /*
   Define declarations.
 */
@@ -74,6 +76,9 @@ struct _SHA2384Info
   WizardBooleanType
     lsb_first;
 
+  SHA2512TransformMethod
+    transform;
+
   time_t
     timestamp;
 
@@ -81,12 +86,6 @@ struct _SHA2384Info
     signature;
 };
 
-/*
-  Forward declarations.
-*/
-static void
-  TransformSHA2384(SHA2384Info *);
-
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -128,6 +127,7 @@ WizardExport SHA2384Info *AcquireSHA2384Info(void)
   lsb_first=1;
   sha_info->lsb_first=(int) (*(char *) &lsb_first) == 1 ? WizardTrue :
     WizardFalse;
+  sha_info->transform=GetSHA2512Transform();
   sha_info->timestamp=time((time_t *) NULL);
   sha_info->signature=WizardSignature;
   (void) InitializeSHA2384(sha_info);
@@ -178,6 +178,55 @@ WizardExport SHA2384Info *DestroySHA2384Info(SHA2384Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t S H A 2 3 8 4 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportSHA2384State() returns the in-progress SHA2384 state as a byte string
+%  holding the accumulator, the message length, and the buffered partial
+%  block.  ImportSHA2384State() resumes from it.
+%
+%  The format of the ExportSHA2384State method is:
+%
+%      StringInfo *ExportSHA2384State(const SHA2384Info *sha_info)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2384Info.
+%
+*/
+WizardExport StringInfo *ExportSHA2384State(const SHA2384Info *sha_info)
+{
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(sha_info != (SHA2384Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  state=AcquireStringInfo(8*8+2*8+4+sha_info->offset);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    ExportHashWord(&q,sha_info->accumulator[i],8);
+  ExportHashWord(&q,sha_info->low_order,8);
+  ExportHashWord(&q,sha_info->high_order,8);
+  ExportHashWord(&q,sha_info->offset,4);
+  (void) CopyWizardMemory(q,GetStringInfoDatum(sha_info->message),
+    sha_info->offset);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e S H A                                                     %
 %                                                                             %
 %                                                                             %
@@ -234,7 +283,7 @@ WizardExport WizardBooleanType FinalizeSHA2384(SHA2384Info *sha_info)
     {
       (void) memset(datum+count,0,(size_t) (GetStringInfoLength(
         sha_info->message)-count));
-      TransformSHA2384(sha_info);
+      sha_info->transform(sha_info->accumulator,datum,1);
       (void) memset(datum,0,(GetStringInfoLength(sha_info->message)-
         16));
     }
@@ -254,7 +303,7 @@ WizardExport WizardBooleanType FinalizeSHA2384(SHA2384Info *sha_info)
   datum[125]=(unsigned char) (low_order >> 16);
   datum[126]=(unsigned char) (low_order >> 8);
   datum[127]=(unsigned char) low_order;
-  TransformSHA2384(sha_info);
+  sha_info->transform(sha_info->accumulator,datum,1);
   p=sha_info->accumulator;
   q=GetStringInfoDatum(sha_info->digest);
   for (i=0; i < (SHA2384Digestsize/8); i++)
@@ -373,6 +422,65 @@ WizardExport unsigned int GetSHA2384Digestsize(const SHA2384Info *sha2384_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   I m p o r t S H A 2 3 8 4 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportSHA2384State() restores a state returned by ExportSHA2384State().  A
+%  malformed state is rejected with WizardFalse and the SHA2384 state is left
+%  as it was.
+%
+%  The format of the ImportSHA2384State method is:
+%
+%      WizardBooleanType ImportSHA2384State(SHA2384Info *sha_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2384Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportSHA2384State(SHA2384Info *sha_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    offset;
+
+  ssize_t
+    i;
+
+  assert(sha_info != (SHA2384Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < (8*8+2*8+4))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+8*8+2*8;
+  offset=(size_t) ImportHashWord(&p,4);
+  if ((offset >= SHA2384Blocksize) ||
+      (GetStringInfoLength(state) != (8*8+2*8+4+offset)))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    sha_info->accumulator[i]=ImportHashWord(&p,8);
+  sha_info->low_order=ImportHashWord(&p,8);
+  sha_info->high_order=ImportHashWord(&p,8);
+  sha_info->offset=offset;
+  p+=4;
+  (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,offset);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e S H A                                                 %
 %                                                                             %
 %                                                                             %
@@ -414,237 +522,31 @@ WizardExport WizardBooleanType InitializeSHA2384(SHA2384Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   T r a n s f o r m S H A                                                   %
+%   U p d a t e S H A                                                         %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  TransformSHA2384() transforms the SHA2384 message accumulator.
+%  UpdateSHA2384() updates the SHA2384 message accumulator.
 %
-%  The format of the TransformSHA2384 method is:
+%  The format of the UpdateSHA2384 method is:
 %
-%      TransformSHA2384(SHA2384Info *sha_info)
+%      WizardBooleanType UpdateSHA2384(SHA2384Info *sha_info,
+%        const StringInfo *message)
 %
 %  A description of each parameter follows:
 %
 %    o sha_info: The address of a structure of type SHA2384Info.
 %
+%    o message: The message.
+%
 */
-
-static inline WizardSizeType Ch(const WizardSizeType x,const WizardSizeType y,
-  const WizardSizeType z)
-{
-  return((x & y) ^ (~x & z));
-}
-
-static inline WizardSizeType Maj(const WizardSizeType x,const WizardSizeType y,
-  const WizardSizeType z)
-{
-  return((x & y) ^ (x & z) ^ (y & z));
-}
-
-static inline WizardSizeType Trunc64(const WizardSizeType x)
-{
-  return((WizardSizeType) (x & WizardULLConstant(0xffffffffffffffff)));
-}
-
-static WizardSizeType RotateRight(const WizardSizeType x,
-  const WizardSizeType n)
-{
-  return(Trunc64((x >> n) | (x << (64-n))));
-}
-
-static void TransformSHA2384(SHA2384Info *sha_info)
+WizardExport WizardBooleanType UpdateSHA2384(SHA2384Info *sha_info,
+  const StringInfo *message)
 {
-#define Sigma0(x)  (RotateRight(x,1) ^ RotateRight(x,8) ^ Trunc64((x) >> 7))
-#define Sigma1(x)  (RotateRight(x,19) ^ RotateRight(x,61) ^ Trunc64((x) >> 6))
-#define Suma0(x)  (RotateRight(x,28) ^ RotateRight(x,34) ^ RotateRight(x,39))
-#define Suma1(x)  (RotateRight(x,14) ^ RotateRight(x,18) ^ RotateRight(x,41))
-
-  ssize_t
-    j;
-
-   ssize_t
-    i;
-
-   unsigned char
-    *p;
-
-  static WizardSizeType
-    K[80] =
-    {
-      WizardULLConstant(0x428a2f98d728ae22),
-      WizardULLConstant(0x7137449123ef65cd),
-      WizardULLConstant(0xb5c0fbcfec4d3b2f),
-      WizardULLConstant(0xe9b5dba58189dbbc),
-      WizardULLConstant(0x3956c25bf348b538),
-      WizardULLConstant(0x59f111f1b605d019),
-      WizardULLConstant(0x923f82a4af194f9b),
-      WizardULLConstant(0xab1c5ed5da6d8118),
-      WizardULLConstant(0xd807aa98a3030242),
-      WizardULLConstant(0x12835b0145706fbe),
-      WizardULLConstant(0x243185be4ee4b28c),
-      WizardULLConstant(0x550c7dc3d5ffb4e2),
-      WizardULLConstant(0x72be5d74f27b896f),
-      WizardULLConstant(0x80deb1fe3b1696b1),
-      WizardULLConstant(0x9bdc06a725c71235),
-      WizardULLConstant(0xc19bf174cf692694),
-      WizardULLConstant(0xe49b69c19ef14ad2),
-      WizardULLConstant(0xefbe4786384f25e3),
-      WizardULLConstant(0x0fc19dc68b8cd5b5),
-      WizardULLConstant(0x240ca1cc77ac9c65),
-      WizardULLConstant(0x2de92c6f592b0275),
-      WizardULLConstant(0x4a7484aa6ea6e483),
-      WizardULLConstant(0x5cb0a9dcbd41fbd4),
-      WizardULLConstant(0x76f988da831153b5),
-      WizardULLConstant(0x983e5152ee66dfab),
-      WizardULLConstant(0xa831c66d2db43210),
-      WizardULLConstant(0xb00327c898fb213f),
-      WizardULLConstant(0xbf597fc7beef0ee4),
-      WizardULLConstant(0xc6e00bf33da88fc2),
-      WizardULLConstant(0xd5a79147930aa725),
-      WizardULLConstant(0x06ca6351e003826f),
-      WizardULLConstant(0x142929670a0e6e70),
-      WizardULLConstant(0x27b70a8546d22ffc),
-      WizardULLConstant(0x2e1b21385c26c926),
-      WizardULLConstant(0x4d2c6dfc5ac42aed),
-      WizardULLConstant(0x53380d139d95b3df),
-      WizardULLConstant(0x650a73548baf63de),
-      WizardULLConstant(0x766a0abb3c77b2a8),
-      WizardULLConstant(0x81c2c92e47edaee6),
-      WizardULLConstant(0x92722c851482353b),
-      WizardULLConstant(0xa2bfe8a14cf10364),
-      WizardULLConstant(0xa81a664bbc423001),
-      WizardULLConstant(0xc24b8b70d0f89791),
-      WizardULLConstant(0xc76c51a30654be30),
-      WizardULLConstant(0xd192e819d6ef5218),
-      WizardULLConstant(0xd69906245565a910),
-      WizardULLConstant(0xf40e35855771202a),
-      WizardULLConstant(0x106aa07032bbd1b8),
-      WizardULLConstant(0x19a4c116b8d2d0c8),
-      WizardULLConstant(0x1e376c085141ab53),
-      WizardULLConstant(0x2748774cdf8eeb99),
-      WizardULLConstant(0x34b0bcb5e19b48a8),
-      WizardULLConstant(0x391c0cb3c5c95a63),
-      WizardULLConstant(0x4ed8aa4ae3418acb),
-      WizardULLConstant(0x5b9cca4f7763e373),
-      WizardULLConstant(0x682e6ff3d6b2b8a3),
-      WizardULLConstant(0x748f82ee5defb2fc),
-      WizardULLConstant(0x78a5636f43172f60),
-      WizardULLConstant(0x84c87814a1f0ab72),
-      WizardULLConstant(0x8cc702081a6439ec),
-      WizardULLConstant(0x90befffa23631e28),
-      WizardULLConstant(0xa4506cebde82bde9),
-      WizardULLConstant(0xbef9a3f7b2c67915),
-      WizardULLConstant(0xc67178f2e372532b),
-      WizardULLConstant(0xca273eceea26619c),
-      WizardULLConstant(0xd186b8c721c0c207),
-      WizardULLConstant(0xeada7dd6cde0eb1e),
-      WizardULLConstant(0xf57d4f7fee6ed178),
-      WizardULLConstant(0x06f067aa72176fba),
-      WizardULLConstant(0x0a637dc5a2c898a6),
-      WizardULLConstant(0x113f9804bef90dae),
-      WizardULLConstant(0x1b710b35131c471b),
-      WizardULLConstant(0x28db77f523047d84),
-      WizardULLConstant(0x32caab7b40c72493),
-      WizardULLConstant(0x3c9ebe0a15c9bebc),
-      WizardULLConstant(0x431d67c49c100d4c),
-      WizardULLConstant(0x4cc5d4becb3e42b6),
-      WizardULLConstant(0x597f299cfc657e2a),
-      WizardULLConstant(0x5fcb6fab3ad6faec),
-      WizardULLConstant(0x6c44198c4a475817)
-    };  /* 64-bit fractional part of the cube root of the first 64 primes */
-
-  WizardSizeType
-    A,
-    B,
-    C,
-    D,
-    E,
-    F,
-    G,
-    H,
-    T,
-    T1,
-    T2,
-    W[80];
-
-  p=GetStringInfoDatum(sha_info->message);
-  if (sha_info->lsb_first == WizardFalse)
-    for (i=0; i < 16; i++)
-    {
-      T=(*((WizardSizeType *) p));
-      p+=8;
-      W[i]=(T);
-    }
-  else
-    for (i=0; i < 16; i++)
-    {
-      T=(*((WizardSizeType *) p));
-      p+=8;
-      W[i]=(WizardSizeType)
-        (((T << 56) & WizardULLConstant(0xff00000000000000)) |
-         ((T << 40) & WizardULLConstant(0x00ff000000000000)) |
-         ((T << 24) & WizardULLConstant(0x0000ff0000000000)) |
-         ((T <<  8) & WizardULLConstant(0x000000ff00000000)) |
-         ((T >>  8) & WizardULLConstant(0x00000000ff000000)) |
-         ((T >> 24) & WizardULLConstant(0x0000000000ff0000)) |
-         ((T >> 40) & WizardULLConstant(0x000000000000ff00)) |
-         ((T >> 56) & WizardULLConstant(0x00000000000000ff)));
-    }
-  /*
-    Copy accumulator to registers.
-  */
-  A=sha_info->accumulator[0];
-  B=sha_info->accumulator[1];
-  C=sha_info->accumulator[2];
-  D=sha_info->accumulator[3];
-  E=sha_info->accumulator[4];
-  F=sha_info->accumulator[5];
-  G=sha_info->accumulator[6];
-  H=sha_info->accumulator[7];
-  for (i=16; i < 80; i++)
-    W[i]=Trunc64(Sigma1(W[i-2])+W[i-7]+Sigma0(W[i-15])+W[i-16]);
-  for (j=0; j < 80; j++)
-  {
-    T1=Trunc64(H+Suma1(E)+Ch(E,F,G)+K[j]+W[j]);
-    T2=Trunc64(Suma0(A)+Maj(A,B,C));
-    H=G;
-    G=F;
-    F=E;
-    E=Trunc64(D+T1);
-    D=C;
-    C=B;
-    B=A;
-    A=Trunc64(T1+T2);
-  }
-  /*
-    Add registers back to accumulator.
-  */
-  sha_info->accumulator[0]=Trunc64(sha_info->accumulator[0]+A);
-  sha_info->accumulator[1]=Trunc64(sha_info->accumulator[1]+B);
-  sha_info->accumulator[2]=Trunc64(sha_info->accumulator[2]+C);
-  sha_info->accumulator[3]=Trunc64(sha_info->accumulator[3]+D);
-  sha_info->accumulator[4]=Trunc64(sha_info->accumulator[4]+E);
-  sha_info->accumulator[5]=Trunc64(sha_info->accumulator[5]+F);
-  sha_info->accumulator[6]=Trunc64(sha_info->accumulator[6]+G);
-  sha_info->accumulator[7]=Trunc64(sha_info->accumulator[7]+H);
-  /*
-    Reset working registers.
-  */
-  A=0;
-  B=0;
-  C=0;
-  D=0;
-  E=0;
-  F=0;
-  G=0;
-  H=0;
-  T=0;
-  T1=0;
-  T2=0;
-  (void) memset(W,0,sizeof(W));
+  return(UpdateSHA2384Bytes(sha_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
 }
 
 /*
@@ -652,18 +554,20 @@ static void TransformSHA2384(SHA2384Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   U p d a t e S H A                                                         %
+%   U p d a t e S H A 2 3 8 4 B y t e s                                       %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  UpdateSHA2384() updates the SHA2384 message accumulator.
+%  UpdateSHA2384Bytes() updates the SHA2384 message accumulator from the
+%  caller's memory.  Whole blocks are transformed directly from it; only a
+%  trailing partial block is buffered.
 %
-%  The format of the UpdateSHA2384 method is:
+%  The format of the UpdateSHA2384Bytes method is:
 %
-%      WizardBooleanType UpdateSHA2384(SHA2384Info *sha_info,
-%        const StringInfo *message)
+%      WizardBooleanType UpdateSHA2384Bytes(SHA2384Info *sha_info,
+%        const void *message,const size_t extent)
 %
 %  A description of each parameter follows:
 %
@@ -671,14 +575,22 @@ static void TransformSHA2384(SHA2384Info *sha_info)
 %
 %    o message: The message.
 %
+%    o extent: The length of the message in bytes.
+%
 */
-WizardExport WizardBooleanType UpdateSHA2384(SHA2384Info *sha_info,
-  const StringInfo *message)
+
+static inline WizardSizeType Trunc64(const WizardSizeType x)
+{
+  return((WizardSizeType) (x & WizardULLConstant(0xffffffffffffffff)));
+}
+
+WizardExport WizardBooleanType UpdateSHA2384Bytes(SHA2384Info *sha_info,
+  const void *message,const size_t extent)
 {
    size_t
     i;
 
-   unsigned char
+   const unsigned char
     *p;
 
   size_t
@@ -692,13 +604,13 @@ WizardExport WizardBooleanType UpdateSHA2384(SHA2384Info *sha_info,
   */
   assert(sha_info != (SHA2384Info *) NULL);
   assert(sha_info->signature == WizardSignature);
-  n=GetStringInfoLength(message);
+  n=extent;
   length=Trunc64(sha_info->low_order+((WizardSizeType) n << 3));
   if (length < sha_info->low_order)
     sha_info->high_order++;
   sha_info->low_order=length;
   sha_info->high_order+=(WizardSizeType) n >> 61;
-  p=GetStringInfoDatum(message);
+  p=(const unsigned char *) message;
   if (sha_info->offset != 0)
     {
       i=GetStringInfoLength(sha_info->message)-sha_info->offset;
@@ -711,15 +623,19 @@ WizardExport WizardBooleanType UpdateSHA2384(SHA2384Info *sha_info,
       sha_info->offset+=i;
       if (sha_info->offset != GetStringInfoLength(sha_info->message))
         return(WizardTrue);
-      TransformSHA2384(sha_info);
+      sha_info->transform(sha_info->accumulator,GetStringInfoDatum(
+        sha_info->message),1);
+    }
+  if (n >= SHA2384Blocksize)
+    {
+      /*
+        Transform whole blocks directly from the message.
+      */
+      i=n/SHA2384Blocksize;
+      sha_info->transform(sha_info->accumulator,p,i);
+      p+=i*SHA2384Blocksize;
+      n-=i*SHA2384Blocksize;
     }
-  while (n >= GetStringInfoLength(sha_info->message))
-  {
-    SetStringInfoDatum(sha_info->message,p);
-    p+=GetStringInfoLength(sha_info->message);
-    n-=GetStringInfoLength(sha_info->message);
-    TransformSHA2384(sha_info);
-  }
   (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,n);
   sha_info->offset=n;
   /*
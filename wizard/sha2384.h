@@ -29,6 +29,9 @@ extern WizardExport SHA2384Info
   *AcquireSHA2384Info(void),
   *DestroySHA2384Info(SHA2384Info *);
 
+extern WizardExport StringInfo
+  *ExportSHA2384State(const SHA2384Info *);
+
 extern WizardExport const StringInfo
   *GetSHA2384Digest(const SHA2384Info *);
 
@@ -37,9 +40,11 @@ extern WizardExport unsigned int
   GetSHA2384Digestsize(const SHA2384Info *);
 
 extern WizardExport WizardBooleanType
+  ImportSHA2384State(SHA2384Info *,const StringInfo *),
   InitializeSHA2384(SHA2384Info *),
   FinalizeSHA2384(SHA2384Info *),
-  UpdateSHA2384(SHA2384Info *,const StringInfo *);
+  UpdateSHA2384(SHA2384Info *,const StringInfo *),
+  UpdateSHA2384Bytes(SHA2384Info *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -0,0 +1,40 @@
+/*
+  Copyright @ 1999 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard's Toolkit private Secure Hash Algorithm 2-512 methods.
+*/
+#ifndef _WIZARDSTOOLKIT_SHA2512_PRIVATE_H
+#define _WIZARDSTOOLKIT_SHA2512_PRIVATE_H
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/*
+  A transform compresses a run of 128-byte blocks into the 8-word accumulator;
+  SHA-384 shares them with SHA-512.
+*/
+typedef void
+  (*SHA2512TransformMethod)(WizardSizeType *,const unsigned char *,
+    const size_t);
+
+extern WizardExport SHA2512TransformMethod
+  GetSHA2512Transform(void);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
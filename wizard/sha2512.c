@@ -42,8 +42,11 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/hash-private.h"
+#include "wizard/cpu-private.h"
 #include "wizard/memory_.h"
 #include "wizard/sha2512.h"
+#include "wizard/sha2512-private.h"
 /*
   Define declarations.
 */
@@ -74,6 +77,9 @@ struct _SHA2512Info
   WizardBooleanType
     lsb_first;
 
+  SHA2512TransformMethod
+    transform;
+
   time_t
     timestamp;
 
@@ -85,7 +91,10 @@ struct _SHA2512Info
   Forward declarations.
 */
 static void
-  TransformSHA2512(SHA2512Info *);
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  TransformSHA2512AVX2(WizardSizeType *,const unsigned char *,const size_t),
+#endif
+  TransformSHA2512(WizardSizeType *,const unsigned char *,const size_t);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -128,6 +137,7 @@ WizardExport SHA2512Info *AcquireSHA2512Info(void)
   lsb_first=1;
   sha_info->lsb_first=(int)
     (*(char *) &lsb_first) == 1 ? WizardTrue : WizardFalse;
+  sha_info->transform=GetSHA2512Transform();
   sha_info->timestamp=time((time_t *) NULL);
   sha_info->signature=WizardSignature;
   (void) InitializeSHA2512(sha_info);
@@ -178,6 +188,55 @@ WizardExport SHA2512Info *DestroySHA2512Info(SHA2512Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t S H A 2 5 1 2 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportSHA2512State() returns the in-progress SHA2512 state as a byte string
+%  holding the accumulator, the message length, and the buffered partial
+%  block.  ImportSHA2512State() resumes from it.
+%
+%  The format of the ExportSHA2512State method is:
+%
+%      StringInfo *ExportSHA2512State(const SHA2512Info *sha_info)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2512Info.
+%
+*/
+WizardExport StringInfo *ExportSHA2512State(const SHA2512Info *sha_info)
+{
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(sha_info != (SHA2512Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  state=AcquireStringInfo(8*8+2*8+4+sha_info->offset);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    ExportHashWord(&q,sha_info->accumulator[i],8);
+  ExportHashWord(&q,sha_info->low_order,8);
+  ExportHashWord(&q,sha_info->high_order,8);
+  ExportHashWord(&q,sha_info->offset,4);
+  (void) CopyWizardMemory(q,GetStringInfoDatum(sha_info->message),
+    sha_info->offset);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e S H A                                                     %
 %                                                                             %
 %                                                                             %
@@ -234,7 +293,7 @@ WizardExport WizardBooleanType FinalizeSHA2512(SHA2512Info *sha_info)
     {
       (void) memset(datum+count,0,(size_t) (GetStringInfoLength(
         sha_info->message)-count));
-      TransformSHA2512(sha_info);
+      sha_info->transform(sha_info->accumulator,datum,1);
       (void) memset(datum,0,GetStringInfoLength(sha_info->message)-
         16);
     }
@@ -254,7 +313,7 @@ WizardExport WizardBooleanType FinalizeSHA2512(SHA2512Info *sha_info)
   datum[125]=(unsigned char) (low_order >> 16);
   datum[126]=(unsigned char) (low_order >> 8);
   datum[127]=(unsigned char) low_order;
-  TransformSHA2512(sha_info);
+  sha_info->transform(sha_info->accumulator,datum,1);
   p=sha_info->accumulator;
   q=GetStringInfoDatum(sha_info->digest);
   for (i=0; i < (SHA2512Digestsize/8); i++)
@@ -373,6 +432,93 @@ WizardExport unsigned int GetSHA2512Digestsize(const SHA2512Info *sha2512_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   G e t S H A 5 1 2 T r a n s f o r m                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetSHA2512Transform() returns the fastest SHA2512 block transform this
+%  processor supports.
+%
+%  The format of the GetSHA2512Transform method is:
+%
+%      SHA2512TransformMethod GetSHA2512Transform(void)
+%
+*/
+WizardExport SHA2512TransformMethod GetSHA2512Transform(void)
+{
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+  if (HasCPUFeature(AVX2CPUFeature) != WizardFalse)
+    return(TransformSHA2512AVX2);
+#endif
+  return(TransformSHA2512);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t S H A 2 5 1 2 S t a t e                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportSHA2512State() restores a state returned by ExportSHA2512State().  A
+%  malformed state is rejected with WizardFalse and the SHA2512 state is left
+%  as it was.
+%
+%  The format of the ImportSHA2512State method is:
+%
+%      WizardBooleanType ImportSHA2512State(SHA2512Info *sha_info,
+%        const StringInfo *state)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2512Info.
+%
+%    o state: The exported state.
+%
+*/
+WizardExport WizardBooleanType ImportSHA2512State(SHA2512Info *sha_info,
+  const StringInfo *state)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    offset;
+
+  ssize_t
+    i;
+
+  assert(sha_info != (SHA2512Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  if (GetStringInfoLength(state) < (8*8+2*8+4))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+8*8+2*8;
+  offset=(size_t) ImportHashWord(&p,4);
+  if ((offset >= SHA2512Blocksize) ||
+      (GetStringInfoLength(state) != (8*8+2*8+4+offset)))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < 8; i++)
+    sha_info->accumulator[i]=ImportHashWord(&p,8);
+  sha_info->low_order=ImportHashWord(&p,8);
+  sha_info->high_order=ImportHashWord(&p,8);
+  sha_info->offset=offset;
+  p+=4;
+  (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,offset);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   I n i t i a l i z e S H A                                                 %
 %                                                                             %
 %                                                                             %
@@ -420,18 +566,115 @@ WizardExport WizardBooleanType InitializeSHA2512(SHA2512Info *sha_info)
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  TransformSHA2512() transforms the SHA2512 message accumulator.
+%  TransformSHA2512() transforms the SHA2512 message accumulator.  A run of
+%  blocks is transformed in one call, with an AVX2 message schedule feeding
+%  scalar rounds where the processor has it.
 %
 %  The format of the TransformSHA2512 method is:
 %
-%      TransformSHA2512(SHA2512Info *sha_info)
+%      void TransformSHA2512(WizardSizeType *accumulator,
+%        const unsigned char *message,const size_t blocks)
 %
 %  A description of each parameter follows:
 %
-%    o sha_info: The address of a structure of type SHA2512Info.
+%    o accumulator: the SHA2512 message accumulator.
+%
+%    o message: the message blocks.
+%
+%    o blocks: the number of 128-byte blocks.
 %
 */
 
+#define Sigma0(x)  (RotateRight(x,1) ^ RotateRight(x,8) ^ Trunc64((x) >> 7))
+#define Sigma1(x)  (RotateRight(x,19) ^ RotateRight(x,61) ^ Trunc64((x) >> 6))
+#define Suma0(x)  (RotateRight(x,28) ^ RotateRight(x,34) ^ RotateRight(x,39))
+#define Suma1(x)  (RotateRight(x,14) ^ RotateRight(x,18) ^ RotateRight(x,41))
+
+static const WizardSizeType
+  K[80] =
+  {
+    WizardULLConstant(0x428a2f98d728ae22),
+    WizardULLConstant(0x7137449123ef65cd),
+    WizardULLConstant(0xb5c0fbcfec4d3b2f),
+    WizardULLConstant(0xe9b5dba58189dbbc),
+    WizardULLConstant(0x3956c25bf348b538),
+    WizardULLConstant(0x59f111f1b605d019),
+    WizardULLConstant(0x923f82a4af194f9b),
+    WizardULLConstant(0xab1c5ed5da6d8118),
+    WizardULLConstant(0xd807aa98a3030242),
+    WizardULLConstant(0x12835b0145706fbe),
+    WizardULLConstant(0x243185be4ee4b28c),
+    WizardULLConstant(0x550c7dc3d5ffb4e2),
+    WizardULLConstant(0x72be5d74f27b896f),
+    WizardULLConstant(0x80deb1fe3b1696b1),
+    WizardULLConstant(0x9bdc06a725c71235),
+    WizardULLConstant(0xc19bf174cf692694),
+    WizardULLConstant(0xe49b69c19ef14ad2),
+    WizardULLConstant(0xefbe4786384f25e3),
+    WizardULLConstant(0x0fc19dc68b8cd5b5),
+    WizardULLConstant(0x240ca1cc77ac9c65),
+    WizardULLConstant(0x2de92c6f592b0275),
+    WizardULLConstant(0x4a7484aa6ea6e483),
+    WizardULLConstant(0x5cb0a9dcbd41fbd4),
+    WizardULLConstant(0x76f988da831153b5),
+    WizardULLConstant(0x983e5152ee66dfab),
+    WizardULLConstant(0xa831c66d2db43210),
+    WizardULLConstant(0xb00327c898fb213f),
+    WizardULLConstant(0xbf597fc7beef0ee4),
+    WizardULLConstant(0xc6e00bf33da88fc2),
+    WizardULLConstant(0xd5a79147930aa725),
+    WizardULLConstant(0x06ca6351e003826f),
+    WizardULLConstant(0x142929670a0e6e70),
+    WizardULLConstant(0x27b70a8546d22ffc),
+    WizardULLConstant(0x2e1b21385c26c926),
+    WizardULLConstant(0x4d2c6dfc5ac42aed),
+    WizardULLConstant(0x53380d139d95b3df),
+    WizardULLConstant(0x650a73548baf63de),
+    WizardULLConstant(0x766a0abb3c77b2a8),
+    WizardULLConstant(0x81c2c92e47edaee6),
+    WizardULLConstant(0x92722c851482353b),
+    WizardULLConstant(0xa2bfe8a14cf10364),
+    WizardULLConstant(0xa81a664bbc423001),
+    WizardULLConstant(0xc24b8b70d0f89791),
+    WizardULLConstant(0xc76c51a30654be30),
+    WizardULLConstant(0xd192e819d6ef5218),
+    WizardULLConstant(0xd69906245565a910),
+    WizardULLConstant(0xf40e35855771202a),
+    WizardULLConstant(0x106aa07032bbd1b8),
+    WizardULLConstant(0x19a4c116b8d2d0c8),
+    WizardULLConstant(0x1e376c085141ab53),
+    WizardULLConstant(0x2748774cdf8eeb99),
+    WizardULLConstant(0x34b0bcb5e19b48a8),
+    WizardULLConstant(0x391c0cb3c5c95a63),
+    WizardULLConstant(0x4ed8aa4ae3418acb),
+    WizardULLConstant(0x5b9cca4f7763e373),
+    WizardULLConstant(0x682e6ff3d6b2b8a3),
+    WizardULLConstant(0x748f82ee5defb2fc),
+    WizardULLConstant(0x78a5636f43172f60),
+    WizardULLConstant(0x84c87814a1f0ab72),
+    WizardULLConstant(0x8cc702081a6439ec),
+    WizardULLConstant(0x90befffa23631e28),
+    WizardULLConstant(0xa4506cebde82bde9),
+    WizardULLConstant(0xbef9a3f7b2c67915),
+    WizardULLConstant(0xc67178f2e372532b),
+    WizardULLConstant(0xca273eceea26619c),
+    WizardULLConstant(0xd186b8c721c0c207),
+    WizardULLConstant(0xeada7dd6cde0eb1e),
+    WizardULLConstant(0xf57d4f7fee6ed178),
+    WizardULLConstant(0x06f067aa72176fba),
+    WizardULLConstant(0x0a637dc5a2c898a6),
+    WizardULLConstant(0x113f9804bef90dae),
+    WizardULLConstant(0x1b710b35131c471b),
+    WizardULLConstant(0x28db77f523047d84),
+    WizardULLConstant(0x32caab7b40c72493),
+    WizardULLConstant(0x3c9ebe0a15c9bebc),
+    WizardULLConstant(0x431d67c49c100d4c),
+    WizardULLConstant(0x4cc5d4becb3e42b6),
+    WizardULLConstant(0x597f299cfc657e2a),
+    WizardULLConstant(0x5fcb6fab3ad6faec),
+    WizardULLConstant(0x6c44198c4a475817)
+  };  /* 64-bit fractional part of the cube root of the first 80 primes */
+
 static inline WizardSizeType Ch(const WizardSizeType x,const WizardSizeType y,
   const WizardSizeType z)
 {
@@ -455,107 +698,12 @@ static inline WizardSizeType RotateRight(const WizardSizeType x,
   return(Trunc64((x >> n) | (x << (64-n))));
 }
 
-static void TransformSHA2512(SHA2512Info *sha_info)
+static inline void RoundsSHA2512(WizardSizeType *accumulator,
+  const WizardSizeType *W)
 {
-#define Sigma0(x)  (RotateRight(x,1) ^ RotateRight(x,8) ^ Trunc64((x) >> 7))
-#define Sigma1(x)  (RotateRight(x,19) ^ RotateRight(x,61) ^ Trunc64((x) >> 6))
-#define Suma0(x)  (RotateRight(x,28) ^ RotateRight(x,34) ^ RotateRight(x,39))
-#define Suma1(x)  (RotateRight(x,14) ^ RotateRight(x,18) ^ RotateRight(x,41))
-
   ssize_t
     j;
 
-   ssize_t
-    i;
-
-   unsigned char
-    *p;
-
-  static WizardSizeType
-    K[80] =
-    {
-      WizardULLConstant(0x428a2f98d728ae22),
-      WizardULLConstant(0x7137449123ef65cd),
-      WizardULLConstant(0xb5c0fbcfec4d3b2f),
-      WizardULLConstant(0xe9b5dba58189dbbc),
-      WizardULLConstant(0x3956c25bf348b538),
-      WizardULLConstant(0x59f111f1b605d019),
-      WizardULLConstant(0x923f82a4af194f9b),
-      WizardULLConstant(0xab1c5ed5da6d8118),
-      WizardULLConstant(0xd807aa98a3030242),
-      WizardULLConstant(0x12835b0145706fbe),
-      WizardULLConstant(0x243185be4ee4b28c),
-      WizardULLConstant(0x550c7dc3d5ffb4e2),
-      WizardULLConstant(0x72be5d74f27b896f),
-      WizardULLConstant(0x80deb1fe3b1696b1),
-      WizardULLConstant(0x9bdc06a725c71235),
-      WizardULLConstant(0xc19bf174cf692694),
-      WizardULLConstant(0xe49b69c19ef14ad2),
-      WizardULLConstant(0xefbe4786384f25e3),
-      WizardULLConstant(0x0fc19dc68b8cd5b5),
-      WizardULLConstant(0x240ca1cc77ac9c65),
-      WizardULLConstant(0x2de92c6f592b0275),
-      WizardULLConstant(0x4a7484aa6ea6e483),
-      WizardULLConstant(0x5cb0a9dcbd41fbd4),
-      WizardULLConstant(0x76f988da831153b5),
-      WizardULLConstant(0x983e5152ee66dfab),
-      WizardULLConstant(0xa831c66d2db43210),
-      WizardULLConstant(0xb00327c898fb213f),
-      WizardULLConstant(0xbf597fc7beef0ee4),
-      WizardULLConstant(0xc6e00bf33da88fc2),
-      WizardULLConstant(0xd5a79147930aa725),
-      WizardULLConstant(0x06ca6351e003826f),
-      WizardULLConstant(0x142929670a0e6e70),
-      WizardULLConstant(0x27b70a8546d22ffc),
-      WizardULLConstant(0x2e1b21385c26c926),
-      WizardULLConstant(0x4d2c6dfc5ac42aed),
-      WizardULLConstant(0x53380d139d95b3df),
-      WizardULLConstant(0x650a73548baf63de),
-      WizardULLConstant(0x766a0abb3c77b2a8),
-      WizardULLConstant(0x81c2c92e47edaee6),
-      WizardULLConstant(0x92722c851482353b),
-      WizardULLConstant(0xa2bfe8a14cf10364),
-      WizardULLConstant(0xa81a664bbc423001),
-      WizardULLConstant(0xc24b8b70d0f89791),
-      WizardULLConstant(0xc76c51a30654be30),
-      WizardULLConstant(0xd192e819d6ef5218),
-      WizardULLConstant(0xd69906245565a910),
-      WizardULLConstant(0xf40e35855771202a),
-      WizardULLConstant(0x106aa07032bbd1b8),
-      WizardULLConstant(0x19a4c116b8d2d0c8),
-      WizardULLConstant(0x1e376c085141ab53),
-      WizardULLConstant(0x2748774cdf8eeb99),
-      WizardULLConstant(0x34b0bcb5e19b48a8),
-      WizardULLConstant(0x391c0cb3c5c95a63),
-      WizardULLConstant(0x4ed8aa4ae3418acb),
-      WizardULLConstant(0x5b9cca4f7763e373),
-      WizardULLConstant(0x682e6ff3d6b2b8a3),
-      WizardULLConstant(0x748f82ee5defb2fc),
-      WizardULLConstant(0x78a5636f43172f60),
-      WizardULLConstant(0x84c87814a1f0ab72),
-      WizardULLConstant(0x8cc702081a6439ec),
-      WizardULLConstant(0x90befffa23631e28),
-      WizardULLConstant(0xa4506cebde82bde9),
-      WizardULLConstant(0xbef9a3f7b2c67915),
-      WizardULLConstant(0xc67178f2e372532b),
-      WizardULLConstant(0xca273eceea26619c),
-      WizardULLConstant(0xd186b8c721c0c207),
-      WizardULLConstant(0xeada7dd6cde0eb1e),
-      WizardULLConstant(0xf57d4f7fee6ed178),
-      WizardULLConstant(0x06f067aa72176fba),
-      WizardULLConstant(0x0a637dc5a2c898a6),
-      WizardULLConstant(0x113f9804bef90dae),
-      WizardULLConstant(0x1b710b35131c471b),
-      WizardULLConstant(0x28db77f523047d84),
-      WizardULLConstant(0x32caab7b40c72493),
-      WizardULLConstant(0x3c9ebe0a15c9bebc),
-      WizardULLConstant(0x431d67c49c100d4c),
-      WizardULLConstant(0x4cc5d4becb3e42b6),
-      WizardULLConstant(0x597f299cfc657e2a),
-      WizardULLConstant(0x5fcb6fab3ad6faec),
-      WizardULLConstant(0x6c44198c4a475817)
-    };  /* 64-bit fractional part of the cube root of the first 64 primes */
-
   WizardSizeType
     A,
     B,
@@ -565,50 +713,23 @@ static void TransformSHA2512(SHA2512Info *sha_info)
     F,
     G,
     H,
-    T,
     T1,
-    T2,
-    W[80];
+    T2;
 
-  p=GetStringInfoDatum(sha_info->message);
-  if (sha_info->lsb_first == WizardFalse)
-    for (i=0; i < 16; i++)
-    {
-      T=(*((WizardSizeType *) p));
-      p+=8;
-      W[i]=(T);
-    }
-  else
-    for (i=0; i < 16; i++)
-    {
-      T=(*((WizardSizeType *) p));
-      p+=8;
-      W[i]=(WizardSizeType)
-        (((T << 56) & WizardULLConstant(0xff00000000000000)) |
-         ((T << 40) & WizardULLConstant(0x00ff000000000000)) |
-         ((T << 24) & WizardULLConstant(0x0000ff0000000000)) |
-         ((T <<  8) & WizardULLConstant(0x000000ff00000000)) |
-         ((T >>  8) & WizardULLConstant(0x00000000ff000000)) |
-         ((T >> 24) & WizardULLConstant(0x0000000000ff0000)) |
-         ((T >> 40) & WizardULLConstant(0x000000000000ff00)) |
-         ((T >> 56) & WizardULLConstant(0x00000000000000ff)));
-    }
   /*
-    Copy accumulator to registers.
+    Copy accumulator to registers, W holds the message schedule plus K.
   */
-  A=sha_info->accumulator[0];
-  B=sha_info->accumulator[1];
-  C=sha_info->accumulator[2];
-  D=sha_info->accumulator[3];
-  E=sha_info->accumulator[4];
-  F=sha_info->accumulator[5];
-  G=sha_info->accumulator[6];
-  H=sha_info->accumulator[7];
-  for (i=16; i < 80; i++)
-    W[i]=Trunc64(Sigma1(W[i-2])+W[i-7]+Sigma0(W[i-15])+W[i-16]);
+  A=accumulator[0];
+  B=accumulator[1];
+  C=accumulator[2];
+  D=accumulator[3];
+  E=accumulator[4];
+  F=accumulator[5];
+  G=accumulator[6];
+  H=accumulator[7];
   for (j=0; j < 80; j++)
   {
-    T1=Trunc64(H+Suma1(E)+Ch(E,F,G)+K[j]+W[j]);
+    T1=Trunc64(H+Suma1(E)+Ch(E,F,G)+W[j]);
     T2=Trunc64(Suma0(A)+Maj(A,B,C));
     H=G;
     G=F;
@@ -622,14 +743,14 @@ static void TransformSHA2512(SHA2512Info *sha_info)
   /*
     Add registers back to accumulator.
   */
-  sha_info->accumulator[0]=Trunc64(sha_info->accumulator[0]+A);
-  sha_info->accumulator[1]=Trunc64(sha_info->accumulator[1]+B);
-  sha_info->accumulator[2]=Trunc64(sha_info->accumulator[2]+C);
-  sha_info->accumulator[3]=Trunc64(sha_info->accumulator[3]+D);
-  sha_info->accumulator[4]=Trunc64(sha_info->accumulator[4]+E);
-  sha_info->accumulator[5]=Trunc64(sha_info->accumulator[5]+F);
-  sha_info->accumulator[6]=Trunc64(sha_info->accumulator[6]+G);
-  sha_info->accumulator[7]=Trunc64(sha_info->accumulator[7]+H);
+  accumulator[0]=Trunc64(accumulator[0]+A);
+  accumulator[1]=Trunc64(accumulator[1]+B);
+  accumulator[2]=Trunc64(accumulator[2]+C);
+  accumulator[3]=Trunc64(accumulator[3]+D);
+  accumulator[4]=Trunc64(accumulator[4]+E);
+  accumulator[5]=Trunc64(accumulator[5]+F);
+  accumulator[6]=Trunc64(accumulator[6]+G);
+  accumulator[7]=Trunc64(accumulator[7]+H);
   /*
     Reset working registers.
   */
@@ -641,11 +762,122 @@ static void TransformSHA2512(SHA2512Info *sha_info)
   F=0;
   G=0;
   H=0;
-  T=0;
   T1=0;
   T2=0;
+}
+
+#if defined(WIZARDSTOOLKIT_HAVE_X86_SIMD)
+static inline WizardTarget("avx2") __m256i Sigma0AVX2(const __m256i x)
+{
+  return(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(
+    _mm256_srli_epi64(x,1),_mm256_slli_epi64(x,63)),_mm256_xor_si256(
+    _mm256_srli_epi64(x,8),_mm256_slli_epi64(x,56))),_mm256_srli_epi64(x,7)));
+}
+
+static inline WizardTarget("avx2") __m256i Sigma1AVX2(const __m256i x)
+{
+  return(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(
+    _mm256_srli_epi64(x,19),_mm256_slli_epi64(x,45)),_mm256_xor_si256(
+    _mm256_srli_epi64(x,61),_mm256_slli_epi64(x,3))),_mm256_srli_epi64(x,6)));
+}
+
+static WizardTarget("avx2") void TransformSHA2512AVX2(
+  WizardSizeType *accumulator,const unsigned char *message,const size_t blocks)
+{
+  const unsigned char
+    *p;
+
+  __m256i
+    k,
+    mask,
+    X[8];
+
+  size_t
+    i,
+    j;
+
+  WizardSizeType
+    W[2][80];
+
+  /*
+    Schedule two blocks at once, one in each 128-bit lane; X[i & 7] holds
+    schedule words 2i and 2i+1.
+  */
+  mask=_mm256_broadcastsi128_si256(_mm_set_epi64x(0x08090a0b0c0d0e0fULL,
+    0x0001020304050607ULL));
+  p=message;
+  for (j=0; (j+2) <= blocks; j+=2)
+  {
+    for (i=0; i < 40; i++)
+    {
+      if (i < 8)
+        X[i]=_mm256_shuffle_epi8(_mm256_inserti128_si256(
+          _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) (p+16*i))),
+          _mm_loadu_si128((const __m128i *) (p+128+16*i)),1),mask);
+      else
+        X[i & 0x07]=_mm256_add_epi64(_mm256_add_epi64(X[i & 0x07],Sigma0AVX2(
+          _mm256_alignr_epi8(X[(i+1) & 0x07],X[i & 0x07],8))),
+          _mm256_add_epi64(_mm256_alignr_epi8(X[(i+5) & 0x07],
+          X[(i+4) & 0x07],8),Sigma1AVX2(X[(i+7) & 0x07])));
+      k=_mm256_add_epi64(X[i & 0x07],_mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) (K+2*i))));
+      _mm_storeu_si128((__m128i *) (W[0]+2*i),_mm256_castsi256_si128(k));
+      _mm_storeu_si128((__m128i *) (W[1]+2*i),_mm256_extracti128_si256(k,1));
+    }
+    RoundsSHA2512(accumulator,W[0]);
+    RoundsSHA2512(accumulator,W[1]);
+    p+=256;
+  }
+  if (j < blocks)
+    TransformSHA2512(accumulator,p,blocks-j);
+  /*
+    Reset working registers.
+  */
+  for (i=0; i < 8; i++)
+    X[i]=_mm256_setzero_si256();
+  k=_mm256_setzero_si256();
   (void) memset(W,0,sizeof(W));
 }
+#endif
+
+static void TransformSHA2512(WizardSizeType *accumulator,
+  const unsigned char *message,const size_t blocks)
+{
+  const unsigned char
+    *p;
+
+  size_t
+    j;
+
+  ssize_t
+    i;
+
+  WizardSizeType
+    W[80];
+
+  p=message;
+  for (j=0; j < blocks; j++)
+  {
+    for (i=0; i < 16; i++)
+    {
+      W[i]=((WizardSizeType) p[0] << 56) | ((WizardSizeType) p[1] << 48) |
+        ((WizardSizeType) p[2] << 40) | ((WizardSizeType) p[3] << 32) |
+        ((WizardSizeType) p[4] << 24) | ((WizardSizeType) p[5] << 16) |
+        ((WizardSizeType) p[6] << 8) | (WizardSizeType) p[7];
+      p+=8;
+    }
+    for (i=16; i < 80; i++)
+      W[i]=Trunc64(Sigma1(W[i-2])+W[i-7]+Sigma0(W[i-15])+W[i-16]);
+    for (i=0; i < 80; i++)
+      W[i]=Trunc64(W[i]+K[i]);
+    RoundsSHA2512(accumulator,W);
+  }
+  /*
+    Reset working registers.
+  */
+  (void) memset(W,0,sizeof(W));
+}
+
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -674,11 +906,47 @@ static void TransformSHA2512(SHA2512Info *sha_info)
 */
 WizardExport WizardBooleanType UpdateSHA2512(SHA2512Info *sha_info,
   const StringInfo *message)
+{
+  return(UpdateSHA2512Bytes(sha_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e S H A 2 5 1 2 B y t e s                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateSHA2512Bytes() updates the SHA2512 message accumulator from the
+%  caller's memory.  Whole blocks are transformed directly from it; only a
+%  trailing partial block is buffered.
+%
+%  The format of the UpdateSHA2512Bytes method is:
+%
+%      WizardBooleanType UpdateSHA2512Bytes(SHA2512Info *sha_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA2512Info.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
+WizardExport WizardBooleanType UpdateSHA2512Bytes(SHA2512Info *sha_info,
+  const void *message,const size_t extent)
 {
    size_t
     i;
 
-   unsigned char
+   const unsigned char
     *p;
 
   size_t
@@ -692,13 +960,13 @@ WizardExport WizardBooleanType UpdateSHA2512(SHA2512Info *sha_info,
   */
   assert(sha_info != (SHA2512Info *) NULL);
   assert(sha_info->signature == WizardSignature);
-  n=GetStringInfoLength(message);
+  n=extent;
   length=Trunc64(sha_info->low_order+((WizardSizeType) n << 3));
   if (length < sha_info->low_order)
     sha_info->high_order++;
   sha_info->low_order=length;
   sha_info->high_order+=(WizardSizeType) n >> 61;
-  p=GetStringInfoDatum(message);
+  p=(const unsigned char *) message;
   if (sha_info->offset != 0)
     {
       i=GetStringInfoLength(sha_info->message)-sha_info->offset;
@@ -711,15 +979,19 @@ WizardExport WizardBooleanType UpdateSHA2512(SHA2512Info *sha_info,
       sha_info->offset+=i;
       if (sha_info->offset != GetStringInfoLength(sha_info->message))
         return(WizardTrue);
-      TransformSHA2512(sha_info);
+      sha_info->transform(sha_info->accumulator,GetStringInfoDatum(
+        sha_info->message),1);
+    }
+  if (n >= SHA2512Blocksize)
+    {
+      /*
+        Transform whole blocks directly from the message.
+      */
+      i=n/SHA2512Blocksize;
+      sha_info->transform(sha_info->accumulator,p,i);
+      p+=i*SHA2512Blocksize;
+      n-=i*SHA2512Blocksize;
     }
-  while (n >= GetStringInfoLength(sha_info->message))
-  {
-    SetStringInfoDatum(sha_info->message,p);
-    p+=GetStringInfoLength(sha_info->message);
-    n-=GetStringInfoLength(sha_info->message);
-    TransformSHA2512(sha_info);
-  }
   (void) CopyWizardMemory(GetStringInfoDatum(sha_info->message),p,n);
   sha_info->offset=n;
   /*
@@ -29,6 +29,9 @@ extern WizardExport SHA2512Info
   *AcquireSHA2512Info(void),
   *DestroySHA2512Info(SHA2512Info *);
 
+extern WizardExport StringInfo
+  *ExportSHA2512State(const SHA2512Info *);
+
 extern WizardExport const StringInfo
   *GetSHA2512Digest(const SHA2512Info *);
 
@@ -37,9 +40,11 @@ extern WizardExport unsigned int
   GetSHA2512Digestsize(const SHA2512Info *);
 
 extern WizardExport WizardBooleanType
+  ImportSHA2512State(SHA2512Info *,const StringInfo *),
   InitializeSHA2512(SHA2512Info *),
   FinalizeSHA2512(SHA2512Info *),
-  UpdateSHA2512(SHA2512Info *,const StringInfo *);
+  UpdateSHA2512(SHA2512Info *,const StringInfo *),
+  UpdateSHA2512Bytes(SHA2512Info *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
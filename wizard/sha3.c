@@ -44,6 +44,7 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/hash-private.h"
 #include "wizard/memory_.h"
 #include "wizard/sha3.h"
 
@@ -52,7 +53,6 @@
 */
 #define SHA3Blocksize  64
 #define SHA3Digestsize  64
-#define SHA3Index(x,y)  (((x) % 5)+5*((y) % 5))
 #define SHA3Lanes  25
 #define SHA3MaximumRate  1536
 #define SHA3PermutationSize  1600
@@ -75,8 +75,10 @@ struct _SHA3Info
   StringInfo
     *digest;
 
+  WizardSizeType
+    state[SHA3Lanes];
+
   unsigned char
-    state[SHA3PermutationSize/8],
     message[SHA3MaximumRate/8];
 
   unsigned int
@@ -91,11 +93,7 @@ struct _SHA3Info
     squeeze;
 
   unsigned int
-    squeeze_bits,
-    rho[SHA3Lanes];
-
-  WizardSizeType
-    rounds[SHA3Rounds];
+    squeeze_bits;
 
   WizardBooleanType
     lsb_first;
@@ -222,6 +220,55 @@ WizardExport SHA3Info *DestroySHA3Info(SHA3Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   E x p o r t S H A 3 S t a t e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportSHA3State() returns the in-progress SHA3 sponge as a byte string:
+%  the 1600-bit state, the capacity, and the queued bytes.  Resume it with
+%  ImportSHA3State().
+%
+%  The format of the ExportSHA3State method is:
+%
+%      StringInfo *ExportSHA3State(const SHA3Info *sha_info)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA3Info.
+%
+*/
+WizardExport StringInfo *ExportSHA3State(const SHA3Info *sha_info)
+{
+  ssize_t
+    i;
+
+  StringInfo
+    *state;
+
+  unsigned char
+    *q;
+
+  assert(sha_info != (SHA3Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  state=AcquireStringInfo(8*SHA3Lanes+13+sha_info->rate/8);
+  q=GetStringInfoDatum(state);
+  for (i=0; i < SHA3Lanes; i++)
+    ExportHashWord(&q,sha_info->state[i],8);
+  ExportHashWord(&q,sha_info->capacity,4);
+  ExportHashWord(&q,sha_info->bits_in_queue,4);
+  ExportHashWord(&q,sha_info->squeeze_bits,4);
+  ExportHashWord(&q,sha_info->squeeze != WizardFalse ? 1 : 0,1);
+  (void) CopyWizardMemory(q,sha_info->message,sha_info->rate/8);
+  return(state);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   F i n a l i z e S H A                                                     %
 %                                                                             %
 %                                                                             %
@@ -240,172 +287,330 @@ WizardExport SHA3Info *DestroySHA3Info(SHA3Info *sha_info)
 %
 */
 
-static inline void ConvertBytesToWords(const unsigned char *bytes,
-  WizardSizeType *words)
-{
-   ssize_t
-    i;
+/*
+  Each Keccak-f[1600] round is unrolled over the 25 lanes held in registers,
+  with the round constants known at compile time.  Rounds alternate between
+  the A and E lane sets so no copy is needed.  Lanes be, bi, go, ki, mi, and sa
+  are stored complemented so that chi needs only one NOT per plane, not five.
+*/
+#define SHA3Round(A,E,i) \
+{ \
+  Ca=A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+  Ce=A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+  Ci=A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+  Co=A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+  Cu=A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+  Da=Cu ^ SHA3RotateLeft(Ce,1); \
+  De=Ca ^ SHA3RotateLeft(Ci,1); \
+  Di=Ce ^ SHA3RotateLeft(Co,1); \
+  Do=Ci ^ SHA3RotateLeft(Cu,1); \
+  Du=Co ^ SHA3RotateLeft(Ca,1); \
+  Ba=A##ba ^ Da; \
+  Be=SHA3RotateLeft(A##ge ^ De,44); \
+  Bi=SHA3RotateLeft(A##ki ^ Di,43); \
+  Bo=SHA3RotateLeft(A##mo ^ Do,21); \
+  Bu=SHA3RotateLeft(A##su ^ Du,14); \
+  E##ba=Ba ^ (Be | Bi) ^ RoundConstants[i]; \
+  E##be=Be ^ ((~Bi) | Bo); \
+  E##bi=Bi ^ (Bo & Bu); \
+  E##bo=Bo ^ (Bu | Ba); \
+  E##bu=Bu ^ (Ba & Be); \
+  Ba=SHA3RotateLeft(A##bo ^ Do,28); \
+  Be=SHA3RotateLeft(A##gu ^ Du,20); \
+  Bi=SHA3RotateLeft(A##ka ^ Da,3); \
+  Bo=SHA3RotateLeft(A##me ^ De,45); \
+  Bu=SHA3RotateLeft(A##si ^ Di,61); \
+  E##ga=Ba ^ (Be | Bi); \
+  E##ge=Be ^ (Bi & Bo); \
+  E##gi=Bi ^ (Bo | (~Bu)); \
+  E##go=Bo ^ (Bu | Ba); \
+  E##gu=Bu ^ (Ba & Be); \
+  Ba=SHA3RotateLeft(A##be ^ De,1); \
+  Be=SHA3RotateLeft(A##gi ^ Di,6); \
+  Bi=SHA3RotateLeft(A##ko ^ Do,25); \
+  Bo=SHA3RotateLeft(A##mu ^ Du,8); \
+  Bu=SHA3RotateLeft(A##sa ^ Da,18); \
+  E##ka=Ba ^ (Be | Bi); \
+  E##ke=Be ^ (Bi & Bo); \
+  E##ki=Bi ^ ((~Bo) & Bu); \
+  E##ko=(~Bo) ^ (Bu | Ba); \
+  E##ku=Bu ^ (Ba & Be); \
+  Ba=SHA3RotateLeft(A##bu ^ Du,27); \
+  Be=SHA3RotateLeft(A##ga ^ Da,36); \
+  Bi=SHA3RotateLeft(A##ke ^ De,10); \
+  Bo=SHA3RotateLeft(A##mi ^ Di,15); \
+  Bu=SHA3RotateLeft(A##so ^ Do,56); \
+  E##ma=Ba ^ (Be & Bi); \
+  E##me=Be ^ (Bi | Bo); \
+  E##mi=Bi ^ ((~Bo) | Bu); \
+  E##mo=(~Bo) ^ (Bu & Ba); \
+  E##mu=Bu ^ (Ba | Be); \
+  Ba=SHA3RotateLeft(A##bi ^ Di,62); \
+  Be=SHA3RotateLeft(A##go ^ Do,55); \
+  Bi=SHA3RotateLeft(A##ku ^ Du,39); \
+  Bo=SHA3RotateLeft(A##ma ^ Da,41); \
+  Bu=SHA3RotateLeft(A##se ^ De,2); \
+  E##sa=Ba ^ ((~Be) & Bi); \
+  E##se=(~Be) ^ (Bi | Bo); \
+  E##si=Bi ^ (Bo & Bu); \
+  E##so=Bo ^ (Bu | Ba); \
+  E##su=Bu ^ (Ba & Be); \
+}
 
-  for (i=0; i < (SHA3PermutationSize/64); i++)
+static const WizardSizeType
+  ComplementMask[SHA3Lanes] =
+  {
+    WizardULLConstant(0),
+    ~WizardULLConstant(0),
+    ~WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    ~WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    ~WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    ~WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    ~WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0),
+    WizardULLConstant(0)
+  },
+  RoundConstants[SHA3Rounds] =
   {
-     ssize_t
-      j;
+    WizardULLConstant(0x0000000000000001),
+    WizardULLConstant(0x0000000000008082),
+    WizardULLConstant(0x800000000000808a),
+    WizardULLConstant(0x8000000080008000),
+    WizardULLConstant(0x000000000000808b),
+    WizardULLConstant(0x0000000080000001),
+    WizardULLConstant(0x8000000080008081),
+    WizardULLConstant(0x8000000000008009),
+    WizardULLConstant(0x000000000000008a),
+    WizardULLConstant(0x0000000000000088),
+    WizardULLConstant(0x0000000080008009),
+    WizardULLConstant(0x000000008000000a),
+    WizardULLConstant(0x000000008000808b),
+    WizardULLConstant(0x800000000000008b),
+    WizardULLConstant(0x8000000000008089),
+    WizardULLConstant(0x8000000000008003),
+    WizardULLConstant(0x8000000000008002),
+    WizardULLConstant(0x8000000000000080),
+    WizardULLConstant(0x000000000000800a),
+    WizardULLConstant(0x800000008000000a),
+    WizardULLConstant(0x8000000080008081),
+    WizardULLConstant(0x8000000000008080),
+    WizardULLConstant(0x0000000080000001),
+    WizardULLConstant(0x8000000080008008)
+  };
 
-    words[i]=0;
-    for (j=0; j< (64/8); j++)
-      words[i]|=(WizardSizeType) (bytes[i*(64/8)+j]) << (8*j);
-  }
+static inline WizardSizeType LoadSHA3Lane(const unsigned char *p)
+{
+  return((WizardSizeType) p[0] | ((WizardSizeType) p[1] << 8) |
+    ((WizardSizeType) p[2] << 16) | ((WizardSizeType) p[3] << 24) |
+    ((WizardSizeType) p[4] << 32) | ((WizardSizeType) p[5] << 40) |
+    ((WizardSizeType) p[6] << 48) | ((WizardSizeType) p[7] << 56));
 }
 
-static inline void ConvertWordsToBytes(const WizardSizeType *words,
-  unsigned char *bytes)
+static void PermuteSHA3(WizardSizeType *state)
 {
-   ssize_t
+  ssize_t
     i;
 
-  for (i=0; i < (SHA3PermutationSize/64); i++)
-  {
-     ssize_t
-      j;
+  WizardSizeType
+    Aba,
+    Abe,
+    Abi,
+    Abo,
+    Abu,
+    Aga,
+    Age,
+    Agi,
+    Ago,
+    Agu,
+    Aka,
+    Ake,
+    Aki,
+    Ako,
+    Aku,
+    Ama,
+    Ame,
+    Ami,
+    Amo,
+    Amu,
+    Asa,
+    Ase,
+    Asi,
+    Aso,
+    Asu,
+    Eba,
+    Ebe,
+    Ebi,
+    Ebo,
+    Ebu,
+    Ega,
+    Ege,
+    Egi,
+    Ego,
+    Egu,
+    Eka,
+    Eke,
+    Eki,
+    Eko,
+    Eku,
+    Ema,
+    Eme,
+    Emi,
+    Emo,
+    Emu,
+    Esa,
+    Ese,
+    Esi,
+    Eso,
+    Esu,
+    Ba,
+    Be,
+    Bi,
+    Bo,
+    Bu,
+    Ca,
+    Ce,
+    Ci,
+    Co,
+    Cu,
+    Da,
+    De,
+    Di,
+    Do,
+    Du;
 
-    for (j=0; j < (64/8); j++)
-      bytes[i*(64/8)+j]=(unsigned char) ((words[i] >> (8*j)) & 0xFF);
+  Aba=state[0];
+  Abe=state[1];
+  Abi=state[2];
+  Abo=state[3];
+  Abu=state[4];
+  Aga=state[5];
+  Age=state[6];
+  Agi=state[7];
+  Ago=state[8];
+  Agu=state[9];
+  Aka=state[10];
+  Ake=state[11];
+  Aki=state[12];
+  Ako=state[13];
+  Aku=state[14];
+  Ama=state[15];
+  Ame=state[16];
+  Ami=state[17];
+  Amo=state[18];
+  Amu=state[19];
+  Asa=state[20];
+  Ase=state[21];
+  Asi=state[22];
+  Aso=state[23];
+  Asu=state[24];
+  for (i=0; i < SHA3Rounds; i+=2)
+  {
+    SHA3Round(A,E,i);
+    SHA3Round(E,A,i+1);
   }
+  state[0]=Aba;
+  state[1]=Abe;
+  state[2]=Abi;
+  state[3]=Abo;
+  state[4]=Abu;
+  state[5]=Aga;
+  state[6]=Age;
+  state[7]=Agi;
+  state[8]=Ago;
+  state[9]=Agu;
+  state[10]=Aka;
+  state[11]=Ake;
+  state[12]=Aki;
+  state[13]=Ako;
+  state[14]=Aku;
+  state[15]=Ama;
+  state[16]=Ame;
+  state[17]=Ami;
+  state[18]=Amo;
+  state[19]=Amu;
+  state[20]=Asa;
+  state[21]=Ase;
+  state[22]=Asi;
+  state[23]=Aso;
+  state[24]=Asu;
 }
 
-static void SHA3PermutationOnWords(const SHA3Info *sha_info,
-  WizardSizeType *state)
+static void AbsorbSHA3Blocks(SHA3Info *sha_info,const unsigned char *message,
+  const size_t blocks)
 {
-   ssize_t
-    i;
+  const unsigned char
+    *p;
+
+  size_t
+    i,
+    lanes;
 
-  for (i=0; i < SHA3Rounds; i++)
+  ssize_t
+    j;
+
+  WizardSizeType
+    lane;
+
+  /*
+    XOR each rate-sized block into the state as little-endian lanes.
+  */
+  lanes=sha_info->rate/64;
+  p=message;
+  for (j=0; j < (ssize_t) blocks; j++)
   {
-    ssize_t
-      x,
-      y;
-
-    WizardSizeType
-      C[5],
-      D[5],
-      T[25];
-
-    /*
-      Theta.
-    */
-    for (x=0; x < 5; x++)
-    {
-      C[x]=0;
-      for (y=0; y < 5; y++)
-        C[x]^=state[SHA3Index(x,y)];
-    }
-    for (x=0; x < 5; x++)
-      D[x]=SHA3RotateLeft(C[(x+1) % 5],1) ^ C[(x+4) % 5];
-    for (x=0; x < 5; x++)
-      for (y=0; y < 5; y++)
-        state[SHA3Index(x,y)]^=D[x];
-    /*
-      Rho.
-    */
-    for (x=0; x < 5; x++)
-      for (y=0; y < 5; y++)
-        state[SHA3Index(x,y)]=SHA3RotateLeft(state[SHA3Index(x,y)],
-          (WizardSizeType) sha_info->rho[SHA3Index(x,y)]);
-    /*
-      Pi.
-    */
-    for (x=0; x < 5; x++)
-      for (y=0; y < 5; y++)
-        T[SHA3Index(x,y)]=state[SHA3Index(x,y)];
-    for (x=0; x < 5; x++)
-      for (y=0; y < 5; y++)
-        state[SHA3Index(0*x+1*y,2*x+3*y)]=T[SHA3Index(x,y)];
-    /*
-      Chi.
-    */
-    for (y=0; y < 5; y++)
-    {
-      for (x=0; x < 5; x++)
-        C[x]=state[SHA3Index(x,y)] ^ ((~state[SHA3Index(x+1,y)]) &
-          state[SHA3Index(x+2,y)]);
-      for (x=0; x< 5; x++)
-        state[SHA3Index(x,y)]=C[x];
-     }
-    /*
-      Iota.
-    */
-    state[SHA3Index(0,0)]^=sha_info->rounds[i];
+    if (sha_info->lsb_first != WizardFalse)
+      for (i=0; i < lanes; i++)
+      {
+        (void) memcpy(&lane,p+8*i,sizeof(lane));
+        sha_info->state[i]^=lane;
+      }
+    else
+      for (i=0; i < lanes; i++)
+        sha_info->state[i]^=LoadSHA3Lane(p+8*i);
+    PermuteSHA3(sha_info->state);
+    p+=8*lanes;
   }
+  lane=0;
 }
 
-static inline void SHA3Permutation(const SHA3Info *sha_info,
+static inline void ExtractSHA3Lanes(const SHA3Info *sha_info,
   unsigned char *bytes)
 {
-  WizardSizeType
-    words[SHA3PermutationSize/64];
-
-  if (sha_info->lsb_first != 0)
-    SHA3PermutationOnWords(sha_info,(WizardSizeType *) bytes);
-  else
-    {
-      ConvertBytesToWords(bytes,words);
-      SHA3PermutationOnWords(sha_info,words);
-      ConvertWordsToBytes(words,bytes);
-    }
-}
+  size_t
+    i,
+    j;
 
-static inline void SHA3PermutationAfterXor(const SHA3Info *sha_info,
-  const unsigned char *message,const size_t length,unsigned char *state)
-{
-   ssize_t
-    i;
+  WizardSizeType
+    lane;
 
-  for (i=0; i < (ssize_t) length; i++)
-    state[i]^=message[i];
-  SHA3Permutation(sha_info,state);
+  for (i=0; i < (sha_info->rate/64); i++)
+  {
+    lane=sha_info->state[i] ^ ComplementMask[i];
+    for (j=0; j < 8; j++)
+      bytes[8*i+j]=(unsigned char) (lane >> (8*j));
+  }
+  lane=0;
 }
 
 static inline void AbsorbQueue(SHA3Info *sha_info)
 {
-  switch (sha_info->rate)
-  {
-    case 576:
-    {
-      SHA3PermutationAfterXor(sha_info,sha_info->message,72,sha_info->state);
-      break;
-    }
-    case 832:
-    {
-      SHA3PermutationAfterXor(sha_info,sha_info->message,104,sha_info->state);
-      break;
-    }
-    case 1024:
-    {
-      SHA3PermutationAfterXor(sha_info,sha_info->message,128,sha_info->state);
-      break;
-    }
-    case 1088:
-    {
-      SHA3PermutationAfterXor(sha_info,sha_info->message,136,sha_info->state);
-      break;
-    }
-    case 1152:
-    {
-      SHA3PermutationAfterXor(sha_info,sha_info->message,144,sha_info->state);
-      break;
-    }
-    case 1344:
-    {
-      SHA3PermutationAfterXor(sha_info,sha_info->message,168,sha_info->state);
-      break;
-    }
-    default:
-    {
-      SHA3PermutationAfterXor(sha_info,sha_info->message,8*sha_info->rate/64,
-        sha_info->state);
-      break;
-    }
-  }
+  AbsorbSHA3Blocks(sha_info,sha_info->message,1);
   sha_info->bits_in_queue=0;
 }
 
@@ -427,7 +632,7 @@ static inline void PadAndSwitchToSqueezingPhase(SHA3Info *sha_info)
     }
   sha_info->message[(sha_info->rate-1)/8]|=1 << ((sha_info->rate-1) % 8);
   AbsorbQueue(sha_info);
-  memcpy(sha_info->message,sha_info->state,8*sha_info->rate/64);
+  ExtractSHA3Lanes(sha_info,sha_info->message);
   sha_info->squeeze_bits=sha_info->rate;
   sha_info->squeeze=WizardTrue;
 }
@@ -452,8 +657,8 @@ static inline WizardBooleanType Squeeze(SHA3Info *sha_info,const size_t length,
   {
     if (sha_info->squeeze_bits == 0)
       {
-        SHA3Permutation(sha_info,sha_info->state);
-        memcpy(sha_info->message,sha_info->state,8*sha_info->rate/64);
+        PermuteSHA3(sha_info->state);
+        ExtractSHA3Lanes(sha_info,sha_info->message);
         sha_info->squeeze_bits=sha_info->rate;
       }
     bits=sha_info->squeeze_bits;
@@ -597,90 +802,91 @@ WizardExport unsigned int GetSHA3Digestsize(const SHA3Info *sha_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   I n i t i a l i z e S H A 3                                               %
+%   I m p o r t S H A 3 S t a t e                                             %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  IntializeSHA3() intializes the SHA3 accumulator.
+%  ImportSHA3State() restores a sponge returned by ExportSHA3State().  The
+%  state must come from the same SHA3 variant; otherwise WizardFalse is
+%  returned and the sponge is left as it was.
 %
-%  The format of the InitializeSHA3Info method is:
+%  The format of the ImportSHA3State method is:
 %
-%      WizardBooleanType InitializeSHA3(SHA3Info *sha_info)
+%      WizardBooleanType ImportSHA3State(SHA3Info *sha_info,
+%        const StringInfo *state)
 %
 %  A description of each parameter follows:
 %
-%    o sha_info: The cipher sha_info.
+%    o sha_info: The address of a structure of type SHA3Info.
+%
+%    o state: The exported state.
 %
 */
-
-static inline int LFSR86540(unsigned char *byte)
-{
-  int
-    result;
-
-  /*
-    Primitive polynomial over GF(2): x^8+x^6+x^5+x^4+1.
-  */
-  result=((*byte) & 0x01) != 0;
-  if (((*byte) & 0x80) != 0)
-    (*byte)=((*byte) << 1) ^ 0x71;
-  else
-    (*byte)<<=1;
-  return(result);
-}
-
-static inline void SHA3InitializeRoundConstants(SHA3Info *sha_info)
-{
-   ssize_t
-    i;
-
-  unsigned char
-    byte;
-
-  byte=0x01;
-  for (i=0; i < SHA3Rounds; i++)
-  {
-     ssize_t
-      j;
-
-    ssize_t
-      offset;
-
-    sha_info->rounds[i]=0;
-    for (j=0; j < 7; j++)
-    {
-      offset=(ssize_t) (1 << j)-1;
-      if (LFSR86540(&byte) != 0)
-        sha_info->rounds[i]^=(WizardSizeType) 1 << offset;
-    }
-  }
-}
-
-static inline void SHA3InitializeRho(SHA3Info *sha_info)
+WizardExport WizardBooleanType ImportSHA3State(SHA3Info *sha_info,
+  const StringInfo *state)
 {
-   ssize_t
-    i;
+  const unsigned char
+    *p;
 
   ssize_t
-    x,
-    y;
+    i;
 
-  sha_info->rho[SHA3Index(0,0)]=0;
-  x=1;
-  y=0;
-  for (i=0; i < 24; i++)
-  {
-    ssize_t
-      z;
+  unsigned int
+    bits_in_queue,
+    capacity,
+    rate;
 
-    sha_info->rho[SHA3Index(x,y)]=(unsigned int) (((i+1)*(i+2)/2) % 64);
-    z=x;
-    x=(0*x+1*y) % 5;
-    y=(2*z+3*y) % 5;
-  }
+  assert(sha_info != (SHA3Info *) NULL);
+  assert(sha_info->signature == WizardSignature);
+  capacity=16*sha_info->digestsize;
+  rate=SHA3PermutationSize-capacity;
+  if (GetStringInfoLength(state) != (8*SHA3Lanes+13+rate/8))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state)+8*SHA3Lanes;
+  if (ImportHashWord(&p,4) != capacity)
+    return(WizardFalse);
+  bits_in_queue=(unsigned int) ImportHashWord(&p,4);
+  if ((bits_in_queue > rate) || ((bits_in_queue % 8) != 0))
+    return(WizardFalse);
+  p=GetStringInfoDatum(state);
+  for (i=0; i < SHA3Lanes; i++)
+    sha_info->state[i]=ImportHashWord(&p,8);
+  sha_info->rate=rate;
+  sha_info->capacity=capacity;
+  sha_info->length=capacity/2;
+  p+=8;
+  sha_info->bits_in_queue=bits_in_queue;
+  sha_info->squeeze_bits=(unsigned int) ImportHashWord(&p,4);
+  sha_info->squeeze=ImportHashWord(&p,1) != 0 ? WizardTrue : WizardFalse;
+  (void) memset(sha_info->message,0,SHA3MaximumRate/8);
+  (void) CopyWizardMemory(sha_info->message,p,rate/8);
+  return(WizardTrue);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n i t i a l i z e S H A 3                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IntializeSHA3() intializes the SHA3 accumulator.
+%
+%  The format of the InitializeSHA3Info method is:
+%
+%      WizardBooleanType InitializeSHA3(SHA3Info *sha_info)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The cipher sha_info.
+%
+*/
 
 static inline WizardBooleanType InitializeSponge(SHA3Info *sha_info,
   const unsigned int rate,const unsigned int capacity)
@@ -689,12 +895,10 @@ static inline WizardBooleanType InitializeSponge(SHA3Info *sha_info,
     return(WizardFalse);
   if ((rate <= 0) || (rate >= 1600) || ((rate % 64) != 0))
     return(WizardFalse);
-  SHA3InitializeRoundConstants(sha_info);
-  SHA3InitializeRho(sha_info);
   sha_info->rate=rate;
   sha_info->capacity=capacity;
   sha_info->length=0;
-  memset(sha_info->state,0,SHA3PermutationSize/8);
+  (void) memcpy(sha_info->state,ComplementMask,sizeof(sha_info->state));
   memset(sha_info->message,0,SHA3MaximumRate/8);
   sha_info->bits_in_queue=0;
   sha_info->squeeze=WizardFalse;
@@ -772,13 +976,45 @@ WizardExport WizardBooleanType InitializeSHA3(SHA3Info *sha_info)
 %    o message: The message
 %
 */
+WizardExport WizardBooleanType UpdateSHA3(SHA3Info *sha_info,
+  const StringInfo *message)
+{
+  return(UpdateSHA3Bytes(sha_info,GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   U p d a t e S H A 3 B y t e s                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UpdateSHA3Bytes() updates the SHA3 message digest from the caller's memory
+%  without copying it into a StringInfo.
+%
+%  The format of the UpdateSHA3Bytes method is:
+%
+%      WizardBooleanType UpdateSHA3Bytes(SHA3Info *sha_info,
+%        const void *message,const size_t extent)
+%
+%  A description of each parameter follows:
+%
+%    o sha_info: The address of a structure of type SHA3Info.
+%
+%    o message: The message.
+%
+%    o extent: The length of the message in bytes.
+%
+*/
 
 static inline WizardBooleanType Absorb(SHA3Info *sha_info,
   const unsigned char *message,const size_t length)
 {
-   const unsigned char
-    *p;
-
    ssize_t
     i;
 
@@ -822,93 +1058,22 @@ static inline WizardBooleanType Absorb(SHA3Info *sha_info,
       }
     else
       {
-         ssize_t
-          j;
-
         blocks=(size_t) ((length-i)/sha_info->rate);
-        p=message+i/8;
-        switch (sha_info->rate)
-        {
-          case 576:
-          {
-            for (j=0; j < (ssize_t) blocks; j++)
-            {
-              SHA3PermutationAfterXor(sha_info,p,72,sha_info->state);
-              p+=576/8;
-            }
-            break;
-          }
-          case 832:
-          {
-            for (j=0; j < (ssize_t) blocks; j++)
-            {
-              SHA3PermutationAfterXor(sha_info,p,104,sha_info->state);
-              p+=832/8;
-            }
-            break;
-          }
-          case 1024:
-          {
-            for (j=0; j < (ssize_t) blocks; j++)
-            {
-              SHA3PermutationAfterXor(sha_info,p,128,sha_info->state);
-              p+=1024/8;
-            }
-            break;
-          }
-          case 1088:
-          {
-            for (j=0; j < (ssize_t) blocks; j++)
-            {
-              SHA3PermutationAfterXor(sha_info,p,136,sha_info->state);
-              p+=1088/8;
-            }
-            break;
-          }
-          case 1152:
-          {
-            for (j=0; j < (ssize_t) blocks; j++)
-            {
-              SHA3PermutationAfterXor(sha_info,p,144,sha_info->state);
-              p+=1152/8;
-            }
-            break;
-          }
-          case 1344:
-          {
-            for (j=0; j < (ssize_t) blocks; j++)
-            {
-              SHA3PermutationAfterXor(sha_info,p,168,sha_info->state);
-              p+=1344/8;
-            }
-            break;
-          }
-          default:
-          {
-            for (j=0; j < (ssize_t) blocks; j++)
-            {
-              SHA3PermutationAfterXor(sha_info,sha_info->message,8*
-                sha_info->rate/64,sha_info->state);
-              p+=sha_info->rate/8;
-            }
-            break;
-          }
-        }
+        AbsorbSHA3Blocks(sha_info,message+i/8,blocks);
         i+=blocks*sha_info->rate;
       }
   }
   return(WizardTrue);
 }
 
-WizardExport WizardBooleanType UpdateSHA3(SHA3Info *sha_info,
-  const StringInfo *message)
+WizardExport WizardBooleanType UpdateSHA3Bytes(SHA3Info *sha_info,
+  const void *message,const size_t extent)
 {
   WizardBooleanType
     status;
 
   assert(sha_info != (SHA3Info *) NULL);
   assert(sha_info->signature == WizardSignature);
-  status=Absorb(sha_info,GetStringInfoDatum(message),8*
-    GetStringInfoLength(message));
+  status=Absorb(sha_info,(const unsigned char *) message,8*extent);
   return(status);
 }
@@ -29,6 +29,9 @@ extern WizardExport SHA3Info
   *AcquireSHA3Info(const HashType),
   *DestroySHA3Info(SHA3Info *);
 
+extern WizardExport StringInfo
+  *ExportSHA3State(const SHA3Info *);
+
 extern WizardExport const StringInfo
   *GetSHA3Digest(const SHA3Info *);
 
@@ -37,9 +40,11 @@ extern WizardExport unsigned int
   GetSHA3Digestsize(const SHA3Info *);
 
 extern WizardExport WizardBooleanType
+  ImportSHA3State(SHA3Info *,const StringInfo *),
   InitializeSHA3(SHA3Info *),
   FinalizeSHA3(SHA3Info *),
-  UpdateSHA3(SHA3Info *,const StringInfo *);
+  UpdateSHA3(SHA3Info *,const StringInfo *),
+  UpdateSHA3Bytes(SHA3Info *,const void *,const size_t);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
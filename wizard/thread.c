@@ -54,21 +54,29 @@
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  WizardCreateThreadKey() creates a thread key and returns it.
+%  WizardCreateThreadKey() creates a thread key and returns it.  With POSIX
+%  threads, the destructor, if any, is called with the thread's value of the
+%  key when the thread exits if that value is not NULL.  Windows and
+%  single-threaded builds ignore the destructor, so values that outlive their
+%  thread are not released.
 %
 %  The format of the WizardCreateThreadKey method is:
 %
-%      WizardThreadKey WizardCreateThreadKey(WizardThreadKey *key)
+%      WizardThreadKey WizardCreateThreadKey(WizardThreadKey *key,
+%        void (*destructor)(void *))
 %
 */
-WizardExport WizardBooleanType WizardCreateThreadKey(WizardThreadKey *key)
+WizardExport WizardBooleanType WizardCreateThreadKey(WizardThreadKey *key,
+  void (*destructor)(void *))
 {
 #if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
-  return(pthread_key_create(key,NULL) == 0 ? WizardTrue : WizardFalse);
+  return(pthread_key_create(key,destructor) == 0 ? WizardTrue : WizardFalse);
 #elif defined(MAGICKORE_HAVE_WINTHREADS)
+  (void) destructor;
   *key=TlsAlloc();
   return(*key != TLS_OUT_OF_INDEXES ? WizardTrue : WizardFalse);
 #else
+  (void) destructor;
   *key=AcquireWizardMemory(sizeof(key));
   return(*key != (void *) NULL ? WizardTrue : WizardFalse);
 #endif
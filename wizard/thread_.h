@@ -39,7 +39,7 @@ typedef size_t *WizardThreadKey;
 #endif
 
 extern WizardExport WizardBooleanType
-  WizardCreateThreadKey(WizardThreadKey *),
+  WizardCreateThreadKey(WizardThreadKey *,void (*)(void *)),
   WizardDeleteThreadKey(WizardThreadKey),
   WizardSetThreadValue(WizardThreadKey,const void *);
 
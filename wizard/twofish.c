@@ -220,6 +220,120 @@ WizardExport void DecipherTwofishBlock(TwofishInfo *twofish_info,
   sigma=0;
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e c i p h e r T w o f i s h B l o c k s                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherTwofishBlocks() deciphers consecutive blocks of ciphertext to
+%  produce blocks of plaintext.
+%
+%  The format of the DecipherTwofishBlocks method is:
+%
+%     void DecipherTwofishBlocks(TwofishInfo *twofish_info,
+%       const unsigned char *ciphertext,unsigned char *plaintext,
+%       const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o twofish_info: The cipher context.
+%
+%    o ciphertext: The cipher text.
+%
+%    o plaintext: The plain text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+static void DecipherTwofishPair(TwofishInfo *twofish_info,
+  const unsigned char *ciphertext,unsigned char *plaintext)
+{
+  const unsigned char
+    *p;
+
+  ssize_t
+    i,
+    j;
+
+  unsigned char
+    *q;
+
+  unsigned int
+    alpha[2],
+    beta[2],
+    gamma[2],
+    delta[2],
+    rho,
+    sigma;
+
+  /*
+    Interleave the rounds of two blocks to hide the table lookup latency.
+  */
+  p=ciphertext;
+  for (j=0; j < 2; j++)
+  {
+    Read32Bits(gamma[j],p);
+    Read32Bits(delta[j],p);
+    Read32Bits(alpha[j],p);
+    Read32Bits(beta[j],p);
+    gamma[j]^=twofish_info->w[4];
+    delta[j]^=twofish_info->w[5];
+    alpha[j]^=twofish_info->w[6];
+    beta[j]^=twofish_info->w[7];
+  }
+  for (i=15; i > 0; i-=2)
+  {
+    DecipherRound(gamma[0],delta[0],alpha[0],beta[0],i);
+    DecipherRound(gamma[1],delta[1],alpha[1],beta[1],i);
+    DecipherRound(alpha[0],beta[0],gamma[0],delta[0],i-1);
+    DecipherRound(alpha[1],beta[1],gamma[1],delta[1],i-1);
+  }
+  q=plaintext;
+  for (j=0; j < 2; j++)
+  {
+    alpha[j]^=twofish_info->w[0];
+    Write32Bits(q,alpha[j]);
+    beta[j]^=twofish_info->w[1];
+    Write32Bits(q,beta[j]);
+    gamma[j]^=twofish_info->w[2];
+    Write32Bits(q,gamma[j]);
+    delta[j]^=twofish_info->w[3];
+    Write32Bits(q,delta[j]);
+  }
+  /*
+    Reset registers.
+  */
+  for (j=0; j < 2; j++)
+  {
+    alpha[j]=0;
+    beta[j]=0;
+    gamma[j]=0;
+    delta[j]=0;
+  }
+  rho=0;
+  sigma=0;
+}
+
+WizardExport void DecipherTwofishBlocks(TwofishInfo *twofish_info,
+  const unsigned char *ciphertext,unsigned char *plaintext,const size_t blocks)
+{
+  size_t
+    i;
+
+  for (i=0; (i+2) <= blocks; i+=2)
+    DecipherTwofishPair(twofish_info,ciphertext+TwofishBlocksize*i,
+      plaintext+TwofishBlocksize*i);
+  if (i < blocks)
+    DecipherTwofishBlock(twofish_info,ciphertext+TwofishBlocksize*i,
+      plaintext+TwofishBlocksize*i);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -349,6 +463,120 @@ WizardExport void EncipherTwofishBlock(TwofishInfo *twofish_info,
   sigma=0;
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r T w o f i s h B l o c k s                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherTwofishBlocks() enciphers consecutive blocks of plaintext to
+%  produce blocks of ciphertext.
+%
+%  The format of the EncipherTwofishBlocks method is:
+%
+%     void EncipherTwofishBlocks(TwofishInfo *twofish_info,
+%       const unsigned char *plaintext,unsigned char *ciphertext,
+%       const size_t blocks)
+%
+%  A description of each parameter follows:
+%
+%    o twofish_info: The cipher context.
+%
+%    o plaintext: The plain text.
+%
+%    o ciphertext: The cipher text.
+%
+%    o blocks: The number of blocks.
+%
+*/
+static void EncipherTwofishPair(TwofishInfo *twofish_info,
+  const unsigned char *plaintext,unsigned char *ciphertext)
+{
+  const unsigned char
+    *p;
+
+  ssize_t
+    i,
+    j;
+
+  unsigned char
+    *q;
+
+  unsigned int
+    alpha[2],
+    beta[2],
+    gamma[2],
+    delta[2],
+    rho,
+    sigma;
+
+  /*
+    Interleave the rounds of two blocks to hide the table lookup latency.
+  */
+  p=plaintext;
+  for (j=0; j < 2; j++)
+  {
+    Read32Bits(alpha[j],p);
+    Read32Bits(beta[j],p);
+    Read32Bits(gamma[j],p);
+    Read32Bits(delta[j],p);
+    alpha[j]^=twofish_info->w[0];
+    beta[j]^=twofish_info->w[1];
+    gamma[j]^=twofish_info->w[2];
+    delta[j]^=twofish_info->w[3];
+  }
+  for (i=0; i < 16; i+=2)
+  {
+    EncipherRound(alpha[0],beta[0],gamma[0],delta[0],i);
+    EncipherRound(alpha[1],beta[1],gamma[1],delta[1],i);
+    EncipherRound(gamma[0],delta[0],alpha[0],beta[0],i+1);
+    EncipherRound(gamma[1],delta[1],alpha[1],beta[1],i+1);
+  }
+  q=ciphertext;
+  for (j=0; j < 2; j++)
+  {
+    gamma[j]^=twofish_info->w[4];
+    Write32Bits(q,gamma[j]);
+    delta[j]^=twofish_info->w[5];
+    Write32Bits(q,delta[j]);
+    alpha[j]^=twofish_info->w[6];
+    Write32Bits(q,alpha[j]);
+    beta[j]^=twofish_info->w[7];
+    Write32Bits(q,beta[j]);
+  }
+  /*
+    Reset registers.
+  */
+  for (j=0; j < 2; j++)
+  {
+    alpha[j]=0;
+    beta[j]=0;
+    gamma[j]=0;
+    delta[j]=0;
+  }
+  rho=0;
+  sigma=0;
+}
+
+WizardExport void EncipherTwofishBlocks(TwofishInfo *twofish_info,
+  const unsigned char *plaintext,unsigned char *ciphertext,const size_t blocks)
+{
+  size_t
+    i;
+
+  for (i=0; (i+2) <= blocks; i+=2)
+    EncipherTwofishPair(twofish_info,plaintext+TwofishBlocksize*i,
+      ciphertext+TwofishBlocksize*i);
+  if (i < blocks)
+    EncipherTwofishBlock(twofish_info,plaintext+TwofishBlocksize*i,
+      ciphertext+TwofishBlocksize*i);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -394,6 +622,10 @@ WizardExport unsigned int GetTwofishBlocksize(const TwofishInfo *twofish_info)
 %  specified in bits.  Valid values are 128, 192, or 256 requiring a key
 %  buffer length in bytes of 16, 24, and 32 respectively.
 %
+%  The key is fully expanded: the key-dependent S-boxes are composed with the
+%  MDS matrix into four 256-entry tables, so the g-function of each round is
+%  four table lookups.
+%
 %  The format of the SetTwofishKey method is:
 %
 %      SetTwofishKey(TwofishInfo *twofish_info,const StringInfo *key)
@@ -34,7 +34,11 @@ extern WizardExport unsigned int
 
 extern WizardExport void
   DecipherTwofishBlock(TwofishInfo *,const unsigned char *,unsigned char *),
+  DecipherTwofishBlocks(TwofishInfo *,const unsigned char *,unsigned char *,
+    const size_t),
   EncipherTwofishBlock(TwofishInfo *,const unsigned char *,unsigned char *),
+  EncipherTwofishBlocks(TwofishInfo *,const unsigned char *,unsigned char *,
+    const size_t),
   SetTwofishKey(TwofishInfo *,const StringInfo *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
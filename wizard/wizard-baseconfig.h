@@ -175,6 +175,11 @@
 #define WIZARDSTOOLKIT_HAVE_GETPID 1
 #endif
 
+/* Define to 1 if you have the 'getrandom' function. */
+#ifndef WIZARDSTOOLKIT_HAVE_GETRANDOM
+#define WIZARDSTOOLKIT_HAVE_GETRANDOM 1
+#endif
+
 /* Define to 1 if you have the 'getrusage' function. */
 #ifndef WIZARDSTOOLKIT_HAVE_GETRUSAGE
 #define WIZARDSTOOLKIT_HAVE_GETRUSAGE 1